@@ -0,0 +1,76 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRAABBTree.h"
+#include "MRMesh/MRAABBTreeWide.h"
+#include "MRMesh/MRBitSet.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRRegionBoundary.h"
+#include <benchmark/benchmark.h>
+
+namespace MR::Bench
+{
+
+static void AABBTreeBuild( benchmark::State & state, Shape shape )
+{
+    const auto & mesh = getMesh( shape, state.range( 0 ) );
+    for ( auto _ : state )
+    {
+        AABBTree tree( mesh );
+        benchmark::DoNotOptimize( tree );
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidFaces() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( AABBTreeBuild, sphere, Shape::Sphere )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( AABBTreeBuild, grid, Shape::Grid )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void AABBTreeWideBuild( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    const auto & tree = mesh.getAABBTree();
+    for ( auto _ : state )
+    {
+        AABBTreeWide wide( tree );
+        benchmark::DoNotOptimize( wide );
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidFaces() );
+    state.counters["binaryBytes"] = double( tree.heapBytes() );
+    state.counters["wideBytes"] = double( AABBTreeWide( tree ).heapBytes() );
+}
+BENCHMARK( AABBTreeWideBuild )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void AABBTreeRefit( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    AABBTree tree( mesh );
+    for ( auto _ : state )
+    {
+        tree.refit( mesh, mesh.topology.getValidVerts() );
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidFaces() );
+}
+BENCHMARK( AABBTreeRefit )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void AABBTreeUpdate( benchmark::State & state )
+{
+    // a local edit moving a patch of 100 vertices, all incident faces are reinserted in the tree
+    Mesh mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    AABBTree tree( mesh );
+    VertBitSet moved( mesh.topology.vertSize() );
+    for ( int i = 0; i < 100; ++i )
+        moved.set( VertId( i ) );
+    const auto changedFaces = getIncidentFaces( mesh.topology, moved );
+    float sign = 1;
+    for ( auto _ : state )
+    {
+        for ( auto v : moved )
+            mesh.points[v] *= 1 + sign * 0.01f;
+        sign = -sign;
+        benchmark::DoNotOptimize( tree.update( mesh, changedFaces ) );
+    }
+    state.SetItemsProcessed( state.iterations() * changedFaces.count() );
+    state.counters["sahCost"] = tree.sahCost();
+}
+BENCHMARK( AABBTreeUpdate )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
@@ -0,0 +1,9 @@
+#include <benchmark/benchmark.h>
+
+// Run all benchmarks and store results in JSON to track regressions between releases:
+//   MRBench --benchmark_out=results.json --benchmark_out_format=json
+// Run only a subset of benchmarks:
+//   MRBench --benchmark_filter=AABBTree
+// Compare two JSON results with `compare.py` from Google Benchmark tools:
+//   compare.py benchmarks old.json new.json
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRBox.h"
+#include "MRMesh/MRMakeSphereMesh.h"
+#include "MRMesh/MRTorus.h"
+#include "MRMesh/MRRegularGridMesh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+
+namespace MR::Bench
+{
+
+namespace
+{
+
+Mesh makeGrid( std::int64_t numFaces )
+{
+    // a regular grid of (side-1)^2 quads has 2*(side-1)^2 triangles
+    const auto side = size_t( std::sqrt( double( numFaces ) / 2 ) ) + 1;
+    const float step = 1.0f / float( side );
+    auto res = makeRegularGridMesh( side, side,
+        [] ( size_t, size_t ) { return true; },
+        [step] ( size_t x, size_t y )
+        {
+            const float fx = x * step, fy = y * step;
+            // not planar surface to avoid degenerate cases in projection and decimation
+            return Vector3f( fx, fy, 0.05f * std::sin( 20 * fx ) * std::cos( 20 * fy ) );
+        } );
+    assert( res );
+    return res ? std::move( *res ) : Mesh{};
+}
+
+Mesh makeMesh( Shape shape, std::int64_t numFaces )
+{
+    switch ( shape )
+    {
+    case Shape::Sphere:
+        // closed mesh of genus 0 has F = 2V - 4
+        return makeSphere( { .radius = 1.0f, .numMeshVertices = int( numFaces / 2 + 2 ) } );
+    case Shape::Torus:
+    {
+        // torus has 2 * primary * secondary faces, take primary = 4 * secondary
+        const int secondary = std::max( 3, int( std::sqrt( double( numFaces ) / 8 ) ) );
+        return makeTorus( 1.0f, 0.3f, 4 * secondary, secondary );
+    }
+    case Shape::Grid:
+        return makeGrid( numFaces );
+    }
+    assert( false );
+    return {};
+}
+
+} //anonymous namespace
+
+const Mesh & getMesh( Shape shape, std::int64_t numFaces )
+{
+    static std::mutex mutex;
+    static std::map<std::pair<Shape, std::int64_t>, std::unique_ptr<Mesh>> cache;
+
+    std::lock_guard lock( mutex );
+    auto & ptr = cache[{ shape, numFaces }];
+    if ( !ptr )
+        ptr = std::make_unique<Mesh>( makeMesh( shape, numFaces ) );
+    return *ptr;
+}
+
+const char * shapeName( Shape shape )
+{
+    switch ( shape )
+    {
+    case Shape::Sphere:
+        return "sphere";
+    case Shape::Torus:
+        return "torus";
+    case Shape::Grid:
+        return "grid";
+    }
+    assert( false );
+    return "";
+}
+
+Rays makeRays( const Mesh & mesh, size_t numRays )
+{
+    const auto box = mesh.computeBoundingBox();
+    const auto center = box.center();
+    const auto radius = box.diagonal();
+
+    std::mt19937 gen( 42 );
+    std::normal_distribution<float> normal;
+    std::uniform_real_distribution<float> jitter( -0.25f, 0.25f );
+
+    Rays res;
+    res.origins.reserve( numRays );
+    res.dirs.reserve( numRays );
+    for ( size_t i = 0; i < numRays; ++i )
+    {
+        Vector3f d( normal( gen ), normal( gen ), normal( gen ) );
+        d = d.normalized();
+        const auto org = center + radius * d;
+        const Vector3f target = center + 0.5f * radius * Vector3f( jitter( gen ), jitter( gen ), jitter( gen ) );
+        res.origins.push_back( org );
+        res.dirs.push_back( ( target - org ).normalized() );
+    }
+    return res;
+}
+
+std::vector<Vector3f> makeQueryPoints( const Mesh & mesh, size_t numPoints )
+{
+    auto box = mesh.computeBoundingBox();
+    const auto expansion = Vector3f::diagonal( box.diagonal() / 4 );
+    box.include( box.min - expansion );
+    box.include( box.max + expansion );
+
+    std::mt19937 gen( 7 );
+    std::uniform_real_distribution<float> dx( box.min.x, box.max.x ), dy( box.min.y, box.max.y ), dz( box.min.z, box.max.z );
+
+    std::vector<Vector3f> res;
+    res.reserve( numPoints );
+    for ( size_t i = 0; i < numPoints; ++i )
+        res.emplace_back( dx( gen ), dy( gen ), dz( gen ) );
+    return res;
+}
+
+} //namespace MR::Bench
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MRMesh/MRMeshFwd.h"
+#include "MRMesh/MRVector3.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MR::Bench
+{
+
+/// kind of synthetic input mesh used in benchmarks
+enum class Shape
+{
+    Sphere, ///< closed sphere with irregular triangulation, see makeSphere
+    Torus,  ///< closed torus with regular triangulation, see makeTorus
+    Grid    ///< open wavy height-field with regular triangulation, see makeRegularGridMesh
+};
+
+/// default sizes of synthetic inputs (in number of faces)
+constexpr std::int64_t cSmall = 10'000;
+constexpr std::int64_t cMedium = 1'000'000;
+constexpr std::int64_t cLarge = 10'000'000;
+
+/// returns synthetic mesh of given shape with approximately given number of faces;
+/// the mesh is created on first request and then cached for the lifetime of the process,
+/// so several benchmarks over the same input do not pay for its generation;
+/// the meshes are built without any randomness to make the results comparable between runs and releases
+[[nodiscard]] const Mesh & getMesh( Shape shape, std::int64_t numFaces );
+
+/// returns human readable name of the shape (to be used as benchmark label)
+[[nodiscard]] const char * shapeName( Shape shape );
+
+/// a set of rays (origin + direction) for intersection benchmarks
+struct Rays
+{
+    std::vector<Vector3f> origins;
+    std::vector<Vector3f> dirs;
+};
+
+/// generates given number of rays starting outside of mesh bounding box and pointing inside it;
+/// the rays are generated by pseudo-random generator with fixed seed,
+/// so they repeat between runs, but std distributions may give other values with another standard library
+[[nodiscard]] Rays makeRays( const Mesh & mesh, size_t numRays );
+
+/// generates given number of query points within the bounding box of mesh expanded by its diagonal/4;
+/// the points are generated by pseudo-random generator with fixed seed,
+/// so they repeat between runs, but std distributions may give other values with another standard library
+[[nodiscard]] std::vector<Vector3f> makeQueryPoints( const Mesh & mesh, size_t numPoints );
+
+} //namespace MR::Bench
@@ -0,0 +1,52 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRAffineXf3.h"
+#include "MRMesh/MRBitSet.h"
+#include "MRMesh/MRBox.h"
+#include "MRMesh/MRFastWindingNumber.h"
+#include "MRMesh/MRMesh.h"
+#include <benchmark/benchmark.h>
+
+namespace MR::Bench
+{
+
+constexpr int cGridSide = 64;
+
+static void FwnCalcFromGrid( benchmark::State & state, bool secondOrder, float beta )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    (void)mesh.getDipoles(); // exclude tree and dipoles construction from measurements
+    FastWindingNumber fwn( mesh, secondOrder );
+
+    // the grid covers the bounding box of the mesh
+    const auto box = mesh.computeBoundingBox();
+    const Vector3i dims = Vector3i::diagonal( cGridSide );
+    const AffineXf3f gridToMeshXf( Matrix3f::scale( box.size() / float( cGridSide - 1 ) ), box.min );
+    std::vector<float> res;
+    for ( auto _ : state )
+    {
+        (void)fwn.calcFromGrid( res, dims, gridToMeshXf, beta, {} );
+        benchmark::DoNotOptimize( res.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * res.size() );
+}
+BENCHMARK_CAPTURE( FwnCalcFromGrid, first_order, false, 2.0f )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FwnCalcFromGrid, second_order, true, 1.5f )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FwnCalcSelfIntersections( benchmark::State & state, bool secondOrder, float beta )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    (void)mesh.getDipoles();
+    FastWindingNumber fwn( mesh, secondOrder );
+    FaceBitSet res;
+    for ( auto _ : state )
+    {
+        (void)fwn.calcSelfIntersections( res, beta, {} );
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidFaces() );
+    state.counters["selfIntersected"] = double( res.count() );
+}
+BENCHMARK_CAPTURE( FwnCalcSelfIntersections, first_order, false, 2.0f )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FwnCalcSelfIntersections, second_order, true, 1.5f )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
@@ -0,0 +1,97 @@
+#ifndef MESHLIB_NO_VOXELS
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRMesh.h"
+#include "MRVoxels/MRMarchingCubes.h"
+#include "MRVoxels/MRMeshToDistanceVolume.h"
+#include "MRMesh/MRParallelFor.h"
+#include <benchmark/benchmark.h>
+
+namespace MR::Bench
+{
+
+namespace
+{
+
+/// signed distance to the sphere inscribed in the grid of given dimension
+float sphereDistance( const Vector3i & v, int dim )
+{
+    const float c = 0.5f * dim;
+    return ( Vector3f( v ) + Vector3f::diagonal( 0.5f - c ) ).length() - 0.4f * dim;
+}
+
+SimpleVolume makeSphereVolume( int dim )
+{
+    SimpleVolume vol;
+    vol.dims = Vector3i::diagonal( dim );
+    vol.data.resize( size_t( dim ) * dim * dim );
+    ParallelFor( 0, dim, [&] ( int z )
+    {
+        size_t n = size_t( z ) * dim * dim;
+        for ( int y = 0; y < dim; ++y )
+            for ( int x = 0; x < dim; ++x )
+                vol.data[n++] = sphereDistance( { x, y, z }, dim );
+    } );
+    return vol;
+}
+
+} //anonymous namespace
+
+static void MarchingCubesSimpleVolume( benchmark::State & state )
+{
+    const auto dim = int( state.range( 0 ) );
+    const auto vol = makeSphereVolume( dim );
+    MarchingCubesParams params{ .lessInside = true };
+    size_t numFaces = 0;
+    for ( auto _ : state )
+    {
+        auto res = marchingCubes( vol, params );
+        numFaces = res ? res->topology.numValidFaces() : 0;
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * vol.data.size() );
+    state.counters["resultFaces"] = double( numFaces );
+}
+BENCHMARK( MarchingCubesSimpleVolume )->Arg( 64 )->Arg( 256 )->Arg( 512 )->Unit( benchmark::kMillisecond );
+
+static void MarchingCubesFunctionVolume( benchmark::State & state )
+{
+    const auto dim = int( state.range( 0 ) );
+    FunctionVolume vol;
+    vol.dims = Vector3i::diagonal( dim );
+    vol.data = [dim] ( const Vector3i & v ) { return sphereDistance( v, dim ); };
+    MarchingCubesParams params{ .lessInside = true };
+    size_t numFaces = 0;
+    for ( auto _ : state )
+    {
+        auto res = marchingCubes( vol, params );
+        numFaces = res ? res->topology.numValidFaces() : 0;
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * size_t( dim ) * dim * dim );
+    state.counters["resultFaces"] = double( numFaces );
+}
+BENCHMARK( MarchingCubesFunctionVolume )->Arg( 64 )->Arg( 256 )->Arg( 512 )->Unit( benchmark::kMillisecond );
+
+static void MeshToDistanceVolume( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    (void)mesh.getAABBTree();
+    const auto box = mesh.computeBoundingBox();
+    constexpr int cDim = 128;
+    MeshToDistanceVolumeParams params;
+    params.vol.origin = box.min;
+    params.vol.voxelSize = box.size() / float( cDim - 1 );
+    params.vol.dimensions = Vector3i::diagonal( cDim );
+    params.dist.maxDistSq = sqr( 3 * params.vol.voxelSize.x );
+    for ( auto _ : state )
+    {
+        auto res = meshToDistanceVolume( mesh, params );
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * size_t( cDim ) * cDim * cDim );
+}
+BENCHMARK( MeshToDistanceVolume )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
+
+#endif //!MESHLIB_NO_VOXELS
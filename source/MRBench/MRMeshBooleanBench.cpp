@@ -0,0 +1,53 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRAffineXf3.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRMeshBoolean.h"
+#include "MRMesh/MRMeshCollidePrecise.h"
+#include <benchmark/benchmark.h>
+
+namespace MR::Bench
+{
+
+static void Boolean( benchmark::State & state, BooleanOperation op )
+{
+    const auto & mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    // generic shift to avoid coinciding vertices of two copies of the same mesh
+    const auto xf = AffineXf3f::translation( { 0.31f, 0.23f, 0.17f } );
+    size_t numFaces = 0;
+    for ( auto _ : state )
+    {
+        auto res = boolean( mesh, mesh, op, &xf );
+        if ( !res.valid() )
+        {
+            state.SkipWithError( res.errorString.c_str() );
+            break;
+        }
+        numFaces = res.mesh.topology.numValidFaces();
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * 2 * mesh.topology.numValidFaces() );
+    state.counters["resultFaces"] = double( numFaces );
+}
+BENCHMARK_CAPTURE( Boolean, union, BooleanOperation::Union )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( Boolean, intersection, BooleanOperation::Intersection )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( Boolean, difference, BooleanOperation::DifferenceAB )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+static void CollidingEdgeTrisPrecise( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    (void)mesh.getAABBTree();
+    const auto xf = AffineXf3f::translation( { 0.31f, 0.23f, 0.17f } );
+    const auto conv = getVectorConverters( mesh, mesh, &xf ).toInt;
+    size_t numCollisions = 0;
+    for ( auto _ : state )
+    {
+        const auto res = findCollidingEdgeTrisPrecise( mesh, mesh, conv, &xf );
+        numCollisions = res.edgesAtrisB.size() + res.edgesBtrisA.size();
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * 2 * mesh.topology.numValidFaces() );
+    state.counters["collisions"] = double( numCollisions );
+}
+BENCHMARK( CollidingEdgeTrisPrecise )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
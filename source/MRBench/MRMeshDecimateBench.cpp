@@ -0,0 +1,39 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRBuffer.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRMeshDecimate.h"
+#include <benchmark/benchmark.h>
+
+namespace MR::Bench
+{
+
+static void DecimateMesh( benchmark::State & state, Shape shape, int subdivideParts )
+{
+    Mesh orgMesh = getMesh( shape, state.range( 0 ) );
+    if ( subdivideParts > 1 )
+        orgMesh.packOptimally(); // required for good performance of parallel decimation in parts
+    DecimateSettings settings
+    {
+        .maxError = 1e-3f,
+        .maxDeletedFaces = int( orgMesh.topology.numValidFaces() / 2 ),
+        .subdivideParts = subdivideParts,
+    };
+    DecimateResult res;
+    for ( auto _ : state )
+    {
+        state.PauseTiming();
+        Mesh mesh = orgMesh;
+        state.ResumeTiming();
+        res = decimateMesh( mesh, settings );
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * orgMesh.topology.numValidFaces() );
+    state.SetLabel( shapeName( shape ) );
+    state.counters["facesDeleted"] = double( res.facesDeleted );
+    state.counters["errorIntroduced"] = double( res.errorIntroduced );
+}
+BENCHMARK_CAPTURE( DecimateMesh, sphere, Shape::Sphere, 1 )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( DecimateMesh, grid, Shape::Grid, 1 )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( DecimateMesh, grid_parts, Shape::Grid, 64 )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
@@ -0,0 +1,66 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRAABBTreeWide.h"
+#include "MRMesh/MRBitSet.h"
+#include "MRMesh/MRLine3.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRMeshIntersect.h"
+#include <benchmark/benchmark.h>
+#include <cfloat>
+
+namespace MR::Bench
+{
+
+constexpr size_t cNumRays = 100'000;
+
+static void RayMeshIntersect( benchmark::State & state, bool wideTree )
+{
+    // the copy shares usual tree with cached mesh, but wide tree is created only in the copy
+    Mesh mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    (void)mesh.getAABBTree(); // exclude tree construction from measurements
+    const AABBTreeWide * wide = wideTree ? &mesh.getAABBTreeWide() : nullptr;
+    const auto rays = makeRays( mesh, cNumRays );
+    size_t numHits = 0;
+    for ( auto _ : state )
+    {
+        numHits = 0;
+        for ( size_t i = 0; i < rays.origins.size(); ++i )
+        {
+            const Line3f line( rays.origins[i], rays.dirs[i] );
+            if ( wide ? rayMeshIntersect( mesh, *wide, line ) : rayMeshIntersect( mesh, line ) )
+                ++numHits;
+        }
+        benchmark::DoNotOptimize( numHits );
+    }
+    state.SetItemsProcessed( state.iterations() * rays.origins.size() );
+    state.counters["hits"] = double( numHits );
+}
+BENCHMARK_CAPTURE( RayMeshIntersect, binary, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( RayMeshIntersect, wide, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void MultiRayMeshIntersect( benchmark::State & state, Shape shape, bool coherentPackets )
+{
+    const auto & mesh = getMesh( shape, state.range( 0 ) );
+    (void)mesh.getAABBTree();
+    const auto rays = makeRays( mesh, cNumRays );
+    BitSet hits;
+    std::vector<float> params;
+    std::vector<FaceId> faces;
+    MultiRayMeshIntersectResult res;
+    res.intersectingRays = &hits;
+    res.rayParams = &params;
+    res.isectFaces = &faces;
+    for ( auto _ : state )
+    {
+        multiRayMeshIntersect( mesh, rays.origins, rays.dirs, res, 0.0f, FLT_MAX, true, {}, coherentPackets );
+        benchmark::DoNotOptimize( params.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * rays.origins.size() );
+    state.SetLabel( shapeName( shape ) );
+    state.counters["hits"] = double( hits.count() );
+}
+BENCHMARK_CAPTURE( MultiRayMeshIntersect, sphere, Shape::Sphere, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( MultiRayMeshIntersect, torus, Shape::Torus, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( MultiRayMeshIntersect, sphere_packets, Shape::Sphere, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( MultiRayMeshIntersect, torus_packets, Shape::Torus, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
@@ -0,0 +1,129 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRMeshLoad.h"
+#include "MRMesh/MRMeshSave.h"
+#include "MRMesh/MRMappedMrmesh.h"
+#include "MRMesh/MRUniqueTemporaryFolder.h"
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+
+namespace MR::Bench
+{
+
+static void SaveMesh( benchmark::State & state, std::string extension )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    size_t bytes = 0;
+    for ( auto _ : state )
+    {
+        std::ostringstream out( std::ios::binary );
+        if ( auto res = MeshSave::toAnySupportedFormat( mesh, extension, out ); !res )
+        {
+            state.SkipWithError( res.error().c_str() );
+            break;
+        }
+        bytes = out.view().size();
+        benchmark::DoNotOptimize( bytes );
+    }
+    state.SetBytesProcessed( state.iterations() * bytes );
+}
+
+static void LoadMesh( benchmark::State & state, std::string extension )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    std::ostringstream out( std::ios::binary );
+    if ( auto res = MeshSave::toAnySupportedFormat( mesh, extension, out ); !res )
+    {
+        state.SkipWithError( res.error().c_str() );
+        return;
+    }
+    const auto data = std::move( out ).str();
+    for ( auto _ : state )
+    {
+        std::istringstream in( data, std::ios::binary );
+        auto res = MeshLoad::fromAnySupportedFormat( in, extension );
+        if ( !res )
+        {
+            state.SkipWithError( res.error().c_str() );
+            break;
+        }
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetBytesProcessed( state.iterations() * data.size() );
+}
+
+/// loading of ASCII .ply, which is parsed by lines in parallel
+static void LoadAsciiPly( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    std::ostringstream out;
+    out << "ply\nformat ascii 1.0\nelement vertex " << mesh.points.size() << "\nproperty float x\nproperty float y\nproperty float z\n"
+        "element face " << mesh.topology.numValidFaces() << "\nproperty list uchar int vertex_indices\nend_header\n";
+    for ( const auto & p : mesh.points )
+        out << p.x << ' ' << p.y << ' ' << p.z << '\n';
+    for ( auto f : mesh.topology.getValidFaces() )
+    {
+        const auto vs = mesh.topology.getTriVerts( f );
+        out << "3 " << int( vs[0] ) << ' ' << int( vs[1] ) << ' ' << int( vs[2] ) << '\n';
+    }
+    const auto data = std::move( out ).str();
+    for ( auto _ : state )
+    {
+        std::istringstream in( data );
+        auto res = MeshLoad::fromPly( in );
+        if ( !res )
+        {
+            state.SkipWithError( res.error().c_str() );
+            break;
+        }
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetBytesProcessed( state.iterations() * data.size() );
+}
+BENCHMARK( LoadAsciiPly )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+/// loading of .mrmesh from file: mapping only (constant time) or mapping and conversion in Mesh
+static void LoadMappedMrmesh( benchmark::State & state, bool makeMesh )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    UniqueTemporaryFolder folder( {} );
+    const auto path = folder / "bench.mrmesh";
+    if ( auto res = MeshSave::toMrmesh( mesh, path ); !res )
+    {
+        state.SkipWithError( res.error().c_str() );
+        return;
+    }
+    for ( auto _ : state )
+    {
+        auto mapped = MappedMrmesh::open( path );
+        if ( !mapped )
+        {
+            state.SkipWithError( mapped.error().c_str() );
+            break;
+        }
+        if ( makeMesh )
+        {
+            auto res = mapped->toMesh();
+            benchmark::DoNotOptimize( res );
+        }
+        benchmark::DoNotOptimize( mapped );
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidFaces() );
+}
+BENCHMARK_CAPTURE( LoadMappedMrmesh, open, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( LoadMappedMrmesh, toMesh, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+#define MR_BENCH_MESH_FORMAT( name, ext ) \
+    BENCHMARK_CAPTURE( SaveMesh, name, ext )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond ); \
+    BENCHMARK_CAPTURE( LoadMesh, name, ext )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+MR_BENCH_MESH_FORMAT( mrmesh, "*.mrmesh" )
+MR_BENCH_MESH_FORMAT( stl, "*.stl" )
+MR_BENCH_MESH_FORMAT( ply, "*.ply" )
+BENCHMARK_CAPTURE( SaveMesh, ply, "*.ply" )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( LoadMesh, ply, "*.ply" )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+MR_BENCH_MESH_FORMAT( obj, "*.obj" )
+MR_BENCH_MESH_FORMAT( off, "*.off" )
+
+} //namespace MR::Bench
@@ -0,0 +1,76 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRAABBTreeWide.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRMeshProject.h"
+#include "MRMesh/MRParallelFor.h"
+#include <benchmark/benchmark.h>
+#include <cfloat>
+
+namespace MR::Bench
+{
+
+constexpr size_t cNumQueries = 100'000;
+
+static void FindProjection( benchmark::State & state, Shape shape, bool wideTree )
+{
+    // the copy shares usual tree with cached mesh, but wide tree is created only in the copy
+    Mesh mesh = getMesh( shape, state.range( 0 ) );
+    // exclude tree construction from measurements
+    const AABBTreeWide * wide = wideTree ? &mesh.getAABBTreeWide() : nullptr;
+    const auto & tree = mesh.getAABBTree();
+    const auto pts = makeQueryPoints( mesh, cNumQueries );
+    std::vector<MeshProjectionResult> res( pts.size() );
+    for ( auto _ : state )
+    {
+        ParallelFor( pts, [&] ( size_t i )
+        {
+            res[i] = wide ? findProjectionSubtree( pts[i], mesh, *wide ) : findProjectionSubtree( pts[i], mesh, tree );
+        } );
+        benchmark::DoNotOptimize( res.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * pts.size() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( FindProjection, sphere, Shape::Sphere, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindProjection, grid, Shape::Grid, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindProjection, sphere_wide, Shape::Sphere, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindProjection, grid_wide, Shape::Grid, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FindProjections( benchmark::State & state, Shape shape, bool wideTree )
+{
+    Mesh mesh = getMesh( shape, state.range( 0 ) );
+    (void)mesh.getAABBTree();
+    const AABBTreeWide * wide = wideTree ? &mesh.getAABBTreeWide() : nullptr;
+    const auto pts = makeQueryPoints( mesh, cNumQueries );
+    for ( auto _ : state )
+    {
+        auto res = findProjections( pts, mesh, FLT_MAX, {}, 0, {}, wide );
+        benchmark::DoNotOptimize( res.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * pts.size() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( FindProjections, sphere, Shape::Sphere, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindProjections, grid, Shape::Grid, false )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindProjections, sphere_wide, Shape::Sphere, true )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FindSignedDistance( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Torus, state.range( 0 ) );
+    (void)mesh.getAABBTree();
+    const auto pts = makeQueryPoints( mesh, cNumQueries );
+    std::vector<float> res( pts.size() );
+    for ( auto _ : state )
+    {
+        ParallelFor( pts, [&] ( size_t i )
+        {
+            if ( auto sd = findSignedDistance( pts[i], mesh ) )
+                res[i] = sd->dist;
+        } );
+        benchmark::DoNotOptimize( res.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * pts.size() );
+}
+BENCHMARK( FindSignedDistance )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
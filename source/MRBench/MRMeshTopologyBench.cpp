@@ -0,0 +1,104 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRFrozenMeshTopology.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRRingIterator.h"
+#include "MRMesh/MRBitSetParallelFor.h"
+#include "MRMesh/MRMeshComponents.h"
+#include "MRMesh/MRUnionFind.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+
+namespace MR::Bench
+{
+
+namespace
+{
+
+/// sums the degrees of all vertices by full iteration over their origin rings
+template <typename T>
+size_t sumVertDegrees( const T & topology )
+{
+    std::atomic<size_t> res{ 0 };
+    BitSetParallelFor( topology.getValidVerts(), [&] ( VertId v )
+    {
+        size_t degree = 0;
+        for ( [[maybe_unused]] EdgeId e : orgRing( topology, v ) )
+            ++degree;
+        res.fetch_add( degree, std::memory_order_relaxed );
+    } );
+    return res;
+}
+
+} //anonymous namespace
+
+static void OrgRingTraversal( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( sumVertDegrees( mesh.topology ) );
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidVerts() );
+}
+BENCHMARK( OrgRingTraversal )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void OrgRingTraversalFrozen( benchmark::State & state )
+{
+    const FrozenMeshTopology frozen( getMesh( Shape::Sphere, state.range( 0 ) ).topology );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( sumVertDegrees( frozen ) );
+    state.SetItemsProcessed( state.iterations() * frozen.numValidVerts() );
+}
+BENCHMARK( OrgRingTraversalFrozen )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FindBoundaryVerts( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Grid, state.range( 0 ) );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( mesh.topology.findBoundaryVerts() );
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidVerts() );
+}
+BENCHMARK( FindBoundaryVerts )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FindBoundaryVertsFrozen( benchmark::State & state )
+{
+    const FrozenMeshTopology frozen( getMesh( Shape::Grid, state.range( 0 ) ).topology );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( frozen.findBoundaryVerts() );
+    state.SetItemsProcessed( state.iterations() * frozen.numValidVerts() );
+}
+BENCHMARK( FindBoundaryVertsFrozen )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FindHoleRepresentiveEdges( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Grid, state.range( 0 ) );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( mesh.topology.findHoleRepresentiveEdges() );
+}
+BENCHMARK( FindHoleRepresentiveEdges )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void FindHoleRepresentiveEdgesFrozen( benchmark::State & state )
+{
+    const FrozenMeshTopology frozen( getMesh( Shape::Grid, state.range( 0 ) ).topology );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( frozen.findHoleRepresentiveEdges() );
+}
+BENCHMARK( FindHoleRepresentiveEdgesFrozen )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void UnionFindFaces( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( MeshComponents::getUnionFindStructureFacesPerEdge( mesh ) );
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidFaces() );
+}
+BENCHMARK( UnionFindFaces )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void UnionFindVerts( benchmark::State & state )
+{
+    const auto & mesh = getMesh( Shape::Sphere, state.range( 0 ) );
+    for ( auto _ : state )
+        benchmark::DoNotOptimize( MeshComponents::getUnionFindStructureVerts( mesh ) );
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidVerts() );
+}
+BENCHMARK( UnionFindVerts )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
@@ -0,0 +1,86 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRPointCloud.h"
+#include "MRMesh/MRBox.h"
+#include "MRMesh/MRPointsKNearest.h"
+#include "MRMesh/MRBuffer.h"
+#include "MRMesh/MROutlierPoints.h"
+#include "MRMesh/MRPointCloudMakeNormals.h"
+#include "MRMesh/MRPointCloudTriangulation.h"
+#include "MRMesh/MRUniformSampling.h"
+#include <benchmark/benchmark.h>
+
+namespace MR::Bench
+{
+
+static PointCloud makeCloud( Shape shape, std::int64_t numFaces )
+{
+    const auto & mesh = getMesh( shape, numFaces );
+    PointCloud pc;
+    pc.points = mesh.points;
+    pc.validPoints = mesh.topology.getValidVerts();
+    (void)pc.getAABBTree(); // exclude tree construction from measurements
+    return pc;
+}
+
+static void FindNClosestPointsPerPoint( benchmark::State & state, Shape shape )
+{
+    const auto pc = makeCloud( shape, state.range( 0 ) );
+    for ( auto _ : state )
+    {
+        auto res = findNClosestPointsPerPoint( pc, 16 );
+        benchmark::DoNotOptimize( res.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * pc.validPoints.count() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( FindNClosestPointsPerPoint, sphere, Shape::Sphere )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindNClosestPointsPerPoint, grid, Shape::Grid )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+static void FindAllKNearestPoints( benchmark::State & state, Shape shape )
+{
+    const auto pc = makeCloud( shape, state.range( 0 ) );
+    for ( auto _ : state )
+    {
+        auto res = findAllKNearestPoints( pc, 16 );
+        benchmark::DoNotOptimize( res->neighbors.data() );
+    }
+    state.SetItemsProcessed( state.iterations() * pc.validPoints.count() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( FindAllKNearestPoints, sphere, Shape::Sphere )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( FindAllKNearestPoints, grid, Shape::Grid )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+/// outlier search, normal estimation, triangulation and sampling of one cloud,
+/// either with independent neighbour searches or with the neighbour tables cached in the cloud
+static void PointCloudPipeline( benchmark::State & state, Shape shape, bool cachedNeighbors )
+{
+    const auto pc0 = makeCloud( shape, state.range( 0 ) );
+    const float radius = 2 * pc0.getBoundingBox().diagonal() / std::sqrt( float( pc0.validPoints.count() ) );
+    const TriangulationParameters triParams;
+    for ( auto _ : state )
+    {
+        state.PauseTiming();
+        auto pc = pc0; // a copy shares the tree but not the tables built below
+        state.ResumeTiming();
+        const auto * radiusNeis = cachedNeighbors ? pc.getNeighborsInRadius( radius ) : nullptr;
+        const auto * kNeis = cachedNeighbors ? pc.getKNearestNeighbors( triParams.numNeighbours ) : nullptr;
+
+        auto outliers = findOutliers( pc, { .radius = radius, .neighbors = radiusNeis } );
+        benchmark::DoNotOptimize( outliers );
+        auto normals = makeOrientedNormals( pc, radius, {}, radiusNeis );
+        benchmark::DoNotOptimize( normals );
+        auto triParamsWithNeis = triParams;
+        triParamsWithNeis.neighbors = kNeis;
+        auto mesh = triangulatePointCloud( pc, triParamsWithNeis );
+        benchmark::DoNotOptimize( mesh );
+        auto samples = pointUniformSampling( pc, { .distance = radius, .neighbors = radiusNeis } );
+        benchmark::DoNotOptimize( samples );
+    }
+    state.SetItemsProcessed( state.iterations() * pc0.validPoints.count() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( PointCloudPipeline, sphere, Shape::Sphere, false )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( PointCloudPipeline, sphere_cached, Shape::Sphere, true )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
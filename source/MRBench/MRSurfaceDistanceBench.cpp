@@ -0,0 +1,45 @@
+#include "MRBenchMeshes.h"
+#include "MRMesh/MRBitSet.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRSurfaceDistance.h"
+#include <benchmark/benchmark.h>
+#include <cfloat>
+
+namespace MR::Bench
+{
+
+static void ComputeSurfaceDistances( benchmark::State & state, Shape shape, float maxDist )
+{
+    const auto & mesh = getMesh( shape, state.range( 0 ) );
+    VertBitSet starts( mesh.topology.vertSize() );
+    starts.set( mesh.topology.getValidVerts().find_first() );
+    for ( auto _ : state )
+    {
+        auto res = computeSurfaceDistances( mesh, starts, maxDist );
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidVerts() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( ComputeSurfaceDistances, sphere, Shape::Sphere, FLT_MAX )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( ComputeSurfaceDistances, grid, Shape::Grid, FLT_MAX )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( ComputeSurfaceDistances, grid_local, Shape::Grid, 0.1f )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+static void ComputeSurfaceDistancesParallel( benchmark::State & state, Shape shape, float maxDist )
+{
+    const auto & mesh = getMesh( shape, state.range( 0 ) );
+    VertBitSet starts( mesh.topology.vertSize() );
+    starts.set( mesh.topology.getValidVerts().find_first() );
+    for ( auto _ : state )
+    {
+        auto res = computeSurfaceDistancesParallel( mesh, starts, maxDist );
+        benchmark::DoNotOptimize( res );
+    }
+    state.SetItemsProcessed( state.iterations() * mesh.topology.numValidVerts() );
+    state.SetLabel( shapeName( shape ) );
+}
+BENCHMARK_CAPTURE( ComputeSurfaceDistancesParallel, sphere, Shape::Sphere, FLT_MAX )->Arg( cSmall )->Arg( cMedium )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( ComputeSurfaceDistancesParallel, grid, Shape::Grid, FLT_MAX )->Arg( cSmall )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+BENCHMARK_CAPTURE( ComputeSurfaceDistancesParallel, grid_local, Shape::Grid, 0.1f )->Arg( cMedium )->Arg( cLarge )->Unit( benchmark::kMillisecond );
+
+} //namespace MR::Bench
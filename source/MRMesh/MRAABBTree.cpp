@@ -7,6 +7,12 @@
 #include "MRBuffer.h"
 #include "MRGTest.h"
 #include "MRRegionBoundary.h"
+#include "MRBitSetParallelFor.h"
+#include "MRParallelFor.h"
+#include "MRTorus.h"
+#include "MRMeshFillHole.h"
+#include "MRMeshSubdivide.h"
+#include <tbb/parallel_reduce.h>
 
 namespace MR
 {
@@ -96,6 +102,349 @@ void AABBTree::refit( const Mesh & mesh, const VertBitSet & changedVerts )
     }
 }
 
+/// half of the surface area of the box
+static float halfArea( const Box3f & box )
+{
+    if ( !box.valid() )
+        return 0;
+    const auto s = box.size();
+    return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+static Box3f unite( Box3f a, const Box3f & b )
+{
+    a.include( b );
+    return a;
+}
+
+float AABBTree::sahCost() const
+{
+    MR_TIMER;
+    if ( nodes_.empty() )
+        return 0;
+    const auto rootArea = halfArea( nodes_[rootNodeId()].box );
+    if ( !( rootArea > 0 ) )
+        return 0;
+    const double sum = tbb::parallel_reduce( tbb::blocked_range<NodeId>( NodeId( 0 ), nodes_.endId() ), 0.0,
+        [&] ( const tbb::blocked_range<NodeId> & range, double curr )
+        {
+            for ( auto nid = range.begin(); nid < range.end(); ++nid )
+                if ( !nodes_[nid].leaf() )
+                    curr += halfArea( nodes_[nid].box );
+            return curr;
+        }, std::plus<double>() );
+    return float( sum / rootArea );
+}
+
+namespace
+{
+
+/// the tree during incremental update, where the nodes can be removed and added in any place of the vector
+class DynamicTree
+{
+public:
+    using Node = AABBTree::Node;
+    using NodeVec = AABBTree::NodeVec;
+
+    /// takes the nodes of the tree, and finds the leaves of given faces in \param changedLeaves
+    DynamicTree( NodeVec && nodes, const FaceBitSet & changedFaces, Vector<NodeId, FaceId> & changedLeaves ) : nodes_( std::move( nodes ) )
+    {
+        MR_TIMER;
+        parent_.resize( nodes_.size() );
+        dirty_.resize( nodes_.size() );
+        root_ = nodes_.empty() ? NodeId{} : AABBTree::rootNodeId();
+        sumArea_ = tbb::parallel_reduce( tbb::blocked_range<NodeId>( NodeId( 0 ), nodes_.endId() ), 0.0,
+            [&] ( const tbb::blocked_range<NodeId> & range, double curr )
+            {
+                for ( auto nid = range.begin(); nid < range.end(); ++nid )
+                {
+                    const auto & node = nodes_[nid];
+                    if ( node.leaf() )
+                    {
+                        if ( const auto f = node.leafId(); changedFaces.test( f ) )
+                            changedLeaves[f] = nid;
+                        continue;
+                    }
+                    parent_[node.l] = nid;
+                    parent_[node.r] = nid;
+                    curr += halfArea( node.box );
+                }
+                return curr;
+            }, std::plus<double>() );
+    }
+
+    /// returns sahCost() of the tree in its current state
+    [[nodiscard]] float sahCost() const
+    {
+        const auto rootArea = root_ ? halfArea( nodes_[root_].box ) : 0.0f;
+        return rootArea > 0 ? float( sumArea_ / rootArea ) : 0.0f;
+    }
+
+    /// removes given leaf node together with its parent, which is replaced by the sibling of the leaf
+    void removeLeaf( NodeId leaf )
+    {
+        assert( nodes_[leaf].leaf() );
+        free_( leaf );
+        const auto p = parent_[leaf];
+        if ( !p )
+        {
+            assert( leaf == root_ );
+            root_ = {};
+            return;
+        }
+        const auto sibling = nodes_[p].l == leaf ? nodes_[p].r : nodes_[p].l;
+        const auto g = parent_[p];
+        free_( p );
+        parent_[sibling] = g;
+        if ( !g )
+        {
+            root_ = sibling;
+            return;
+        }
+        auto & gnode = nodes_[g];
+        ( gnode.l == p ? gnode.l : gnode.r ) = sibling;
+        refitUpwards_( g );
+    }
+
+    /// inserts new leaf with given face and box as the sibling of the node, where the increase of surface areas is minimal
+    void insertLeaf( FaceId f, const Box3f & box )
+    {
+        const auto leaf = alloc_();
+        nodes_[leaf].setLeafId( f );
+        nodes_[leaf].box = box;
+        if ( !root_ )
+        {
+            root_ = leaf;
+            return;
+        }
+
+        // greedy descent: stop at the node if making it the sibling is cheaper than the lower bound of descending into any of its children
+        auto sibling = root_;
+        while ( !nodes_[sibling].leaf() )
+        {
+            const auto & node = nodes_[sibling];
+            const auto area = halfArea( node.box );
+            const auto unitedArea = halfArea( unite( node.box, box ) );
+            const auto cost = 2 * unitedArea; // new parent with this node and the leaf as children
+            const auto inheritanceCost = 2 * ( unitedArea - area ); // the increase of this node's area if the leaf is inserted below
+            auto childCost = [&]( NodeId c )
+            {
+                const auto & cbox = nodes_[c].box;
+                const auto united = halfArea( unite( cbox, box ) );
+                return nodes_[c].leaf() ? united + inheritanceCost : united - halfArea( cbox ) + inheritanceCost;
+            };
+            const auto costL = childCost( node.l );
+            const auto costR = childCost( node.r );
+            if ( cost < costL && cost < costR )
+                break;
+            sibling = costL < costR ? node.l : node.r;
+        }
+
+        const auto oldParent = parent_[sibling];
+        const auto newParent = alloc_();
+        auto & pnode = nodes_[newParent];
+        pnode.l = sibling;
+        pnode.r = leaf;
+        pnode.box = unite( nodes_[sibling].box, box );
+        sumArea_ += halfArea( pnode.box );
+        parent_[newParent] = oldParent;
+        parent_[sibling] = newParent;
+        parent_[leaf] = newParent;
+        if ( !oldParent )
+        {
+            root_ = newParent;
+            return;
+        }
+        auto & onode = nodes_[oldParent];
+        ( onode.l == sibling ? onode.l : onode.r ) = newParent;
+        refitUpwards_( oldParent );
+    }
+
+    /// returns the nodes of the tree in depth-first order without gaps, so the children always follow their parents;
+    /// the subtrees without any changes are copied as whole blocks, since they are already in depth-first order
+    [[nodiscard]] NodeVec compact() const
+    {
+        MR_TIMER;
+        NodeVec res;
+        if ( !root_ )
+            return res;
+        res.resize( nodes_.size() - freeNodes_.size() );
+        assert( subtreeSize_( root_ ) == res.size() );
+        struct Item
+        {
+            NodeId src;
+            NodeId dst;
+        };
+        std::vector<Item> stack, cleanSubtrees;
+        stack.push_back( { root_, NodeId( 0 ) } );
+        while ( !stack.empty() )
+        {
+            const auto [src, dst] = stack.back();
+            stack.pop_back();
+            if ( !dirty_.test( src ) )
+            {
+                cleanSubtrees.push_back( { src, dst } );
+                continue;
+            }
+            const auto & node = nodes_[src];
+            auto & out = res[dst];
+            out = node;
+            if ( node.leaf() )
+                continue;
+            out.l = dst + 1;
+            out.r = out.l + subtreeSize_( node.l );
+            stack.push_back( { node.r, out.r } );
+            stack.push_back( { node.l, out.l } ); // to process first
+        }
+
+        // clean subtree occupies the block of nodes [src, src + size) in depth-first order, which is copied with the shift of children ids
+        ParallelFor( cleanSubtrees, [&]( size_t i )
+        {
+            const auto [src, dst] = cleanSubtrees[i];
+            const int size = subtreeSize_( src );
+            const int shift = dst - src;
+            for ( int j = 0; j < size; ++j )
+            {
+                auto n = nodes_[src + j];
+                if ( !n.leaf() )
+                {
+                    n.l += shift;
+                    n.r += shift;
+                }
+                res[dst + j] = n;
+            }
+        } );
+        return res;
+    }
+
+private:
+    NodeId alloc_()
+    {
+        if ( !freeNodes_.empty() )
+        {
+            const auto res = freeNodes_.back();
+            freeNodes_.pop_back();
+            dirty_.set( res );
+            return res;
+        }
+        parent_.emplace_back();
+        dirty_.autoResizeSet( nodes_.endId() );
+        return nodes_.emplace_back(), nodes_.backId();
+    }
+
+    void free_( NodeId nid )
+    {
+        if ( !nodes_[nid].leaf() )
+            sumArea_ -= halfArea( nodes_[nid].box );
+        freeNodes_.push_back( nid );
+    }
+
+    /// the number of nodes in the subtree with given root
+    [[nodiscard]] int subtreeSize_( NodeId nid ) const
+    {
+        // the subtree of a dirty node can contain nodes at any places, so its leaves are counted
+        if ( dirty_.test( nid ) )
+            return nodes_[nid].leaf() ? 1 : 1 + subtreeSize_( nodes_[nid].l ) + subtreeSize_( nodes_[nid].r );
+        auto last = nid;
+        while ( !nodes_[last].leaf() )
+            last = nodes_[last].r;
+        return last - nid + 1;
+    }
+
+    /// changes the box of not-leaf node
+    void setBox_( NodeId nid, const Box3f & box )
+    {
+        auto & node = nodes_[nid];
+        sumArea_ += double( halfArea( box ) ) - halfArea( node.box );
+        node.box = box;
+    }
+
+    /// updates the boxes of given node and all its ancestors, and rotates the subtrees to reduce the areas of the nodes
+    void refitUpwards_( NodeId nid )
+    {
+        for ( ; nid; nid = parent_[nid] )
+        {
+            dirty_.set( nid );
+            rotate_( nid );
+            const auto & node = nodes_[nid];
+            setBox_( nid, unite( nodes_[node.l].box, nodes_[node.r].box ) );
+        }
+    }
+
+    /// tries to swap a child of given node with a grandchild from another side, if it reduces the area of grandchild's parent
+    void rotate_( NodeId nid )
+    {
+        const auto & node = nodes_[nid];
+        NodeId bestA, bestB; // a child and a grandchild to swap
+        float bestGain = 0;
+        auto consider = [&]( NodeId child, NodeId other )
+        {
+            const auto & onode = nodes_[other];
+            if ( onode.leaf() )
+                return;
+            const auto otherArea = halfArea( onode.box );
+            // child replaces onode.r, and onode.r becomes the child of nid
+            if ( auto gain = otherArea - halfArea( unite( nodes_[child].box, nodes_[onode.l].box ) ); gain > bestGain )
+            {
+                bestGain = gain;
+                bestA = child;
+                bestB = onode.r;
+            }
+            if ( auto gain = otherArea - halfArea( unite( nodes_[child].box, nodes_[onode.r].box ) ); gain > bestGain )
+            {
+                bestGain = gain;
+                bestA = child;
+                bestB = onode.l;
+            }
+        };
+        consider( node.l, node.r );
+        consider( node.r, node.l );
+        if ( !bestA )
+            return;
+
+        const auto other = parent_[bestB];
+        auto & n = nodes_[nid];
+        ( n.l == bestA ? n.l : n.r ) = bestB;
+        auto & o = nodes_[other];
+        ( o.l == bestB ? o.l : o.r ) = bestA;
+        parent_[bestB] = nid;
+        parent_[bestA] = other;
+        dirty_.set( other );
+        setBox_( other, unite( nodes_[o.l].box, nodes_[o.r].box ) );
+    }
+
+    NodeVec nodes_;
+    Vector<NodeId, NodeId> parent_;
+    NodeBitSet dirty_; ///< the nodes that were changed or moved, and all their ancestors
+    std::vector<NodeId> freeNodes_;
+    NodeId root_;
+    double sumArea_ = 0; ///< the sum of surface areas of all not-leaf nodes
+};
+
+} //anonymous namespace
+
+bool AABBTree::update( const Mesh & mesh, const FaceBitSet & changedFaces )
+{
+    MR_TIMER;
+    Vector<NodeId, FaceId> changedLeaves( changedFaces.size() );
+    DynamicTree tree( std::move( nodes_ ), changedFaces, changedLeaves );
+    if ( refSahCost_ <= 0 )
+        refSahCost_ = tree.sahCost();
+
+    const auto & validFaces = mesh.topology.getValidFaces();
+    for ( auto f : changedFaces )
+        if ( changedLeaves[f] )
+            tree.removeLeaf( changedLeaves[f] );
+    for ( auto f : changedFaces )
+        if ( validFaces.test( f ) )
+            tree.insertLeaf( f, computeFaceBox( mesh, f ) );
+    nodes_ = tree.compact();
+
+    // the cost is relative to the area of the root, so it is comparable even if the mesh grew or shrank
+    constexpr float cMaxSahCostGrowth = 1.25f;
+    return tree.sahCost() <= cMaxSahCostGrowth * refSahCost_;
+}
+
 template auto AABBTreeBase<FaceTreeTraits3>::getSubtrees( int minNum ) const -> std::vector<NodeId>;
 template auto AABBTreeBase<FaceTreeTraits3>::getSubtreeLeaves( NodeId subtreeRoot ) const -> LeafBitSet;
 template NodeBitSet AABBTreeBase<FaceTreeTraits3>::getNodesFromLeaves( const LeafBitSet & leaves ) const;
@@ -121,6 +470,75 @@ TEST(MRMesh, AABBTree)
     EXPECT_EQ( smallerTree.nodes().size(), 1 );
 }
 
+TEST(MRMesh, AABBTreeUpdate)
+{
+    Mesh mesh = makeTorus( 1.0f, 0.3f, 64, 32 );
+    AABBTree tree( mesh );
+    const auto cost0 = tree.sahCost();
+    EXPECT_GT( cost0, 0 );
+
+    // delete a band of faces and move some vertices
+    FaceBitSet changed;
+    for ( int i = 0; i < 64; ++i )
+        changed.autoResizeSet( FaceId( 2 * 32 * 10 + i ) );
+    mesh.topology.deleteFaces( changed );
+    VertBitSet moved;
+    for ( int i = 0; i < 32; ++i )
+    {
+        const auto v = VertId( 32 * 40 + i );
+        mesh.points[v] *= 1.1f;
+        moved.autoResizeSet( v );
+    }
+    changed |= getIncidentFaces( mesh.topology, moved );
+    EXPECT_TRUE( tree.update( mesh, changed ) );
+
+    // the updated tree has the same leaves and boxes of all faces as new tree
+    const AABBTree newTree( mesh );
+    EXPECT_EQ( tree.nodes().size(), newTree.nodes().size() );
+    EXPECT_EQ( tree.getBoundingBox(), newTree.getBoundingBox() );
+    EXPECT_EQ( tree.numLeaves(), mesh.topology.numValidFaces() );
+    EXPECT_TRUE( ( tree.getSubtreeLeaves( AABBTree::rootNodeId() ) - mesh.topology.getValidFaces() ).none() );
+    for ( auto nid = AABBTree::rootNodeId(); nid < tree.nodes().endId(); ++nid )
+    {
+        const auto & node = tree[nid];
+        if ( node.leaf() )
+        {
+            EXPECT_EQ( node.box, computeFaceBox( mesh, node.leafId() ) );
+            continue;
+        }
+        EXPECT_GT( node.l, nid );
+        EXPECT_GT( node.r, nid );
+        Box3f box = tree[node.l].box;
+        box.include( tree[node.r].box );
+        EXPECT_EQ( node.box, box );
+    }
+    EXPECT_LT( tree.sahCost(), 1.25f * cost0 );
+
+    // the mesh keeps its tree after small changes and updates it on request
+    (void)mesh.getAABBTree();
+    FaceBitSet small;
+    small.autoResizeSet( FaceId( 2 * 32 * 30 ) );
+    mesh.deleteFaces( small );
+    EXPECT_EQ( mesh.getAABBTreeNotCreate(), nullptr );
+    EXPECT_EQ( mesh.getAABBTree().numLeaves(), mesh.topology.numValidFaces() );
+
+    // the changes of several calls are accumulated
+    for ( auto e : mesh.topology.findHoleRepresentiveEdges() )
+        fillHole( mesh, e );
+    EXPECT_EQ( subdivideMesh( mesh, { .maxEdgeSplits = 20 } ), 20 );
+    EXPECT_EQ( mesh.getAABBTree().numLeaves(), mesh.topology.numValidFaces() );
+    EXPECT_EQ( mesh.getAABBTree().getBoundingBox(), AABBTree( mesh ).getBoundingBox() );
+
+    // the faces deleted directly in topology are not reported, then the tree is rebuilt
+    FaceBitSet unreported;
+    unreported.autoResizeSet( FaceId( 2 * 32 * 50 ) );
+    const auto holes = findRightBoundary( mesh.topology, unreported );
+    mesh.topology.deleteFaces( unreported );
+    for ( const auto & hole : holes )
+        fillHole( mesh, hole.front().sym() );
+    EXPECT_EQ( mesh.getAABBTree().numLeaves(), mesh.topology.numValidFaces() );
+}
+
 TEST(MRMesh, ProjectionToEmptyMesh)
 {
     Vector3f p( 1.f, 2.f, 3.f );
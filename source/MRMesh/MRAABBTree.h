@@ -28,11 +28,26 @@ public:
     /// \param changedVerts vertex ids with modified coordinates (since tree construction or last refit)
     MRMESH_API void refit( const Mesh & mesh, const VertBitSet & changedVerts );
 
+    /// updates the tree after a local change of mesh topology or geometry without full rebuild:
+    /// the leaves of changed faces are removed, and the faces remaining valid are inserted back at the best places found by surface area heuristic,
+    /// and the nodes on the paths to the root are locally rebalanced by rotations;
+    /// this tree must be constructed for whole mesh (without region)
+    /// \param mesh same mesh for which this tree was constructed but with changed topology or coordinates;
+    /// \param changedFaces all faces that were deleted, added or got other vertices or vertex coordinates (since tree construction or last update)
+    /// \return false if the quality of the tree degraded too much (see sahCost) and it is better to rebuild it from scratch
+    MRMESH_API bool update( const Mesh & mesh, const FaceBitSet & changedFaces );
+
+    /// returns the quality metric of the tree (the less the better): the sum of surface areas of all not-leaf nodes divided on the surface area of the root node,
+    /// which is proportional to the expected number of visited nodes in a query by surface area heuristic
+    [[nodiscard]] MRMESH_API float sahCost() const;
+
 private:
     AABBTree( const AABBTree & ) = default;
     AABBTree & operator =( const AABBTree & ) = default;
     friend class UniqueThreadSafeOwner<AABBTree>;
     friend class SharedThreadSafeOwner<AABBTree>;
+
+    float refSahCost_ = 0; ///< sahCost() of the tree before the first update, 0 if not computed yet
 };
 
 } // namespace MR
@@ -0,0 +1,197 @@
+#include "MRAABBTreeWide.h"
+#include "MRAABBTree.h"
+#include "MRMesh.h"
+#include "MRMeshIntersect.h"
+#include "MRMeshProject.h"
+#include "MRMakeSphereMesh.h"
+#include "MRLine3.h"
+#include "MRTimer.h"
+#include "MRGTest.h"
+#include <cmath>
+
+namespace MR
+{
+
+namespace
+{
+
+/// sets the quantization parameters of the node so to cover given box
+void setNodeBox( AABBTreeWideNode & node, const Box3f & box )
+{
+    node.origin = box.min;
+    for ( int d = 0; d < 3; ++d )
+    {
+        const float size = box.max[d] - box.min[d];
+        float scale = size > 0 ? size / 255 : 0;
+        // make sure that the last quantization step reaches box.max despite rounding errors
+        while ( box.min[d] + 255 * scale < box.max[d] )
+            scale = std::nextafter( scale, FLT_MAX );
+        node.scale[d] = scale;
+    }
+}
+
+/// quantizes given child box relative to the node box, so that dequantized box contains the original one
+void setChildBox( AABBTreeWideNode & node, int i, const Box3f & box )
+{
+    for ( int d = 0; d < 3; ++d )
+    {
+        const float o = node.origin[d];
+        const float s = node.scale[d];
+        if ( !( s > 0 ) )
+        {
+            node.lo[d][i] = node.hi[d][i] = 0;
+            continue;
+        }
+        int lo = std::clamp( int( std::floor( ( box.min[d] - o ) / s ) ), 0, 255 );
+        while ( lo > 0 && o + float( lo ) * s > box.min[d] )
+            --lo;
+        int hi = std::clamp( int( std::ceil( ( box.max[d] - o ) / s ) ), 0, 255 );
+        while ( hi < 255 && o + float( hi ) * s < box.max[d] )
+            ++hi;
+        node.lo[d][i] = std::uint8_t( lo );
+        node.hi[d][i] = std::uint8_t( hi );
+    }
+}
+
+/// marks given child slot as unused
+void setNoChild( AABBTreeWideNode & node, int i )
+{
+    for ( int d = 0; d < 3; ++d )
+    {
+        node.lo[d][i] = 255;
+        node.hi[d][i] = 0;
+    }
+    node.child[i] = 0;
+}
+
+} //anonymous namespace
+
+AABBTreeWide::AABBTreeWide( const AABBTree & tree )
+{
+    MR_TIMER;
+    if ( tree.nodes().empty() )
+        return;
+    numLeaves_ = tree.numLeaves();
+
+    // each wide node takes at least 2 children (except for the root of single-leaf tree)
+    nodes_.reserve( std::max( size_t( 1 ), numLeaves_ / 2 ) );
+
+    struct Task
+    {
+        NodeId src; ///< binary tree node
+        NodeId dst; ///< corresponding wide tree node
+        int level = 1; ///< the level of the node in wide tree, 1 for the root
+    };
+    std::vector<Task> stack;
+    stack.push_back( { tree.rootNodeId(), NodeId( nodes_.size() ) } );
+    nodes_.emplace_back();
+
+    while ( !stack.empty() )
+    {
+        const auto t = stack.back();
+        stack.pop_back();
+        depth_ = std::max( depth_, t.level );
+
+        // expand binary nodes until there are 4 candidates, opening first the nodes with the largest boxes
+        NodeId candidates[AABBTreeWideNode::cWidth];
+        int numCandidates = 1;
+        candidates[0] = t.src;
+        while ( numCandidates < AABBTreeWideNode::cWidth )
+        {
+            int best = -1;
+            float bestSize = -1;
+            for ( int i = 0; i < numCandidates; ++i )
+            {
+                const auto & n = tree[candidates[i]];
+                if ( n.leaf() )
+                    continue;
+                const auto size = n.box.size();
+                const float area = size.x * size.y + size.y * size.z + size.z * size.x;
+                if ( area > bestSize )
+                {
+                    best = i;
+                    bestSize = area;
+                }
+            }
+            if ( best < 0 )
+                break;
+            const auto & n = tree[candidates[best]];
+            candidates[best] = n.l;
+            candidates[numCandidates++] = n.r;
+        }
+
+        AABBTreeWideNode node;
+        setNodeBox( node, tree[t.src].box );
+        for ( int i = 0; i < AABBTreeWideNode::cWidth; ++i )
+        {
+            if ( i >= numCandidates )
+            {
+                setNoChild( node, i );
+                continue;
+            }
+            const auto & n = tree[candidates[i]];
+            setChildBox( node, i, n.box );
+            if ( n.leaf() )
+            {
+                node.child[i] = ~int( n.leafId() );
+                continue;
+            }
+            const NodeId childId( nodes_.size() );
+            nodes_.emplace_back();
+            node.child[i] = int( childId );
+            stack.push_back( { candidates[i], childId, t.level + 1 } );
+        }
+        nodes_[t.dst] = node;
+    }
+    nodes_.vec_.shrink_to_fit();
+}
+
+TEST( MRMesh, AABBTreeWide )
+{
+    Mesh sphere = makeUVSphere( 1, 16, 16 );
+    const auto & tree = sphere.getAABBTree();
+    const AABBTreeWide wide( tree );
+    EXPECT_EQ( wide.numLeaves(), sphere.topology.numValidFaces() );
+    // 4-ary nodes are twice larger than binary ones, but there are more than twice less of them
+    // (not four times less, since some wide nodes get only two children)
+    EXPECT_LT( wide.heapBytes(), tree.heapBytes() * 3 / 5 );
+
+    // every leaf is present exactly once, and its dequantized box contains the triangle
+    FaceBitSet found( sphere.topology.faceSize() );
+    for ( const auto & node : wide.nodes() )
+    {
+        for ( int i = 0; i < AABBTreeWideNode::cWidth; ++i )
+        {
+            if ( !node.hasChild( i ) || !node.isLeafChild( i ) )
+                continue;
+            const auto f = node.leafId( i );
+            EXPECT_FALSE( found.test( f ) );
+            found.set( f );
+            const auto box = node.childBox( i );
+            for ( auto p : sphere.getTriPoints( f ) )
+                EXPECT_TRUE( box.contains( p ) );
+        }
+    }
+    EXPECT_EQ( found, sphere.topology.getValidFaces() );
+
+    EXPECT_GT( wide.depth(), 1 );
+    EXPECT_EQ( wide.maxTraversalStackSize(), wide.depth() * 3 + 1 );
+
+    // queries give the same results with wide tree, which is used only when passed explicitly
+    (void)sphere.getAABBTreeWide();
+    for ( int i = 0; i < 20; ++i )
+    {
+        const Vector3f p( std::cos( 0.3f * i ), std::sin( 0.7f * i ), 0.1f * i - 1.0f );
+        const auto proj = findProjection( p, sphere );
+        const auto wideProj = findProjectionSubtree( p, sphere, wide );
+        EXPECT_NEAR( proj.distSq, wideProj.distSq, 1e-6f );
+
+        const Line3f line( 2.0f * p, -p );
+        const auto isect = rayMeshIntersect( sphere, line );
+        const auto wideIsect = rayMeshIntersect( sphere, wide, line );
+        EXPECT_EQ( bool( isect ), bool( wideIsect ) );
+        EXPECT_NEAR( isect.distanceAlongLine, wideIsect.distanceAlongLine, 1e-6f );
+    }
+}
+
+} //namespace MR
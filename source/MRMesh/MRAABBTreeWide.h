@@ -0,0 +1,112 @@
+#pragma once
+
+#include "MRBox.h"
+#include "MRId.h"
+#include "MRVector.h"
+#include <cstdint>
+
+namespace MR
+{
+
+/// \addtogroup AABBTreeGroup
+/// \{
+
+/// node of wide bounding volume hierarchy, having up to 4 children;
+/// the boxes of children are stored in structure of arrays layout and quantized to 8 bits relative to the box of this node,
+/// so the whole node occupies exactly one cache line
+struct alignas( 64 ) AABBTreeWideNode
+{
+    static constexpr int cWidth = 4;
+
+    Vector3f origin; ///< minimal corner of the box of this node
+    Vector3f scale;  ///< the size of one quantization step in each dimension
+    std::uint8_t lo[3][cWidth]; ///< quantized minimal corners of children boxes: lo[dim][child]
+    std::uint8_t hi[3][cWidth]; ///< quantized maximal corners of children boxes: hi[dim][child]
+    /// non-negative values are the indices of children nodes, negative values are ~FaceId of leaves
+    std::int32_t child[cWidth];
+
+    /// returns true if given child slot is used
+    [[nodiscard]] bool hasChild( int i ) const { return lo[0][i] <= hi[0][i]; }
+
+    /// returns true if given child is a leaf (triangle) rather than another node
+    [[nodiscard]] bool isLeafChild( int i ) const { return child[i] < 0; }
+
+    /// returns the face of leaf child
+    [[nodiscard]] FaceId leafId( int i ) const { assert( isLeafChild( i ) ); return FaceId( ~child[i] ); }
+
+    /// returns the node of not-leaf child
+    [[nodiscard]] NodeId nodeId( int i ) const { assert( !isLeafChild( i ) ); return NodeId( child[i] ); }
+
+    /// returns dequantized (slightly enlarged) bounding box of given child
+    [[nodiscard]] Box3f childBox( int i ) const
+    {
+        assert( hasChild( i ) );
+        Box3f res;
+        for ( int d = 0; d < 3; ++d )
+        {
+            res.min[d] = origin[d] + float( lo[d][i] ) * scale[d];
+            res.max[d] = origin[d] + float( hi[d][i] ) * scale[d];
+        }
+        return res;
+    }
+
+    /// dequantizes the boxes of all children at once: min[dim][child], max[dim][child]
+    void getChildBoxes( float (&min)[3][cWidth], float (&max)[3][cWidth] ) const
+    {
+        for ( int d = 0; d < 3; ++d )
+        {
+            for ( int i = 0; i < cWidth; ++i )
+            {
+                min[d][i] = origin[d] + float( lo[d][i] ) * scale[d];
+                max[d][i] = origin[d] + float( hi[d][i] ) * scale[d];
+            }
+        }
+    }
+};
+static_assert( sizeof( AABBTreeWideNode ) == 64 );
+
+/// \brief bounding volume hierarchy with 4 children per node and quantized boxes, built from usual binary AABBTree
+/// \details leaves are stored directly in their parent nodes, and each node is twice larger than a node of AABBTree,
+/// but there are about 1.9 times less nodes than leaves (some wide nodes get only two children), so the tree occupies
+/// a bit more than half (and less than 3/5) of AABBTree memory;
+/// a query reads one cache line per 4 children boxes, which makes point projection and ray intersection faster on large meshes;
+/// the tree is used only if passed explicitly: see Mesh::getAABBTreeWide(), findProjectionSubtree, findProjections and rayMeshIntersect
+class AABBTreeWide
+{
+public:
+    AABBTreeWide() = default;
+
+    /// makes wide tree by collapsing the levels of given binary tree
+    MRMESH_API explicit AABBTreeWide( const AABBTree & tree );
+
+    /// const-access to all nodes
+    [[nodiscard]] const Vector<AABBTreeWideNode, NodeId> & nodes() const { return nodes_; }
+
+    /// const-access to any node
+    [[nodiscard]] const AABBTreeWideNode & operator[]( NodeId nid ) const { return nodes_[nid]; }
+
+    /// returns root node id
+    [[nodiscard]] static NodeId rootNodeId() { return NodeId{ 0 }; }
+
+    /// returns the number of leaves (triangles) in whole tree
+    [[nodiscard]] size_t numLeaves() const { return numLeaves_; }
+
+    /// returns the number of node levels in the tree
+    [[nodiscard]] int depth() const { return depth_; }
+
+    /// returns the size of the stack sufficient for depth-first traversal of the tree,
+    /// where each visited node is replaced by its children
+    [[nodiscard]] int maxTraversalStackSize() const { return depth_ * ( AABBTreeWideNode::cWidth - 1 ) + 1; }
+
+    /// returns the amount of memory this object occupies on heap
+    [[nodiscard]] size_t heapBytes() const { return nodes_.heapBytes(); }
+
+private:
+    Vector<AABBTreeWideNode, NodeId> nodes_;
+    size_t numLeaves_ = 0;
+    int depth_ = 0;
+};
+
+/// \}
+
+} // namespace MR
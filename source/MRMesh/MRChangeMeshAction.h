@@ -3,6 +3,8 @@
 #include "MRObjectMesh.h"
 #include "MRMesh.h"
 #include "MRHeapBytes.h"
+#include "MRSpilledMesh.h"
+#include <cassert>
 #include <memory>
 
 namespace MR
@@ -48,6 +50,12 @@ public:
         if ( !objMesh_ )
             return;
 
+        // HistoryStore calls unspill() in advance and drops the action on failure
+        if ( !unspill() )
+        {
+            assert( false );
+            return;
+        }
         cloneMesh_ = objMesh_->updateMesh( cloneMesh_ );
     }
 
@@ -62,9 +70,40 @@ public:
         return name_.capacity() + MR::heapBytes( cloneMesh_ );
     }
 
+    /// moves remembered mesh in a compressed file inside given folder
+    virtual bool spill( const std::filesystem::path & folder ) override
+    {
+        if ( !cloneMesh_ || !spilledMesh_.empty() )
+            return false;
+        auto s = SpilledMesh::save( *cloneMesh_, folder );
+        if ( !s )
+            return false;
+        spilledMesh_ = std::move( *s );
+        cloneMesh_.reset();
+        return true;
+    }
+
+    /// loads remembered mesh back from the file, the file is kept if it fails
+    virtual Expected<void> unspill() override
+    {
+        if ( spilledMesh_.empty() )
+            return {};
+        auto m = spilledMesh_.load();
+        if ( !m )
+            return unexpected( std::move( m.error() ) );
+        cloneMesh_ = std::make_shared<Mesh>( std::move( *m ) );
+        return {};
+    }
+
+    [[nodiscard]] virtual size_t spilledBytes() const override
+    {
+        return spilledMesh_.bytes();
+    }
+
 private:
     std::shared_ptr<ObjectMesh> objMesh_;
     std::shared_ptr<Mesh> cloneMesh_;
+    SpilledMesh spilledMesh_; ///< not empty if cloneMesh_ was moved on disk
 
     std::string name_;
 };
@@ -41,4 +41,34 @@ size_t CombinedHistoryAction::heapBytes() const
     return res;
 }
 
+bool CombinedHistoryAction::spill( const std::filesystem::path & folder )
+{
+    bool res = false;
+    for ( const auto & a : actions_ )
+        if ( a && a->spill( folder ) )
+            res = true;
+    return res;
+}
+
+Expected<void> CombinedHistoryAction::unspill()
+{
+    for ( const auto & a : actions_ )
+    {
+        if ( !a )
+            continue;
+        if ( auto s = a->unspill(); !s )
+            return s;
+    }
+    return {};
+}
+
+size_t CombinedHistoryAction::spilledBytes() const
+{
+    size_t res = 0;
+    for ( const auto & a : actions_ )
+        if ( a )
+            res += a->spilledBytes();
+    return res;
+}
+
 }
@@ -31,6 +31,14 @@ public:
 
     [[nodiscard]] MRMESH_API virtual size_t heapBytes() const override;
 
+    /// spills all actions inside
+    MRMESH_API virtual bool spill( const std::filesystem::path & folder ) override;
+
+    /// loads back all spilled actions inside, returns the first error
+    MRMESH_API virtual Expected<void> unspill() override;
+
+    [[nodiscard]] MRMESH_API virtual size_t spilledBytes() const override;
+
 private:
     HistoryActionsVector actions_;
     std::string name_;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "MRUnionFind.h"
+#include "MRParallelFor.h"
+#include <atomic>
+#include <vector>
+
+namespace MR
+{
+
+/**
+ * \brief Union find data structure that can be modified from many threads simultaneously without locks, e.g. inside BitSetParallelFor;
+ * the sets are linked by compare-and-swap operations, and the paths to the roots are shortened by path halving;
+ * the root of each set is always its element with the smallest index, so the result does not depend on the order of unions
+ * \tparam I is an id type, e.g. FaceId
+ * \ingroup BasicGroup
+ */
+template <typename I>
+class ConcurrentUnionFind
+{
+public:
+    ConcurrentUnionFind() = default;
+    explicit ConcurrentUnionFind( size_t size ) { reset( size ); }
+    auto size() const { return parents_.size(); }
+
+    /// reset roots to represent each element as disjoint set
+    void reset( size_t size )
+    {
+        parents_ = std::vector<std::atomic<I>>( size );
+        ParallelFor( size_t( 0 ), size, [&]( size_t i ) { parents_[i].store( I( i ), std::memory_order_relaxed ); } );
+    }
+
+    /// finds the root of the set containing given element, halving the path to it on the way; thread-safe
+    I find( I a )
+    {
+        for (;;)
+        {
+            I p = parent_( a ).load( std::memory_order_relaxed );
+            if ( p == a )
+                return a;
+            const I gp = parent_( p ).load( std::memory_order_relaxed );
+            if ( gp == p )
+                return p;
+            // failure is not a problem here: it means that another thread has already shortened the path
+            parent_( a ).compare_exchange_weak( p, gp, std::memory_order_relaxed );
+            a = gp;
+        }
+    }
+
+    /// unite two elements; thread-safe
+    /// \return true if union was done, false if first and second were already united
+    bool unite( I first, I second )
+    {
+        for (;;)
+        {
+            first = find( first );
+            second = find( second );
+            if ( first == second )
+                return false;
+            if ( first < second )
+                std::swap( first, second );
+            // the root with larger index is linked to the root with smaller index, provided that it is still a root
+            I expected = first;
+            if ( parent_( first ).compare_exchange_strong( expected, second, std::memory_order_relaxed ) )
+                return true;
+        }
+    }
+
+    /// returns true if given two elements are from one component; thread-safe
+    bool united( I first, I second )
+    {
+        for (;;)
+        {
+            first = find( first );
+            second = find( second );
+            if ( first == second )
+                return true;
+            // the roots are distinct only if first is still a root, otherwise another thread has just united it
+            if ( parent_( first ).load( std::memory_order_relaxed ) == first )
+                return false;
+        }
+    }
+
+    /// sets the root as the parent of each element, computes the sizes of all sets,
+    /// and converts this into ordinary UnionFind structure;
+    /// shall be called after all concurrent unions are finished
+    UnionFind<I> toUnionFind() &&
+    {
+        Vector<I, I> roots;
+        roots.resizeNoInit( parents_.size() );
+        ParallelFor( roots, [&]( I i ) { roots[i] = find( i ); } );
+        std::vector<std::atomic<I>>().swap( parents_ );
+
+        // consecutive elements usually belong to the same set, so each thread increments the size of the set only once per series
+        std::vector<std::atomic<size_t>> counts( roots.size() );
+        tbb::parallel_for( tbb::blocked_range( I( size_t( 0 ) ), I( roots.size() ) ), [&]( const tbb::blocked_range<I> & range )
+        {
+            I root = roots[range.begin()];
+            size_t count = 0;
+            for ( I i = range.begin(); i < range.end(); ++i )
+            {
+                if ( roots[i] != root )
+                {
+                    counts[size_t( root )].fetch_add( count, std::memory_order_relaxed );
+                    root = roots[i];
+                    count = 0;
+                }
+                ++count;
+            }
+            counts[size_t( root )].fetch_add( count, std::memory_order_relaxed );
+        } );
+        Vector<size_t, I> sizes( roots.size() );
+        ParallelFor( sizes, [&]( I i ) { sizes[i] = counts[size_t( i )].load( std::memory_order_relaxed ); } );
+        return UnionFind<I>( std::move( roots ), std::move( sizes ) );
+    }
+
+private:
+    std::atomic<I> & parent_( I a ) { return parents_[size_t( a )]; }
+
+    /// parent of each element, which is always smaller than the element itself, or the element for the root
+    std::vector<std::atomic<I>> parents_;
+};
+
+} //namespace MR
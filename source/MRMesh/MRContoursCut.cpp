@@ -21,6 +21,7 @@
 #include "MRSurfaceDistance.h"
 #include "MRExtractIsolines.h"
 #include "MRParallelFor.h"
+#include "MRFinally.h"
 #include <parallel_hashmap/phmap.h>
 #include <numeric>
 
@@ -2150,7 +2151,23 @@ CutMeshResult cutMesh( Mesh& mesh, const OneMeshContours& contours, const CutMes
     if ( params.new2OldMap )
         prepareFacesMap( mesh.topology, *params.new2OldMap );
 
+    // remember the faces before cut to update aabb-tree of the mesh incrementally in the end
+    const auto fsz0 = mesh.topology.faceSize();
+    const auto validFaces0 = mesh.topology.getValidFaces();
+
     auto preRes = doPreCutMesh( mesh, contours );
+    MR_FINALLY_ON_SUCCESS
+    {
+        // all deleted and new faces, and the removed faces are added in case their ids were reused
+        FaceBitSet changedFaces = validFaces0 - mesh.topology.getValidFaces();
+        changedFaces.resize( mesh.topology.faceSize() );
+        changedFaces.set( FaceId( fsz0 ), changedFaces.size() - fsz0, true );
+        for ( const auto & removedFaces : preRes.removedFaces )
+            for ( const auto & r : removedFaces )
+                if ( r.f )
+                    changedFaces.set( r.f );
+        mesh.invalidateCaches( changedFaces );
+    };
 
     if ( params.new2oldEdgesMap )
     {
@@ -3,6 +3,7 @@
 #include "MRMesh.h"
 #include "MRParallelFor.h"
 #include "MRTimer.h"
+#include "MRTorus.h"
 #include "MRGTest.h"
 
 namespace MR
@@ -77,6 +78,36 @@ Dipoles calcDipoles( const AABBTree& tree, const Mesh& mesh )
     return dipoles;
 }
 
+void calcDipoleSecondOrders( DipoleSecondOrders& res, const Dipoles& dipoles, const AABBTree& tree )
+{
+    MR_TIMER;
+    assert( dipoles.size() == tree.nodes().size() );
+    // the terms of leaves are zero, since the dipole of a leaf is located in the center of its triangle
+    res.clear();
+    res.resize( dipoles.size(), Matrix3f::zero() );
+
+    // sum the terms of children shifting them from children centers to the parent center,
+    // which is numerically more stable than summing the products of triangle centers and subtracting the parent center in the end
+    for ( auto i = res.backId(); i; --i )
+    {
+        const auto& node = tree[i];
+        if ( node.leaf() )
+            continue;
+        const auto& d = dipoles[i];
+        const auto& dl = dipoles[node.l];
+        const auto& dr = dipoles[node.r];
+        res[i] = res[node.l] + outer( dl.dirArea, dl.pos - d.pos )
+               + res[node.r] + outer( dr.dirArea, dr.pos - d.pos );
+    }
+}
+
+DipoleSecondOrders calcDipoleSecondOrders( const Dipoles& dipoles, const AABBTree& tree )
+{
+    DipoleSecondOrders res;
+    calcDipoleSecondOrders( res, dipoles, tree );
+    return res;
+}
+
 /// see (6) in https://users.cs.utah.edu/~ladislav/jacobson13robust/jacobson13robust.pdf
 static float triangleSolidAngle( const Vector3f & p, const Triangle3f & tri )
 {
@@ -91,8 +122,67 @@ static float triangleSolidAngle( const Vector3f & p, const Triangle3f & tri )
     return 2 * std::atan2( m.det(), den );
 }
 
+namespace
+{
+
+/// accumulates exact solid angles of triangles as seen from one point,
+/// the triangles are evaluated in groups of cSize in structure-of-arrays layout, so the loops are vectorized by compiler
+class TriangleSolidAngles
+{
+public:
+    static constexpr int cSize = 8;
+
+    explicit TriangleSolidAngles( const Vector3f & p ) : p_( p ) {}
+
+    /// adds one more triangle, the solid angles of full group are added to \param res
+    void add( const Triangle3f & tri, float & res )
+    {
+        for ( int i = 0; i < 3; ++i )
+        {
+            const auto v = tri[i] - p_;
+            x_[i][n_] = v.x;
+            y_[i][n_] = v.y;
+            z_[i][n_] = v.z;
+        }
+        if ( ++n_ == cSize )
+            flush( res );
+    }
+
+    /// adds solid angles of all triangles not added yet to \param res
+    void flush( float & res )
+    {
+        float dets[cSize], dens[cSize];
+        for ( int j = 0; j < cSize; ++j )
+        {
+            const float ax = x_[0][j], ay = y_[0][j], az = z_[0][j];
+            const float bx = x_[1][j], by = y_[1][j], bz = z_[1][j];
+            const float cx = x_[2][j], cy = y_[2][j], cz = z_[2][j];
+            const float a = std::sqrt( ax * ax + ay * ay + az * az );
+            const float b = std::sqrt( bx * bx + by * by + bz * bz );
+            const float c = std::sqrt( cx * cx + cy * cy + cz * cz );
+            const float ab = ax * bx + ay * by + az * bz;
+            const float bc = bx * cx + by * cy + bz * cz;
+            const float ca = cx * ax + cy * ay + cz * az;
+            dets[j] = ax * ( by * cz - bz * cy ) - ay * ( bx * cz - bz * cx ) + az * ( bx * cy - by * cx );
+            dens[j] = a * b * c + ab * c + bc * a + ca * b;
+        }
+        for ( int j = 0; j < n_; ++j )
+            res += 2 * std::atan2( dets[j], dens[j] );
+        n_ = 0;
+    }
+
+private:
+    Vector3f p_;
+    int n_ = 0;
+    float x_[3][cSize] = {};
+    float y_[3][cSize] = {};
+    float z_[3][cSize] = {};
+};
+
+} //anonymous namespace
+
 float calcFastWindingNumber( const Dipoles& dipoles, const AABBTree& tree, const Mesh& mesh,
-    const Vector3f & q, float beta, FaceId skipFace )
+    const Vector3f & q, float beta, FaceId skipFace, const DipoleSecondOrders* secondOrders )
 {
     if ( dipoles.empty() )
     {
@@ -111,13 +201,15 @@ float calcFastWindingNumber( const Dipoles& dipoles, const AABBTree& tree, const
     int stackSize = 0;
     subtasks[stackSize++].n = tree.rootNodeId();
 
+    assert( !secondOrders || secondOrders->size() == dipoles.size() );
     float res = 0;
+    TriangleSolidAngles exact( q );
     while( stackSize > 0 )
     {
         const auto i = subtasks[--stackSize].n;
         const auto & node = tree[i];
         const auto & d = dipoles[i];
-        if ( d.addIfGoodApprox( q, betaSq, res ) )
+        if ( secondOrders ? d.addIfGoodApprox( q, betaSq, res, ( *secondOrders )[i] ) : d.addIfGoodApprox( q, betaSq, res ) )
             continue;
         if ( !node.leaf() )
         {
@@ -127,8 +219,9 @@ float calcFastWindingNumber( const Dipoles& dipoles, const AABBTree& tree, const
             continue;
         }
         if ( node.leafId() != skipFace )
-            res += triangleSolidAngle( q, mesh.getTriPoints( node.leafId() ) );
+            exact.add( mesh.getTriPoints( node.leafId() ), res );
     }
+    exact.flush( res );
     constexpr float INV_4PI = 1.0f / ( 4 * PI_F );
     return INV_4PI * res;
 }
@@ -161,4 +254,31 @@ TEST(MRMesh, TriangleSolidAngle)
     EXPECT_EQ( triangleSolidAngle( -tri[2], tri ), 0 );
 }
 
+TEST(MRMesh, FastWindingNumberSecondOrder)
+{
+    const auto mesh = makeTorus( 1.0f, 0.3f, 64, 32 );
+    const auto & tree = mesh.getAABBTree();
+    const auto & dipoles = mesh.getDipoles();
+    const auto secondOrders = calcDipoleSecondOrders( dipoles, tree );
+
+    // with very large beta all triangles are evaluated exactly
+    float exactSum = 0;
+    const Vector3f q( 1.2f, 0.1f, 0.05f );
+    for ( auto f : mesh.topology.getValidFaces() )
+        exactSum += triangleSolidAngle( q, mesh.getTriPoints( f ) );
+    EXPECT_NEAR( calcFastWindingNumber( dipoles, tree, mesh, q, 1e6f, {} ), exactSum / ( 4 * PI_F ), 1e-5f );
+
+    // second-order terms reduce the error of approximation for the same beta
+    float err1 = 0, err2 = 0;
+    for ( int i = 0; i < 100; ++i )
+    {
+        const auto a = 0.0628f * i;
+        const Vector3f p( ( 1 + 0.5f * std::cos( 3 * a ) ) * std::cos( a ), ( 1 + 0.5f * std::cos( 3 * a ) ) * std::sin( a ), 0.4f * std::sin( 5 * a ) );
+        const auto w = calcFastWindingNumber( dipoles, tree, mesh, p, 1e6f, {} );
+        err1 = std::max( err1, std::abs( calcFastWindingNumber( dipoles, tree, mesh, p, 1.5f, {} ) - w ) );
+        err2 = std::max( err2, std::abs( calcFastWindingNumber( dipoles, tree, mesh, p, 1.5f, {}, &secondOrders ) - w ) );
+    }
+    EXPECT_LT( err2, 0.6f * err1 );
+}
+
 } //namespace MR
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "MRVector3.h"
+#include "MRMatrix3.h"
+#include "MRVector.h"
 
 namespace MR
 {
@@ -25,6 +27,18 @@ struct Dipole
             addTo += dot( dp, dirArea ) / ( d * dd );
         return true;
     }
+    /// same as above, but also adds the second-order term of dipole expansion \param c (see DipoleSecondOrders),
+    /// which makes the approximation more precise for the same distance or allows one to use smaller beta for the same precision
+    [[nodiscard]] bool addIfGoodApprox( const Vector3f& q, float betaSq, float& addTo, const Matrix3f& c ) const
+    {
+        const auto dp = pos - q;
+        const auto dd = dp.lengthSq();
+        if ( dd <= betaSq * rr )
+            return false;
+        if ( const auto d = std::sqrt( dd ); d > 0 )
+            addTo += ( dot( dp, dirArea ) + c.trace() - 3 * dot( dp, c * dp ) / dd ) / ( d * dd );
+        return true;
+    }
 };
 
 static_assert( sizeof( Dipole ) == 8 * sizeof( float ) );
@@ -33,11 +47,20 @@ static_assert( sizeof( Dipole ) == 8 * sizeof( float ) );
 MRMESH_API void calcDipoles( Dipoles& dipoles, const AABBTree& tree, const Mesh& mesh );
 [[nodiscard]] MRMESH_API Dipoles calcDipoles( const AABBTree& tree, const Mesh& mesh );
 
+// DipoleSecondOrders (declared in MRMeshFwd.h) are second-order terms of dipole expansions for all nodes of AABB tree:
+// the sum over all node's triangles t of outer( dirArea_t, center_t - dipole.pos );
+// they are stored separately from Dipoles to keep the size of the latter
+
+/// calculates second-order terms of dipole expansions for given AABB-tree and dipoles computed for it
+MRMESH_API void calcDipoleSecondOrders( DipoleSecondOrders& res, const Dipoles& dipoles, const AABBTree& tree );
+[[nodiscard]] MRMESH_API DipoleSecondOrders calcDipoleSecondOrders( const Dipoles& dipoles, const AABBTree& tree );
+
 /// compute approximate winding number at \param q;
 /// \param beta determines the precision of the approximation: the more the better, recommended value 2 or more;
 /// if distance from q to the center of some triangle group is more than beta times the distance from the center to most distance triangle in the group then we use approximate formula
 /// \param skipFace this triangle (if it is close to \param q) will be skipped from summation
+/// \param secondOrders if given then second-order terms of dipole expansions are used as well
 [[nodiscard]] MRMESH_API float calcFastWindingNumber( const Dipoles& dipoles, const AABBTree& tree, const Mesh& mesh,
-    const Vector3f & q, float beta, FaceId skipFace );
+    const Vector3f & q, float beta, FaceId skipFace, const DipoleSecondOrders* secondOrders = nullptr );
 
 } //namespace MR
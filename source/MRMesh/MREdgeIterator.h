@@ -7,15 +7,17 @@
 namespace MR
 {
  
-// The iterator to find all not-lone undirected edges in the mesh
-class UndirectedEdgeIterator
+// The iterator to find all not-lone undirected edges in the mesh;
+// T is either MeshTopology or FrozenMeshTopology
+template <typename T>
+class UndirectedEdgeIteratorT
 {
 public:
     using iterator_category = std::forward_iterator_tag;
     using value_type        = UndirectedEdgeId;
 
     // creates begin iterator
-    UndirectedEdgeIterator( const MeshTopology & topology ) : topology_( &topology )
+    UndirectedEdgeIteratorT( const T & topology ) : topology_( &topology )
     {
         if ( topology_->undirectedEdgeSize() == 0 )
             return; // end has reached
@@ -24,9 +26,9 @@ public:
             operator ++();
     }
     // creates end iterator
-    UndirectedEdgeIterator() = default;
+    UndirectedEdgeIteratorT() = default;
 
-    UndirectedEdgeIterator & operator++( )
+    UndirectedEdgeIteratorT & operator++( )
     {
         assert( edge_.valid() );
         for (;;)
@@ -45,16 +47,20 @@ public:
     UndirectedEdgeId operator *( ) const { return edge_; }
 
 private:
-    const MeshTopology * topology_ = nullptr;
+    const T * topology_ = nullptr;
     UndirectedEdgeId edge_;
 };
 
-inline bool operator ==( const UndirectedEdgeIterator & a, const UndirectedEdgeIterator & b )
+template <typename T>
+inline bool operator ==( const UndirectedEdgeIteratorT<T> & a, const UndirectedEdgeIteratorT<T> & b )
     { return *a == *b; }
 
-inline bool operator !=( const UndirectedEdgeIterator & a, const UndirectedEdgeIterator & b )
+template <typename T>
+inline bool operator !=( const UndirectedEdgeIteratorT<T> & a, const UndirectedEdgeIteratorT<T> & b )
     { return *a != *b; }
 
+using UndirectedEdgeIterator = UndirectedEdgeIteratorT<MeshTopology>;
+
 inline IteratorRange<UndirectedEdgeIterator> undirectedEdges( const MeshTopology & topology )
     { return { UndirectedEdgeIterator( topology ), UndirectedEdgeIterator() }; }
 
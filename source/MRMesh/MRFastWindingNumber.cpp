@@ -13,16 +13,18 @@
 namespace MR
 {
 
-FastWindingNumber::FastWindingNumber( const Mesh & mesh ) :
+FastWindingNumber::FastWindingNumber( const Mesh & mesh, bool secondOrder ) :
     mesh_( mesh ),
     tree_( mesh.getAABBTree() ),
     dipoles_( mesh.getDipoles() )
 {
+    if ( secondOrder )
+        calcDipoleSecondOrders( secondOrders_, dipoles_, tree_ );
 }
 
 inline float FastWindingNumber::calc_( const Vector3f & q, float beta, FaceId skipFace ) const
 {
-    return calcFastWindingNumber( dipoles_, tree_, mesh_, q, beta, skipFace );
+    return calcFastWindingNumber( dipoles_, tree_, mesh_, q, beta, skipFace, secondOrders_.empty() ? nullptr : &secondOrders_ );
 }
 
 Expected<void> FastWindingNumber::calcFromVector( std::vector<float>& res, const std::vector<Vector3f>& points, float beta, FaceId skipFace, const ProgressCallback& cb )
@@ -3,6 +3,8 @@
 #include "MRProgressCallback.h"
 #include "MRExpected.h"
 #include "MRId.h"
+#include "MRVector.h"
+#include "MRMatrix3.h"
 
 namespace MR
 {
@@ -56,7 +58,10 @@ class MRMESH_CLASS FastWindingNumber : public IFastWindingNumber
 public:
     /// constructs this from AABB tree of given mesh;
     /// this remains valid only if tree is valid
-    [[nodiscard]] MRMESH_API FastWindingNumber( const Mesh & mesh );
+    /// \param secondOrder if true then second-order terms of dipole expansions are computed and used,
+    /// which takes additional 36 bytes per tree node, but gives the same precision with smaller beta (e.g. 1.5 instead of 2)
+    /// and so accepts far field approximations earlier
+    [[nodiscard]] MRMESH_API FastWindingNumber( const Mesh & mesh, bool secondOrder = false );
 
     // see methods' descriptions in IFastWindingNumber
     MRMESH_API Expected<void> calcFromVector( std::vector<float>& res, const std::vector<Vector3f>& points, float beta, FaceId skipFace, const ProgressCallback& cb ) override;
@@ -71,6 +76,7 @@ private:
     const Mesh & mesh_;
     const AABBTree & tree_;
     const Dipoles & dipoles_;
+    DipoleSecondOrders secondOrders_; ///< empty if second order is not used
 };
 
 /// Abstract class that complements \ref IFastWindingNumber with chunked processing variants of its methods
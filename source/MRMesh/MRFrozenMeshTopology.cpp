@@ -0,0 +1,277 @@
+#include "MRFrozenMeshTopology.h"
+#include "MRBitSetParallelFor.h"
+#include "MRParallelFor.h"
+#include "MRTimer.h"
+#include "MRGTest.h"
+#include "MRMakeSphereMesh.h"
+#include "MRMesh.h"
+#include "MRPch/MRTBB.h"
+
+namespace MR
+{
+
+FrozenMeshTopology::FrozenMeshTopology( const MeshTopology & topology )
+{
+    MR_TIMER;
+    assert( topology.updatingValids() );
+
+    const auto numEdges = topology.edgeSize();
+    next_.resizeNoInit( numEdges );
+    org_.resizeNoInit( numEdges );
+    left_.resizeNoInit( numEdges );
+    ParallelFor( topology.edges_, [&] ( EdgeId e )
+    {
+        const auto & he = topology.edges_[e];
+        next_[e] = he.next;
+        org_[e] = he.org;
+        left_[e] = he.left;
+    } );
+
+    edgePerVertex_ = topology.edgePerVertex_;
+    validVerts_ = topology.validVerts_;
+    edgePerFace_ = topology.edgePerFace_;
+    validFaces_ = topology.validFaces_;
+    numValidVerts_ = topology.numValidVerts_;
+    numValidFaces_ = topology.numValidFaces_;
+}
+
+MeshTopology FrozenMeshTopology::toMeshTopology() const
+{
+    MR_TIMER;
+    MeshTopology res;
+    res.edges_.resizeNoInit( edgeSize() );
+    ParallelFor( res.edges_, [&] ( EdgeId e )
+    {
+        auto & he = res.edges_[e];
+        he.next = next_[e];
+        // prev-field is restored from next-field of the previous edge in the ring
+        res.edges_[next_[e]].prev = e;
+        he.org = org_[e];
+        he.left = left_[e];
+    } );
+
+    res.edgePerVertex_ = edgePerVertex_;
+    res.validVerts_ = validVerts_;
+    res.edgePerFace_ = edgePerFace_;
+    res.validFaces_ = validFaces_;
+    res.numValidVerts_ = numValidVerts_;
+    res.numValidFaces_ = numValidFaces_;
+    return res;
+}
+
+bool FrozenMeshTopology::isLoneEdge( EdgeId a ) const
+{
+    assert( a.valid() );
+    if ( a >= edgeSize() )
+        return true;
+    // next_[a] == a implies prev( a ) == a
+    if ( left_[a].valid() || org_[a].valid() || next_[a] != a )
+        return false;
+
+    auto b = a.sym();
+    if ( left_[b].valid() || org_[b].valid() || next_[b] != b )
+        return false;
+
+    return true;
+}
+
+EdgeId FrozenMeshTopology::prev( EdgeId he ) const
+{
+    assert( he.valid() );
+    EdgeId e = he;
+    for ( ;; )
+    {
+        const EdgeId n = next_[e];
+        if ( n == he )
+            return e;
+        e = n;
+    }
+}
+
+int FrozenMeshTopology::getOrgDegree( EdgeId a ) const
+{
+    assert( a.valid() );
+    int degree = 0;
+    for ( [[maybe_unused]] auto e : orgRing( *this, a ) )
+        ++degree;
+    return degree;
+}
+
+bool FrozenMeshTopology::isLeftTri( EdgeId a ) const
+{
+    assert( a.valid() );
+    // same as MeshTopology::isLeftTri, but the left ring is walked backward
+    EdgeId b = lprev( a );
+    // dest(b) == org(a)
+    if ( a == b )
+        return false;
+    EdgeId c = lprev( b );
+    if ( a == c || b == c )
+        return false;
+    EdgeId d = lprev( c );
+    return a == d;
+}
+
+void FrozenMeshTopology::getLeftTriVerts( EdgeId a, VertId & v0, VertId & v1, VertId & v2 ) const
+{
+    // c = lprev( a ) goes from v2 to v0, and b = lprev( c ) goes from v1 to v2
+    v0 = org( a );
+    v1 = dest( a );
+    EdgeId c = lprev( a );
+    assert( a != c );
+    v2 = org( c );
+    assert( a == lprev( lprev( c ) ) );
+}
+
+Triangulation FrozenMeshTopology::getTriangulation() const
+{
+    MR_TIMER;
+    Triangulation res;
+    res.resize( faceSize() );
+    BitSetParallelFor( validFaces_, [&]( FaceId f )
+    {
+        getTriVerts( f, res[f] );
+    } );
+    return res;
+}
+
+EdgeBitSet FrozenMeshTopology::findBoundaryEdges() const
+{
+    MR_TIMER;
+    EdgeBitSet res( edgeSize() );
+    BitSetParallelForAll( res, [&]( EdgeId e )
+    {
+        if ( !left( e ) && !isLoneEdge( e ) )
+            res.set( e );
+    } );
+    return res;
+}
+
+FaceBitSet FrozenMeshTopology::findBoundaryFaces( const FaceBitSet * region ) const
+{
+    MR_TIMER;
+    const auto & fs = getFaceIds( region );
+    FaceBitSet res( fs.size() );
+    BitSetParallelFor( fs, [&]( FaceId f )
+    {
+        for ( EdgeId e : leftRingCW( *this, f ) )
+        {
+            if ( !right( e ) )
+            {
+                res.set( f );
+                break;
+            }
+        }
+    } );
+    return res;
+}
+
+VertBitSet FrozenMeshTopology::findBoundaryVerts( const VertBitSet * region ) const
+{
+    MR_TIMER;
+    const auto & vs = getVertIds( region );
+    VertBitSet res( vs.size() );
+    BitSetParallelFor( vs, [&]( VertId v )
+    {
+        for ( EdgeId e : orgRing( *this, v ) )
+        {
+            if ( !left( e ) )
+            {
+                res.set( v );
+                break;
+            }
+        }
+    } );
+    return res;
+}
+
+std::vector<EdgeId> FrozenMeshTopology::findHoleRepresentiveEdges() const
+{
+    MR_TIMER;
+    auto bdEdges = findBoundaryEdges();
+    EdgeBitSet representativeEdges( bdEdges.size() );
+
+    // same algorithm as in MeshTopology::findNumHoles
+    const int endBlock = int( bdEdges.size() + bdEdges.bits_per_block - 1 ) / bdEdges.bits_per_block;
+    tbb::parallel_for( tbb::blocked_range<int>( 0, endBlock ),
+        [&]( const tbb::blocked_range<int> & range )
+        {
+            const EdgeId eBeg{ range.begin() * BitSet::bits_per_block };
+            const EdgeId eEnd{ range.end() < endBlock ? range.end() * bdEdges.bits_per_block : bdEdges.size() };
+            for ( auto e = eBeg; e < eEnd; ++e )
+            {
+                if ( !bdEdges.test( e ) )
+                    continue;
+                EdgeId smallestHoleEdge = e;
+                for ( EdgeId ei : leftRing0CW( *this, e ) )
+                {
+                    if ( ei > e )
+                    {
+                        // skip this hole when its edge is encountered again,
+                        // we can safely change only bits of our part
+                        if ( ei < eEnd )
+                            bdEdges.reset( ei );
+                    }
+                    else if ( ei < smallestHoleEdge )
+                        smallestHoleEdge = ei;
+                }
+                if ( smallestHoleEdge >= eBeg )
+                    representativeEdges.set( smallestHoleEdge );
+            }
+        } );
+
+    std::vector<EdgeId> res;
+    res.reserve( representativeEdges.count() );
+    for ( EdgeId e : representativeEdges )
+        res.push_back( e );
+    return res;
+}
+
+size_t FrozenMeshTopology::heapBytes() const
+{
+    return
+        next_.heapBytes() +
+        org_.heapBytes() +
+        left_.heapBytes() +
+        edgePerVertex_.heapBytes() +
+        validVerts_.heapBytes() +
+        edgePerFace_.heapBytes() +
+        validFaces_.heapBytes();
+}
+
+TEST( MRMesh, FrozenMeshTopology )
+{
+    Mesh mesh = makeUVSphere( 1, 16, 16 );
+    // make a hole
+    FaceBitSet del( mesh.topology.faceSize() );
+    del.set( 0_f );
+    mesh.topology.deleteFaces( del );
+
+    const FrozenMeshTopology frozen( mesh.topology );
+    EXPECT_EQ( frozen.numValidVerts(), mesh.topology.numValidVerts() );
+    EXPECT_EQ( frozen.numValidFaces(), mesh.topology.numValidFaces() );
+    EXPECT_EQ( frozen.findBoundaryEdges(), mesh.topology.findBoundaryEdges() );
+    EXPECT_EQ( frozen.findBoundaryVerts(), mesh.topology.findBoundaryVerts() );
+    EXPECT_EQ( frozen.findBoundaryFaces(), mesh.topology.findBoundaryFaces() );
+    EXPECT_EQ( frozen.findHoleRepresentiveEdges(), mesh.topology.findHoleRepresentiveEdges() );
+
+    for ( auto v : frozen.getValidVerts() )
+        EXPECT_EQ( frozen.getVertDegree( v ), mesh.topology.getVertDegree( v ) );
+    for ( auto f : frozen.getValidFaces() )
+        EXPECT_EQ( frozen.getTriVerts( f ), mesh.topology.getTriVerts( f ) );
+    for ( EdgeId e{ 0 }; e < frozen.edgeSize(); ++e )
+    {
+        EXPECT_EQ( frozen.prev( e ), mesh.topology.prev( e ) );
+        EXPECT_EQ( frozen.isLeftTri( e ), mesh.topology.isLeftTri( e ) );
+    }
+    EXPECT_LT( frozen.heapBytes(), mesh.topology.heapBytes() );
+
+    size_t numEdges = 0;
+    for ( [[maybe_unused]] auto ue : undirectedEdges( frozen ) )
+        ++numEdges;
+    EXPECT_EQ( numEdges, mesh.topology.computeNotLoneUndirectedEdges() );
+
+    EXPECT_EQ( frozen.toMeshTopology(), mesh.topology );
+}
+
+} //namespace MR
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "MRMeshTopology.h"
+#include "MRRingIterator.h"
+#include "MREdgeIterator.h"
+
+namespace MR
+{
+
+/// \brief read-only compact representation of mesh topology optimized for traversal-heavy algorithms
+/// \details in contrast to MeshTopology, which stores all four fields of each half-edge together (16 bytes per half-edge),
+/// this class keeps only next, org and left fields of half-edges (12 bytes per half-edge) each in a separate array (structure of arrays):
+/// * sym is implicit in edge identifiers as everywhere else, and prev is not stored at all:
+///   left rings are traversed backward using next only ( lprev(e) = next(e).sym() ),
+///   and prev( e ) is found by the walk around the origin ring, so it shall be avoided in hot loops;
+/// * each traversal step reads only the data it needs:
+///   e.g. iteration over an origin ring touches only 4 bytes of next-array per step instead of whole half-edge record,
+///   and boundary detection reads only left-array;
+/// edge, vertex and face identifiers are exactly the same as in the source MeshTopology,
+/// so all per-element attributes (coordinates, colors, bit sets) remain valid;
+/// for the best memory locality call MeshTopology::pack() or Mesh::packOptimally() before freezing
+/// \ingroup MeshTopologyGroup
+class FrozenMeshTopology
+{
+public:
+    FrozenMeshTopology() = default;
+
+    /// makes compact read-only copy of given topology, which must have valid vertices and faces updating enabled
+    MRMESH_API explicit FrozenMeshTopology( const MeshTopology & topology );
+
+    /// makes usual mutable topology from this
+    [[nodiscard]] MRMESH_API MeshTopology toMeshTopology() const;
+
+    /// returns the number of half-edge records including lone ones
+    [[nodiscard]] size_t edgeSize() const { return next_.size(); }
+
+    /// returns the number of undirected edges (pairs of half-edges) including lone ones
+    [[nodiscard]] size_t undirectedEdgeSize() const { return next_.size() >> 1; }
+
+    /// returns true if given edge is within valid range and not-lone
+    [[nodiscard]] bool hasEdge( EdgeId e ) const { assert( e.valid() ); return e < (int)edgeSize() && !isLoneEdge( e ); }
+
+    /// checks whether the edge is disconnected from all other edges and disassociated from all vertices and faces (as if after makeEdge)
+    [[nodiscard]] MRMESH_API bool isLoneEdge( EdgeId a ) const;
+
+    /// next (counter clock wise) half-edge in the origin ring
+    [[nodiscard]] EdgeId next( EdgeId he ) const { assert( he.valid() ); return next_[he]; }
+
+    /// previous (clock wise) half-edge in the origin ring;
+    /// it is not stored, but found by the walk around the origin ring, so its cost is proportional to the vertex degree
+    [[nodiscard]] MRMESH_API EdgeId prev( EdgeId he ) const;
+
+    /// previous half-edge in the left ring (next(e).sym()), which is cheap in contrast to the next one in the left ring
+    [[nodiscard]] EdgeId lprev( EdgeId he ) const { assert( he.valid() ); return next_[he].sym(); }
+
+    /// returns origin vertex of half-edge
+    [[nodiscard]] VertId org( EdgeId he ) const { assert( he.valid() ); return org_[he]; }
+
+    /// returns destination vertex of half-edge
+    [[nodiscard]] VertId dest( EdgeId he ) const { assert( he.valid() ); return org_[he.sym()]; }
+
+    /// returns left face of half-edge
+    [[nodiscard]] FaceId left( EdgeId he ) const { assert( he.valid() ); return left_[he]; }
+
+    /// returns right face of half-edge
+    [[nodiscard]] FaceId right( EdgeId he ) const { assert( he.valid() ); return left_[he.sym()]; }
+
+    /// returns the number of edges around the origin vertex, returns 1 for lone edges
+    [[nodiscard]] MRMESH_API int getOrgDegree( EdgeId a ) const;
+
+    /// returns the number of edges around the given vertex
+    [[nodiscard]] int getVertDegree( VertId v ) const { return getOrgDegree( edgeWithOrg( v ) ); }
+
+    /// returns true if the cell to the left of a is triangular
+    [[nodiscard]] MRMESH_API bool isLeftTri( EdgeId a ) const;
+
+    /// gets 3 vertices of the left face ( face-id may not exist, but the shape must be triangular)
+    /// the vertices are returned in counter-clockwise order if look from mesh outside: v0 = org( a ), v1 = dest( a )
+    MRMESH_API void getLeftTriVerts( EdgeId a, VertId & v0, VertId & v1, VertId & v2 ) const;
+    void getLeftTriVerts( EdgeId a, VertId (&v)[3] ) const { getLeftTriVerts( a, v[0], v[1], v[2] ); }
+    void getLeftTriVerts( EdgeId a, ThreeVertIds & v ) const { getLeftTriVerts( a, v[0], v[1], v[2] ); }
+    [[nodiscard]] ThreeVertIds getLeftTriVerts( EdgeId a ) const { ThreeVertIds v; getLeftTriVerts( a, v[0], v[1], v[2] ); return v; }
+
+    /// gets 3 vertices of given triangular face;
+    /// the vertices are returned in counter-clockwise order if look from mesh outside
+    void getTriVerts( FaceId f, VertId (&v)[3] ) const { getLeftTriVerts( edgeWithLeft( f ), v ); }
+    void getTriVerts( FaceId f, ThreeVertIds & v ) const { getLeftTriVerts( edgeWithLeft( f ), v ); }
+    [[nodiscard]] ThreeVertIds getTriVerts( FaceId f ) const { return getLeftTriVerts( edgeWithLeft( f ) ); }
+
+    /// returns three vertex ids for valid triangles (which can be accessed by FaceId),
+    /// vertex ids for invalid triangles are undefined, and shall not be read
+    [[nodiscard]] MRMESH_API Triangulation getTriangulation() const;
+
+    /// returns the number of vertex records including invalid ones
+    [[nodiscard]] size_t vertSize() const { return edgePerVertex_.size(); }
+
+    /// returns valid edge if given vertex is present in the mesh
+    [[nodiscard]] EdgeId edgeWithOrg( VertId a ) const { assert( a.valid() ); return a < int( edgePerVertex_.size() ) ? edgePerVertex_[a] : EdgeId(); }
+
+    /// returns true if given vertex is present in the mesh
+    [[nodiscard]] bool hasVert( VertId a ) const { return validVerts_.test( a ); }
+
+    /// returns the number of valid vertices
+    [[nodiscard]] int numValidVerts() const { return numValidVerts_; }
+
+    /// returns cached set of all valid vertices
+    [[nodiscard]] const VertBitSet & getValidVerts() const { return validVerts_; }
+
+    /// if region pointer is not null then converts it in reference, otherwise returns all valid vertices in the mesh
+    [[nodiscard]] const VertBitSet & getVertIds( const VertBitSet * region ) const { return region ? *region : validVerts_; }
+
+    /// returns the number of face records including invalid ones
+    [[nodiscard]] size_t faceSize() const { return edgePerFace_.size(); }
+
+    /// returns valid edge if given face is present in the mesh
+    [[nodiscard]] EdgeId edgeWithLeft( FaceId a ) const { assert( a.valid() ); return a < int( edgePerFace_.size() ) ? edgePerFace_[a] : EdgeId(); }
+
+    /// returns true if given face is present in the mesh
+    [[nodiscard]] bool hasFace( FaceId a ) const { return validFaces_.test( a ); }
+
+    /// returns the number of valid faces
+    [[nodiscard]] int numValidFaces() const { return numValidFaces_; }
+
+    /// returns cached set of all valid faces
+    [[nodiscard]] const FaceBitSet & getValidFaces() const { return validFaces_; }
+
+    /// if region pointer is not null then converts it in reference, otherwise returns all valid faces in the mesh
+    [[nodiscard]] const FaceBitSet & getFaceIds( const FaceBitSet * region ) const { return region ? *region : validFaces_; }
+
+    /// returns true if given edge has no valid left face
+    [[nodiscard]] bool isLeftBdEdge( EdgeId e ) const { return !left( e ) && !isLoneEdge( e ); }
+
+    /// returns all boundary edges, where each edge does not have valid left face
+    [[nodiscard]] MRMESH_API EdgeBitSet findBoundaryEdges() const;
+
+    /// returns all boundary faces, having at least one boundary edge;
+    /// \param region if given then search among faces there otherwise among all valid faces
+    [[nodiscard]] MRMESH_API FaceBitSet findBoundaryFaces( const FaceBitSet * region = nullptr ) const;
+
+    /// returns all boundary vertices, incident to at least one boundary edge;
+    /// \param region if given then search among vertices there otherwise among all valid vertices
+    [[nodiscard]] MRMESH_API VertBitSet findBoundaryVerts( const VertBitSet * region = nullptr ) const;
+
+    /// returns one edge with no valid left face for every boundary in the mesh
+    [[nodiscard]] MRMESH_API std::vector<EdgeId> findHoleRepresentiveEdges() const;
+
+    /// returns the amount of memory this object occupies on heap
+    [[nodiscard]] MRMESH_API size_t heapBytes() const;
+
+private:
+    // every stored field of half-edge records is kept in its own array, prev-field is implicit
+    Vector<EdgeId, EdgeId> next_;
+    Vector<VertId, EdgeId> org_;
+    Vector<FaceId, EdgeId> left_;
+
+    Vector<EdgeId, VertId> edgePerVertex_;
+    VertBitSet validVerts_;
+    Vector<EdgeId, FaceId> edgePerFace_;
+    FaceBitSet validFaces_;
+
+    int numValidVerts_ = 0;
+    int numValidFaces_ = 0;
+};
+
+class NextEdgeSameOriginFrozen
+{
+    const FrozenMeshTopology * topology_ = nullptr;
+
+public:
+    NextEdgeSameOriginFrozen( const FrozenMeshTopology & topology ) : topology_( &topology ) { }
+    EdgeId next( EdgeId e ) const { return topology_->next( e ); }
+};
+
+using FrozenOrgRingIterator = RingIterator<NextEdgeSameOriginFrozen>;
+
+/// unlike NextEdgeSameLeft, walks the left ring in clockwise order, since prev-field is not stored in FrozenMeshTopology
+class NextEdgeSameLeftFrozen
+{
+    const FrozenMeshTopology * topology_ = nullptr;
+
+public:
+    NextEdgeSameLeftFrozen( const FrozenMeshTopology & topology ) : topology_( &topology ) { }
+    EdgeId next( EdgeId e ) const { return topology_->lprev( e ); }
+};
+
+using FrozenLeftRingIterator = RingIterator<NextEdgeSameLeftFrozen>;
+
+// to iterate over all edges with same origin vertex as firstEdge (INCLUDING firstEdge)
+// for ( Edge e : orgRing( frozenTopology, firstEdge ) ) ...
+inline IteratorRange<FrozenOrgRingIterator> orgRing( const FrozenMeshTopology & topology, EdgeId edge )
+    { return { FrozenOrgRingIterator( topology, edge, edge.valid() ), FrozenOrgRingIterator( topology, edge, false ) }; }
+inline IteratorRange<FrozenOrgRingIterator> orgRing( const FrozenMeshTopology & topology, VertId v )
+    { return orgRing( topology, topology.edgeWithOrg( v ) ); }
+
+// to iterate over all edges with same origin vertex as firstEdge (EXCLUDING firstEdge)
+inline IteratorRange<FrozenOrgRingIterator> orgRing0( const FrozenMeshTopology & topology, EdgeId edge )
+    { return { ++FrozenOrgRingIterator( topology, edge, true ), FrozenOrgRingIterator( topology, edge, false ) }; }
+
+// to iterate over all edges with same left face as firstEdge (INCLUDING firstEdge) in clockwise order,
+// which is opposite to leftRing( const MeshTopology &, ... )
+// for ( Edge e : leftRingCW( frozenTopology, firstEdge ) ) ...
+inline IteratorRange<FrozenLeftRingIterator> leftRingCW( const FrozenMeshTopology & topology, EdgeId edge )
+    { return { FrozenLeftRingIterator( topology, edge, edge.valid() ), FrozenLeftRingIterator( topology, edge, false ) }; }
+inline IteratorRange<FrozenLeftRingIterator> leftRingCW( const FrozenMeshTopology & topology, FaceId f )
+    { return leftRingCW( topology, topology.edgeWithLeft( f ) ); }
+
+// to iterate over all edges with same left face as firstEdge (EXCLUDING firstEdge) in clockwise order
+inline IteratorRange<FrozenLeftRingIterator> leftRing0CW( const FrozenMeshTopology & topology, EdgeId edge )
+    { return { ++FrozenLeftRingIterator( topology, edge, true ), FrozenLeftRingIterator( topology, edge, false ) }; }
+
+inline IteratorRange<UndirectedEdgeIteratorT<FrozenMeshTopology>> undirectedEdges( const FrozenMeshTopology & topology )
+    { return { UndirectedEdgeIteratorT<FrozenMeshTopology>( topology ), UndirectedEdgeIteratorT<FrozenMeshTopology>() }; }
+
+} //namespace MR
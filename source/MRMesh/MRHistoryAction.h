@@ -1,5 +1,7 @@
 #pragma once
 #include "MRMeshFwd.h"
+#include "MRExpected.h"
+#include <filesystem>
 #include <functional>
 #include <string>
 
@@ -25,6 +27,18 @@ public:
 
     /// returns the amount of memory this object occupies on heap
     [[nodiscard]] virtual size_t heapBytes() const = 0;
+
+    /// moves the heavy data of this action from memory in compressed files inside given folder,
+    /// the data are loaded back automatically on next action() call;
+    /// returns false if the action does not support it or nothing was moved
+    virtual bool spill( const std::filesystem::path & folder ) { (void)folder; return false; }
+
+    /// loads the data moved by spill() back in memory, HistoryStore calls it before action();
+    /// returns error if the data cannot be restored, then the action cannot be performed
+    virtual Expected<void> unspill() { return {}; }
+
+    /// returns the amount of disk space occupied by the data moved by spill()
+    [[nodiscard]] virtual size_t spilledBytes() const { return 0; }
 };
 
 using HistoryStackFilter = std::function<bool( const std::shared_ptr<HistoryAction>& )>;
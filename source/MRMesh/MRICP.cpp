@@ -7,17 +7,21 @@
 #include "MRQuaternion.h"
 #include "MRBestFit.h"
 #include "MRBitSetParallelFor.h"
+#include "MRMortonCode.h"
+#include "MRPch/MRTBB.h"
 #include <numeric>
 
 namespace MR
 {
 
-void setupPairs( PointPairs & pairs, const VertBitSet& srcSamples )
+/// the pairs are ordered by Morton codes of source points, so that the pairs processed by one thread are spatially close
+static void setupPairs( PointPairs & pairs, const VertBitSet& srcSamples, const VertCoords& srcPoints )
 {
+    const auto order = getMortonOrder( srcPoints, srcSamples );
     pairs.vec.clear();
-    pairs.vec.reserve( srcSamples.count() );
-    for ( auto id : srcSamples )
-        pairs.vec.emplace_back().srcVertId = id;
+    pairs.vec.resize( order.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+        pairs.vec[i].srcVertId = order[i];
     pairs.active.clear();
 }
 
@@ -37,8 +41,8 @@ ICP::ICP( const MeshOrPointsXf& flt, const MeshOrPointsXf& ref, const VertBitSet
     : flt_( flt )
     , ref_( ref )
 {
-    MR::setupPairs( flt2refPairs_, fltSamples );
-    MR::setupPairs( ref2fltPairs_, refSamples );
+    setupPairs( flt2refPairs_, fltSamples, flt_.obj.points() );
+    setupPairs( ref2fltPairs_, refSamples, ref_.obj.points() );
 }
 
 ICP::ICP( const MeshOrPointsXf& flt, const MeshOrPointsXf& ref, float samplingVoxelSize )
@@ -93,7 +97,7 @@ AffineXf3f ICP::autoSelectFloatXf()
 
 void ICP::setFltSamples( const VertBitSet& fltSamples )
 {
-    setupPairs( flt2refPairs_, fltSamples );
+    setupPairs( flt2refPairs_, fltSamples, flt_.obj.points() );
 }
 
 void ICP::sampleFltPoints( float samplingVoxelSize )
@@ -103,7 +107,7 @@ void ICP::sampleFltPoints( float samplingVoxelSize )
 
 void ICP::setRefSamples( const VertBitSet& refSamples )
 {
-    setupPairs( ref2fltPairs_, refSamples );
+    setupPairs( ref2fltPairs_, refSamples, ref_.obj.points() );
 }
 
 void ICP::sampleRefPoints( float samplingVoxelSize )
@@ -240,20 +244,49 @@ void ICP::deactivatefarDistPairs_()
     }
 }
 
+namespace
+{
+
+/// sum of points coordinates to find their centroid
+struct PointsSum
+{
+    Vector3d sum;
+    int num = 0;
+    void add( const PointsSum & other ) { sum += other.sum; num += other.num; }
+};
+
+/// accumulates all active pairs in parallel threads, the result does not depend on the number of threads
+template<typename T, typename F>
+T accumulateActivePairs( const PointPairs & pairs, F && addPair )
+{
+    return tbb::parallel_deterministic_reduce( tbb::blocked_range<size_t>( 0, pairs.vec.size(), 1024 ), T{},
+        [&] ( const tbb::blocked_range<size_t> & range, T curr )
+        {
+            for ( size_t i = range.begin(); i < range.end(); ++i )
+                if ( pairs.active.test( i ) )
+                    addPair( curr, pairs.vec[i] );
+            return curr;
+        },
+        [] ( T a, const T & b )
+        {
+            a.add( b );
+            return a;
+        } );
+}
+
+} //anonymous namespace
+
 bool ICP::p2ptIter_()
 {
     MR_TIMER;
-    PointToPointAligningTransform p2pt;
-    for ( size_t idx : flt2refPairs_.active )
+    auto p2pt = accumulateActivePairs<PointToPointAligningTransform>( flt2refPairs_, [] ( PointToPointAligningTransform & acc, const PointPair & vp )
     {
-        const auto& vp = flt2refPairs_.vec[idx];
-        p2pt.add( vp.srcPoint, vp.tgtPoint, vp.weight );
-    }
-    for ( size_t idx : ref2fltPairs_.active )
+        acc.add( vp.srcPoint, vp.tgtPoint, vp.weight );
+    } );
+    p2pt.add( accumulateActivePairs<PointToPointAligningTransform>( ref2fltPairs_, [] ( PointToPointAligningTransform & acc, const PointPair & vp )
     {
-        const auto& vp = ref2fltPairs_.vec[idx];
-        p2pt.add( vp.tgtPoint, vp.srcPoint, vp.weight );
-    }
+        acc.add( vp.tgtPoint, vp.srcPoint, vp.weight );
+    } ) );
 
     AffineXf3f res;
     switch ( prop_.icpMode )
@@ -335,39 +368,26 @@ AffineXf3f getAligningXf( const PointToPlaneAligningTransform & p2pl,
 bool ICP::p2plIter_()
 {
     MR_TIMER;
-    Vector3f centroidRef;
-    int activeCount = 0;
-    for ( size_t idx : flt2refPairs_.active )
-    {
-        const auto& vp = flt2refPairs_.vec[idx];
-        centroidRef += vp.tgtPoint;
-        centroidRef += vp.srcPoint;
-        ++activeCount;
-    }
-    for ( size_t idx : ref2fltPairs_.active )
+    auto addBoth = [] ( PointsSum & acc, const PointPair & vp )
     {
-        const auto& vp = ref2fltPairs_.vec[idx];
-        centroidRef += vp.tgtPoint;
-        centroidRef += vp.srcPoint;
-        ++activeCount;
-    }
-    if ( activeCount <= 0 )
+        acc.sum += Vector3d( vp.tgtPoint ) + Vector3d( vp.srcPoint );
+        acc.num += 2;
+    };
+    auto pointsSum = accumulateActivePairs<PointsSum>( flt2refPairs_, addBoth );
+    pointsSum.add( accumulateActivePairs<PointsSum>( ref2fltPairs_, addBoth ) );
+    if ( pointsSum.num <= 0 )
         return false;
-    centroidRef /= float(activeCount * 2);
+    const Vector3f centroidRef( pointsSum.sum / double( pointsSum.num ) );
     AffineXf3f centroidRefXf = AffineXf3f(Matrix3f(), centroidRef);
 
-    PointToPlaneAligningTransform p2pl;
-    for ( size_t idx : flt2refPairs_.active )
+    auto p2pl = accumulateActivePairs<PointToPlaneAligningTransform>( flt2refPairs_, [&] ( PointToPlaneAligningTransform & acc, const PointPair & vp )
     {
-        const auto& vp = flt2refPairs_.vec[idx];
-        p2pl.add( vp.srcPoint - centroidRef, vp.tgtPoint - centroidRef, vp.tgtNorm, vp.weight );
-    }
-    for ( size_t idx : ref2fltPairs_.active )
+        acc.add( vp.srcPoint - centroidRef, vp.tgtPoint - centroidRef, vp.tgtNorm, vp.weight );
+    } );
+    p2pl.add( accumulateActivePairs<PointToPlaneAligningTransform>( ref2fltPairs_, [&] ( PointToPlaneAligningTransform & acc, const PointPair & vp )
     {
-        const auto& vp = ref2fltPairs_.vec[idx];
-        p2pl.add( vp.tgtPoint - centroidRef, vp.srcPoint - centroidRef, vp.srcNorm, vp.weight );
-    }
-    p2pl.prepare();
+        acc.add( vp.tgtPoint - centroidRef, vp.srcPoint - centroidRef, vp.srcNorm, vp.weight );
+    } ) );
 
     AffineXf3f res = getAligningXf( p2pl, prop_.icpMode, prop_.p2plAngleLimit, prop_.p2plScaleLimit, prop_.fixedRotationAxis );
     if (std::isnan(res.b.x)) //nan check
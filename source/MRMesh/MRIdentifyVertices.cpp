@@ -1,6 +1,19 @@
 #include "MRIdentifyVertices.h"
+#include "MRBitSet.h"
 #include "MRParallelFor.h"
+#include "MRStringConvert.h"
+#include "MRUniqueTemporaryFolder.h"
 #include "MRTimer.h"
+#include "MRMesh.h"
+#include "MRMakeSphereMesh.h"
+#include "MRGTest.h"
+#include "MRPch/MRTBB.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <fstream>
 
 namespace MR
 {
@@ -63,6 +76,276 @@ void VertexIdentifier::addTriangles( const std::vector<Triangle3f> & buffer )
     }
 }
 
+namespace
+{
+
+/// one triangle corner as stored in temporary files
+struct Corner
+{
+    Vector3f p;
+    std::uint32_t corner; ///< 3 * triangle + corner index in the triangle
+};
+static_assert( sizeof( Corner ) == 16 );
+
+/// bit-wise representation of point coordinates
+std::array<std::uint32_t, 3> bitKey( const Vector3f & p )
+{
+    std::array<std::uint32_t, 3> res;
+    static_assert( sizeof( res ) == sizeof( p ) );
+    std::memcpy( res.data(), &p, sizeof( p ) );
+    return res;
+}
+
+/// returns the partition for given point, equal points always get the same partition
+size_t partitionOf( const Vector3f & p, size_t numParts )
+{
+    const auto k = bitKey( p );
+    std::uint64_t h = ( ( std::uint64_t( k[0] ) << 32 ) | k[1] ) * 0x9E3779B97F4A7C15ull;
+    h ^= k[2] + 0x632BE59BD9B4E019ull + ( h << 6 ) + ( h >> 2 );
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 31;
+    return size_t( h >> 32 ) % numParts;
+}
+
+} //anonymous namespace
+
+struct OutOfCoreVertexIdentifier::Impl
+{
+    size_t numTris = 0;
+    size_t addedTris = 0;
+    size_t numParts = 1;
+    size_t bufferCorners = 0;
+    UniqueTemporaryFolder folder{ {} };
+    std::vector<std::filesystem::path> paths;
+    std::vector<std::ofstream> files;
+    std::vector<std::vector<Corner>> buffers;
+    std::string error; ///< delayed error from constructor
+    Triangulation t;
+    VertCoords points;
+
+    Expected<void> flush( size_t part )
+    {
+        auto & buf = buffers[part];
+        if ( buf.empty() )
+            return {};
+        files[part].write( (const char*)buf.data(), buf.size() * sizeof( Corner ) );
+        buf.clear();
+        if ( !files[part] )
+            return unexpected( "Cannot write temporary file " + utf8string( paths[part] ) );
+        return {};
+    }
+};
+
+OutOfCoreVertexIdentifier::OutOfCoreVertexIdentifier( size_t numTris, size_t memoryBudget )
+    : impl_( std::make_unique<Impl>() )
+{
+    auto & m = *impl_;
+    m.numTris = numTris;
+    if ( 3 * numTris > size_t( INT_MAX ) )
+    {
+        m.error = "Too many triangles for out-of-core vertex identification";
+        return;
+    }
+    if ( !m.folder )
+    {
+        m.error = "Cannot create temporary folder";
+        return;
+    }
+
+    // one half of the budget is for a loaded partition, and one quarter is for write buffers of all partitions
+    constexpr size_t cMaxParts = 256; // do not exceed the limit on simultaneously opened files
+    const size_t partBudget = std::max( memoryBudget / 2, size_t( 1 ) << 20 );
+    const size_t totalBytes = 3 * numTris * sizeof( Corner );
+    m.numParts = std::clamp( ( totalBytes + partBudget - 1 ) / partBudget, size_t( 1 ), cMaxParts );
+    m.bufferCorners = std::clamp( memoryBudget / 4 / m.numParts / sizeof( Corner ), size_t( 1024 ), size_t( 1 ) << 20 );
+
+    m.paths.resize( m.numParts );
+    m.files.resize( m.numParts );
+    m.buffers.resize( m.numParts );
+    for ( size_t i = 0; i < m.numParts; ++i )
+    {
+        m.paths[i] = m.folder / ( "part" + std::to_string( i ) );
+        m.files[i].open( m.paths[i], std::ios::binary );
+        if ( !m.files[i] )
+        {
+            m.error = "Cannot create temporary file " + utf8string( m.paths[i] );
+            return;
+        }
+        m.buffers[i].reserve( m.bufferCorners );
+    }
+    m.t.resize( numTris );
+}
+
+OutOfCoreVertexIdentifier::~OutOfCoreVertexIdentifier() = default;
+
+size_t OutOfCoreVertexIdentifier::numTris() const
+{
+    return impl_->addedTris;
+}
+
+Expected<void> OutOfCoreVertexIdentifier::addTriangles( const std::vector<Triangle3f> & buffer )
+{
+    MR_TIMER;
+    auto & m = *impl_;
+    if ( !m.error.empty() )
+        return unexpected( m.error );
+    assert( m.addedTris + buffer.size() <= m.numTris );
+
+    auto corner = std::uint32_t( 3 * m.addedTris );
+    for ( const auto & tri : buffer )
+    {
+        for ( const auto & p : tri )
+        {
+            const auto part = partitionOf( p, m.numParts );
+            m.buffers[part].push_back( { p, corner++ } );
+            if ( m.buffers[part].size() >= m.bufferCorners )
+                if ( auto r = m.flush( part ); !r )
+                    return r;
+        }
+    }
+    m.addedTris += buffer.size();
+    return {};
+}
+
+Expected<void> OutOfCoreVertexIdentifier::finish( ProgressCallback cb )
+{
+    MR_TIMER;
+    auto & m = *impl_;
+    if ( !m.error.empty() )
+        return unexpected( m.error );
+    assert( m.addedTris == m.numTris );
+
+    for ( size_t i = 0; i < m.numParts; ++i )
+    {
+        if ( auto r = m.flush( i ); !r )
+            return r;
+        m.files[i].close();
+        m.buffers[i] = {};
+    }
+
+    // find equal points in each partition by sorting, the first corner of each point gets bit in this set,
+    // and temporary all corners in the triangulation reference the first corner of the same point
+    BitSet firstCorners( 3 * m.numTris );
+    auto setCornerRef = [&]( std::uint32_t c, std::uint32_t ref )
+    {
+        m.t[FaceId( int( c / 3 ) )][c % 3] = VertId( int( ref ) );
+    };
+    std::vector<Corner> corners;
+    for ( size_t i = 0; i < m.numParts; ++i )
+    {
+        std::ifstream in( m.paths[i], std::ios::binary );
+        corners.resize( std::filesystem::file_size( m.paths[i] ) / sizeof( Corner ) );
+        in.read( (char*)corners.data(), corners.size() * sizeof( Corner ) );
+        if ( !in )
+            return unexpected( "Cannot read temporary file " + utf8string( m.paths[i] ) );
+        tbb::parallel_sort( corners.begin(), corners.end(), []( const Corner & a, const Corner & b )
+        {
+            const auto ka = bitKey( a.p ), kb = bitKey( b.p );
+            if ( ka != kb )
+                return ka < kb;
+            return a.corner < b.corner;
+        } );
+        for ( size_t j = 0; j < corners.size(); )
+        {
+            const auto first = corners[j].corner;
+            const auto key = bitKey( corners[j].p );
+            firstCorners.set( first );
+            for ( ; j < corners.size() && bitKey( corners[j].p ) == key; ++j )
+                setCornerRef( corners[j].corner, first );
+        }
+        if ( !reportProgress( cb, 0.7f * float( i + 1 ) / m.numParts ) )
+            return unexpectedOperationCanceled();
+    }
+    corners = {};
+
+    // vertex id of a point is the number of first corners before its first corner
+    const auto & blocks = firstCorners.bits();
+    std::vector<int> blockPrefix( blocks.size() + 1 );
+    blockPrefix[0] = 0;
+    for ( size_t b = 0; b < blocks.size(); ++b )
+        blockPrefix[b + 1] = blockPrefix[b] + std::popcount( blocks[b] );
+    auto rank = [&]( std::uint32_t c )
+    {
+        const auto b = c / BitSet::bits_per_block;
+        const auto mask = ( BitSet::block_type( 1 ) << ( c % BitSet::bits_per_block ) ) - 1;
+        return VertId( blockPrefix[b] + std::popcount( blocks[b] & mask ) );
+    };
+    ParallelFor( m.t, [&]( FaceId f )
+    {
+        for ( auto & v : m.t[f] )
+            v = rank( std::uint32_t( int( v ) ) );
+    } );
+    if ( !reportProgress( cb, 0.8f ) )
+        return unexpectedOperationCanceled();
+
+    // read partitions again to get the coordinates of all first corners
+    m.points.resizeNoInit( blockPrefix.back() );
+    std::atomic<bool> readFailed{ false };
+    ParallelFor( size_t( 0 ), m.numParts, [&]( size_t i )
+    {
+        std::ifstream in( m.paths[i], std::ios::binary );
+        std::vector<Corner> buf( 65536 );
+        auto remaining = std::filesystem::file_size( m.paths[i] ) / sizeof( Corner );
+        while ( remaining > 0 )
+        {
+            buf.resize( std::min( remaining, buf.size() ) );
+            in.read( (char*)buf.data(), buf.size() * sizeof( Corner ) );
+            if ( !in )
+            {
+                readFailed = true;
+                return;
+            }
+            for ( const auto & c : buf )
+                if ( firstCorners.test( c.corner ) )
+                    m.points[rank( c.corner )] = c.p;
+            remaining -= buf.size();
+        }
+        in.close();
+        std::error_code ec;
+        std::filesystem::remove( m.paths[i], ec ); // free disk space as soon as possible
+    } );
+    if ( readFailed )
+        return unexpected( std::string( "Cannot read temporary file" ) );
+
+    if ( !reportProgress( cb, 1.0f ) )
+        return unexpectedOperationCanceled();
+    return {};
+}
+
+Triangulation OutOfCoreVertexIdentifier::takeTriangulation()
+{
+    return std::move( impl_->t );
+}
+
+VertCoords OutOfCoreVertexIdentifier::takePoints()
+{
+    return std::move( impl_->points );
+}
+
+TEST( MRMesh, OutOfCoreVertexIdentifier )
+{
+    const auto sphere = makeUVSphere( 1, 256, 256 );
+    std::vector<Triangle3f> tris;
+    for ( auto f : sphere.topology.getValidFaces() )
+        tris.push_back( sphere.getTriPoints( f ) );
+
+    VertexIdentifier vi;
+    vi.reserve( tris.size() );
+    vi.addTriangles( tris );
+    const auto refT = vi.takeTriangulation();
+    const auto refPoints = vi.takePoints();
+
+    // minimal memory budget to have several partitions
+    OutOfCoreVertexIdentifier ovi( tris.size(), 1 );
+    const auto half = tris.size() / 2;
+    EXPECT_TRUE( ovi.addTriangles( { tris.begin(), tris.begin() + half } ).has_value() );
+    EXPECT_TRUE( ovi.addTriangles( { tris.begin() + half, tris.end() } ).has_value() );
+    EXPECT_EQ( ovi.numTris(), tris.size() );
+    EXPECT_TRUE( ovi.finish().has_value() );
+    EXPECT_EQ( ovi.takeTriangulation(), refT );
+    EXPECT_EQ( ovi.takePoints(), refPoints );
+}
+
 } //namespace MeshBuilder
 
 } //namespace MR
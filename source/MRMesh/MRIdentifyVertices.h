@@ -4,7 +4,10 @@
 #include "MRVector3.h"
 #include "MRVector.h"
 #include "MRphmap.h"
+#include "MRExpected.h"
+#include "MRProgressCallback.h"
 #include <cstring>
+#include <memory>
 
 namespace MR
 {
@@ -52,6 +55,35 @@ private:
     VertCoords points_;
 };
 
+/// this class gives a unique id to each vertex with distinct coordinates (bit-wise as VertexIdentifier does),
+/// but keeps in memory only the output triangulation and points and a limited amount of temporary data:
+/// all triangle corners are spilled in temporary files partitioned by the hash of coordinates,
+/// then each partition is loaded and sorted separately to find equal points;
+/// vertex ids are assigned in the order of first appearance of the points exactly as in VertexIdentifier
+class OutOfCoreVertexIdentifier
+{
+public:
+    /// \param numTris the total number of triangles to be added
+    /// \param memoryBudget approximate limit on the size of temporary data in bytes
+    MRMESH_API OutOfCoreVertexIdentifier( size_t numTris, size_t memoryBudget );
+    MRMESH_API ~OutOfCoreVertexIdentifier();
+
+    /// writes the corners of next chunk of triangles in temporary files
+    MRMESH_API Expected<void> addTriangles( const std::vector<Triangle3f> & buffer );
+    /// returns the number of triangles added so far
+    [[nodiscard]] MRMESH_API size_t numTris() const;
+    /// identifies the vertices of all added triangles, must be called once after the last addTriangles
+    MRMESH_API Expected<void> finish( ProgressCallback cb = {} );
+    /// obtains triangulation with vertex ids
+    [[nodiscard]] MRMESH_API Triangulation takeTriangulation();
+    /// obtains coordinates of unique points in the order of vertex ids
+    [[nodiscard]] MRMESH_API VertCoords takePoints();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 } //namespace MeshBuilder
 
 } //namespace MR
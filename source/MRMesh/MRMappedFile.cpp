@@ -0,0 +1,112 @@
+#include "MRMappedFile.h"
+#include "MRStringConvert.h"
+#include <utility>
+
+#ifdef _WIN32
+#include "MRPch/MRWinapi.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MR
+{
+
+MappedFile::MappedFile( MappedFile && b ) noexcept
+{
+    *this = std::move( b );
+}
+
+MappedFile & MappedFile::operator =( MappedFile && b ) noexcept
+{
+    if ( this == &b )
+        return *this;
+    close_();
+    data_ = std::exchange( b.data_, nullptr );
+    size_ = std::exchange( b.size_, 0 );
+#ifdef _WIN32
+    mapping_ = std::exchange( b.mapping_, nullptr );
+#endif
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    close_();
+}
+
+void MappedFile::close_()
+{
+#ifdef _WIN32
+    if ( data_ )
+        UnmapViewOfFile( data_ );
+    if ( mapping_ )
+        CloseHandle( mapping_ );
+    mapping_ = nullptr;
+#else
+    if ( data_ )
+        munmap( const_cast<char*>( data_ ), size_ );
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+Expected<MappedFile> MappedFile::open( const std::filesystem::path & file )
+{
+    auto cannotOpen = [&]
+    {
+        return unexpected( std::string( "Cannot open file for reading " ) + utf8string( file ) );
+    };
+
+    MappedFile res;
+#ifdef _WIN32
+    HANDLE f = CreateFileW( file.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if ( f == INVALID_HANDLE_VALUE )
+        return cannotOpen();
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( f, &size ) )
+    {
+        CloseHandle( f );
+        return cannotOpen();
+    }
+    if ( size.QuadPart == 0 )
+    {
+        CloseHandle( f );
+        return res;
+    }
+    res.mapping_ = CreateFileMappingW( f, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    CloseHandle( f ); // the mapping object keeps the file open
+    if ( !res.mapping_ )
+        return unexpected( std::string( "Cannot map file in memory " ) + utf8string( file ) );
+    res.data_ = (const char*)MapViewOfFile( res.mapping_, FILE_MAP_READ, 0, 0, 0 );
+    if ( !res.data_ )
+        return unexpected( std::string( "Cannot map file in memory " ) + utf8string( file ) );
+    res.size_ = size_t( size.QuadPart );
+#else
+    const int fd = ::open( file.c_str(), O_RDONLY );
+    if ( fd < 0 )
+        return cannotOpen();
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 )
+    {
+        ::close( fd );
+        return cannotOpen();
+    }
+    if ( st.st_size == 0 )
+    {
+        ::close( fd );
+        return res;
+    }
+    void * ptr = mmap( nullptr, size_t( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd ); // the mapping keeps the file open
+    if ( ptr == MAP_FAILED )
+        return unexpected( std::string( "Cannot map file in memory " ) + utf8string( file ) );
+    res.data_ = (const char*)ptr;
+    res.size_ = size_t( st.st_size );
+#endif
+    return res;
+}
+
+} //namespace MR
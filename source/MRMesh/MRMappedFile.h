@@ -0,0 +1,46 @@
+#pragma once
+
+#include "MRMeshFwd.h"
+#include "MRExpected.h"
+#include <filesystem>
+
+namespace MR
+{
+
+/// \brief read-only memory mapping of whole file
+/// \details the pages of the file are loaded by the operating system lazily on first access to them,
+/// and they are shared with the file system cache rather than copied in process memory
+/// \ingroup IOGroup
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MRMESH_API MappedFile( MappedFile && b ) noexcept;
+    MRMESH_API MappedFile & operator =( MappedFile && b ) noexcept;
+    MappedFile( const MappedFile & ) = delete;
+    MappedFile & operator =( const MappedFile & ) = delete;
+    MRMESH_API ~MappedFile();
+
+    /// maps given file in memory for reading
+    [[nodiscard]] MRMESH_API static Expected<MappedFile> open( const std::filesystem::path & file );
+
+    /// returns the pointer on the first byte of mapped file, or nullptr if the file is empty
+    [[nodiscard]] const char * data() const { return data_; }
+
+    /// returns the size of mapped file in bytes
+    [[nodiscard]] size_t size() const { return size_; }
+
+    /// returns true if no file is mapped or it is empty
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+private:
+    void close_();
+
+    const char * data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void * mapping_ = nullptr; // HANDLE of file mapping object
+#endif
+};
+
+} //namespace MR
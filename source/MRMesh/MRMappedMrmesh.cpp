@@ -0,0 +1,142 @@
+#include "MRMappedMrmesh.h"
+#include "MRMesh.h"
+#include "MRMeshSave.h"
+#include "MRMakeSphereMesh.h"
+#include "MRParallelFor.h"
+#include "MRUniqueTemporaryFolder.h"
+#include "MRStringConvert.h"
+#include "MRTimer.h"
+#include "MRGTest.h"
+#include <cstring>
+
+namespace MR
+{
+
+Expected<MappedMrmesh> MappedMrmesh::open( const std::filesystem::path & file )
+{
+    MR_TIMER;
+    auto mapped = MappedFile::open( file );
+    if ( !mapped )
+        return unexpected( std::move( mapped.error() ) );
+
+    MappedMrmesh res;
+    res.file_ = std::move( *mapped );
+    const char * const data = res.file_.data();
+    const size_t fileSize = res.file_.size();
+
+    // reads the number of elements in next array and returns the pointer on its first element
+    size_t pos = 0;
+    auto readArray = [&]( size_t elemSize, size_t & num ) -> const char *
+    {
+        std::uint32_t n = 0;
+        if ( pos + sizeof( n ) > fileSize )
+            return nullptr;
+        std::memcpy( &n, data + pos, sizeof( n ) );
+        pos += sizeof( n );
+        if ( pos + n * elemSize > fileSize )
+            return nullptr;
+        num = n;
+        const char * arr = data + pos;
+        pos += n * elemSize;
+        return arr;
+    };
+    auto tooShort = [&]
+    {
+        return unexpected( "Error reading mrmesh-file: file is too short\n" + utf8string( file ) );
+    };
+
+    const char * p = readArray( sizeof( HalfEdge ), res.numEdges_ );
+    if ( !p )
+        return tooShort();
+    res.edges_ = reinterpret_cast<const HalfEdge*>( p );
+
+    if ( !( p = readArray( sizeof( EdgeId ), res.numVerts_ ) ) )
+        return tooShort();
+    res.edgePerVertex_ = reinterpret_cast<const EdgeId*>( p );
+
+    if ( !( p = readArray( sizeof( EdgeId ), res.numFaces_ ) ) )
+        return tooShort();
+    res.edgePerFace_ = reinterpret_cast<const EdgeId*>( p );
+
+    if ( !( p = readArray( sizeof( Vector3f ), res.numPoints_ ) ) )
+        return tooShort();
+    res.points_ = reinterpret_cast<const Vector3f*>( p );
+
+    return res;
+}
+
+Expected<Mesh> MappedMrmesh::toMesh( ProgressCallback cb ) const
+{
+    MR_TIMER;
+    Mesh mesh;
+    auto & topology = mesh.topology;
+    topology.updateValids_ = false;
+
+    topology.edges_.resizeNoInit( numEdges_ );
+    if ( !ParallelFor( topology.edges_, [&]( EdgeId e )
+    {
+        const auto & src = edges_[e];
+        auto & tgt = topology.edges_[e];
+        tgt.next = src.next;
+        tgt.prev = src.prev;
+        tgt.org = src.org;
+        tgt.left = src.left;
+    }, subprogress( cb, 0.0f, 0.4f ) ) )
+        return unexpectedOperationCanceled();
+
+    topology.edgePerVertex_.resizeNoInit( numVerts_ );
+    if ( !ParallelFor( topology.edgePerVertex_, [&]( VertId v )
+    {
+        topology.edgePerVertex_[v] = edgePerVertex_[v];
+    }, subprogress( cb, 0.4f, 0.5f ) ) )
+        return unexpectedOperationCanceled();
+
+    topology.edgePerFace_.resizeNoInit( numFaces_ );
+    if ( !ParallelFor( topology.edgePerFace_, [&]( FaceId f )
+    {
+        topology.edgePerFace_[f] = edgePerFace_[f];
+    }, subprogress( cb, 0.5f, 0.6f ) ) )
+        return unexpectedOperationCanceled();
+
+    mesh.points.resizeNoInit( numPoints_ );
+    if ( !ParallelFor( mesh.points, [&]( VertId v )
+    {
+        mesh.points[v] = points_[v];
+    }, subprogress( cb, 0.6f, 0.7f ) ) )
+        return unexpectedOperationCanceled();
+
+    if ( !topology.computeValidsFromEdges( subprogress( cb, 0.7f, 0.8f ) ) )
+        return unexpectedOperationCanceled();
+    if ( !topology.checkValidity( subprogress( cb, 0.8f, 1.0f ) ) )
+        return unexpected( std::string( "Error reading topology from mrmesh - file:\nData is invalid" ) );
+
+    return mesh;
+}
+
+TEST( MRMesh, MappedMrmesh )
+{
+    UniqueTemporaryFolder folder( {} );
+    const auto path = folder / "sphere.mrmesh";
+    const Mesh sphere = makeUVSphere( 1, 8, 8 );
+    ASSERT_TRUE( MeshSave::toMrmesh( sphere, path ).has_value() );
+
+    auto mapped = MappedMrmesh::open( path );
+    ASSERT_TRUE( mapped.has_value() );
+    EXPECT_EQ( mapped->edgeSize(), sphere.topology.edgeSize() );
+    EXPECT_EQ( mapped->vertSize(), sphere.topology.vertSize() );
+    EXPECT_EQ( mapped->faceSize(), sphere.topology.faceSize() );
+    for ( auto f : sphere.topology.getValidFaces() )
+        EXPECT_EQ( mapped->getTriVerts( f ), sphere.topology.getTriVerts( f ) );
+    for ( auto v : sphere.topology.getValidVerts() )
+        EXPECT_EQ( mapped->point( v ), sphere.points[v] );
+
+    auto mesh = mapped->toMesh();
+    ASSERT_TRUE( mesh.has_value() );
+    EXPECT_EQ( *mesh, sphere );
+
+    // truncated file
+    std::filesystem::resize_file( path, std::filesystem::file_size( path ) - 1 );
+    EXPECT_FALSE( MappedMrmesh::open( path ).has_value() );
+}
+
+} //namespace MR
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "MRMappedFile.h"
+#include "MRId.h"
+#include "MRVector3.h"
+#include "MRProgressCallback.h"
+#include <array>
+#include <cassert>
+
+namespace MR
+{
+
+/// \brief read-only view of .mrmesh file mapped in memory
+/// \details opening takes constant time independently of the mesh size: only array sizes are read and validated,
+/// and all other pages are loaded by the operating system on first access;
+/// .mrmesh format stores 4-byte values only, so all arrays in the mapping are naturally aligned and accessed in place;
+/// the view is immutable, call toMesh() to get usual mesh for modification or for algorithms requiring Mesh
+/// \ingroup IOGroup
+class MappedMrmesh
+{
+public:
+    /// half-edge record exactly as stored in .mrmesh file
+    struct HalfEdge
+    {
+        EdgeId next; ///< next counter clock wise half-edge in the origin ring
+        EdgeId prev; ///< next clock wise half-edge in the origin ring
+        VertId org;  ///< vertex at the origin of the edge
+        FaceId left; ///< face at the left of the edge
+    };
+    static_assert( sizeof( HalfEdge ) == 16 );
+
+    MappedMrmesh() = default;
+
+    /// maps given .mrmesh file in memory and checks that it has enough size for all stored arrays
+    [[nodiscard]] MRMESH_API static Expected<MappedMrmesh> open( const std::filesystem::path & file );
+
+    /// returns the number of half-edge records including lone ones
+    [[nodiscard]] size_t edgeSize() const { return numEdges_; }
+
+    /// returns the number of vertex records including invalid ones
+    [[nodiscard]] size_t vertSize() const { return numVerts_; }
+
+    /// returns the number of face records including invalid ones
+    [[nodiscard]] size_t faceSize() const { return numFaces_; }
+
+    /// returns the number of stored points
+    [[nodiscard]] size_t pointsSize() const { return numPoints_; }
+
+    /// returns stored record of given half-edge
+    [[nodiscard]] const HalfEdge & edge( EdgeId e ) const { assert( e.valid() && e < (int)numEdges_ ); return edges_[e]; }
+
+    [[nodiscard]] EdgeId next( EdgeId e ) const { return edge( e ).next; }
+    [[nodiscard]] EdgeId prev( EdgeId e ) const { return edge( e ).prev; }
+    [[nodiscard]] VertId org( EdgeId e ) const { return edge( e ).org; }
+    [[nodiscard]] VertId dest( EdgeId e ) const { return edge( e.sym() ).org; }
+    [[nodiscard]] FaceId left( EdgeId e ) const { return edge( e ).left; }
+    [[nodiscard]] FaceId right( EdgeId e ) const { return edge( e.sym() ).left; }
+
+    /// returns valid edge if given vertex is present in the mesh
+    [[nodiscard]] EdgeId edgeWithOrg( VertId v ) const { assert( v.valid() ); return v < (int)numVerts_ ? edgePerVertex_[v] : EdgeId(); }
+
+    /// returns valid edge if given face is present in the mesh
+    [[nodiscard]] EdgeId edgeWithLeft( FaceId f ) const { assert( f.valid() ); return f < (int)numFaces_ ? edgePerFace_[f] : EdgeId(); }
+
+    /// returns true if given vertex is present in the mesh
+    [[nodiscard]] bool hasVert( VertId v ) const { return edgeWithOrg( v ).valid(); }
+
+    /// returns true if given face is present in the mesh
+    [[nodiscard]] bool hasFace( FaceId f ) const { return edgeWithLeft( f ).valid(); }
+
+    /// returns three vertices of given triangular face in counter-clockwise order if look from mesh outside
+    [[nodiscard]] ThreeVertIds getTriVerts( FaceId f ) const
+    {
+        const auto a = edgeWithLeft( f );
+        const auto b = prev( a.sym() );
+        const auto c = prev( b.sym() );
+        assert( a == prev( c.sym() ) );
+        return { org( a ), org( b ), org( c ) };
+    }
+
+    /// returns the coordinates of given point
+    [[nodiscard]] const Vector3f & point( VertId v ) const { assert( v.valid() && v < (int)numPoints_ ); return points_[v]; }
+
+    /// makes usual mesh by copying all data from the mapping;
+    /// the data is validated in the same way as on reading .mrmesh from a stream
+    [[nodiscard]] MRMESH_API Expected<Mesh> toMesh( ProgressCallback cb = {} ) const;
+
+private:
+    MappedFile file_;
+    const HalfEdge * edges_ = nullptr;
+    const EdgeId * edgePerVertex_ = nullptr;
+    const EdgeId * edgePerFace_ = nullptr;
+    const Vector3f * points_ = nullptr;
+    size_t numEdges_ = 0;
+    size_t numVerts_ = 0;
+    size_t numFaces_ = 0;
+    size_t numPoints_ = 0;
+};
+
+} //namespace MR
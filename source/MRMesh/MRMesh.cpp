@@ -1,6 +1,7 @@
 #include "MRMesh.h"
 #include "MRAABBTree.h"
 #include "MRAABBTreePoints.h"
+#include "MRAABBTreeWide.h"
 #include "MRAffineXf3.h"
 #include "MRBitSet.h"
 #include "MRBitSetParallelFor.h"
@@ -506,10 +507,13 @@ Expected<PackMapping> Mesh::packOptimally( bool preserveAABBTree, ProgressCallba
                     map.f.b[f] = FaceId{};
         }
         AABBTreeOwner_.update( [&map]( AABBTree& t ) { t.getLeafOrderAndReset( map.f ); } );
+        AABBTreeWideOwner_.update( [this]( AABBTreeWide& t ) { t = AABBTreeWide( getAABBTree() ); } );
     }
     else
     {
         AABBTreeOwner_.reset();
+        outdatedAABBTreeOwner_.reset();
+        AABBTreeWideOwner_.reset();
         map.f = getOptimalFaceOrdering( *this );
     }
     if ( !reportProgress( cb, 0.3f ) )
@@ -534,7 +538,7 @@ void Mesh::deleteFaces( const FaceBitSet & fs, const UndirectedEdgeBitSet * keep
     if ( fs.none() )
         return;
     topology.deleteFaces( fs, keepEdges );
-    invalidateCaches(); // some points can be deleted as well
+    invalidateCaches( fs ); // some points can be deleted as well
 }
 
 bool Mesh::projectPoint( const Vector3f& point, PointOnFace& res, float maxDistSq, const FaceBitSet * region, const AffineXf3f * xf ) const
@@ -568,7 +572,29 @@ std::optional<MeshProjectionResult> Mesh::projectPoint( const Vector3f& point, f
 
 const AABBTree & Mesh::getAABBTree() const
 {
-    const auto & res = AABBTreeOwner_.getOrCreate( [this]{ return AABBTree( *this ); } );
+    const auto & res = AABBTreeOwner_.getOrCreate( [this]
+    {
+        // the creator is called in one thread only, so the outdated tree can be updated here
+        std::optional<AABBTree> updated;
+        outdatedAABBTreeOwner_.update( [&]( AABBTree & tree )
+        {
+            // the number of leaves differs if some faces were deleted without notification, e.g. directly in topology
+            if ( tree.update( *this, outdatedTreeChangedFaces_ ) && tree.numLeaves() == topology.numValidFaces() )
+                updated = std::move( tree );
+        } );
+        outdatedAABBTreeOwner_.reset();
+        return updated ? std::move( *updated ) : AABBTree( *this );
+    } );
+    assert( res.numLeaves() == topology.numValidFaces() );
+    return res;
+}
+
+const AABBTreeWide & Mesh::getAABBTreeWide() const
+{
+    if ( auto pRes = AABBTreeWideOwner_.get() )
+        return *pRes; // fast path without tree access
+    const auto & tree = getAABBTree(); // must be ready before lambda body for single-threaded Emscripten
+    const auto & res = AABBTreeWideOwner_.getOrCreate( [&tree] { return AABBTreeWide( tree ); } );
     assert( res.numLeaves() == topology.numValidFaces() );
     return res;
 }
@@ -596,6 +622,36 @@ const Dipoles & Mesh::getDipoles() const
 void Mesh::invalidateCaches( bool pointsChanged )
 {
     AABBTreeOwner_.reset();
+    outdatedAABBTreeOwner_.reset();
+    AABBTreeWideOwner_.reset();
+    if ( pointsChanged )
+        AABBTreePointsOwner_.reset();
+    dipolesOwner_.reset();
+}
+
+void Mesh::invalidateCaches( const FaceBitSet & changedFaces, bool pointsChanged )
+{
+    if ( AABBTreeOwner_.get() )
+    {
+        // the valid tree becomes outdated and will be updated lazily;
+        // it is shared with other meshes (if any) and will be copied on update then
+        outdatedAABBTreeOwner_ = AABBTreeOwner_;
+        outdatedTreeChangedFaces_ = changedFaces;
+        outdatedTreeNumChanged_ = 0;
+    }
+    else if ( outdatedAABBTreeOwner_.get() )
+        outdatedTreeChangedFaces_ |= changedFaces;
+    AABBTreeOwner_.reset();
+
+    if ( outdatedAABBTreeOwner_.get() )
+    {
+        // incremental update is slower than full rebuild if many faces are changed
+        constexpr size_t cMaxChangedFacesFraction = 8;
+        outdatedTreeNumChanged_ += changedFaces.count();
+        if ( outdatedTreeNumChanged_ * cMaxChangedFacesFraction > size_t( topology.numValidFaces() ) )
+            outdatedAABBTreeOwner_.reset();
+    }
+    AABBTreeWideOwner_.reset();
     if ( pointsChanged )
         AABBTreePointsOwner_.reset();
     dipolesOwner_.reset();
@@ -603,11 +659,17 @@ void Mesh::invalidateCaches( bool pointsChanged )
 
 void Mesh::updateCaches( const VertBitSet & changedVerts )
 {
+    outdatedAABBTreeOwner_.reset(); // the faces around changed vertices are not tracked
     AABBTreeOwner_.update( [&]( AABBTree & tree )
     {
         assert( tree.numLeaves() == topology.numValidFaces() );
         tree.refit( *this, changedVerts );
     } );
+    // quantized boxes cannot be refitted locally, so the wide tree is rebuilt from refitted usual tree
+    AABBTreeWideOwner_.update( [&]( AABBTreeWide & tree )
+    {
+        tree = AABBTreeWide( getAABBTree() );
+    } );
     AABBTreePointsOwner_.update( [&]( AABBTreePoints & tree )
     {
         assert( tree.orderedPoints().size() == topology.numValidVerts() );
@@ -621,8 +683,11 @@ size_t Mesh::heapBytes() const
     return topology.heapBytes()
         + points.heapBytes()
         + AABBTreeOwner_.heapBytes()
+        + AABBTreeWideOwner_.heapBytes()
         + AABBTreePointsOwner_.heapBytes()
-        + dipolesOwner_.heapBytes();
+        + dipolesOwner_.heapBytes()
+        + outdatedAABBTreeOwner_.heapBytes()
+        + outdatedTreeChangedFaces_.heapBytes();
 }
 
 void Mesh::shrinkToFit()
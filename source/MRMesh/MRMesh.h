@@ -463,9 +463,16 @@ struct [[nodiscard]] Mesh
     /// returns cached aabb-tree for this mesh, creating it if it did not exist in a thread-safe manner
     MRMESH_API const AABBTree & getAABBTree() const;
 
-    /// returns cached aabb-tree for this mesh, but does not create it if it did not exist
+    /// returns cached aabb-tree for this mesh, but does not create it if it did not exist (or was not updated after invalidateCaches( changedFaces ))
     [[nodiscard]] const AABBTree * getAABBTreeNotCreate() const { return AABBTreeOwner_.get(); }
 
+    /// returns cached wide aabb-tree for this mesh, creating it (and usual aabb-tree) if it did not exist in a thread-safe manner;
+    /// the wide tree is used only by the functions receiving it explicitly (findProjectionSubtree, findProjections, rayMeshIntersect)
+    MRMESH_API const AABBTreeWide & getAABBTreeWide() const;
+
+    /// returns cached wide aabb-tree for this mesh, but does not create it if it did not exist
+    [[nodiscard]] const AABBTreeWide * getAABBTreeWideNotCreate() const { return AABBTreeWideOwner_.get(); }
+
     /// returns cached aabb-tree for points of this mesh, creating it if it did not exist in a thread-safe manner
     MRMESH_API const AABBTreePoints & getAABBTreePoints() const;
 
@@ -482,6 +489,15 @@ struct [[nodiscard]] Mesh
     /// \param pointsChanged specifies whether points have changed (otherwise only topology has changed)
     MRMESH_API void invalidateCaches( bool pointsChanged = true );
 
+    /// invalidates caches after a local change of mesh topology or geometry, but keeps aabb-tree aside to update it incrementally
+    /// on next getAABBTree() call instead of full rebuild, if the total number of faces changed since the tree was valid is small
+    /// and the quality of the tree after the update is good enough (see AABBTree::update);
+    /// the changes of many calls are accumulated and applied at once, so the cost of each call is small;
+    /// deleteFaces, fillHole, subdivideMesh and cutMesh call it themselves
+    /// \param changedFaces all faces that were deleted, added or got other vertices or vertex coordinates
+    /// \param pointsChanged specifies whether points have changed (otherwise only topology has changed)
+    MRMESH_API void invalidateCaches( const FaceBitSet & changedFaces, bool pointsChanged = true );
+
     /// updates existing caches in case of few vertices were changed insignificantly,
     /// and topology remained unchanged;
     /// it shall be considered as a faster alternative to invalidateCaches() and following rebuild of trees
@@ -498,8 +514,15 @@ struct [[nodiscard]] Mesh
 
 private:
     mutable SharedThreadSafeOwner<AABBTree> AABBTreeOwner_;
+    mutable SharedThreadSafeOwner<AABBTreeWide> AABBTreeWideOwner_;
     mutable SharedThreadSafeOwner<AABBTreePoints> AABBTreePointsOwner_;
     mutable SharedThreadSafeOwner<Dipoles> dipolesOwner_;
+
+    /// aabb-tree before local changes of the mesh, which will be updated in getAABBTree() instead of full rebuild
+    mutable SharedThreadSafeOwner<AABBTree> outdatedAABBTreeOwner_;
+    /// all faces changed since outdatedAABBTreeOwner_ was valid, and their total number (possibly with repetitions)
+    FaceBitSet outdatedTreeChangedFaces_;
+    size_t outdatedTreeNumChanged_ = 0;
 };
 
 } //namespace MR
@@ -326,6 +326,9 @@ BooleanResult booleanImpl( Mesh&& meshA, Mesh&& meshB, BooleanOperation operatio
             CutMeshParameters cmParams;
             cmParams.sortData = dataForA.get();
             cmParams.new2OldMap = cut2oldAPtr;
+            // cutMesh updates aabb-tree of the mesh, which is needed only if there is no original mesh for inside tests
+            if ( intParams.originalMeshA )
+                meshA.invalidateCaches();
             auto res = cutMesh( meshA, meshAContours, cmParams );
             meshAContours.clear();
             meshAContours.shrink_to_fit(); // free memory
@@ -358,6 +361,9 @@ BooleanResult booleanImpl( Mesh&& meshA, Mesh&& meshB, BooleanOperation operatio
         CutMeshParameters cmParams;
         cmParams.sortData = dataForB.get();
         cmParams.new2OldMap = cut2oldBPtr;
+        // cutMesh updates aabb-tree of the mesh, which is needed only if there is no original mesh for inside tests
+        if ( intParams.originalMeshB )
+            meshB.invalidateCaches();
         auto res = cutMesh( meshB, meshBContours, cmParams );
         meshBContours.clear();
         meshBContours.shrink_to_fit(); // free memory
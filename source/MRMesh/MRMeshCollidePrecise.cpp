@@ -4,13 +4,141 @@
 #include "MRPrecisePredicates3.h"
 #include "MRFaceFace.h"
 #include "MRTimer.h"
+#include "MRBitSetParallelFor.h"
+#include "MRRegionBoundary.h"
 #include "MRPch/MRTBB.h"
 #include "MRProcessSelfTreeSubtasks.h"
+#include "MREdgeIterator.h"
+#include "MRTorus.h"
+#include "MRGTest.h"
+#include <algorithm>
 #include <array>
 
 namespace MR
 {
 
+namespace
+{
+
+/// converts the coordinates of all vertices of mesh part in integers only once before checking many triangle pairs
+Vector<Vector3i, VertId> convertToInt( const MeshPart & mp, const ConvertToIntVector & conv, const AffineXf3f * xf )
+{
+    MR_TIMER;
+    Vector<Vector3i, VertId> res( mp.mesh.topology.vertSize() );
+    VertBitSet store;
+    BitSetParallelFor( getIncidentVerts( mp.mesh.topology, mp.region, store ), [&]( VertId v )
+    {
+        const auto p = mp.mesh.points[v];
+        res[v] = conv( xf ? ( *xf )( p ) : p );
+    } );
+    return res;
+}
+
+/// a pair of triangles to check for intersections of the edges of each triangle with the other triangle
+struct TriPair
+{
+    FaceId aTri, bTri;
+    std::array<PreciseVertCoords, 3> avc, bvc;
+    /// aEdges[i] connects avc[i] and avc[(i+1)%3], it is invalid if the edge shall not be checked
+    std::array<EdgeId, 3> aEdges, bEdges;
+};
+
+/// accumulates pairs of triangles and checks them together:
+/// first the positions of all vertices relative to the plane of the other triangle in each pair are found
+/// by floating-point filter in a loop vectorized by the compiler, and then exact predicates are evaluated
+/// only for uncertain positions and for the edges crossing the plane of the other triangle
+class TriPairsBatch
+{
+public:
+    static constexpr int cMaxSize = 64;
+
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+    [[nodiscard]] bool full() const { return size_ == cMaxSize; }
+
+    /// returns next pair to be filled by the caller
+    [[nodiscard]] TriPair & add() { assert( !full() ); return pairs_[size_++]; }
+
+    /// checks all accumulated pairs, appends found intersections in given vectors (which can be the same) and clears the batch
+    void flush( std::vector<EdgeTri> & edgesAtrisB, std::vector<EdgeTri> & edgesBtrisA );
+
+private:
+    /// stores the vectors from point d to the vertices of triangle tri
+    void setFilterInput_( int k, const std::array<PreciseVertCoords, 3> & tri, const Vector3i & d );
+
+    /// checks the edges from verts with the given signs of vertices' orientations relative to the triangle tri
+    static void checkEdges_( const std::array<PreciseVertCoords, 3> & tri, FaceId triId,
+        const std::array<PreciseVertCoords, 3> & verts, const std::array<EdgeId, 3> & edges,
+        const signed char * sides, std::vector<EdgeTri> & res );
+
+    std::array<TriPair, cMaxSize> pairs_;
+    int size_ = 0;
+
+    // the input of floating-point filter in structure-of-arrays layout, 6 orientations per pair
+    static constexpr int cMaxOrients = 6 * cMaxSize;
+    std::array<double, cMaxOrients> ax_, ay_, az_, bx_, by_, bz_, cx_, cy_, cz_;
+    std::array<signed char, cMaxOrients> sides_;
+};
+
+void TriPairsBatch::setFilterInput_( int k, const std::array<PreciseVertCoords, 3> & tri, const Vector3i & d )
+{
+    const auto a = tri[0].pt - d, b = tri[1].pt - d, c = tri[2].pt - d;
+    ax_[k] = a.x; ay_[k] = a.y; az_[k] = a.z;
+    bx_[k] = b.x; by_[k] = b.y; bz_[k] = b.z;
+    cx_[k] = c.x; cy_[k] = c.y; cz_[k] = c.z;
+}
+
+void TriPairsBatch::checkEdges_( const std::array<PreciseVertCoords, 3> & tri, FaceId triId,
+    const std::array<PreciseVertCoords, 3> & verts, const std::array<EdgeId, 3> & edges,
+    const signed char * sides, std::vector<EdgeTri> & res )
+{
+    bool left[3] = { false, false, false };
+    for ( int j = 0; j < 3; ++j )
+    {
+        if ( !edges[j] && !edges[( j + 2 ) % 3] )
+            continue; // the vertex is not needed
+        // exact predicate is evaluated only if the filter was not certain
+        left[j] = sides[j] ? sides[j] > 0 : orient3d( { tri[0], tri[1], tri[2], verts[j] } );
+    }
+    for ( int j = 0; j < 3; ++j )
+    {
+        const auto e = edges[j];
+        if ( !e )
+            continue;
+        const int j1 = ( j + 1 ) % 3;
+        if ( left[j] == left[j1] )
+            continue; // the edge is located at one side of the triangle's plane
+        if ( doTriangleSegmentIntersectCrossingPlane( { tri[0], tri[1], tri[2], verts[j], verts[j1] } ) )
+            res.emplace_back( left[j] ? e : e.sym(), triId );
+    }
+}
+
+void TriPairsBatch::flush( std::vector<EdgeTri> & edgesAtrisB, std::vector<EdgeTri> & edgesBtrisA )
+{
+    for ( int i = 0; i < size_; ++i )
+    {
+        const auto & p = pairs_[i];
+        for ( int j = 0; j < 3; ++j )
+        {
+            setFilterInput_( 6 * i + j, p.bvc, p.avc[j].pt );
+            setFilterInput_( 6 * i + 3 + j, p.avc, p.bvc[j].pt );
+        }
+    }
+
+    const int numOrients = 6 * size_;
+    for ( int k = 0; k < numOrients; ++k )
+        sides_[k] = (signed char)orient3dFilter( { ax_[k], ay_[k], az_[k] }, { bx_[k], by_[k], bz_[k] }, { cx_[k], cy_[k], cz_[k] } );
+
+    for ( int i = 0; i < size_; ++i )
+    {
+        const auto & p = pairs_[i];
+        checkEdges_( p.bvc, p.bTri, p.avc, p.aEdges, sides_.data() + 6 * i, edgesAtrisB );
+        checkEdges_( p.avc, p.aTri, p.bvc, p.bEdges, sides_.data() + 6 * i + 3, edgesBtrisA );
+    }
+    size_ = 0;
+}
+
+} //anonymous namespace
+
 PreciseCollisionResult findCollidingEdgeTrisPrecise( const MeshPart & a, const MeshPart & b, 
     ConvertToIntVector conv, const AffineXf3f * rigidB2A, bool anyIntersection )
 {
@@ -87,74 +215,30 @@ PreciseCollisionResult findCollidingEdgeTrisPrecise( const MeshPart & a, const M
     };
 
     const int aVertsSize = (int)a.mesh.topology.vertSize();
-    auto checkTwoTris = [&]( FaceId aTri, FaceId bTri, PreciseCollisionResult & res )
+    const auto aCoords = convertToInt( a, conv, nullptr );
+    const auto bCoords = convertToInt( b, conv, rigidB2A );
+    auto addTwoTris = [&]( FaceId aTri, FaceId bTri, TriPairsBatch & batch )
     {
-        PreciseVertCoords avc[3], bvc[3];
-        a.mesh.topology.getTriVerts( aTri, avc[0].id, avc[1].id, avc[2].id );
-        b.mesh.topology.getTriVerts( bTri, bvc[0].id, bvc[1].id, bvc[2].id );
-
+        auto & p = batch.add();
+        p.aTri = aTri;
+        p.bTri = bTri;
+        a.mesh.topology.getTriVerts( aTri, p.avc[0].id, p.avc[1].id, p.avc[2].id );
+        b.mesh.topology.getTriVerts( bTri, p.bvc[0].id, p.bvc[1].id, p.bvc[2].id );
         for ( int j = 0; j < 3; ++j )
         {
-            avc[j].pt = conv( a.mesh.points[avc[j].id] );
-            const auto bf = b.mesh.points[bvc[j].id];
-            bvc[j].pt = conv( rigidB2A ? (*rigidB2A)( bf ) : bf );
-            bvc[j].id += aVertsSize;
+            p.avc[j].pt = aCoords[p.avc[j].id];
+            p.bvc[j].pt = bCoords[p.bvc[j].id];
+            p.bvc[j].id += aVertsSize;
         }
 
-        // check edges from A
-        int numA = 0;
         EdgeId aEdge = a.mesh.topology.edgeWithLeft( aTri );
-        auto aEdgeCheck = [&]( int v0, int v1 )
-        {
-            if ( !checkEdge( aEdge, a ) )
-                return EdgeId{};
-            auto isect = doTriangleSegmentIntersect( { bvc[0], bvc[1], bvc[2], avc[v0], avc[v1] } );
-            if ( !isect )
-                return EdgeId{};
-            return isect.dIsLeftFromABC ? aEdge : aEdge.sym();
-        };
-        if ( auto e = aEdgeCheck( 0, 1 ) )
-        {
-            res.edgesAtrisB.emplace_back( e, bTri );
-        }
-        aEdge = a.mesh.topology.prev( aEdge.sym() );
-        if ( auto e = aEdgeCheck( 1, 2 ) )
-        {
-            res.edgesAtrisB.emplace_back( e, bTri );
-        }
-        aEdge = a.mesh.topology.prev( aEdge.sym() );
-        if ( numA < 2 )
-        {
-            if ( auto e = aEdgeCheck( 2, 0 ) )
-                res.edgesAtrisB.emplace_back( e, bTri );
-        }
-
-        // check edges from B
-        int numB = 0;
         EdgeId bEdge = b.mesh.topology.edgeWithLeft( bTri );
-        auto bEdgeCheck = [&]( int v0, int v1 )
-        {
-            if ( !checkEdge( bEdge, b ) )
-                return EdgeId{};
-            auto isect = doTriangleSegmentIntersect( { avc[0], avc[1], avc[2], bvc[v0], bvc[v1] } );
-            if ( !isect )
-                return EdgeId{};
-            return isect.dIsLeftFromABC ? bEdge : bEdge.sym();
-        };
-        if ( auto e = bEdgeCheck( 0, 1 ) )
-        {
-            res.edgesBtrisA.emplace_back( e, aTri );
-        }
-        bEdge = b.mesh.topology.prev( bEdge.sym() );
-        if ( auto e = bEdgeCheck( 1, 2 ) )
-        {
-            res.edgesBtrisA.emplace_back( e, aTri );
-        }
-        bEdge = b.mesh.topology.prev( bEdge.sym() );
-        if ( numB < 2 )
+        for ( int j = 0; j < 3; ++j )
         {
-            if ( auto e = bEdgeCheck( 2, 0 ) )
-                res.edgesBtrisA.emplace_back( e, aTri );
+            p.aEdges[j] = checkEdge( aEdge, a ) ? aEdge : EdgeId{};
+            aEdge = a.mesh.topology.prev( aEdge.sym() );
+            p.bEdges[j] = checkEdge( bEdge, b ) ? bEdge : EdgeId{};
+            bEdge = b.mesh.topology.prev( bEdge.sym() );
         }
     };
 
@@ -164,6 +248,7 @@ PreciseCollisionResult findCollidingEdgeTrisPrecise( const MeshPart & a, const M
         [&]( const tbb::blocked_range<size_t>& range )
     {
         std::vector<NodeNode> mySubtasks;
+        TriPairsBatch batch;
         for ( auto is = range.begin(); is < range.end(); ++is )
         {
             mySubtasks.push_back( subtasks[is] );
@@ -192,7 +277,10 @@ PreciseCollisionResult findCollidingEdgeTrisPrecise( const MeshPart & a, const M
                     const auto bFace = bNode.leafId();
                     if ( b.region && !b.region->test( bFace ) )
                         continue;
-                    checkTwoTris( aFace, bFace, myRes );
+                    addTwoTris( aFace, bFace, batch );
+                    if ( !batch.full() )
+                        continue;
+                    batch.flush( myRes.edgesAtrisB, myRes.edgesBtrisA );
                     if ( anyIntersection && ( !myRes.edgesAtrisB.empty() || !myRes.edgesBtrisA.empty() ) )
                     {
                         anyIntersectionAtm.store( true, std::memory_order_relaxed );
@@ -215,6 +303,12 @@ PreciseCollisionResult findCollidingEdgeTrisPrecise( const MeshPart & a, const M
                     mySubtasks.push_back( { s.aNode, bNode.r } );
                 }
             }
+            if ( !batch.empty() )
+            {
+                batch.flush( myRes.edgesAtrisB, myRes.edgesBtrisA );
+                if ( anyIntersection && ( !myRes.edgesAtrisB.empty() || !myRes.edgesBtrisA.empty() ) )
+                    anyIntersectionAtm.store( true, std::memory_order_relaxed );
+            }
             subtaskRes[is] = std::move( myRes );
         }
     } );
@@ -346,7 +440,7 @@ std::vector<EdgeTri> findCollidingEdgeTrisPrecise(
 }
 
 
-inline std::pair<int, int> sharedPreciseVertCoord( const PreciseVertCoords av[3], const PreciseVertCoords bv[3] )
+inline std::pair<int, int> sharedPreciseVertCoord( const std::array<PreciseVertCoords, 3> & av, const std::array<PreciseVertCoords, 3> & bv )
 {
     for ( int i = 0; i < 3; ++i )
     {
@@ -406,85 +500,35 @@ std::vector<EdgeTri> findSelfCollidingEdgeTrisPrecise( const MeshPart& mp, Conve
         return l < r;
     };
 
-    auto checkTwoTris = [&] ( FaceId lTri, FaceId rTri, std::vector<EdgeTri>& res )
+    const auto coords = convertToInt( mp, conv, rigidB2A );
+    auto addTwoTris = [&] ( FaceId lTri, FaceId rTri, TriPairsBatch & batch )
     {
-        PreciseVertCoords lvc[3], rvc[3];
-        mp.mesh.topology.getTriVerts( lTri, lvc[0].id, lvc[1].id, lvc[2].id );
-        mp.mesh.topology.getTriVerts( rTri, rvc[0].id, rvc[1].id, rvc[2].id );
-
+        auto & p = batch.add();
+        p.aTri = lTri;
+        p.bTri = rTri;
+        mp.mesh.topology.getTriVerts( lTri, p.avc[0].id, p.avc[1].id, p.avc[2].id );
+        mp.mesh.topology.getTriVerts( rTri, p.bvc[0].id, p.bvc[1].id, p.bvc[2].id );
         for ( int j = 0; j < 3; ++j )
         {
-            const auto& lf = mp.mesh.points[lvc[j].id];
-            lvc[j].pt = conv( rigidB2A ? ( *rigidB2A )( lf ) : lf );
-            lvc[j].id += aVertsSize;
-
-            const auto rf = mp.mesh.points[rvc[j].id];
-            rvc[j].pt = conv( rigidB2A ? ( *rigidB2A )( rf ) : rf );
-            rvc[j].id += aVertsSize;
+            p.avc[j].pt = coords[p.avc[j].id];
+            p.avc[j].id += aVertsSize;
+            p.bvc[j].pt = coords[p.bvc[j].id];
+            p.bvc[j].id += aVertsSize;
         }
 
-        auto sharedVerts = sharedPreciseVertCoord( lvc, rvc );
-
-        // check edges from A
-        int numL = 0;
+        // skip edges incident to shared vert
+        const auto sharedVerts = sharedPreciseVertCoord( p.avc, p.bvc );
         EdgeId lEdge = mp.mesh.topology.edgeWithLeft( lTri );
-        auto lEdgeCheck = [&] ( int v0, int v1 )
-        {
-            // skip incident to shared vert
-            if ( sharedVerts.first == v0 || sharedVerts.first == v1 )
-                return EdgeId{};
-            if ( !checkEdge( lEdge ) )
-                return EdgeId{};
-            auto isect = doTriangleSegmentIntersect( { rvc[0], rvc[1], rvc[2], lvc[v0], lvc[v1] } );
-            if ( !isect )
-                return EdgeId{};
-            return isect.dIsLeftFromABC ? lEdge : lEdge.sym();
-        };
-        if ( auto e = lEdgeCheck( 0, 1 ) )
-        {
-            res.emplace_back( e, rTri );
-        }
-        lEdge = mp.mesh.topology.prev( lEdge.sym() );
-        if ( auto e = lEdgeCheck( 1, 2 ) )
-        {
-            res.emplace_back( e, rTri );
-        }
-        lEdge = mp.mesh.topology.prev( lEdge.sym() );
-        if ( numL < 2 )
-        {
-            if ( auto e = lEdgeCheck( 2, 0 ) )
-                res.emplace_back( e, rTri );
-        }
-
-        // check edges from B
-        int numR = 0;
         EdgeId rEdge = mp.mesh.topology.edgeWithLeft( rTri );
-        auto rEdgeCheck = [&] ( int v0, int v1 )
-        {
-            // skip incident to shared vert
-            if ( sharedVerts.second == v0 || sharedVerts.second == v1 )
-                return EdgeId{};
-            if ( !checkEdge( rEdge ) )
-                return EdgeId{};
-            auto isect = doTriangleSegmentIntersect( { lvc[0], lvc[1], lvc[2], rvc[v0], rvc[v1] } );
-            if ( !isect )
-                return EdgeId{};
-            return isect.dIsLeftFromABC ? rEdge : rEdge.sym();
-        };
-        if ( auto e = rEdgeCheck( 0, 1 ) )
-        {
-            res.emplace_back( e, lTri );
-        }
-        rEdge = mp.mesh.topology.prev( rEdge.sym() );
-        if ( auto e = rEdgeCheck( 1, 2 ) )
-        {
-            res.emplace_back( e, lTri );
-        }
-        rEdge = mp.mesh.topology.prev( rEdge.sym() );
-        if ( numR < 2 )
+        for ( int j = 0; j < 3; ++j )
         {
-            if ( auto e = rEdgeCheck( 2, 0 ) )
-                res.emplace_back( e, lTri );
+            const int j1 = ( j + 1 ) % 3;
+            const bool lShared = sharedVerts.first == j || sharedVerts.first == j1;
+            p.aEdges[j] = !lShared && checkEdge( lEdge ) ? lEdge : EdgeId{};
+            lEdge = mp.mesh.topology.prev( lEdge.sym() );
+            const bool rShared = sharedVerts.second == j || sharedVerts.second == j1;
+            p.bEdges[j] = !rShared && checkEdge( rEdge ) ? rEdge : EdgeId{};
+            rEdge = mp.mesh.topology.prev( rEdge.sym() );
         }
     };
 
@@ -494,12 +538,13 @@ std::vector<EdgeTri> findSelfCollidingEdgeTrisPrecise( const MeshPart& mp, Conve
         [&] ( const tbb::blocked_range<size_t>& range )
     {
         std::vector<NodeNode> mySubtasks;
+        TriPairsBatch batch;
         for ( auto is = range.begin(); is < range.end(); ++is )
         {
             mySubtasks.push_back( subtasks[is] );
             std::vector<EdgeTri> myRes;
             processSelfSubtasks( tree, mySubtasks, mySubtasks, 
-                [&tree, &mp, &myRes, &checkTwoTris, anyIntersection, &keepGoing] ( const NodeNode& s )
+                [&tree, &mp, &myRes, &batch, &addTwoTris, anyIntersection, &keepGoing] ( const NodeNode& s )
             {
                 const auto& lNode = tree[s.aNode];
                 const auto& rNode = tree[s.bNode];
@@ -511,7 +556,10 @@ std::vector<EdgeTri> findSelfCollidingEdgeTrisPrecise( const MeshPart& mp, Conve
                     return Processing::Continue;
                 if ( mp.mesh.topology.sharedEdge( lFace, rFace ) )
                     return Processing::Continue;
-                checkTwoTris( lFace, rFace, myRes );
+                addTwoTris( lFace, rFace, batch );
+                if ( !batch.full() )
+                    return Processing::Continue;
+                batch.flush( myRes, myRes );
                 if ( anyIntersection && !myRes.empty() )
                 {
                     keepGoing.store( false, std::memory_order_relaxed );
@@ -520,6 +568,12 @@ std::vector<EdgeTri> findSelfCollidingEdgeTrisPrecise( const MeshPart& mp, Conve
                 return Processing::Continue;
             }, 
             processBoxes );
+            if ( !batch.empty() )
+            {
+                batch.flush( myRes, myRes );
+                if ( anyIntersection && !myRes.empty() )
+                    keepGoing.store( false, std::memory_order_relaxed );
+            }
             subtaskRes[is] = std::move( myRes );
         }
     } );
@@ -552,4 +606,79 @@ CoordinateConverters getVectorConverters( const MeshPart& a, const MeshPart& b,
     return res;
 }
 
+// finds all intersections of the edges of mesh a with the triangles of mesh b by checking every pair
+static std::vector<EdgeTri> findCollidingEdgeTrisBruteForce( const Mesh & a, const Mesh & b, int aVertsSize, const ConvertToIntVector & conv )
+{
+    std::vector<EdgeTri> res;
+    for ( auto ue : undirectedEdges( a.topology ) )
+    {
+        const EdgeId e = ue;
+        std::array<PreciseVertCoords, 5> vs;
+        vs[3] = { a.topology.org( e ), conv( a.orgPnt( e ) ) };
+        vs[4] = { a.topology.dest( e ), conv( a.destPnt( e ) ) };
+        for ( auto f : b.topology.getValidFaces() )
+        {
+            VertId v[3];
+            b.topology.getTriVerts( f, v );
+            for ( int j = 0; j < 3; ++j )
+                vs[j] = { v[j] + aVertsSize, conv( b.points[v[j]] ) };
+            if ( auto isect = doTriangleSegmentIntersect( vs ) )
+                res.emplace_back( isect.dIsLeftFromABC ? e : e.sym(), f );
+        }
+    }
+    return res;
+}
+
+static void sortEdgeTris( std::vector<EdgeTri> & ets )
+{
+    std::sort( ets.begin(), ets.end(), []( const EdgeTri & x, const EdgeTri & y )
+        { return std::tie( x.edge, x.tri ) < std::tie( y.edge, y.tri ); } );
+}
+
+TEST( MRMesh, FindCollidingEdgeTrisPrecise )
+{
+    const auto a = makeTorus( 1.0f, 0.3f, 32, 16 );
+    auto b = makeTorus( 1.0f, 0.3f, 24, 12 );
+    b.transform( AffineXf3f::translation( { 0.37f, 0.21f, 0.13f } ) );
+    const auto conv = getVectorConverters( a, b ).toInt;
+    const int aVertsSize = (int)a.topology.vertSize();
+
+    auto res = findCollidingEdgeTrisPrecise( a, b, conv );
+    auto expAB = findCollidingEdgeTrisBruteForce( a, b, aVertsSize, conv );
+    EXPECT_FALSE( expAB.empty() );
+    sortEdgeTris( res.edgesAtrisB );
+    sortEdgeTris( expAB );
+    EXPECT_TRUE( res.edgesAtrisB == expAB );
+
+    // in the opposite direction, the vertices of b still have shifted ids
+    std::vector<EdgeTri> expBA;
+    for ( auto ue : undirectedEdges( b.topology ) )
+    {
+        const EdgeId e = ue;
+        for ( auto f : a.topology.getValidFaces() )
+        {
+            std::array<PreciseVertCoords, 5> vs;
+            VertId v[3];
+            a.topology.getTriVerts( f, v );
+            for ( int j = 0; j < 3; ++j )
+                vs[j] = { v[j], conv( a.points[v[j]] ) };
+            vs[3] = { b.topology.org( e ) + aVertsSize, conv( b.orgPnt( e ) ) };
+            vs[4] = { b.topology.dest( e ) + aVertsSize, conv( b.destPnt( e ) ) };
+            if ( auto isect = doTriangleSegmentIntersect( vs ) )
+                expBA.emplace_back( isect.dIsLeftFromABC ? e : e.sym(), f );
+        }
+    }
+    sortEdgeTris( res.edgesBtrisA );
+    sortEdgeTris( expBA );
+    EXPECT_TRUE( res.edgesBtrisA == expBA );
+
+    // both tori in one mesh give the same intersections as self-collisions
+    Mesh ab = a;
+    ab.addMesh( b );
+    auto selfRes = findSelfCollidingEdgeTrisPrecise( ab, conv );
+    EXPECT_EQ( selfRes.size(), expAB.size() + expBA.size() );
+    EXPECT_FALSE( findSelfCollidingEdgeTrisPrecise( ab, conv, true ).empty() );
+    EXPECT_TRUE( findSelfCollidingEdgeTrisPrecise( a, conv ).empty() );
+}
+
 } //namespace MR
@@ -5,6 +5,7 @@
 #include "MRRingIterator.h"
 #include "MRBitSetParallelFor.h"
 #include "MRParallelFor.h"
+#include "MRConcurrentUnionFind.h"
 #include "MRRegionBoundary.h"
 #include "MRMeshBuilder.h"
 #include "MREdgeIterator.h"
@@ -454,39 +455,9 @@ static void getUnionFindStructureFacesPerEdge( const MeshPart& meshPart, const U
 
     const auto& mesh = meshPart.mesh;
     const FaceBitSet& region = mesh.topology.getFaceIds( meshPart.region );
-    const FaceBitSet* lastPassFaces = &region;
-    const auto numFaces = region.find_last() + 1;
-    res.reset( numFaces );
-    const auto numThreads = int( tbb::global_control::active_value( tbb::global_control::max_allowed_parallelism ) );
-
-    FaceBitSet bdFaces;
-    if ( numThreads > 1 )
-    {
-        bdFaces.resize( numFaces );
-        lastPassFaces = &bdFaces;
-
-        BitSetParallelForAllRanged( region, [&] ( FaceId f0, const auto & range )
-        {
-            if ( !contains( region, f0 ) )
-                return;
-            EdgeId e[3];
-            mesh.topology.getTriEdges( f0, e );
-            for ( int i = 0; i < 3; ++i )
-            {
-                assert( mesh.topology.left( e[i] ) == f0 );
-                FaceId f1 = mesh.topology.right( e[i] );
-                if ( f0 < f1 && contains( meshPart.region, f1 ) )
-                {
-                    if ( f1 >= range.end )
-                        bdFaces.set( f0 ); // remember the face to unite later in a sequential region
-                    else if ( !isCompBd || !isCompBd( e[i].undirected() ) )
-                        res.unite( f0, f1 ); // our region
-                }
-            }
-        } );
-    }
+    ConcurrentUnionFind<FaceId> unionFind( region.find_last() + 1 );
 
-    for ( auto f0 : *lastPassFaces )
+    BitSetParallelFor( region, [&] ( FaceId f0 )
     {
         EdgeId e[3];
         mesh.topology.getTriEdges( f0, e );
@@ -495,9 +466,10 @@ static void getUnionFindStructureFacesPerEdge( const MeshPart& meshPart, const U
             assert( mesh.topology.left( e[i] ) == f0 );
             FaceId f1 = mesh.topology.right( e[i] );
             if ( f0 < f1 && contains( meshPart.region, f1 ) && ( !isCompBd || !isCompBd( e[i].undirected() ) ) )
-                res.unite( f0, f1 );
+                unionFind.unite( f0, f1 );
         }
-    }
+    } );
+    res = std::move( unionFind ).toUnionFind();
 }
 
 std::vector<FaceBitSet> getAllComponents( const MeshPart& meshPart, const UndirectedEdgePredicate& isCompBd, UnionFind<FaceId>& unionFindStruct )
@@ -775,7 +747,6 @@ UnionFind<FaceId> getUnionFindStructureFacesPerEdge( const MeshPart& meshPart, c
 
 UnionFind<FaceId> getUnionFindStructureFaces( const MeshPart& meshPart, FaceIncidence incidence, const UndirectedEdgePredicate & isCompBd )
 {
-    UnionFind<FaceId> res;
     if ( incidence == FaceIncidence::PerEdge )
         return getUnionFindStructureFacesPerEdge( meshPart, isCompBd );
 
@@ -783,10 +754,10 @@ UnionFind<FaceId> getUnionFindStructureFaces( const MeshPart& meshPart, FaceInci
     assert( !isCompBd );
     const auto& mesh = meshPart.mesh;
     const FaceBitSet& region = mesh.topology.getFaceIds( meshPart.region );
-    res.reset( region.find_last() + 1 );
+    ConcurrentUnionFind<FaceId> res( region.find_last() + 1 );
     assert ( incidence == FaceIncidence::PerVertex );
     VertBitSet store;
-    for ( auto v : getIncidentVerts( mesh.topology, meshPart.region, store ) )
+    BitSetParallelFor( getIncidentVerts( mesh.topology, meshPart.region, store ), [&]( VertId v )
     {
         FaceId f0;
         for ( auto edge : orgRing( mesh.topology, v ) )
@@ -801,8 +772,8 @@ UnionFind<FaceId> getUnionFindStructureFaces( const MeshPart& meshPart, FaceInci
             }
             res.unite( f0, f1 );
         }
-    }
-    return res;
+    } );
+    return std::move( res ).toUnionFind();
 }
 
 UnionFind<VertId> getUnionFindStructureVerts( const MeshTopology& topology, const VertBitSet* region )
@@ -820,19 +791,18 @@ UnionFind<VertId> getUnionFindStructureVerts( const MeshTopology& topology, cons
     };
 
     static_assert( VertBitSet::npos + 1 == 0 );
-    UnionFind<VertId> unionFindStructure( vertsRegion.find_last() + 1 );
+    ConcurrentUnionFind<VertId> unionFindStructure( vertsRegion.find_last() + 1 );
 
-    VertId v1;
-    for ( auto v0 : vertsRegion )
+    BitSetParallelFor( vertsRegion, [&] ( VertId v0 )
     {
         for ( auto e : orgRing( topology, v0 ) )
         {
-            v1 = topology.dest( e );
+            const auto v1 = topology.dest( e );
             if ( v1.valid() && test( v1 ) && v1 < v0 )
                 unionFindStructure.unite( v0, v1 );
         }
-    }
-    return unionFindStructure;
+    } );
+    return std::move( unionFindStructure ).toUnionFind();
 }
 
 UnionFind<VertId> getUnionFindStructureVerts( const Mesh& mesh, const VertBitSet* region )
@@ -966,41 +936,12 @@ TEST(MRMesh, getAllComponentsEdges)
     ASSERT_EQ( comp[0].count(), 5 );
 }
 
-UnionFind<UndirectedEdgeId> getUnionFindStructureUndirectedEdges( const Mesh& mesh, bool allPointToRoots )
+UnionFind<UndirectedEdgeId> getUnionFindStructureUndirectedEdges( const Mesh& mesh )
 {
     MR_TIMER;
 
-    UnionFind<UndirectedEdgeId> res( mesh.topology.undirectedEdgeSize() );
-    const auto numThreads = int( tbb::global_control::active_value( tbb::global_control::max_allowed_parallelism ) );
-
-    UndirectedEdgeBitSet lastPass( mesh.topology.undirectedEdgeSize(), numThreads <= 1 );
-    if ( numThreads > 1 )
-    {
-        BitSetParallelForAllRanged( lastPass, [&] ( UndirectedEdgeId ue, const auto & range )
-        {
-            const EdgeId e = ue;
-            const UndirectedEdgeId ues[4] =
-            {
-                mesh.topology.prev( e ),
-                mesh.topology.next( e ),
-                mesh.topology.prev( e.sym() ),
-                mesh.topology.next( e.sym() )
-            };
-            for ( int i = 0; i < 4; ++i )
-            {
-                const auto uei = ues[i];
-                if ( ue < uei )
-                {
-                    if ( uei >= range.end )
-                        lastPass.set( ue ); // remember the edge to unite later in a sequential region
-                    else
-                        res.unite( ue, uei ); // our region
-                }
-            }
-        } );
-    }
-
-    for ( auto ue : lastPass )
+    ConcurrentUnionFind<UndirectedEdgeId> res( mesh.topology.undirectedEdgeSize() );
+    ParallelFor( 0_ue, UndirectedEdgeId( res.size() ), [&] ( UndirectedEdgeId ue )
     {
         const EdgeId e = ue;
         const UndirectedEdgeId ues[4] =
@@ -1016,25 +957,15 @@ UnionFind<UndirectedEdgeId> getUnionFindStructureUndirectedEdges( const Mesh& me
             if ( ue < uei )
                 res.unite( ue, uei );
         }
-    }
-
-    if ( allPointToRoots )
-    {
-        tbb::parallel_for( tbb::blocked_range( 0_ue, UndirectedEdgeId( res.size() ) ),
-            [&] ( const tbb::blocked_range<UndirectedEdgeId>& range )
-        {
-            for ( UndirectedEdgeId ue = range.begin(); ue < range.end(); ++ue )
-                res.findUpdateRange( ue, range.begin(), range.end() );
-        } );
-    }
-
-    return res;
+    } );
+    // every element points directly to the root after the conversion
+    return std::move( res ).toUnionFind();
 }
 
 UndirectedEdgeBitSet getComponentsUndirectedEdges( const Mesh& mesh, const UndirectedEdgeBitSet& seeds )
 {
     MR_TIMER;
-    auto unionFindStruct = getUnionFindStructureUndirectedEdges( mesh, true );
+    auto unionFindStruct = getUnionFindStructureUndirectedEdges( mesh );
 
     UndirectedEdgeId commonRoot;
     for ( auto s : seeds )
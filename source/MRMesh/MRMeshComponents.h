@@ -147,7 +147,7 @@ MRMESH_API void excludeFullySelectedComponents( const Mesh& mesh, VertBitSet& se
 [[nodiscard]] MRMESH_API UnionFind<FaceId> getUnionFindStructureFaces( const MeshPart& meshPart, FaceIncidence incidence = FaceIncidence::PerEdge, const UndirectedEdgePredicate & isCompBd = {} );
 
 /// gets union-find structure for faces with connectivity by shared edge, and optional edge predicate whether to skip uniting components over it
-/// it is guaranteed that isCompBd is invoked in a thread-safe manner (that left and right face are always processed by one thread)
+/// isCompBd is invoked only once for each edge between two region faces, but from many threads simultaneously for different edges
 [[nodiscard]] MRMESH_API UnionFind<FaceId> getUnionFindStructureFacesPerEdge( const MeshPart& meshPart, const UndirectedEdgePredicate& isCompBd = {} );
 
 /// gets union-find structure for vertices
@@ -174,9 +174,14 @@ MRMESH_API void excludeFullySelectedComponents( const Mesh& mesh, VertBitSet& se
 [[nodiscard]] MRMESH_API UnionFind<VertId> getUnionFindStructureVertsSeparatedByPaths( const Mesh& mesh, const std::vector<SurfacePath>& paths,
     VertBitSet* outPathVerts = nullptr );
 
-/// gets union-find structure for all undirected edges in \param mesh
-/// \param allPointToRoots if true, then every element in the structure will point directly to the root of its respective component
-[[nodiscard]] MRMESH_API UnionFind<UndirectedEdgeId> getUnionFindStructureUndirectedEdges( const Mesh& mesh, bool allPointToRoots = false );
+/// gets union-find structure for all undirected edges in \param mesh,
+/// every element in the structure points directly to the root of its respective component
+[[nodiscard]] MRMESH_API UnionFind<UndirectedEdgeId> getUnionFindStructureUndirectedEdges( const Mesh& mesh );
+[[deprecated( "Use getUnionFindStructureUndirectedEdges( mesh ), all elements always point to the roots")]]
+[[nodiscard]] inline UnionFind<UndirectedEdgeId> getUnionFindStructureUndirectedEdges( const Mesh& mesh, bool )
+{
+    return getUnionFindStructureUndirectedEdges( mesh );
+}
 
 /// returns union of connected components, each of which contains at least one seed edge
 [[nodiscard]] MRMESH_API UndirectedEdgeBitSet getComponentsUndirectedEdges( const Mesh& mesh, const UndirectedEdgeBitSet& seeds );
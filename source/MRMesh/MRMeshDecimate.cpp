@@ -18,6 +18,7 @@
 #include "MRBuffer.h"
 #include "MRTbbThreadMutex.h"
 #include "MRMeshFixer.h"
+#include <bit>
 
 namespace MR
 {
@@ -65,10 +66,12 @@ private:
     UndirectedEdgeBitSet outdated_; // true if edge's error in the queue may be outdated (too optimistic) due to nearby collapse
     int numOutdated_ = 0; // total number of not lone outdated edges in the queue
     DecimateResult res_;
-    std::vector<VertId> originNeis_;
-    std::vector<Vector3f> triDblAreas_; // directed double areas of newly formed triangles to check that they are consistently oriented
     class EdgeMetricCalc;
 
+    /// true if decimation is performed by rounds of independent operations
+    bool parallelRounds_() const { return settings_.parallelRounds && !settings_.twinMap; }
+    DecimateResult runRounds_();
+
     bool initialize_();
     void initializeQueue_();
     std::vector<QueueElement> makeQueueElements_();
@@ -115,7 +118,20 @@ private:
         EdgeId e;
         CollapseStatus status = CollapseStatus::Ok;
     };
-    CanCollapseRes canCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos ); // not const because it changes temporary originNeis_ and triDblAreas_
+    /// temporary buffers used by canCollapse_, one per thread
+    struct CanCollapseBuffers
+    {
+        std::vector<VertId> originNeis;
+        std::vector<Vector3f> triDblAreas; // directed double areas of newly formed triangles to check that they are consistently oriented
+    };
+    CanCollapseBuffers canCollapseBuffers_;
+    CanCollapseRes canCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos, CanCollapseBuffers & buffers ) const;
+    CanCollapseRes canCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos ) { return canCollapse_( edgeToCollapse, collapsePos, canCollapseBuffers_ ); }
+
+    /// performs edge collapse after previous successful check by canCollapse_ without any queue update,
+    /// if one of the edge's vertices remain, then stores (collapseForm) as its new form
+    /// \return org( edgeToCollapse ) or invalid id if it was the last edge
+    VertId applyCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos, const QuadraticForm3f & collapseForm );
 
     /// performs edge collapse after previous successful check by canCollapse_,
     /// if one of the edge's vertices remain, then stores (collapseForm) as its new form and updates error of its neighbor edges
@@ -290,7 +306,8 @@ bool MeshDecimator::initialize_()
     if ( settings_.progressCallback && !settings_.progressCallback( 0.15f ) )
         return false;
 
-    initializeQueue_();
+    if ( !parallelRounds_() )
+        initializeQueue_();
 
     if ( settings_.progressCallback && !settings_.progressCallback( 0.25f ) )
         return false;
@@ -529,8 +546,10 @@ void MeshDecimator::flipEdge_( UndirectedEdgeId ue )
     addInQueueIfMissing_( mesh_.topology.next( e.sym() ).undirected() );
 }
 
-auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos ) -> CanCollapseRes
+auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos, CanCollapseBuffers & buffers ) const -> CanCollapseRes
 {
+    auto & originNeis = buffers.originNeis;
+    auto & triDblAreas = buffers.triDblAreas;
     const auto & topology = mesh_.topology;
     auto vl = topology.left( edgeToCollapse ).valid()  ? topology.dest( topology.next( edgeToCollapse ) ) : VertId{};
     auto vr = topology.right( edgeToCollapse ).valid() ? topology.dest( topology.prev( edgeToCollapse ) ) : VertId{};
@@ -589,8 +608,8 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
     float maxNewEdgeLenSq = 0;
 
     bool normalFlip = false; // at least one triangle flips its normal or a degenerate triangle becomes not-degenerate
-    originNeis_.clear();
-    triDblAreas_.clear();
+    originNeis.clear();
+    triDblAreas.clear();
     Vector3d sumDblArea_;
     EdgeId oBdEdge; // a boundary edge !right(e) incident to org( edgeToCollapse )
     for ( EdgeId e : orgRing0( topology, edgeToCollapse ) )
@@ -599,7 +618,7 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
         if ( eDest == vd )
             return { .status =  CollapseStatus::MultipleEdge }; // multiple edge found
         if ( eDest != vl && eDest != vr )
-            originNeis_.push_back( eDest );
+            originNeis.push_back( eDest );
 
         const auto pDest = mesh_.points[eDest];
         maxOldEdgeLenSq = std::max( maxOldEdgeLenSq, ( po - pDest ).lengthSq() );
@@ -623,11 +642,11 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
                 if ( dot( da, oldA ) <= 0 )
                     normalFlip = true;
             }
-            triDblAreas_.push_back( da );
+            triDblAreas.push_back( da );
             sumDblArea_ += Vector3d{ da };
             const auto triAspect = triangleAspectRatio( collapsePos, pDest, pDest2 );
             if ( triAspect >= settings_.criticalTriAspectRatio )
-                triDblAreas_.back() = Vector3f{}; //cannot trust direction of degenerate triangles
+                triDblAreas.back() = Vector3f{}; //cannot trust direction of degenerate triangles
             maxNewAspectRatio = std::max( maxNewAspectRatio, triAspect );
         }
         maxOldAspectRatio = std::max( maxOldAspectRatio, triangleAspectRatio( po, pDest, pDest2 ) );
@@ -636,14 +655,14 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
         && !smallShift( LineSegm3f{ po, mesh_.destPnt( oBdEdge ) }, collapsePos )
         && !smallShift( LineSegm3f{ po, mesh_.orgPnt( topology.prevLeftBd( oBdEdge ) ) }, collapsePos ) )
             return { .status =  CollapseStatus::PosFarBd }; // new vertex is too far from both existed boundary edges
-    std::sort( originNeis_.begin(), originNeis_.end() );
+    std::sort( originNeis.begin(), originNeis.end() );
 
     EdgeId dBdEdge; // a boundary edge !right(e) incident to dest( edgeToCollapse )
     for ( EdgeId e : orgRing0( topology, edgeToCollapse.sym() ) )
     {
         const auto eDest = topology.dest( e );
         assert ( eDest != vo );
-        if ( std::binary_search( originNeis_.begin(), originNeis_.end(), eDest ) )
+        if ( std::binary_search( originNeis.begin(), originNeis.end(), eDest ) )
             return { .status =  CollapseStatus::MultipleEdge }; // to prevent appearance of multiple edges
 
         const auto pDest = mesh_.points[eDest];
@@ -668,11 +687,11 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
                 if ( dot( da, oldA ) <= 0 )
                     normalFlip = true;
             }
-            triDblAreas_.push_back( da );
+            triDblAreas.push_back( da );
             sumDblArea_ += Vector3d{ da };
             const auto triAspect = triangleAspectRatio( collapsePos, pDest, pDest2 );
             if ( triAspect >= settings_.criticalTriAspectRatio )
-                triDblAreas_.back() = Vector3f{}; //cannot trust direction of degenerate triangles
+                triDblAreas.back() = Vector3f{}; //cannot trust direction of degenerate triangles
             maxNewAspectRatio = std::max( maxNewAspectRatio, triAspect );
         }
         maxOldAspectRatio = std::max( maxOldAspectRatio, triangleAspectRatio( pd, pDest, pDest2 ) );
@@ -698,7 +717,7 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
     if ( normalFlip && ( ( po != pd ) || ( po != collapsePos ) ) )
     {
         auto n = Vector3f{ sumDblArea_.normalized() };
-        for ( const auto da : triDblAreas_ )
+        for ( const auto da : triDblAreas )
             if ( dot( da, n ) < 0 )
                 return { .status =  CollapseStatus::NormalFlip };
     }
@@ -710,7 +729,7 @@ auto MeshDecimator::canCollapse_( EdgeId edgeToCollapse, const Vector3f & collap
     return { .e = edgeToCollapse };
 }
 
-VertId MeshDecimator::forceCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos, const QuadraticForm3f & collapseForm )
+VertId MeshDecimator::applyCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos, const QuadraticForm3f & collapseForm )
 {
     ++res_.vertsDeleted;
 
@@ -735,11 +754,16 @@ VertId MeshDecimator::forceCollapse_( EdgeId edgeToCollapse, const Vector3f & co
     if ( !eo )
         return {};
 
+    // must be done before computeQueueElement_ for neighbor edges
+    (*pVertForms_)[vo] = collapseForm;
+    return vo;
+}
+
+VertId MeshDecimator::forceCollapse_( EdgeId edgeToCollapse, const Vector3f & collapsePos, const QuadraticForm3f & collapseForm )
+{
+    const auto vo = applyCollapse_( edgeToCollapse, collapsePos, collapseForm );
     if ( vo )
     {
-        // must be done before computeQueueElement_ in addInQueueIfMissing_
-        (*pVertForms_)[vo] = collapseForm;
-
         // update edges around remaining vertex
         for ( EdgeId e : orgRing( mesh_.topology, vo ) )
         {
@@ -843,6 +867,9 @@ DecimateResult MeshDecimator::run()
     if ( !initialize_() )
         return res_;
 
+    if ( parallelRounds_() )
+        return runRounds_();
+
     res_.errorIntroduced = settings_.maxError;
     int lastProgressFacesDeleted = 0;
     const int maxFacesDeleted = std::min(
@@ -939,6 +966,244 @@ DecimateResult MeshDecimator::run()
     return res_;
 }
 
+// converts float into unsigned integer with the same order of values
+static std::uint32_t orderedBits( float f )
+{
+    const auto u = std::bit_cast<std::uint32_t>( f );
+    return ( u & 0x80000000u ) ? ~u : ( u | 0x80000000u );
+}
+
+// bijective mixing of bits (finalizer of MurmurHash3)
+static std::uint32_t mixBits( std::uint32_t h )
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+DecimateResult MeshDecimator::runRounds_()
+{
+    MR_TIMER;
+    auto & topology = mesh_.topology;
+    const auto numUe = topology.undirectedEdgeSize();
+
+    // the best operation for each edge, valid only if the bit in validInQueue_ is set
+    std::vector<QueueElement> cands( numUe );
+    validInQueue_.clear();
+    validInQueue_.resize( numUe, false );
+
+    // outdated_ contains the edges to (re)compute in the beginning of next round
+    if ( regionEdges_.empty() )
+    {
+        outdated_.clear();
+        outdated_.resize( numUe, true );
+    }
+    else
+    {
+        outdated_ = regionEdges_;
+        outdated_.resize( numUe );
+    }
+    numOutdated_ = int( outdated_.count() );
+    auto markOutdated = [&]( UndirectedEdgeId ue )
+    {
+        if ( !regionEdges_.empty() && !regionEdges_.test( ue ) )
+            return;
+        if ( !outdated_.test_set( ue ) )
+            ++numOutdated_;
+    };
+
+    // the edges with failed collapse to optimal position, which are recomputed with the collapse in one of edge's ends
+    UndirectedEdgeBitSet noOptPos( numUe );
+
+    // the minimal key of all candidates incident to each vertex
+    Vector<std::uint64_t, VertId> minKey( topology.vertSize() );
+    constexpr auto noKey = ~std::uint64_t( 0 );
+
+    struct Winner
+    {
+        EdgeId e;
+        QueueElement qe;
+        Vector3f collapsePos;
+        QuadraticForm3f collapseForm;
+    };
+    struct ThreadData
+    {
+        CanCollapseBuffers buffers;
+        std::vector<Winner> winners;
+        std::vector<std::pair<UndirectedEdgeId, bool>> failures; // second is true if collapse to optimal position failed by geometrical criterion
+    };
+    tbb::enumerable_thread_specific<ThreadData> threadData;
+    std::vector<Winner> winners;
+    std::vector<float> costs;
+
+    res_.errorIntroduced = settings_.maxError;
+    const int maxFacesDeleted = std::min(
+        settings_.region ? (int)settings_.region->count() : topology.numValidFaces(), settings_.maxDeletedFaces );
+    bool limitReached = false;
+    while ( !limitReached )
+    {
+        // recompute the errors of the edges changed in previous round
+        BitSetParallelForAll( validInQueue_, [&]( UndirectedEdgeId ue )
+        {
+            if ( !outdated_.test( ue ) )
+                return;
+            std::optional<QueueElement> qe;
+            if ( !topology.isLoneEdge( ue ) )
+                qe = computeQueueElement_( ue, settings_.optimizeVertexPos && !noOptPos.test( ue ) );
+            if ( qe )
+                cands[ue] = *qe;
+            validInQueue_.set( ue, qe.has_value() );
+        } );
+        outdated_.reset();
+        numOutdated_ = 0;
+
+        const auto numCands = validInQueue_.count();
+        if ( numCands == 0 )
+            break;
+
+        // find the threshold of errors not to perform more operations than permitted by the limits
+        float maxCost = FLT_MAX;
+        const auto maxOps = (size_t)std::max( std::int64_t( 0 ), std::min(
+            ( std::int64_t( settings_.maxDeletedFaces ) - res_.facesDeleted + 1 ) / 2,
+            std::int64_t( settings_.maxDeletedVertices ) - res_.vertsDeleted ) );
+        if ( maxOps < numCands )
+        {
+            costs.clear();
+            for ( auto ue : validInQueue_ )
+                costs.push_back( cands[ue].c );
+            std::nth_element( costs.begin(), costs.begin() + maxOps, costs.end() );
+            maxCost = costs[maxOps];
+        }
+
+        // unique key of each candidate: smaller error goes first;
+        // the errors are compared with the precision of about 12% and the ties are broken pseudo-randomly,
+        // otherwise the errors vary smoothly over the mesh and only few candidates have minimal error in their neighbourhoods
+        auto key = [&]( UndirectedEdgeId ue )
+        {
+            if ( !validInQueue_.test( ue ) || cands[ue].c > maxCost )
+                return noKey;
+            return ( std::uint64_t( orderedBits( cands[ue].c ) >> 20 ) << 32 ) | mixBits( std::uint32_t( ue ) );
+        };
+        ParallelFor( minKey, [&]( VertId v )
+        {
+            auto m = noKey;
+            if ( topology.hasVert( v ) )
+                for ( EdgeId e : orgRing( topology, v ) )
+                    m = std::min( m, key( e.undirected() ) );
+            minKey[v] = m;
+        } );
+
+        // select the candidates with minimal keys in their vicinity and check them;
+        // the vicinities of selected collapses do not overlap, so the checks are the same as in serial processing
+        BitSetParallelFor( validInQueue_, threadData, [&]( UndirectedEdgeId ue, ThreadData & tls )
+        {
+            const auto k = key( ue );
+            if ( k == noKey )
+                return;
+            const EdgeId e( ue );
+            const auto o = topology.org( e );
+            const auto d = topology.dest( e );
+            if ( minKey[o] != k || minKey[d] != k )
+                return;
+            for ( auto v : { o, d } )
+                for ( EdgeId ei : orgRing( topology, v ) )
+                    if ( minKey[topology.dest( ei )] < k )
+                        return;
+
+            Winner w{ .e = e, .qe = cands[ue] };
+            if ( w.qe.x.edgeOp != EdgeOp::Flip )
+            {
+                [[maybe_unused]] const auto qe = computeQueueElement_( ue, w.qe.x.edgeOp == EdgeOp::CollapseOptPos, &w.collapseForm, &w.collapsePos );
+                assert( qe && qe->x.edgeOp == w.qe.x.edgeOp );
+                const auto can = canCollapse_( e, w.collapsePos, tls.buffers );
+                if ( can.status != CollapseStatus::Ok )
+                {
+                    tls.failures.emplace_back( ue, w.qe.x.edgeOp == EdgeOp::CollapseOptPos && geomFail_( can.status ) );
+                    return;
+                }
+                w.e = can.e;
+            }
+            tls.winners.push_back( w );
+        } );
+
+        winners.clear();
+        bool anyFailure = false;
+        for ( auto & tls : threadData )
+        {
+            winners.insert( winners.end(), tls.winners.begin(), tls.winners.end() );
+            tls.winners.clear();
+            for ( auto [ue, retry] : tls.failures )
+            {
+                anyFailure = true;
+                validInQueue_.reset( ue );
+                if ( retry )
+                {
+                    // try again with the collapse in one of edge's ends
+                    noOptPos.set( ue );
+                    markOutdated( ue );
+                }
+            }
+            tls.failures.clear();
+        }
+        if ( winners.empty() && !anyFailure )
+            break;
+
+        // perform selected operations in the order of increasing error
+        std::sort( winners.begin(), winners.end(), []( const Winner & a, const Winner & b ) { return b.qe < a.qe; } );
+        for ( const auto & w : winners )
+        {
+            if ( res_.facesDeleted >= settings_.maxDeletedFaces || res_.vertsDeleted >= settings_.maxDeletedVertices )
+            {
+                res_.errorIntroduced = std::sqrt( w.qe.c );
+                limitReached = true;
+                break;
+            }
+            const auto ue = w.qe.uedgeId();
+            validInQueue_.reset( ue );
+            if ( w.qe.x.edgeOp == EdgeOp::Flip )
+            {
+                // another flip in this round could create the same diagonal
+                if ( checkDeloneQuadrangleInMesh( mesh_, ue, deloneSettings_ ) )
+                    continue;
+                EdgeId e = ue;
+                topology.flipEdge( e );
+                for ( auto fe : { e, topology.prev( e ), topology.next( e ), topology.prev( e.sym() ), topology.next( e.sym() ) } )
+                {
+                    noOptPos.reset( fe.undirected() );
+                    markOutdated( fe.undirected() );
+                }
+            }
+            else if ( auto vo = applyCollapse_( w.e, w.collapsePos, w.collapseForm ) )
+            {
+                for ( EdgeId e : orgRing( topology, vo ) )
+                {
+                    noOptPos.reset( e.undirected() );
+                    markOutdated( e.undirected() );
+                    if ( topology.left( e ) )
+                    {
+                        noOptPos.reset( topology.prev( e.sym() ).undirected() );
+                        markOutdated( topology.prev( e.sym() ).undirected() );
+                    }
+                }
+            }
+        }
+
+        if ( settings_.progressCallback && !settings_.progressCallback( 0.25f + 0.75f * res_.facesDeleted / std::max( 1, maxFacesDeleted ) ) )
+            return res_;
+    }
+
+    if ( settings_.progressCallback && !settings_.progressCallback( 1.0f ) )
+        return res_;
+
+    if ( settings_.packMesh )
+        packMesh( mesh_, settings_ );
+    res_.cancelled = false;
+    return res_;
+}
+
 static DecimateResult decimateMeshSerial( Mesh & mesh, const DecimateSettings & settings )
 {
     MR_TIMER;
@@ -1231,7 +1496,7 @@ DecimateResult decimateMesh( Mesh & mesh, const DecimateSettings & settings0 )
 #endif
 
     mesh.invalidateCaches(); // free memory occupied by trees before running the algorithm, which makes them invalid anyway
-    res = ( settings.subdivideParts > 1 ) ?
+    res = ( settings.subdivideParts > 1 && !settings.parallelRounds ) ?
         decimateMeshParallelInplace( mesh, settings ) : decimateMeshSerial( mesh, settings );
     assert ( !mesh.getAABBTreeNotCreate() ); // make sure that nobody created the tree by mistake
     assert ( mesh.topology.checkValidity() );
@@ -1362,4 +1627,32 @@ TEST( MRMesh, MeshDecimateParallel )
     ASSERT_EQ( mesh.topology.numValidVerts(), 3 );
 }
 
+TEST( MRMesh, MeshDecimateParallelRounds )
+{
+    const auto sphere = makeSphere( { .numMeshVertices = 2000 } );
+    DecimateSettings settings
+    {
+        .maxError = 0.05f
+    };
+    auto serialMesh = sphere;
+    const auto serialRes = decimateMesh( serialMesh, settings );
+
+    settings.parallelRounds = true;
+    auto mesh = sphere;
+    const auto res = decimateMesh( mesh, settings );
+    EXPECT_FALSE( res.cancelled );
+    EXPECT_LE( res.errorIntroduced, settings.maxError );
+    // the quality is close to the one of serial decimation
+    EXPECT_NEAR( res.facesDeleted, serialRes.facesDeleted, serialRes.facesDeleted / 10 );
+    EXPECT_EQ( mesh.topology.numValidFaces(), sphere.topology.numValidFaces() - res.facesDeleted );
+
+    // the limit on the number of deleted faces
+    settings.maxError = FLT_MAX;
+    settings.maxDeletedFaces = 1000;
+    mesh = sphere;
+    const auto res1 = decimateMesh( mesh, settings );
+    EXPECT_GE( res1.facesDeleted, 1000 );
+    EXPECT_LE( res1.facesDeleted, 1001 );
+}
+
 } //namespace MR
@@ -157,6 +157,14 @@ struct DecimateSettings
 
     /// minimum number of faces in one subdivision part for ( subdivideParts > 1 ) mode
     int minFacesInPart = 0;
+
+    /// if true, then the whole mesh is decimated without subdivision on parts by rounds (subdivideParts is ignored):
+    /// in each round the errors of all changed edges are computed and the collapses are checked in parallel threads,
+    /// then the operations having the minimal error in their neighbourhoods (which do not overlap) are performed;
+    /// the result is close to the one of serial decimation and has no seams between parts;
+    /// preCollapse and adjustCollapse callbacks are called from parallel threads in this mode and must be thread-safe;
+    /// this mode is not supported together with twinMap, which makes decimation serial
+    bool parallelRounds = false;
 };
 
 /**
@@ -0,0 +1,515 @@
+#include "MRMeshDecimateOutOfCore.h"
+#include "MRMesh.h"
+#include "MRBox.h"
+#include "MRRegionBoundary.h"
+#include "MRParallelFor.h"
+#include "MRUniqueTemporaryFolder.h"
+#include "MRStringConvert.h"
+#include "MRMeshLoad.h"
+#include "MRMeshSave.h"
+#include "MRMakeSphereMesh.h"
+#include "MRTimer.h"
+#include "MRGTest.h"
+#include "MRPch/MRTBB.h"
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+
+namespace MR
+{
+
+namespace
+{
+
+/// approximate memory occupied by one triangle during decimation of a tile: topology, points, quadratic forms and the queue of edges
+constexpr size_t cBytesPerTriangle = 400;
+
+/// the number of triangles read from input file at once
+constexpr size_t cReadChunkTris = 1 << 16;
+
+/// the size of one triangle record in binary STL
+constexpr size_t cStlRecordSize = 50;
+
+/// returns the maximal size of the bounding box of given triangle in any dimension
+float triangleExtent( const Triangle3f & t )
+{
+    Box3f box;
+    for ( const auto & p : t )
+        box.include( p );
+    const auto size = box.size();
+    return std::max( { size.x, size.y, size.z } );
+}
+
+/// calls given function for all triangles of binary STL file split in chunks, returns the number of triangles
+Expected<size_t> forEachStlChunk( const std::filesystem::path & file, const std::function<Expected<void>( const std::vector<Triangle3f> & )> & onChunk )
+{
+    std::ifstream in( file, std::ifstream::binary );
+    if ( !in )
+        return unexpected( "Cannot open file for reading " + utf8string( file ) );
+
+    char header[80];
+    in.read( header, 80 );
+    std::uint32_t numTris = 0;
+    in.read( (char*)&numTris, 4 );
+    if ( !in )
+        return unexpected( std::string( "Binary STL read error" ) );
+
+    std::vector<char> records;
+    std::vector<Triangle3f> tris;
+    for ( size_t done = 0; done < numTris; )
+    {
+        const auto n = std::min( cReadChunkTris, numTris - done );
+        records.resize( n * cStlRecordSize );
+        in.read( records.data(), records.size() );
+        if ( !in )
+            return unexpected( std::string( "Binary STL read error" ) );
+        tris.resize( n );
+        for ( size_t i = 0; i < n; ++i )
+            std::memcpy( (void*)&tris[i], records.data() + i * cStlRecordSize + sizeof( Vector3f ), sizeof( Triangle3f ) ); // skip normal
+        if ( auto r = onChunk( tris ); !r )
+            return unexpected( std::move( r.error() ) );
+        done += n;
+    }
+    return numTris;
+}
+
+/// writes triangles in binary STL file, the number of triangles in the header is written on closing
+class StlWriter
+{
+public:
+    Expected<void> open( const std::filesystem::path & file )
+    {
+        file_ = file;
+        out_.open( file, std::ofstream::binary );
+        if ( !out_ )
+            return unexpected( "Cannot open file for writing " + utf8string( file ) );
+        char header[80] = "MeshInspector.com";
+        out_.write( header, 80 );
+        std::uint32_t numTris = 0;
+        out_.write( (const char*)&numTris, 4 );
+        return check_();
+    }
+
+    Expected<void> write( const std::vector<Triangle3f> & tris )
+    {
+        std::vector<char> records( tris.size() * cStlRecordSize );
+        ParallelFor( tris, [&] ( size_t i )
+        {
+            const auto & t = tris[i];
+            // perform normal computation in double-precision as in MeshSave::toBinaryStl
+            const Vector3d a( t[0] ), b( t[1] ), c( t[2] );
+            const Vector3f normal( cross( b - a, c - a ).normalized() );
+            auto * rec = records.data() + i * cStlRecordSize;
+            std::memcpy( rec, &normal, sizeof( Vector3f ) );
+            std::memcpy( rec + sizeof( Vector3f ), &t, sizeof( Triangle3f ) );
+        } );
+        out_.write( records.data(), records.size() );
+        numTris_ += tris.size();
+        return check_();
+    }
+
+    Expected<void> close()
+    {
+        if ( numTris_ > UINT32_MAX )
+            return unexpected( std::string( "Too many triangles for binary STL" ) );
+        const auto numTris = std::uint32_t( numTris_ );
+        out_.seekp( 80 );
+        out_.write( (const char*)&numTris, 4 );
+        out_.close();
+        return check_();
+    }
+
+    size_t numTris() const { return numTris_; }
+
+private:
+    Expected<void> check_() const
+    {
+        if ( !out_ )
+            return unexpected( "Error writing file " + utf8string( file_ ) );
+        return {};
+    }
+
+    std::filesystem::path file_;
+    std::ofstream out_;
+    size_t numTris_ = 0;
+};
+
+/// regular grid of spatial tiles
+struct TileGrid
+{
+    Vector3f origin;
+    Vector3f cell;
+    Vector3i dims{ 1, 1, 1 };
+
+    size_t size() const { return size_t( dims.x ) * dims.y * dims.z; }
+
+    /// returns the coordinates of the tile containing given point, the points outside the grid are attributed to the closest tile
+    Vector3i coordsOf( const Vector3f & p ) const
+    {
+        Vector3i res;
+        for ( int d = 0; d < 3; ++d )
+            res[d] = cell[d] > 0 ? std::clamp( int( std::floor( ( p[d] - origin[d] ) / cell[d] ) ), 0, dims[d] - 1 ) : 0;
+        return res;
+    }
+
+    size_t indexOf( const Vector3i & c ) const { return ( size_t( c.z ) * dims.y + c.y ) * dims.x + c.x; }
+
+    Vector3i coordsOf( size_t i ) const
+    {
+        return { int( i % dims.x ), int( i / dims.x % dims.y ), int( i / dims.x / dims.y ) };
+    }
+
+    /// returns the index of the tile, which the triangle belongs to
+    size_t tileOf( const Triangle3f & t ) const { return indexOf( coordsOf( ( t[0] + t[1] + t[2] ) / 3.0f ) ); }
+
+    /// returns true if point (p) in given tile can belong to a triangle of neighbour tile;
+    /// (extent) is the maximal size of triangles' boxes in any dimension
+    bool nearSharedBoundary( const Vector3i & tile, const Vector3f & p, float extent ) const
+    {
+        for ( int d = 0; d < 3; ++d )
+        {
+            const float min = origin[d] + cell[d] * tile[d];
+            if ( tile[d] > 0 && p[d] <= min + extent )
+                return true;
+            if ( tile[d] + 1 < dims[d] && p[d] >= min + cell[d] - extent )
+                return true;
+        }
+        return false;
+    }
+};
+
+/// splits given box on at least given number of tiles, subdividing each time the longest dimension of tiles
+TileGrid makeTileGrid( const Box3f & box, size_t numTiles )
+{
+    TileGrid res;
+    res.origin = box.min;
+    const auto size = box.size();
+    while ( res.size() < numTiles )
+    {
+        int best = 0;
+        for ( int d = 1; d < 3; ++d )
+            if ( size[d] / res.dims[d] > size[best] / res.dims[best] )
+                best = d;
+        if ( !( size[best] > 0 ) )
+            break; // degenerate box
+        ++res.dims[best];
+    }
+    for ( int d = 0; d < 3; ++d )
+        res.cell[d] = size[d] / res.dims[d];
+    return res;
+}
+
+/// returns the grid with the tiles shifted on half of their size, so the centers of new tiles are in the corners of old ones
+TileGrid makeShiftedTileGrid( const TileGrid & grid )
+{
+    TileGrid res = grid;
+    for ( int d = 0; d < 3; ++d )
+    {
+        if ( grid.dims[d] <= 1 )
+            continue;
+        res.origin[d] -= grid.cell[d] / 2;
+        ++res.dims[d];
+    }
+    return res;
+}
+
+/// triangles of all tiles spilled in temporary files
+class TileFiles
+{
+public:
+    TileFiles( const std::filesystem::path & folder, const std::string & prefix, const TileGrid & grid, size_t memoryBudget )
+        : grid_( grid )
+    {
+        const auto numTiles = grid.size();
+        paths_.resize( numTiles );
+        for ( size_t i = 0; i < numTiles; ++i )
+            paths_[i] = folder / ( prefix + std::to_string( i ) );
+        buffers_.resize( numTiles );
+        counts_.resize( numTiles, 0 );
+        // the buffers of all tiles take at most a quarter of the budget
+        bufferTris_ = std::clamp( memoryBudget / 4 / numTiles / sizeof( Triangle3f ), size_t( 1024 ), size_t( 1 ) << 16 );
+    }
+
+    const TileGrid & grid() const { return grid_; }
+
+    /// the maximal size of added triangles' boxes in any dimension
+    float maxExtent() const { return maxExtent_; }
+
+    /// the number of triangles in given tile
+    size_t count( size_t tile ) const { return counts_[tile]; }
+
+    /// distributes given triangles among tiles, can be called from several threads simultaneously
+    Expected<void> add( const std::vector<Triangle3f> & tris )
+    {
+        std::lock_guard lock( mutex_ );
+        for ( const auto & t : tris )
+        {
+            maxExtent_ = std::max( maxExtent_, triangleExtent( t ) );
+            const auto tile = grid_.tileOf( t );
+            buffers_[tile].push_back( t );
+            ++counts_[tile];
+            if ( buffers_[tile].size() >= bufferTris_ )
+                if ( auto r = flush_( tile ); !r )
+                    return r;
+        }
+        return {};
+    }
+
+    /// writes all buffered triangles
+    Expected<void> finish()
+    {
+        for ( size_t i = 0; i < buffers_.size(); ++i )
+        {
+            if ( auto r = flush_( i ); !r )
+                return r;
+            buffers_[i] = {};
+        }
+        return {};
+    }
+
+    /// reads all triangles of given tile and deletes its file
+    Expected<std::vector<Triangle3f>> load( size_t tile ) const
+    {
+        std::vector<Triangle3f> res( counts_[tile] );
+        if ( res.empty() )
+            return res;
+        {
+            std::ifstream in( paths_[tile], std::ifstream::binary );
+            in.read( (char*)res.data(), res.size() * sizeof( Triangle3f ) );
+            if ( !in )
+                return unexpected( "Cannot read temporary file " + utf8string( paths_[tile] ) );
+        }
+        std::error_code ec;
+        std::filesystem::remove( paths_[tile], ec );
+        return res;
+    }
+
+private:
+    /// appends buffered triangles of the tile to its file, the files are not kept open to avoid the limit on simultaneously opened files
+    Expected<void> flush_( size_t tile )
+    {
+        auto & buf = buffers_[tile];
+        if ( buf.empty() )
+            return {};
+        std::ofstream out( paths_[tile], std::ofstream::binary | std::ofstream::app );
+        out.write( (const char*)buf.data(), buf.size() * sizeof( Triangle3f ) );
+        buf.clear();
+        if ( !out )
+            return unexpected( "Cannot write temporary file " + utf8string( paths_[tile] ) );
+        return {};
+    }
+
+    TileGrid grid_;
+    std::vector<std::filesystem::path> paths_;
+    std::vector<std::vector<Triangle3f>> buffers_;
+    std::vector<size_t> counts_;
+    size_t bufferTris_ = 0;
+    float maxExtent_ = 0;
+    std::mutex mutex_;
+};
+
+/// returns the part of the limit proportional to the part of triangles
+int limitPart( int limit, size_t partTris, size_t totalTris )
+{
+    if ( limit == INT_MAX || totalTris == 0 )
+        return limit;
+    return int( double( std::max( limit, 0 ) ) * partTris / totalTris );
+}
+
+struct TilesDecimation
+{
+    size_t facesBefore = 0;
+    size_t facesAfter = 0;
+    size_t vertsDeleted = 0;
+    float errorIntroduced = 0;
+};
+
+/// decimates all tiles in parallel threads keeping the vertices near shared tile boundaries, and passes the triangles of decimated tiles in (sink)
+Expected<TilesDecimation> decimateTiles( const TileFiles & tiles, const DecimateSettings & settings, size_t numFaces,
+    const std::function<Expected<void>( const std::vector<Triangle3f> & )> & sink, ProgressCallback cb )
+{
+    MR_TIMER;
+    const auto & grid = tiles.grid();
+    std::mutex mutex;
+    std::string error;
+    TilesDecimation res;
+    res.facesBefore = numFaces;
+
+    const bool completed = ParallelFor( size_t( 0 ), grid.size(), [&] ( size_t i )
+    {
+        const auto tileFaces = tiles.count( i );
+        if ( tileFaces == 0 )
+            return;
+        auto setError = [&] ( std::string && e )
+        {
+            std::lock_guard lock( mutex );
+            if ( error.empty() )
+                error = std::move( e );
+        };
+
+        auto tris = tiles.load( i );
+        if ( !tris )
+            return setError( std::move( tris.error() ) );
+        Mesh mesh = Mesh::fromPointTriples( *tris, true );
+        *tris = {};
+
+        // the vertices of the triangles from neighbour tiles must not move
+        const auto tile = grid.coordsOf( i );
+        auto lockedVerts = getBoundaryVerts( mesh.topology );
+        for ( auto v : lockedVerts )
+            if ( !grid.nearSharedBoundary( tile, mesh.points[v], tiles.maxExtent() ) )
+                lockedVerts.reset( v );
+
+        DecimateSettings s = settings;
+        s.maxDeletedVertices = limitPart( settings.maxDeletedVertices, tileFaces, numFaces );
+        s.maxDeletedFaces = limitPart( settings.maxDeletedFaces, tileFaces, numFaces );
+        s.region = nullptr;
+        s.notFlippable = nullptr;
+        s.edgesToCollapse = nullptr;
+        s.twinMap = nullptr;
+        s.vertForms = nullptr;
+        s.partFaces = nullptr;
+        s.touchBdVerts = false;
+        s.bdVerts = &lockedVerts;
+        s.packMesh = false;
+        s.progressCallback = {};
+        // parallel decimation of parts finds its own boundaries ignoring locked vertices, and the tiles are already processed in parallel
+        s.subdivideParts = 1;
+        const auto decRes = decimateMesh( mesh, s );
+
+        std::vector<Triangle3f> decimated;
+        decimated.reserve( mesh.topology.numValidFaces() );
+        for ( auto f : mesh.topology.getValidFaces() )
+            decimated.push_back( mesh.getTriPoints( f ) );
+        auto sinkRes = sink( decimated );
+
+        std::lock_guard lock( mutex );
+        if ( !sinkRes && error.empty() )
+            error = std::move( sinkRes.error() );
+        res.facesAfter += decimated.size();
+        res.vertsDeleted += decRes.vertsDeleted;
+        res.errorIntroduced = std::max( res.errorIntroduced, decRes.errorIntroduced );
+    }, cb, 1 );
+
+    if ( !error.empty() )
+        return unexpected( std::move( error ) );
+    if ( !completed )
+        return unexpectedOperationCanceled();
+    return res;
+}
+
+} //anonymous namespace
+
+Expected<DecimateOutOfCoreResult> decimateBinaryStlOutOfCore( const std::filesystem::path & inFile, const std::filesystem::path & outFile,
+    const DecimateOutOfCoreSettings & settings )
+{
+    MR_TIMER;
+    DecimateOutOfCoreResult res;
+
+    // the first reading of the input is to find the size of the tiles
+    Box3f box;
+    auto numTris = forEachStlChunk( inFile, [&] ( const std::vector<Triangle3f> & tris )
+    {
+        for ( const auto & t : tris )
+            for ( const auto & p : t )
+                box.include( p );
+        return Expected<void>{};
+    } );
+    if ( !numTris )
+        return unexpected( std::move( numTris.error() ) );
+    res.facesBefore = *numTris;
+    if ( !reportProgress( settings.progress, 0.1f ) )
+        return unexpectedOperationCanceled();
+
+    // one half of the budget is for simultaneously decimated tiles
+    const size_t numThreads = std::max( 1, tbb::this_task_arena::max_concurrency() );
+    const size_t tileBudget = std::max( settings.memoryBudget / 2 / numThreads, size_t( 1 ) );
+    const size_t numTiles = std::max( ( res.facesBefore * cBytesPerTriangle + tileBudget - 1 ) / tileBudget, size_t( 1 ) );
+    const auto grid = makeTileGrid( box, numTiles );
+    res.numTiles = grid.size();
+    const bool secondPass = settings.decimateSeams && grid.size() > 1;
+
+    UniqueTemporaryFolder folder( {} );
+    if ( !folder )
+        return unexpected( std::string( "Cannot create temporary folder" ) );
+
+    TileFiles firstTiles( folder, "first", grid, settings.memoryBudget );
+    if ( auto r = forEachStlChunk( inFile, [&] ( const std::vector<Triangle3f> & tris ) { return firstTiles.add( tris ); } ); !r )
+        return unexpected( std::move( r.error() ) );
+    if ( auto r = firstTiles.finish(); !r )
+        return unexpected( std::move( r.error() ) );
+    if ( !reportProgress( settings.progress, 0.2f ) )
+        return unexpectedOperationCanceled();
+
+    StlWriter writer;
+    if ( auto r = writer.open( outFile ); !r )
+        return unexpected( std::move( r.error() ) );
+    std::mutex writerMutex;
+    auto writeOutput = [&] ( const std::vector<Triangle3f> & tris )
+    {
+        std::lock_guard lock( writerMutex );
+        return writer.write( tris );
+    };
+
+    std::optional<TileFiles> secondTiles;
+    if ( secondPass )
+        secondTiles.emplace( folder, "second", makeShiftedTileGrid( grid ), settings.memoryBudget );
+
+    auto firstRes = decimateTiles( firstTiles, settings.decimate, res.facesBefore,
+        [&] ( const std::vector<Triangle3f> & tris ) { return secondTiles ? secondTiles->add( tris ) : writeOutput( tris ); },
+        subprogress( settings.progress, 0.2f, secondPass ? 0.6f : 1.0f ) );
+    if ( !firstRes )
+        return unexpected( std::move( firstRes.error() ) );
+    res.errorIntroduced = firstRes->errorIntroduced;
+
+    if ( secondTiles )
+    {
+        if ( auto r = secondTiles->finish(); !r )
+            return unexpected( std::move( r.error() ) );
+        // the limits are reduced by the deletions in the first pass
+        DecimateSettings seamSettings = settings.decimate;
+        if ( seamSettings.maxDeletedFaces != INT_MAX )
+            seamSettings.maxDeletedFaces = int( std::max<std::int64_t>( 0, std::int64_t( seamSettings.maxDeletedFaces ) - std::int64_t( firstRes->facesBefore - firstRes->facesAfter ) ) );
+        if ( seamSettings.maxDeletedVertices != INT_MAX )
+            seamSettings.maxDeletedVertices = int( std::max<std::int64_t>( 0, std::int64_t( seamSettings.maxDeletedVertices ) - std::int64_t( firstRes->vertsDeleted ) ) );
+        auto secondRes = decimateTiles( *secondTiles, seamSettings, firstRes->facesAfter, writeOutput, subprogress( settings.progress, 0.6f, 1.0f ) );
+        if ( !secondRes )
+            return unexpected( std::move( secondRes.error() ) );
+        res.errorIntroduced = std::max( res.errorIntroduced, secondRes->errorIntroduced );
+    }
+
+    if ( auto r = writer.close(); !r )
+        return unexpected( std::move( r.error() ) );
+    res.facesAfter = writer.numTris();
+    return res;
+}
+
+TEST( MRMesh, DecimateOutOfCore )
+{
+    UniqueTemporaryFolder folder( {} );
+    const auto inFile = folder / "in.stl";
+    const auto outFile = folder / "out.stl";
+    const Mesh sphere = makeUVSphere( 1, 64, 64 );
+    ASSERT_TRUE( MeshSave::toBinaryStl( sphere, inFile ).has_value() );
+
+    DecimateOutOfCoreSettings settings;
+    settings.decimate.maxError = 0.01f;
+    // small budget to get many tiles
+    settings.memoryBudget = sphere.topology.numValidFaces() * cBytesPerTriangle / 4;
+    const auto res = decimateBinaryStlOutOfCore( inFile, outFile, settings );
+    ASSERT_TRUE( res.has_value() );
+    EXPECT_GT( res->numTiles, 1 );
+    EXPECT_EQ( res->facesBefore, sphere.topology.numValidFaces() );
+    EXPECT_LT( res->facesAfter, res->facesBefore / 2 );
+
+    const auto decimated = MeshLoad::fromBinaryStl( outFile );
+    ASSERT_TRUE( decimated.has_value() );
+    EXPECT_EQ( decimated->topology.numValidFaces(), res->facesAfter );
+    // the tiles are stitched without holes
+    EXPECT_EQ( decimated->topology.findNumHoles(), 0 );
+    for ( auto v : decimated->topology.getValidVerts() )
+        EXPECT_NEAR( decimated->points[v].length(), 1.0f, 0.02f );
+}
+
+} //namespace MR
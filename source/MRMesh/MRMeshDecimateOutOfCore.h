@@ -0,0 +1,57 @@
+#pragma once
+
+#include "MRMeshDecimate.h"
+#include "MRExpected.h"
+#include <filesystem>
+
+namespace MR
+{
+
+/**
+ * \struct MR::DecimateOutOfCoreSettings
+ * \brief Parameters structure for MR::decimateBinaryStlOutOfCore
+ * \ingroup DecimateGroup
+ */
+struct DecimateOutOfCoreSettings
+{
+    /// decimation parameters applied to each tile, the limits on deleted vertices and faces are distributed among the tiles proportionally to their sizes;
+    /// the pointers on mesh data (region, notFlippable, edgesToCollapse, twinMap, bdVerts, vertForms, partFaces) and progressCallback are ignored
+    DecimateSettings decimate;
+
+    /// approximate limit of memory occupied by all simultaneously decimated tiles and by write buffers,
+    /// the input mesh is split on as many tiles as necessary assuming more or less uniform density of triangles
+    size_t memoryBudget = size_t( 1 ) << 30;
+
+    /// whether to decimate the seams between the tiles of the first pass in the second pass with the tiles shifted on half of their size;
+    /// the surface deviation near the seams can reach the sum of maxError in both passes
+    bool decimateSeams = true;
+
+    /// callback to report algorithm progress and cancel it by user request
+    ProgressCallback progress;
+};
+
+/**
+ * \struct MR::DecimateOutOfCoreResult
+ * \brief Results of MR::decimateBinaryStlOutOfCore
+ * \ingroup DecimateGroup
+ */
+struct DecimateOutOfCoreResult
+{
+    size_t facesBefore = 0; ///< the number of triangles in the input file
+    size_t facesAfter = 0;  ///< the number of triangles in the output file
+    size_t numTiles = 0;    ///< the number of tiles in the first pass
+    /// maximal estimated distance deviation among all tiles for DecimateStrategy::MinimizeError
+    float errorIntroduced = 0;
+};
+
+/**
+ * \brief Decimates the mesh from binary STL file, which can be much larger than available memory, and saves the result in another binary STL file
+ * \ingroup DecimateGroup
+ * \details The triangles are streamed from the input file and spilled in temporary files of spatial tiles.
+ * Each tile is decimated independently keeping the positions of the vertices near its shared boundaries,
+ * so the decimated tiles match exactly. Then the seams are decimated in the second pass with the tiles shifted on half of their size.
+ */
+MRMESH_API Expected<DecimateOutOfCoreResult> decimateBinaryStlOutOfCore( const std::filesystem::path & inFile, const std::filesystem::path & outFile,
+    const DecimateOutOfCoreSettings & settings = {} );
+
+} //namespace MR
@@ -4,28 +4,31 @@
 #include "MRTriDist.h"
 #include "MRLine3.h"
 #include "MRMeshIntersect.h"
+#include "MRMeshProject.h"
 #include "MRTimer.h"
 
 namespace MR
 {
 
-std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p, const SignedDistanceToMeshOptions& op )
+MinMaxf signedDistanceProjectionRange( const SignedDistanceToMeshOptions& op )
 {
-    assert( op.signMode != SignDetectionMode::OpenVDB );
-
-    auto minDistSq = op.minDistSq;
-    auto maxDistSq = op.maxDistSq;
     if ( !op.nullOutsideMinMax && op.signMode == SignDetectionMode::ProjectionNormal )
     {
         // if the sign is determined by the normal at projection point then projection point must be found precisely
-        minDistSq = 0;
-        maxDistSq = FLT_MAX;
+        return { 0, FLT_MAX };
     }
-    const auto proj = findProjection( p, mp, maxDistSq, nullptr, minDistSq );
+    return { op.minDistSq, op.maxDistSq };
+}
+
+std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p, const MeshProjectionResult& proj,
+    const SignedDistanceToMeshOptions& op, std::optional<bool> insideByWindingRule )
+{
+    assert( op.signMode != SignDetectionMode::OpenVDB );
+
     if ( !proj && op.signMode == SignDetectionMode::ProjectionNormal )
         return {}; // no projection point found
 
-    if ( op.nullOutsideMinMax && ( proj.distSq < minDistSq || proj.distSq >= maxDistSq ) ) // note that proj.distSq == minDistSq (e.g. == 0) is a valid situation
+    if ( op.nullOutsideMinMax && ( proj.distSq < op.minDistSq || proj.distSq >= op.maxDistSq ) ) // note that proj.distSq == minDistSq (e.g. == 0) is a valid situation
         return {}; // distance is too small or too large, discard them
 
     float dist = std::sqrt( proj.distSq );
@@ -38,10 +41,14 @@ std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p
 
     case SignDetectionMode::WindingRule:
     {
-        const Line3d ray( Vector3d( p ), Vector3d::plusX() );
-        int count = 0;
-        rayMeshIntersectAll( mp, ray, [&count] ( auto&& ) { ++count; return true; } );
-        if ( count % 2 == 1 ) // inside
+        if ( !insideByWindingRule )
+        {
+            const Line3d ray( Vector3d( p ), Vector3d::plusX() );
+            int count = 0;
+            rayMeshIntersectAll( mp, ray, [&count] ( auto&& ) { ++count; return true; } );
+            insideByWindingRule = count % 2 == 1;
+        }
+        if ( *insideByWindingRule )
             dist = -dist;
         break;
     }
@@ -57,6 +64,13 @@ std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p
     return dist;
 }
 
+std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p, const SignedDistanceToMeshOptions& op )
+{
+    assert( op.signMode != SignDetectionMode::OpenVDB );
+    const auto range = signedDistanceProjectionRange( op );
+    return signedDistanceToMesh( mp, p, findProjection( p, mp, range.max, nullptr, range.min ), op );
+}
+
 void processCloseTriangles( const MeshPart& mp, const Triangle3f & t, float rangeSq, const TriangleCallback & call )
 {
     assert( call );
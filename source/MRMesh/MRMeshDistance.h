@@ -4,6 +4,7 @@
 
 #include "MRMeshPart.h"
 #include "MRDistanceToMeshOptions.h"
+#include "MRBox.h"
 #include <functional>
 #include <optional>
 
@@ -35,6 +36,16 @@ MRMESH_API void processCloseTriangles( const MeshPart& mp, const Triangle3f & t,
 /// returns std::nullopt if distance is smaller than op.minDist or larger than op.maxDist (except for op.signMode == HoleWindingRule)
 [[nodiscard]] MRMESH_API std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p, const SignedDistanceToMeshOptions& op );
 
+/// returns the range of squared distances, where the projection of a point shall be searched
+/// to compute signed distance with given options (op)
+[[nodiscard]] MRMESH_API MinMaxf signedDistanceProjectionRange( const SignedDistanceToMeshOptions& op );
+
+/// computes signed distance from point (p) to mesh part (mp) following options (op) given already found projection (proj) of the point
+/// within the range returned by signedDistanceProjectionRange( op );
+/// \param insideByWindingRule if set then it is used in SignDetectionMode::WindingRule instead of shooting a ray from (p)
+[[nodiscard]] MRMESH_API std::optional<float> signedDistanceToMesh( const MeshPart& mp, const Vector3f& p, const MeshProjectionResult& proj,
+    const SignedDistanceToMeshOptions& op, std::optional<bool> insideByWindingRule = {} );
+
 /// \}
 
 } // namespace MR
@@ -9,6 +9,7 @@
 #include "MRMeshDelone.h"
 #include "MRHash.h"
 #include "MRMarkedContour.h"
+#include "MRFinally.h"
 #include "MRGTest.h"
 #include "MRPch/MRTBB.h"
 #include "MRPch/MRSpdlog.h"
@@ -764,6 +765,17 @@ bool isHoleBd( const MeshTopology & topology, const EdgeLoop & loop )
     return n == loop.size();
 }
 
+// updates the caches of the mesh after only new faces (with ids not less than firstNewFace) have been added to it
+static void invalidateCachesAfterNewFaces( Mesh & mesh, size_t firstNewFace, size_t firstNewVert )
+{
+    const auto fsz = mesh.topology.faceSize();
+    if ( fsz == firstNewFace )
+        return;
+    FaceBitSet newFaces( fsz );
+    newFaces.set( FaceId( firstNewFace ), fsz - firstNewFace, true );
+    mesh.invalidateCaches( newFaces, mesh.topology.vertSize() != firstNewVert );
+}
+
 void fillHole( Mesh& mesh, EdgeId a0, const FillHoleParams& params )
 {
     MR_TIMER;
@@ -787,6 +799,11 @@ void fillHole( Mesh& mesh, EdgeId a0, const FillHoleParams& params )
         return;
     }
 
+    // new faces are appended to the mesh, so aabb-tree can be updated with them incrementally
+    const auto fsz0 = mesh.topology.faceSize();
+    const auto vsz0 = mesh.topology.vertSize();
+    MR_FINALLY_ON_SUCCESS { invalidateCachesAfterNewFaces( mesh, fsz0, vsz0 ); };
+
     if ( params.makeDegenerateBand )
     {
         a = a0 = makeDegenerateBandAroundHole( mesh, a0, params.outNewFaces );
@@ -127,6 +127,7 @@ class ViewportMask;
 struct UnorientedTriangle;
 struct SomeLocalTriangulations;
 struct AllLocalTriangulations;
+struct AllPointNeighbors;
 
 using EdgePath = std::vector<EdgeId>;
 using EdgeLoop = std::vector<EdgeId>;
@@ -444,6 +445,8 @@ MR_CANONICAL_TYPEDEFS( (template <typename T, typename I> class MRMESH_CLASS), V
     ( Triangulation,  Vector<ThreeVertIds, FaceId> )
 
     ( Dipoles,  Vector<Dipole, NodeId> )
+    /// second-order terms of dipole expansions for all nodes of AABB tree (see MRDipole.h)
+    ( DipoleSecondOrders,  Vector<Matrix3f, NodeId> )
 
     ( FaceMap,  Vector<FaceId, FaceId> )
     ( VertMap,  Vector<VertId, VertId> )
@@ -525,14 +528,17 @@ using UndirectedEdgeHashMap = HashMap<UndirectedEdgeId, UndirectedEdgeId>;
 using WholeEdgeHashMap = HashMap<UndirectedEdgeId, EdgeId>;
 
 template <typename I> class UnionFind;
+template <typename I> class ConcurrentUnionFind;
 template <typename T, typename I, typename P> class Heap;
 
 class MRMESH_CLASS MeshTopology;
+class MRMESH_CLASS FrozenMeshTopology;
 struct MRMESH_CLASS Mesh;
 struct MRMESH_CLASS EdgeLengthMesh;
 class MRMESH_CLASS MeshOrPoints;
 struct MRMESH_CLASS PointCloud;
 class MRMESH_CLASS AABBTree;
+class MRMESH_CLASS AABBTreeWide;
 class MRMESH_CLASS AABBTreePoints;
 class MRMESH_CLASS AABBTreeObjects;
 struct MRMESH_CLASS CloudPartMapping;
@@ -608,6 +614,8 @@ struct Image;
 class AnyVisualizeMaskEnum;
 
 class HistoryAction;
+class SpilledMesh;
+class UniqueTemporaryFolder;
 class ChangeObjectAction;
 class MRMESH_CLASS ChangeSceneAction;
 class ChangeMeshFaceSelectionAction;
@@ -1,5 +1,6 @@
 #include "MRMeshIntersect.h"
 #include "MRAABBTree.h"
+#include "MRAABBTreeWide.h"
 #include "MRMesh.h"
 #include "MRMeshPart.h"
 #include "MRRayBoxIntersection.h"
@@ -11,8 +12,11 @@
 #include "MRMeshBuilder.h"
 #include "MRParallelFor.h"
 #include "MRBitSetParallelFor.h"
+#include "MRMortonCode.h"
 #include "MRTimer.h"
 #include "MRPch/MRSpdlog.h"
+#include "MRPch/MRTBB.h"
+#include <numeric>
 
 namespace MR
 {
@@ -118,6 +122,113 @@ MeshIntersectionResult meshRayIntersect_( const MeshPart& meshPart, const Line3<
     return res;
 }
 
+/// same as meshRayIntersect_ but traverses the wide tree with quantized boxes
+MeshIntersectionResult meshRayIntersectWide_( const MeshPart& meshPart, const AABBTreeWide& tree, const Line3f& line,
+    float rayStart, float rayEnd, const IntersectionPrecomputes<float>& prec, bool closestIntersect, const FacePredicate & validFaces )
+{
+    const auto& m = meshPart.mesh;
+    MeshIntersectionResult res;
+    if( tree.nodes().empty() )
+        return res;
+
+    const Vector3f invDir(
+        line.d.x == 0 ? FLT_MAX : 1 / line.d.x,
+        line.d.y == 0 ? FLT_MAX : 1 / line.d.y,
+        line.d.z == 0 ? FLT_MAX : 1 / line.d.z );
+
+    constexpr int W = AABBTreeWideNode::cWidth;
+    // each visited node replaces itself with at most W children, so the buffer on the stack is enough for trees of depth up to 32
+    constexpr int maxStackSize = 32 * ( W - 1 ) + 1; // to avoid allocations
+    using StackEntry = std::pair<int, float>; // child encoded as in AABBTreeWideNode::child, and entry distance
+    StackEntry localStack[maxStackSize];
+    std::vector<StackEntry> heapStack;
+    StackEntry * nodesStack = localStack;
+    const int stackCapacity = tree.maxTraversalStackSize();
+    if ( stackCapacity > maxStackSize )
+    {
+        heapStack.resize( stackCapacity );
+        nodesStack = heapStack.data();
+    }
+    int currentNode = 0;
+    nodesStack[0] = { int( tree.rootNodeId() ), rayStart };
+
+    FaceId faceId;
+    TriPointf triP;
+    while( currentNode >= 0 && ( closestIntersect || !faceId ) )
+    {
+        const auto [child, entry] = nodesStack[currentNode--];
+        if ( !( entry < rayEnd ) )
+            continue;
+
+        if ( child < 0 )
+        {
+            const FaceId face( ~child );
+            if( ( !meshPart.region || meshPart.region->test( face ) ) && ( !validFaces || validFaces( face ) ) )
+            {
+                VertId a, b, c;
+                m.topology.getTriVerts( face, a, b, c );
+                if ( auto triIsect = rayTriangleIntersect( m.points[a] - line.p, m.points[b] - line.p, m.points[c] - line.p, prec ) )
+                {
+                    if ( triIsect->t < rayEnd && triIsect->t > rayStart )
+                    {
+                        faceId = face;
+                        triP = triIsect->bary;
+                        rayEnd = triIsect->t;
+                    }
+                }
+            }
+            continue;
+        }
+
+        const auto & node = tree[NodeId( child )];
+        float min[3][W], max[3][W];
+        node.getChildBoxes( min, max );
+        float t0s[W];
+        for ( int i = 0; i < W; ++i )
+        {
+            float t0 = rayStart, t1 = rayEnd;
+            for ( int k = 0; k < 3; ++k )
+            {
+                const float a = ( min[k][i] - line.p[k] ) * invDir[k];
+                const float b = ( max[k][i] - line.p[k] ) * invDir[k];
+                t0 = std::max( t0, std::min( a, b ) );
+                t1 = std::min( t1, std::max( a, b ) );
+            }
+            t0s[i] = node.hasChild( i ) && t0 <= t1 ? t0 : FLT_MAX;
+        }
+
+        // push farther children first to visit closer ones earlier
+        int order[W] = { 0, 1, 2, 3 };
+        static_assert( W == 4 );
+        std::sort( order, order + W, [&]( int a, int b ) { return t0s[a] > t0s[b]; } );
+        for ( int i : order )
+        {
+            if ( t0s[i] == FLT_MAX )
+                continue;
+            assert( currentNode + 1 < stackCapacity );
+            nodesStack[++currentNode] = { node.child[i], t0s[i] };
+        }
+    }
+
+    if( faceId.valid() )
+    {
+        res.proj.face = faceId;
+        res.proj.point = line.p + rayEnd * line.d;
+        res.mtp = MeshTriPoint( m.topology.edgeWithLeft( faceId ), triP );
+        res.distanceAlongLine = rayEnd;
+    }
+    return res;
+}
+
+MeshIntersectionResult rayMeshIntersect( const MeshPart& meshPart, const AABBTreeWide& tree, const Line3f& line,
+    float rayStart, float rayEnd, const IntersectionPrecomputes<float>* prec, bool closestIntersect, const FacePredicate & validFaces )
+{
+    if ( prec )
+        return meshRayIntersectWide_( meshPart, tree, line, rayStart, rayEnd, *prec, closestIntersect, validFaces );
+    const IntersectionPrecomputes<float> precNew( line.d );
+    return meshRayIntersectWide_( meshPart, tree, line, rayStart, rayEnd, precNew, closestIntersect, validFaces );
+}
+
 MeshIntersectionResult rayMeshIntersect( const MeshPart& meshPart, const Line3f& line,
     float rayStart, float rayEnd, const IntersectionPrecomputes<float>* prec, bool closestIntersect, const FacePredicate & validFaces )
 {
@@ -146,18 +257,179 @@ MeshIntersectionResult rayMeshIntersect( const MeshPart& meshPart, const Line3d&
     }
 }
 
-void multiRayMeshIntersect(
+namespace
+{
+
+/// the number of rays traversing AABB tree together
+constexpr int cPacketSize = 8;
+
+/// a group of rays stored in structure of arrays layout,
+/// so that the compiler can vectorize ray-box tests over all rays of the packet
+struct alignas( 32 ) RayPacket
+{
+    float ox[cPacketSize], oy[cPacketSize], oz[cPacketSize]; // ray origins
+    float ix[cPacketSize], iy[cPacketSize], iz[cPacketSize]; // inverse ray directions
+    float tEnd[cPacketSize]; // current end of interval on each ray
+    bool active[cPacketSize] = {}; // false for unused lanes and for the rays with already found intersection in any-hit mode
+    size_t rayId[cPacketSize];
+    IntersectionPrecomputes<float> prec[cPacketSize];
+};
+
+/// intersects given box with all rays of the packet,
+/// returns true if at least one ray intersects it and fills per-ray entry distances and intersection flags
+bool packetBoxIntersect( const Box3f & box, const RayPacket & p, float tStart, float (&entry)[cPacketSize], bool (&hit)[cPacketSize] )
+{
+    bool any = false;
+    for ( int i = 0; i < cPacketSize; ++i )
+    {
+        const float x0 = ( box.min.x - p.ox[i] ) * p.ix[i], x1 = ( box.max.x - p.ox[i] ) * p.ix[i];
+        const float y0 = ( box.min.y - p.oy[i] ) * p.iy[i], y1 = ( box.max.y - p.oy[i] ) * p.iy[i];
+        const float z0 = ( box.min.z - p.oz[i] ) * p.iz[i], z1 = ( box.max.z - p.oz[i] ) * p.iz[i];
+        const float t0 = std::max( std::max( std::min( x0, x1 ), std::min( y0, y1 ) ), std::max( std::min( z0, z1 ), tStart ) );
+        const float t1 = std::min( std::min( std::max( x0, x1 ), std::max( y0, y1 ) ), std::min( std::max( z0, z1 ), p.tEnd[i] ) );
+        entry[i] = t0;
+        hit[i] = p.active[i] & ( t0 <= t1 );
+        any |= hit[i];
+    }
+    return any;
+}
+
+/// returns the smallest entry distance among the rays intersecting the box
+float minEntry( const float (&entry)[cPacketSize], const bool (&hit)[cPacketSize] )
+{
+    float res = FLT_MAX;
+    for ( int i = 0; i < cPacketSize; ++i )
+        if ( hit[i] )
+            res = std::min( res, entry[i] );
+    return res;
+}
+
+/// finds intersections of all rays in the packet with the mesh traversing AABB tree only once for the whole packet;
+/// ray-triangle tests are the same as in single-ray mode, so the results are identical
+void packetMeshIntersect( const MeshPart & meshPart, RayPacket & p, float rayStart, bool closestIntersect, const FacePredicate & validFaces,
+    const RayFacePredicate & validRayFaces, FaceId (&faces)[cPacketSize], TriPointf (&bary)[cPacketSize] )
+{
+    const auto & m = meshPart.mesh;
+    const auto & tree = m.getAABBTree();
+    if ( tree.nodes().empty() )
+        return;
+
+    struct StackEntry
+    {
+        NodeId node;
+        float entry[cPacketSize]; // the distance along each ray till node box, or FLT_MAX if the ray misses it
+    };
+    constexpr int maxTreeDepth = 32;
+    StackEntry nodesStack[maxTreeDepth];
+    int currentNode = 0;
+
+    bool hit[cPacketSize];
+    nodesStack[0].node = tree.rootNodeId();
+    if ( !packetBoxIntersect( tree[tree.rootNodeId()].box, p, rayStart, nodesStack[0].entry, hit ) )
+        return;
+    for ( int i = 0; i < cPacketSize; ++i )
+        if ( !hit[i] )
+            nodesStack[0].entry[i] = FLT_MAX;
+
+    while ( currentNode >= 0 )
+    {
+        if ( currentNode >= maxTreeDepth ) // max depth exceeded
+        {
+            spdlog::critical( "Maximal AABBTree depth reached!" );
+            assert( false );
+            break;
+        }
+
+        const auto & top = nodesStack[currentNode--];
+        bool any = false;
+        for ( int i = 0; i < cPacketSize; ++i )
+        {
+            hit[i] = p.active[i] & ( top.entry[i] < p.tEnd[i] );
+            any |= hit[i];
+        }
+        if ( !any )
+            continue;
+
+        const auto & node = tree[top.node];
+        if ( node.leaf() )
+        {
+            auto face = node.leafId();
+            if ( ( meshPart.region && !meshPart.region->test( face ) ) || ( validFaces && !validFaces( face ) ) )
+                continue;
+            VertId a, b, c;
+            m.topology.getTriVerts( face, a, b, c );
+            const auto & pA = m.points[a];
+            const auto & pB = m.points[b];
+            const auto & pC = m.points[c];
+            for ( int i = 0; i < cPacketSize; ++i )
+            {
+                if ( !hit[i] )
+                    continue;
+                if ( validRayFaces && !validRayFaces( p.rayId[i], face ) )
+                    continue;
+                const Vector3f o( p.ox[i], p.oy[i], p.oz[i] );
+                if ( auto triIsect = rayTriangleIntersect( pA - o, pB - o, pC - o, p.prec[i] ) )
+                {
+                    if ( triIsect->t < p.tEnd[i] && triIsect->t > rayStart )
+                    {
+                        faces[i] = face;
+                        bary[i] = triIsect->bary;
+                        p.tEnd[i] = triIsect->t;
+                        if ( !closestIntersect )
+                            p.active[i] = false;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // top is not used after this point, so its slot can be reused
+        StackEntry l{ node.l }, r{ node.r };
+        bool lHit[cPacketSize], rHit[cPacketSize];
+        const bool lAny = packetBoxIntersect( tree[node.l].box, p, rayStart, l.entry, lHit );
+        const bool rAny = packetBoxIntersect( tree[node.r].box, p, rayStart, r.entry, rHit );
+        for ( int i = 0; i < cPacketSize; ++i )
+        {
+            if ( !lHit[i] )
+                l.entry[i] = FLT_MAX;
+            if ( !rHit[i] )
+                r.entry[i] = FLT_MAX;
+        }
+        if ( lAny && rAny )
+        {
+            // visit first the child closer to the rays
+            if ( minEntry( l.entry, lHit ) > minEntry( r.entry, rHit ) )
+            {
+                nodesStack[++currentNode] = l;
+                nodesStack[++currentNode] = r;
+            }
+            else
+            {
+                nodesStack[++currentNode] = r;
+                nodesStack[++currentNode] = l;
+            }
+        }
+        else if ( lAny )
+            nodesStack[++currentNode] = l;
+        else if ( rAny )
+            nodesStack[++currentNode] = r;
+    }
+}
+
+/// common implementation of multiRayMeshIntersect and multiRayMeshIntersectSkipping
+void multiRayMeshIntersectImpl(
     const MeshPart& meshPart,
     const std::vector<Vector3f>& origins,
     const std::vector<Vector3f>& dirs,
     const MultiRayMeshIntersectResult& result,
     float rayStart, float rayEnd,
     bool closestIntersect,
-    const FacePredicate & validFaces
+    const FacePredicate & validFaces,
+    const RayFacePredicate & validRayFaces,
+    bool coherentPackets,
+    const std::vector<size_t> * coherentOrder
 )
 {
-    MR_TIMER;
-
     const auto sz = origins.size();
     assert( dirs.size() == sz );
     if ( result.intersectingRays )
@@ -191,11 +463,17 @@ void multiRayMeshIntersect(
 
     auto processRay = [&]( size_t i )
     {
-        auto res = rayMeshIntersect( meshPart, Line3f( origins[i], dirs[i] ), rayStart, rayEnd, nullptr, closestIntersect, validFaces );
+        FacePredicate rayFaces;
+        if ( validRayFaces )
+            rayFaces = [&validRayFaces, i]( FaceId f ) { return validRayFaces( i, f ); };
+        auto res = rayMeshIntersect( meshPart, Line3f( origins[i], dirs[i] ), rayStart, rayEnd, nullptr, closestIntersect,
+            validRayFaces ? rayFaces : validFaces );
         if ( !res )
             return;
         if ( result.intersectingRays )
             result.intersectingRays->set( i );
+        if ( result.rayParams )
+            (*result.rayParams)[i] = res.distanceAlongLine;
         if ( result.isectFaces )
             (*result.isectFaces)[i] = res.proj.face;
         if ( result.isectBary )
@@ -204,10 +482,134 @@ void multiRayMeshIntersect(
             (*result.isectPts)[i] = res.proj.point;
     };
 
+    if ( !coherentPackets )
+    {
+        if ( result.intersectingRays )
+            BitSetParallelForAll( *result.intersectingRays, processRay );
+        else
+            ParallelFor( size_t( 0 ), sz, processRay );
+        return;
+    }
+
+    std::vector<size_t> localOrder;
+    if ( !coherentOrder )
+        localOrder = getCoherentRayOrder( origins, dirs );
+    const auto & order = coherentOrder ? *coherentOrder : localOrder;
+    assert( order.size() == sz );
+    const size_t numPackets = ( sz + cPacketSize - 1 ) / cPacketSize;
+    // intersection distances are stored here even if the user did not request them, to fill intersectingRays later
+    std::vector<float> localParams;
+    auto & params = result.rayParams ? *result.rayParams : localParams;
+    if ( !result.rayParams && result.intersectingRays )
+        params.resize( sz, cQuietNan );
+
+    ParallelFor( size_t( 0 ), numPackets, [&]( size_t packetId )
+    {
+        RayPacket p;
+        const size_t first = packetId * cPacketSize;
+        const int num = int( std::min( sz - first, size_t( cPacketSize ) ) );
+        for ( int i = 0; i < num; ++i )
+        {
+            const auto rayId = order[first + i];
+            const auto & o = origins[rayId];
+            const auto & d = dirs[rayId];
+            p.ox[i] = o.x; p.oy[i] = o.y; p.oz[i] = o.z;
+            p.ix[i] = d.x == 0 ? FLT_MAX : 1 / d.x;
+            p.iy[i] = d.y == 0 ? FLT_MAX : 1 / d.y;
+            p.iz[i] = d.z == 0 ? FLT_MAX : 1 / d.z;
+            p.tEnd[i] = rayEnd;
+            p.active[i] = true;
+            p.rayId[i] = rayId;
+            p.prec[i] = IntersectionPrecomputes<float>( d );
+        }
+        for ( int i = num; i < cPacketSize; ++i )
+        {
+            // unused lanes are inactive, fill them with some finite values
+            p.ox[i] = p.oy[i] = p.oz[i] = 0;
+            p.ix[i] = p.iy[i] = p.iz[i] = 1;
+            p.tEnd[i] = rayStart;
+        }
+
+        FaceId faces[cPacketSize];
+        TriPointf bary[cPacketSize];
+        packetMeshIntersect( meshPart, p, rayStart, closestIntersect, validFaces, validRayFaces, faces, bary );
+
+        for ( int i = 0; i < num; ++i )
+        {
+            if ( !faces[i] )
+                continue;
+            const auto rayId = p.rayId[i];
+            if ( !params.empty() )
+                params[rayId] = p.tEnd[i];
+            if ( result.isectFaces )
+                (*result.isectFaces)[rayId] = faces[i];
+            if ( result.isectBary )
+                (*result.isectBary)[rayId] = bary[i];
+            if ( result.isectPts )
+                (*result.isectPts)[rayId] = origins[rayId] + p.tEnd[i] * dirs[rayId];
+        }
+    } );
+
+    // rays are processed in arbitrary order, so the bits are set in a separate pass to avoid data races
     if ( result.intersectingRays )
-        BitSetParallelForAll( *result.intersectingRays, processRay );
-    else
-        ParallelFor( size_t( 0 ), sz, processRay );
+        BitSetParallelForAll( *result.intersectingRays, [&]( size_t i )
+        {
+            if ( !std::isnan( params[i] ) )
+                result.intersectingRays->set( i );
+        } );
+}
+
+} //anonymous namespace
+
+std::vector<size_t> getCoherentRayOrder( const std::vector<Vector3f> & origins, const std::vector<Vector3f> & dirs )
+{
+    MR_TIMER;
+    auto keys = getMortonCodes( origins );
+    ParallelFor( keys, [&] ( size_t i )
+    {
+        const auto & d = dirs[i];
+        const std::uint64_t octant = ( d.x < 0 ? 1 : 0 ) | ( d.y < 0 ? 2 : 0 ) | ( d.z < 0 ? 4 : 0 );
+        keys[i] = ( octant << 60 ) | ( keys[i] >> 3 );
+    } );
+
+    std::vector<size_t> res( origins.size() );
+    std::iota( res.begin(), res.end(), size_t( 0 ) );
+    tbb::parallel_sort( res.begin(), res.end(), [&] ( size_t a, size_t b )
+    {
+        return keys[a] < keys[b];
+    } );
+    return res;
+}
+
+void multiRayMeshIntersect(
+    const MeshPart& meshPart,
+    const std::vector<Vector3f>& origins,
+    const std::vector<Vector3f>& dirs,
+    const MultiRayMeshIntersectResult& result,
+    float rayStart, float rayEnd,
+    bool closestIntersect,
+    const FacePredicate & validFaces,
+    bool coherentPackets,
+    const std::vector<size_t> * coherentOrder
+)
+{
+    MR_TIMER;
+    multiRayMeshIntersectImpl( meshPart, origins, dirs, result, rayStart, rayEnd, closestIntersect, validFaces, {}, coherentPackets, coherentOrder );
+}
+
+void multiRayMeshIntersectSkipping(
+    const MeshPart& meshPart,
+    const std::vector<Vector3f>& origins,
+    const std::vector<Vector3f>& dirs,
+    const RayFacePredicate & validRayFaces,
+    const MultiRayMeshIntersectResult& result,
+    float rayStart, float rayEnd,
+    bool closestIntersect,
+    bool coherentPackets
+)
+{
+    MR_TIMER;
+    multiRayMeshIntersectImpl( meshPart, origins, dirs, result, rayStart, rayEnd, closestIntersect, {}, validRayFaces, coherentPackets, nullptr );
 }
 
 template<typename T>
@@ -37,6 +37,11 @@ struct MeshIntersectionResult
     float rayStart = 0.0f, float rayEnd = FLT_MAX, const IntersectionPrecomputes<float>* prec = nullptr, bool closestIntersect = true,
     const FacePredicate & validFaces = {} );
 
+/// Same as above, but searches in explicitly given wide tree with quantized boxes, see Mesh::getAABBTreeWide()
+[[nodiscard]] MRMESH_API MeshIntersectionResult rayMeshIntersect( const MeshPart& meshPart, const AABBTreeWide& tree, const Line3f& line,
+    float rayStart = 0.0f, float rayEnd = FLT_MAX, const IntersectionPrecomputes<float>* prec = nullptr, bool closestIntersect = true,
+    const FacePredicate & validFaces = {} );
+
 /// Finds ray and mesh intersection in double-precision.
 /// \p rayStart and \p rayEnd define the interval on the ray to detect an intersection.
 /// \p prec can be specified to reuse some precomputations (e.g. for checking many parallel rays).
@@ -68,7 +73,32 @@ MRMESH_API void multiRayMeshIntersect(
     // advanced options:
     float rayStart = 0.0f, float rayEnd = FLT_MAX,
     bool closestIntersect = true, ///< finds the closest to ray origin intersection (or any intersection for better performance if \p !closestIntersect)
-    const FacePredicate & validFaces = {} ///< if given then all faces for which false is returned will be skipped
+    const FacePredicate & validFaces = {}, ///< if given then all faces for which false is returned will be skipped
+    bool coherentPackets = false, ///< if true then the rays are first sorted by origin location and direction octant, and then
+                                  ///< each group of 8 neighbor rays traverses AABB tree together, which is faster for many coherent rays
+    const std::vector<size_t> * coherentOrder = nullptr ///< optional order of rays for coherent packets found by getCoherentRayOrder,
+                                                         ///< which can be reused for the rays with same origins and direction octants
+);
+
+/// returns the order of rays, where the rays with close origins and same direction octant go next to each other
+[[nodiscard]] MRMESH_API std::vector<size_t> getCoherentRayOrder( const std::vector<Vector3f> & origins, const std::vector<Vector3f> & dirs );
+
+/// returns false if the ray with given index shall skip given face
+using RayFacePredicate = std::function<bool( size_t rayId, FaceId f )>;
+
+/// Same as multiRayMeshIntersect, but each ray skips its own set of faces (e.g. the faces incident to its origin),
+/// and coherent packets are used by default.
+MRMESH_API void multiRayMeshIntersectSkipping(
+    // input:
+    const MeshPart& meshPart, ///< mesh (or its part) to find intersections with
+    const std::vector<Vector3f>& origins, ///< origin point of every ray
+    const std::vector<Vector3f>& dirs,    ///< direction of every ray
+    const RayFacePredicate & validRayFaces, ///< all faces for which false is returned will be skipped by the ray
+    const MultiRayMeshIntersectResult& result, ///< output data for every ray
+    // advanced options:
+    float rayStart = 0.0f, float rayEnd = FLT_MAX,
+    bool closestIntersect = true, ///< finds the closest to ray origin intersection (or any intersection for better performance if \p !closestIntersect)
+    bool coherentPackets = true ///< see multiRayMeshIntersect
 );
 
 struct MultiMeshIntersectionResult : MeshIntersectionResult
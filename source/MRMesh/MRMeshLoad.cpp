@@ -8,6 +8,7 @@
 #include "MRIOFormatsRegistry.h"
 #include "MRStringConvert.h"
 #include "MRMeshLoadObj.h"
+#include "MRMappedMrmesh.h"
 #include "MRObjectMesh.h"
 #include "MRObjectsAccess.h"
 #include "MRColor.h"
@@ -119,11 +120,13 @@ namespace MeshLoad
 
 Expected<Mesh> fromMrmesh( const std::filesystem::path& file, const MeshLoadSettings& settings /*= {}*/ )
 {
-    std::ifstream in( file, std::ifstream::binary );
-    if ( !in )
-        return unexpected( std::string( "Cannot open file for reading " ) + utf8string( file ) );
+    MR_TIMER;
+    // mapping of the file avoids intermediate stream buffers and allows copying of all arrays in parallel
+    auto mapped = MappedMrmesh::open( file );
+    if ( !mapped )
+        return unexpected( std::move( mapped.error() ) );
 
-    return addFileNameInError( fromMrmesh( in, settings ), file );
+    return addFileNameInError( mapped->toMesh( settings.callback ), file );
 }
 
 Expected<Mesh> fromMrmesh( std::istream& in, const MeshLoadSettings& settings /*= {}*/ )
@@ -372,9 +375,6 @@ Expected<Mesh> fromBinaryStl( std::istream& in, const MeshLoadSettings& settings
     if ( streamSize < 50 * std::istream::pos_type( numTris ) )
         return unexpected( std::string( "Binary STL-file is too short" ) );
 
-    MeshBuilder::VertexIdentifier vi;
-    vi.reserve( numTris );
-
     #pragma pack(push, 1)
     struct StlTriangle
     {
@@ -385,68 +385,93 @@ Expected<Mesh> fromBinaryStl( std::istream& in, const MeshLoadSettings& settings
     #pragma pack(pop)
     static_assert( sizeof( StlTriangle ) == 50, "check your padding" );
 
-    const auto itemsInBuffer = std::min( numTris, 32768u );
-    std::vector<StlTriangle> buffer( itemsInBuffer ), nextBuffer( itemsInBuffer );
-    std::vector<Triangle3f> chunk( itemsInBuffer );
-
-    // first chunk
-    in.read( (char*)buffer.data(), sizeof(StlTriangle) * itemsInBuffer );
-    if ( !in  )
-        return unexpected( std::string( "Binary STL read error" ) );
-
-    size_t decodedBytes = 0;
+    // in out-of-core mode, the triangles are spilled in temporary files instead of filling a hash map
+    const bool outOfCore = settings.memoryBudget > 0 && size_t( numTris ) * sizeof( Triangle3f ) > settings.memoryBudget;
     // 0.5 because fromTrianglesDuplicatingNonManifoldVertices takes at least half of time
-    const float rStreamSize = 0.5f * sizeof( StlTriangle ) / float( streamSize );
+    const float readPart = outOfCore ? 0.3f : 0.5f;
 
-    while ( !buffer.empty() )
+    // reads all triangles from the stream and passes them to addChunk by portions
+    auto readTriangles = [&] ( const auto & addChunk ) -> Expected<void>
     {
-        // decode previously read buffer in a worked thread
-        tbb::task_group taskGroup;
-        taskGroup.run( [&chunk, &vi, &buffer] ()
-        {
-            chunk.resize( buffer.size() );
-            for ( int i = 0; i < buffer.size(); ++i )
-                for ( int j = 0; j < 3; ++j )
-                    chunk[i][j] = buffer[i].vert[j];
-            vi.addTriangles( chunk );
-        } );
-
-        if ( vi.numTris() + buffer.size() < numTris )
+        const auto itemsInBuffer = std::min( numTris, 32768u );
+        std::vector<StlTriangle> buffer( itemsInBuffer ), nextBuffer( itemsInBuffer );
+        std::vector<Triangle3f> chunk( itemsInBuffer );
+
+        // first chunk
+        in.read( (char*)buffer.data(), sizeof(StlTriangle) * itemsInBuffer );
+        if ( !in  )
+            return unexpected( std::string( "Binary STL read error" ) );
+
+        size_t decodedTris = 0;
+        const float rNumTris = readPart / float( std::max( numTris, 1u ) );
+
+        while ( !buffer.empty() )
         {
-            const auto itemsInNextChuck = std::min( numTris - (std::uint32_t)( vi.numTris() + buffer.size() ), itemsInBuffer );
-            nextBuffer.resize( itemsInNextChuck );
-            const size_t size = sizeof( StlTriangle ) * nextBuffer.size();
-            // read from stream in the current thread to be compatible with PythonIstreamBuf
-            in.read( ( char* )nextBuffer.data(), size );
-        }
-        else
-            nextBuffer.clear();
+            // decode previously read buffer in a worked thread
+            Expected<void> added;
+            tbb::task_group taskGroup;
+            taskGroup.run( [&chunk, &buffer, &addChunk, &added] ()
+            {
+                chunk.resize( buffer.size() );
+                for ( int i = 0; i < buffer.size(); ++i )
+                    for ( int j = 0; j < 3; ++j )
+                        chunk[i][j] = buffer[i].vert[j];
+                added = addChunk( chunk );
+            } );
+
+            if ( decodedTris + buffer.size() < numTris )
+            {
+                const auto itemsInNextChuck = std::min( numTris - (std::uint32_t)( decodedTris + buffer.size() ), itemsInBuffer );
+                nextBuffer.resize( itemsInNextChuck );
+                const size_t size = sizeof( StlTriangle ) * nextBuffer.size();
+                // read from stream in the current thread to be compatible with PythonIstreamBuf
+                in.read( ( char* )nextBuffer.data(), size );
+            }
+            else
+                nextBuffer.clear();
 
-        taskGroup.wait();
-        decodedBytes += buffer.size();
+            taskGroup.wait();
+            if ( !added )
+                return added;
+            decodedTris += buffer.size();
 
-        if ( !reportProgress( settings.callback , decodedBytes * rStreamSize ) )
-            return unexpectedOperationCanceled();
-        if ( !in )
-            return unexpected( std::string( "Binary STL read error" ) );
-        buffer.swap( nextBuffer );
-    }
+            if ( !reportProgress( settings.callback, decodedTris * rNumTris ) )
+                return unexpectedOperationCanceled();
+            if ( !in )
+                return unexpected( std::string( "Binary STL read error" ) );
+            buffer.swap( nextBuffer );
+        }
+        return {};
+    };
 
-//     #pragma warning(disable: 4244)
-//     std::cout <<
-//         "tris = " << numTris << "\n"
-//         "verts = " << hmap.size() << "\n"
-//         "bucket_count = " << hmap.bucket_count() << "\n"
-//         "subcnt = " << hmap.subcnt() << "\n"
-//         "load_factor = " << hmap.load_factor() << "\n"
-//         "max_load_factor = " << hmap.max_load_factor() << "\n";
+    // the identifiers are destroyed before mesh creation to release their temporary memory
+    Triangulation t;
+    VertCoords points;
+    if ( outOfCore )
+    {
+        MeshBuilder::OutOfCoreVertexIdentifier vi( numTris, settings.memoryBudget );
+        if ( auto r = readTriangles( [&vi] ( const std::vector<Triangle3f> & chunk ) { return vi.addTriangles( chunk ); } ); !r )
+            return unexpected( std::move( r.error() ) );
+        if ( auto r = vi.finish( subprogress( settings.callback, readPart, 0.5f ) ); !r )
+            return unexpected( std::move( r.error() ) );
+        t = vi.takeTriangulation();
+        points = vi.takePoints();
+    }
+    else
+    {
+        MeshBuilder::VertexIdentifier vi;
+        vi.reserve( numTris );
+        if ( auto r = readTriangles( [&vi] ( const std::vector<Triangle3f> & chunk ) { vi.addTriangles( chunk ); return Expected<void>{}; } ); !r )
+            return unexpected( std::move( r.error() ) );
+        t = vi.takeTriangulation();
+        points = vi.takePoints();
+    }
 
-    auto t = vi.takeTriangulation();
     std::vector<MeshBuilder::VertDuplication> dups;
     std::vector<MeshBuilder::VertDuplication>* dupsPtr = nullptr;
     if ( settings.duplicatedVertexCount )
         dupsPtr = &dups;
-    const auto res = Mesh::fromTrianglesDuplicatingNonManifoldVertices( vi.takePoints(), t, dupsPtr, { .skippedFaceCount = settings.skippedFaceCount } );
+    const auto res = Mesh::fromTrianglesDuplicatingNonManifoldVertices( std::move( points ), t, dupsPtr, { .skippedFaceCount = settings.skippedFaceCount } );
     if ( settings.duplicatedVertexCount )
         *settings.duplicatedVertexCount = int( dups.size() );
     if ( !reportProgress( settings.callback , 1.0f ) )
@@ -563,9 +588,8 @@ Expected<Mesh> fromPly( std::istream& in, const MeshLoadSettings& settings /*= {
         return unexpected( std::string( "PLY file open error" ) );
 
     uint32_t indecies[3];
-    bool gotVerts = false, gotFaces = false;
+    bool gotVerts = false, gotFaces = false, gotColors = false;
 
-    std::vector<unsigned char> colorsBuffer;
     Mesh res;
     const auto posEnd = reader.get_end_pos();
     const float streamSize = float( posEnd - posStart );
@@ -592,8 +616,12 @@ Expected<Mesh> fromPly( std::istream& in, const MeshLoadSettings& settings /*= {
             if ( settings.colors && reader.find_color( indecies ) )
             {
                 Timer t( "extractColors" );
-                colorsBuffer.resize( 3 * numVerts );
-                reader.extract_properties( indecies, 3, miniply::PLYPropertyType::UChar, colorsBuffer.data() );
+                // extract red, green and blue directly in colors leaving alpha components intact
+                static_assert( sizeof( Color ) == 4 );
+                settings.colors->clear();
+                settings.colors->resize( numVerts );
+                reader.extract_properties_with_stride( indecies, 3, miniply::PLYPropertyType::UChar, settings.colors->data(), sizeof( Color ) );
+                gotColors = true;
             }
             const float progress = float( in.tellg() - posStart ) / streamSize;
             if ( !reportProgress( settings.callback, progress ) )
@@ -653,15 +681,8 @@ Expected<Mesh> fromPly( std::istream& in, const MeshLoadSettings& settings /*= {
     if ( !gotVerts )
         return unexpected( std::string( "PLY file does not contain vertices" ) );
 
-    if ( settings.colors && !colorsBuffer.empty() )
-    {
+    if ( gotColors )
         settings.colors->resize( res.points.size() );
-        for ( VertId i{ 0 }; i < res.points.size(); ++i )
-        {
-            int ind = 3 * i;
-            ( *settings.colors )[i] = Color( colorsBuffer[ind], colorsBuffer[ind + 1], colorsBuffer[ind + 2] );
-        }
-    }
 
     return res;
 }
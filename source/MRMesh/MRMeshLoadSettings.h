@@ -16,6 +16,9 @@ struct MeshLoadSettings
     int* duplicatedVertexCount = nullptr; ///< optional output: counter of duplicated vertices (that created for resolve non-manifold geometry)
     AffineXf3f* xf = nullptr;        ///< optional output: transform for the loaded mesh to improve precision of vertex coordinates
     ProgressCallback callback;       ///< callback for set progress and stop process
+    /// if not zero, then the loaders supporting it (binary STL) limit the size of temporary data by about this number of bytes,
+    /// spilling the rest in temporary files; the memory for resulting mesh is not counted here
+    size_t memoryBudget = 0;
 };
 
 } //namespace MR
@@ -4,6 +4,7 @@
 #include "MRBox.h"
 #include "MRGridSampling.h"
 #include "MRMeshProject.h"
+#include "MRRingIterator.h"
 #include "MRPointsProject.h"
 #include "MRObjectMesh.h"
 #include "MRObjectPoints.h"
@@ -122,8 +123,25 @@ auto MeshOrPoints::limitedProjector() const -> LimitedProjectorFunc
         {
             return [&mp]( const Vector3f & p, ProjectionResult & res )
             {
-                MeshProjectionResult mpr = findProjection( p, mp, res.distSq );
-                if ( mpr.distSq < res.distSq )
+                const auto & topology = mp.mesh.topology;
+                MeshProjectionResult warm{ .distSq = res.distSq };
+                if ( res.closestVert && topology.hasVert( res.closestVert ) )
+                {
+                    // the triangles around previous closest vertex give a tight upper bound of the distance
+                    for ( EdgeId e : orgRing( topology, res.closestVert ) )
+                    {
+                        const auto f = topology.left( e );
+                        if ( !f || ( mp.region && !mp.region->test( f ) ) )
+                            continue;
+                        const auto candidate = projectOnFace( p, mp.mesh, f );
+                        if ( candidate.distSq < warm.distSq )
+                            warm = candidate;
+                    }
+                }
+                MeshProjectionResult mpr = findProjection( p, mp, warm.distSq );
+                if ( !mpr )
+                    mpr = warm; // nothing is strictly closer than the triangles around previous closest vertex
+                if ( mpr && mpr.distSq < res.distSq )
                     res = ProjectionResult
                     {
                         .point = mpr.proj.point,
@@ -85,7 +85,9 @@ public:
 
     using LimitedProjectorFunc = std::function<void( const Vector3f& p, ProjectionResult& res )>;
     /// returns a function that updates projection (closest) points on this,
-    /// the update takes place only if res.distSq on input is more than squared distance to the closest point
+    /// the update takes place only if res.distSq on input is more than squared distance to the closest point;
+    /// if res.closestVert is valid on input (e.g. found for a close point before), then for meshes
+    /// the triangles around it are checked first to narrow the search
     [[nodiscard]] MRMESH_API LimitedProjectorFunc limitedProjector() const;
 
 private:
@@ -1,14 +1,42 @@
 #include "MRMeshProject.h"
 #include "MRAABBTree.h"
+#include "MRAABBTreeWide.h"
 #include "MRMesh.h"
 #include "MRClosestPointInTriangle.h"
 #include "MRBall.h"
+#include "MRMortonCode.h"
+#include "MRChunkIterator.h"
+#include "MRParallelFor.h"
+#include "MRMakeSphereMesh.h"
 #include "MRTimer.h"
 #include "MRMatrix3Decompose.h"
+#include "MRGTest.h"
 
 namespace MR
 {
 
+MeshProjectionResult projectOnFace( const Vector3f & pt, const Mesh & mesh, FaceId face, const AffineXf3f * xf )
+{
+    Vector3f a, b, c;
+    mesh.getTriPoints( face, a, b, c );
+    if ( xf )
+    {
+        a = (*xf)( a );
+        b = (*xf)( b );
+        c = (*xf)( c );
+    }
+
+    // compute the closest point in double-precision, because float might be not enough
+    const auto [projD, baryD] = closestPointInTriangle( Vector3d( pt ), Vector3d( a ), Vector3d( b ), Vector3d( c ) );
+    const Vector3f proj( projD );
+    return
+    {
+        .proj = PointOnFace{ face, proj },
+        .mtp = MeshTriPoint{ mesh.topology.edgeWithLeft( face ), TriPointf( baryD ) },
+        .distSq = ( proj - pt ).lengthSq()
+    };
+}
+
 MeshProjectionResult findProjectionSubtree( const Vector3f & pt, const MeshPart & mp, const AABBTree & tree, float upDistLimitSq, const AffineXf3f * xf, float loDistLimitSq,
     const FacePredicate & validFaces, const std::function<bool(const MeshProjectionResult&)> & validProjections )
 {
@@ -61,24 +89,7 @@ MeshProjectionResult findProjectionSubtree( const Vector3f & pt, const MeshPart
                 continue;
             if ( mp.region && !mp.region->test( face ) )
                 continue;
-            Vector3f a, b, c;
-            mp.mesh.getTriPoints( face, a, b, c );
-            if ( xf )
-            {
-                a = (*xf)( a );
-                b = (*xf)( b );
-                c = (*xf)( c );
-            }
-            
-            // compute the closest point in double-precision, because float might be not enough
-            const auto [projD, baryD] = closestPointInTriangle( Vector3d( pt ), Vector3d( a ), Vector3d( b ), Vector3d( c ) );
-            const Vector3f proj( projD );
-            const MeshProjectionResult candidate
-            {
-                .proj = PointOnFace{ face, proj },
-                .mtp = MeshTriPoint{ mp.mesh.topology.edgeWithLeft( face ), TriPointf( baryD ) },
-                .distSq = ( proj - pt ).lengthSq()
-            };
+            const auto candidate = projectOnFace( pt, mp.mesh, face, xf );
             if ( validProjections && !validProjections( candidate ) )
                 continue;
             if ( candidate.distSq < res.distSq )
@@ -108,6 +119,100 @@ MeshProjectionResult findProjectionSubtree( const Vector3f & pt, const MeshPart
     return res;
 }
 
+MeshProjectionResult findProjectionSubtree( const Vector3f & pt, const MeshPart & mp, const AABBTreeWide & tree, float upDistLimitSq, const AffineXf3f * xf, float loDistLimitSq,
+    const FacePredicate & validFaces, const std::function<bool(const MeshProjectionResult&)> & validProjections )
+{
+    MeshProjectionResult res;
+    res.distSq = upDistLimitSq;
+    if ( tree.nodes().empty() )
+        return res;
+
+    constexpr int W = AABBTreeWideNode::cWidth;
+    struct SubTask
+    {
+        int child; ///< encoded as in AABBTreeWideNode::child
+        float distSq;
+    };
+
+    // each visited node replaces itself with at most W children, so the buffer on the stack is enough for trees of depth up to 32
+    constexpr int MaxStackSize = 32 * ( W - 1 ) + 1; // to avoid allocations
+    SubTask localSubtasks[MaxStackSize];
+    std::vector<SubTask> heapSubtasks;
+    SubTask * subtasks = localSubtasks;
+    const int stackCapacity = tree.maxTraversalStackSize();
+    if ( stackCapacity > MaxStackSize )
+    {
+        heapSubtasks.resize( stackCapacity );
+        subtasks = heapSubtasks.data();
+    }
+    int stackSize = 0;
+    subtasks[stackSize++] = { int( tree.rootNodeId() ), 0.0f };
+
+    while( stackSize > 0 )
+    {
+        const auto s = subtasks[--stackSize];
+        if ( s.distSq >= res.distSq )
+            continue;
+
+        if ( s.child < 0 )
+        {
+            const FaceId face( ~s.child );
+            if ( validFaces && !validFaces( face ) )
+                continue;
+            if ( mp.region && !mp.region->test( face ) )
+                continue;
+            const auto candidate = projectOnFace( pt, mp.mesh, face, xf );
+            if ( validProjections && !validProjections( candidate ) )
+                continue;
+            if ( candidate.distSq < res.distSq )
+            {
+                res = candidate;
+                if ( res.distSq <= loDistLimitSq )
+                    break;
+            }
+            continue;
+        }
+
+        const auto & node = tree[NodeId( s.child )];
+        float distSq[W];
+        if ( xf )
+        {
+            for ( int i = 0; i < W; ++i )
+                distSq[i] = node.hasChild( i ) ? transformed( node.childBox( i ), *xf ).getDistanceSq( pt ) : FLT_MAX;
+        }
+        else
+        {
+            float min[3][W], max[3][W];
+            node.getChildBoxes( min, max );
+            for ( int i = 0; i < W; ++i )
+            {
+                float d = 0;
+                for ( int k = 0; k < 3; ++k )
+                {
+                    const float dk = std::max( { min[k][i] - pt[k], 0.0f, pt[k] - max[k][i] } );
+                    d += dk * dk;
+                }
+                distSq[i] = node.hasChild( i ) ? d : FLT_MAX;
+            }
+        }
+
+        // add children with smaller distance last to descend there first
+        int order[W] = { 0, 1, 2, 3 };
+        static_assert( W == 4 );
+        std::sort( order, order + W, [&]( int a, int b ) { return distSq[a] > distSq[b]; } );
+        for ( int i : order )
+        {
+            if ( distSq[i] < res.distSq )
+            {
+                assert( stackSize < stackCapacity );
+                subtasks[stackSize++] = { node.child[i], distSq[i] };
+            }
+        }
+    }
+
+    return res;
+}
+
 MeshProjectionTransforms createProjectionTransforms( AffineXf3f& storageXf, const AffineXf3f* pointXf, const AffineXf3f* treeXf )
 {
     MeshProjectionTransforms res;
@@ -132,6 +237,59 @@ MeshProjectionResult findProjection( const Vector3f & pt, const MeshPart & mp, f
     return findProjectionSubtree( pt, mp, mp.mesh.getAABBTree(), upDistLimitSq, xf, loDistLimitSq, validFaces, validProjections );
 }
 
+std::vector<MeshProjectionResult> findProjections( const std::vector<Vector3f> & pts, const MeshPart & mp,
+    float upDistLimitSq, const MeshProjectionTransforms & xfs, float loDistLimitSq, const FacePredicate & validFaces, const AABBTreeWide * wideTree )
+{
+    MR_TIMER;
+    std::vector<MeshProjectionResult> res( pts.size() );
+    if ( pts.empty() )
+        return res;
+
+    const AABBTree * tree = wideTree ? nullptr : &mp.mesh.getAABBTree();
+    auto findProj = [&]( const Vector3f & pt, float upLimitSq )
+    {
+        if ( wideTree )
+            return findProjectionSubtree( pt, mp, *wideTree, upLimitSq, xfs.nonRigidXfTree, loDistLimitSq, validFaces );
+        return findProjectionSubtree( pt, mp, *tree, upLimitSq, xfs.nonRigidXfTree, loDistLimitSq, validFaces );
+    };
+
+    // rigid transformation of the points does not change their spatial order
+    const auto order = getMortonOrder( pts );
+    constexpr size_t cChunkSize = 256; // the number of consecutive queries processed by one thread
+    ParallelFor( size_t( 0 ), chunkCount( pts.size(), cChunkSize ), [&] ( size_t chunk )
+    {
+        FaceId prevFace;
+        const auto end = std::min( ( chunk + 1 ) * cChunkSize, pts.size() );
+        for ( auto j = chunk * cChunkSize; j < end; ++j )
+        {
+            const auto i = order[j];
+            const auto pt = xfs.rigidXfPoint ? ( *xfs.rigidXfPoint )( pts[i] ) : pts[i];
+            auto & r = res[i];
+            if ( prevFace )
+            {
+                // the triangle of the previous close point gives an upper bound of the distance
+                const auto warm = projectOnFace( pt, mp.mesh, prevFace, xfs.nonRigidXfTree );
+                if ( warm.distSq < upDistLimitSq )
+                {
+                    if ( warm.distSq > loDistLimitSq )
+                    {
+                        r = findProj( pt, warm.distSq );
+                        if ( !r )
+                            r = warm; // nothing is strictly closer than the triangle of previous point
+                    }
+                    else
+                        r = warm;
+                    prevFace = r.proj.face;
+                    continue;
+                }
+            }
+            r = findProj( pt, upDistLimitSq );
+            prevFace = r.proj.face;
+        }
+    } );
+    return res;
+}
+
 void findBoxedTrisInBall( const MeshPart & mp, Ball3f ball, const FoundBoxedTriCallback& foundCallback )
 {
     const auto & tree = mp.mesh.getAABBTree();
@@ -228,4 +386,33 @@ std::optional<SignedDistanceToMeshResult> findSignedDistance( const Vector3f & p
     return res;
 }
 
+TEST( MRMesh, FindProjections )
+{
+    const Mesh sphere = makeUVSphere( 1, 32, 32 );
+    std::vector<Vector3f> pts;
+    for ( int x = -4; x <= 4; ++x )
+        for ( int y = -4; y <= 4; ++y )
+            for ( int z = -4; z <= 4; ++z )
+                pts.emplace_back( 0.4f * x, 0.4f * y, 0.4f * z );
+
+    const auto check = [&] ( float upDistLimitSq, const MeshProjectionTransforms & xfs )
+    {
+        const auto res = findProjections( pts, sphere, upDistLimitSq, xfs );
+        ASSERT_EQ( res.size(), pts.size() );
+        for ( size_t i = 0; i < pts.size(); ++i )
+        {
+            const auto pt = xfs.rigidXfPoint ? ( *xfs.rigidXfPoint )( pts[i] ) : pts[i];
+            const auto ref = findProjection( pt, sphere, upDistLimitSq, xfs.nonRigidXfTree );
+            EXPECT_EQ( bool( ref ), bool( res[i] ) );
+            EXPECT_NEAR( ref.distSq, res[i].distSq, 1e-6f );
+        }
+    };
+    check( FLT_MAX, {} );
+    check( 0.25f, {} );
+
+    const auto shift = AffineXf3f::translation( Vector3f( 0.1f, 0.2f, 0.3f ) );
+    const auto scale = AffineXf3f::linear( Matrix3f::scale( 2.0f ) );
+    check( FLT_MAX, { .rigidXfPoint = &shift, .nonRigidXfTree = &scale } );
+}
+
 } //namespace MR
@@ -45,6 +45,10 @@ struct MeshProjectionTransforms
 /// <returns>structure with simplified transforms</returns>
 MRMESH_API MeshProjectionTransforms createProjectionTransforms( AffineXf3f& storageXf, const AffineXf3f* pointXf, const AffineXf3f* treeXf );
 
+/// computes the closest point to given one on the triangle of given face
+/// \param xf mesh-to-point transformation, if not specified then identity transformation is assumed
+[[nodiscard]] MRMESH_API MeshProjectionResult projectOnFace( const Vector3f & pt, const Mesh & mesh, FaceId face, const AffineXf3f * xf = nullptr );
+
 /**
  * \brief computes the closest point on mesh (or its region) to given point
  * \param upDistLimitSq upper limit on the distance in question, if the real distance is larger than the function exits returning upDistLimitSq and no valid point
@@ -77,6 +81,31 @@ MRMESH_API MeshProjectionTransforms createProjectionTransforms( AffineXf3f& stor
     const FacePredicate & validFaces = {},
     const std::function<bool(const MeshProjectionResult&)> & validProjections = {} );
 
+/// same as above, but searches in the wide tree with quantized boxes, see Mesh::getAABBTreeWide()
+[[nodiscard]] MRMESH_API MeshProjectionResult findProjectionSubtree( const Vector3f & pt,
+    const MeshPart & mp, const AABBTreeWide & tree,
+    float upDistLimitSq = FLT_MAX,
+    const AffineXf3f * xf = nullptr,
+    float loDistLimitSq = 0,
+    const FacePredicate & validFaces = {},
+    const std::function<bool(const MeshProjectionResult&)> & validProjections = {} );
+
+/**
+ * \brief computes the closest points on mesh (or its region) to all given points
+ * \details the points are processed in parallel threads in the order of their Morton codes, so that consecutive queries in one thread are spatially close,
+ * and the projection of each point on the triangle found for the previous point limits the search of its projection;
+ * it is several times faster than independent calls of findProjection for dense query sets like voxel grids
+ * \param xfs rigidXfPoint is applied to the points, nonRigidXfTree is applied to the mesh
+ * \param upDistLimitSq, loDistLimitSq, validFaces same as in findProjection
+ * \param wideTree if given then the search is done in this tree (see Mesh::getAABBTreeWide()) instead of usual AABBTree of the mesh
+ */
+[[nodiscard]] MRMESH_API std::vector<MeshProjectionResult> findProjections( const std::vector<Vector3f> & pts, const MeshPart & mp,
+    float upDistLimitSq = FLT_MAX,
+    const MeshProjectionTransforms & xfs = {},
+    float loDistLimitSq = 0,
+    const FacePredicate & validFaces = {},
+    const AABBTreeWide * wideTree = nullptr );
+
 /// this callback is invoked on every triangle with bounding box at least partially in the ball (the triangle itself can be fully out of ball),
 /// and allows changing (shrinking only) the ball
 using FoundBoxedTriCallback = std::function<Processing( FaceId found, Ball3f & ball )>;
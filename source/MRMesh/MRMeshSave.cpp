@@ -6,6 +6,7 @@
 #include "MRStringConvert.h"
 #include "MRProgressReadWrite.h"
 #include "MRBitSetParallelFor.h"
+#include "MRParallelFor.h"
 #include "MRPch/MRFmt.h"
 #include "MRMeshTexture.h"
 #include "MRImageSave.h"
@@ -359,6 +360,66 @@ Expected<void> toAsciiStl( const Mesh& mesh, std::ostream& out, const SaveSettin
     return {};
 }
 
+/// writes fixed-size binary records of all elements with ids from 0 to (numIds-1), or only of the elements from (onlyIds) if it is given;
+/// the records are prepared in parallel in memory by big portions, which are written in the stream sequentially
+template<typename T, typename F>
+static bool writeRecordsParallel( std::ostream & out, size_t numIds, const TaggedBitSet<T> * onlyIds, size_t recordSize, F && writeRecord, const ProgressCallback & cb )
+{
+    MR_TIMER;
+    constexpr size_t cBlockSize = 1 << 14;
+    constexpr size_t cBlocksInPortion = 64;
+    const size_t numBlocks = ( numIds + cBlockSize - 1 ) / cBlockSize;
+
+    std::vector<size_t> blockFirstRecord( cBlocksInPortion + 1 );
+    std::vector<char> buf;
+    for ( size_t portionBegin = 0; portionBegin < numBlocks; portionBegin += cBlocksInPortion )
+    {
+        const size_t portionBlocks = std::min( cBlocksInPortion, numBlocks - portionBegin );
+        auto blockIds = [&] ( size_t i )
+        {
+            const size_t begin = ( portionBegin + i ) * cBlockSize;
+            return std::make_pair( begin, std::min( begin + cBlockSize, numIds ) );
+        };
+
+        // count the records in each block to know where it starts in the buffer
+        ParallelFor( size_t( 0 ), portionBlocks, [&] ( size_t i )
+        {
+            const auto [begin, end] = blockIds( i );
+            size_t numRecords = end - begin;
+            if ( onlyIds )
+            {
+                numRecords = 0;
+                for ( auto id = begin; id < end; ++id )
+                    if ( onlyIds->test( Id<T>( id ) ) )
+                        ++numRecords;
+            }
+            blockFirstRecord[i + 1] = numRecords;
+        } );
+        blockFirstRecord[0] = 0;
+        for ( size_t i = 0; i < portionBlocks; ++i )
+            blockFirstRecord[i + 1] += blockFirstRecord[i];
+
+        buf.resize( blockFirstRecord[portionBlocks] * recordSize );
+        ParallelFor( size_t( 0 ), portionBlocks, [&] ( size_t i )
+        {
+            const auto [begin, end] = blockIds( i );
+            char * dst = buf.data() + blockFirstRecord[i] * recordSize;
+            for ( auto id = begin; id < end; ++id )
+            {
+                if ( onlyIds && !onlyIds->test( Id<T>( id ) ) )
+                    continue;
+                writeRecord( Id<T>( id ), dst );
+                dst += recordSize;
+            }
+        } );
+
+        out.write( buf.data(), buf.size() );
+        if ( !reportProgress( cb, float( portionBegin + portionBlocks ) / numBlocks ) )
+            return false;
+    }
+    return true;
+}
+
 Expected<void> toPly( const Mesh & mesh, const std::filesystem::path & file, const SaveSettings & settings )
 {
     std::ofstream out( file, std::ofstream::binary );
@@ -396,23 +457,20 @@ Expected<void> toPly( const Mesh & mesh, std::ostream & out, const SaveSettings
     static_assert( sizeof( PlyColor ) == 3, "check your padding" );
 
     // write vertices
-    int numSaved = 0;
-    for ( VertId i{ 0 }; i <= lastVertId; ++i )
-    {
-        if ( settings.saveValidOnly && !mesh.topology.hasVert( i ) )
-            continue;
-        const Vector3f p = applyFloat( settings.xf, mesh.points[i] );
-        out.write( ( const char* )&p, 12 );
-        if ( settings.colors )
+    const size_t vertRecordSize = saveColors ? 15 : 12;
+    if ( !writeRecordsParallel( out, lastVertId + 1, settings.saveValidOnly ? &mesh.topology.getValidVerts() : nullptr, vertRecordSize,
+        [&] ( VertId v, char * dst )
         {
-            const auto c = ( *settings.colors )[i];
-            PlyColor pc{ .r = c.r, .g = c.g, .b = c.b };
-            out.write( ( const char* )&pc, 3 );
-        }
-        ++numSaved;
-        if ( settings.progress && !( numSaved & 0x3FF ) && !settings.progress( float( numSaved ) / numPoints * 0.5f ) )
-            return unexpectedOperationCanceled();
-    }
+            const Vector3f p = applyFloat( settings.xf, mesh.points[v] );
+            std::memcpy( dst, &p, 12 );
+            if ( saveColors )
+            {
+                const auto c = ( *settings.colors )[v];
+                const PlyColor pc{ .r = c.r, .g = c.g, .b = c.b };
+                std::memcpy( dst + 12, &pc, 3 );
+            }
+        }, subprogress( settings.progress, 0.0f, 0.5f ) ) )
+        return unexpectedOperationCanceled();
 
     // write triangles
     #pragma pack(push, 1)
@@ -424,26 +482,22 @@ Expected<void> toPly( const Mesh & mesh, std::ostream & out, const SaveSettings
     #pragma pack(pop)
     static_assert( sizeof( PlyTriangle ) == 13, "check your padding" );
 
-    PlyTriangle tri;
-    int savedFaces = 0;
-    for ( FaceId f{0}; f <= fLast; ++f )
-    {
-        if ( mesh.topology.hasFace( f ) )
+    if ( !writeRecordsParallel( out, fLast + 1, settings.rearrangeTriangles ? &mesh.topology.getValidFaces() : nullptr, sizeof( PlyTriangle ),
+        [&] ( FaceId f, char * dst )
         {
-            VertId vs[3];
-            mesh.topology.getTriVerts( f, vs );
-            for ( int i = 0; i < 3; ++i )
-                tri.v[i] = vertRenumber( vs[i] );
-        }
-        else if ( !settings.rearrangeTriangles )
-            tri.v[0] = tri.v[1] = tri.v[2] = 0;
-        else
-            continue;
-        out.write( (const char *)&tri, sizeof( PlyTriangle ) );
-        ++savedFaces;
-        if ( settings.progress && !( savedFaces & 0x3FF ) && !settings.progress( float( savedFaces ) / numSaveFaces * 0.5f + 0.5f ) )
-            return unexpectedOperationCanceled();
-    }
+            PlyTriangle tri;
+            if ( mesh.topology.hasFace( f ) )
+            {
+                VertId vs[3];
+                mesh.topology.getTriVerts( f, vs );
+                for ( int i = 0; i < 3; ++i )
+                    tri.v[i] = vertRenumber( vs[i] );
+            }
+            else
+                tri.v[0] = tri.v[1] = tri.v[2] = 0;
+            std::memcpy( dst, &tri, sizeof( PlyTriangle ) );
+        }, subprogress( settings.progress, 0.5f, 1.0f ) ) )
+        return unexpectedOperationCanceled();
 
     if ( !out )
         return unexpected( std::string( "Error saving in PLY-format" ) );
@@ -15,6 +15,7 @@
 #include "MRBuffer.h"
 #include "MRObjectMesh.h"
 #include "MRMeshSubdivideCallbacks.h"
+#include "MRFinally.h"
 #include <queue>
 
 namespace MR
@@ -106,6 +107,19 @@ int subdivideMesh( Mesh & mesh, const SubdivideSettings & settings )
 
     MR_WRITER( mesh );
 
+    // every face changed by a split or a following flip is incident to the new vertex afterwards,
+    // so aabb-tree can be updated incrementally with the faces around all new vertices
+    const auto vsz0 = mesh.topology.vertSize();
+    MR_FINALLY_ON_SUCCESS
+    {
+        FaceBitSet changedFaces( mesh.topology.faceSize() );
+        for ( auto v = VertId( vsz0 ); v < mesh.topology.vertSize(); ++v )
+            for ( auto e : orgRing( mesh.topology, v ) )
+                if ( auto f = mesh.topology.left( e ) )
+                    changedFaces.set( f );
+        mesh.invalidateCaches( changedFaces );
+    };
+
     int splitsDone = 0;
     int lastProgressSplitsDone = 0;
     VertBitSet newVerts;
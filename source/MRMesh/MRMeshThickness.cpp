@@ -4,6 +4,7 @@
 #include "MRLine3.h"
 #include "MRRingIterator.h"
 #include "MRBitSetParallelFor.h"
+#include "MRParallelFor.h"
 #include "MRClosestPointInTriangle.h"
 #include "MRBall.h"
 #include "MRTimer.h"
@@ -59,13 +60,46 @@ MeshIntersectionResult rayInsideIntersect( const Mesh& mesh, VertId v, float ray
 std::optional<VertScalars> computeRayThicknessAtVertices( const Mesh& mesh, const ProgressCallback & progress )
 {
     MR_TIMER;
+    std::vector<VertId> rayVerts;
+    rayVerts.reserve( mesh.topology.numValidVerts() );
+    for ( auto v : mesh.topology.getValidVerts() )
+        rayVerts.push_back( v );
+
+    // the rays from neighbor vertices go in close directions, so they are traced together in coherent packets;
+    // the vertices are processed in blocks to report progress and support cancellation
+    constexpr size_t blockSize = 1 << 16;
     VertScalars res( mesh.points.size(), FLT_MAX );
-    if ( !BitSetParallelFor( mesh.topology.getValidVerts(), [&]( VertId v )
+    std::vector<Vector3f> origins, dirs;
+    std::vector<float> rayParams;
+    for ( size_t begin = 0; begin < rayVerts.size(); begin += blockSize )
     {
-        if ( auto isec = rayInsideIntersect( mesh, v ) )
-            res[v] = isec.distanceAlongLine;
-    }, progress ) )
-        return {};
+        const auto end = std::min( begin + blockSize, rayVerts.size() );
+        origins.resize( end - begin );
+        dirs.resize( end - begin );
+        // same rays as in rayInsideIntersect( mesh, v )
+        ParallelFor( origins, [&]( size_t i )
+        {
+            const auto v = rayVerts[begin + i];
+            origins[i] = mesh.points[v];
+            dirs[i] = -mesh.pseudonormal( v );
+        } );
+
+        multiRayMeshIntersectSkipping( mesh, origins, dirs, [&]( size_t i, FaceId f )
+        {
+            VertId a, b, c;
+            mesh.topology.getTriVerts( f, a, b, c );
+            const auto v = rayVerts[begin + i];
+            return v != a && v != b && v != c;
+        }, { .rayParams = &rayParams } );
+
+        ParallelFor( rayParams, [&]( size_t i )
+        {
+            if ( !std::isnan( rayParams[i] ) )
+                res[rayVerts[begin + i]] = rayParams[i];
+        } );
+        if ( !reportProgress( progress, float( end ) / rayVerts.size() ) )
+            return {};
+    }
     return res;
 }
 
@@ -519,6 +519,8 @@ public:
 
 private:
     friend class MeshTopologyDiff;
+    friend class FrozenMeshTopology;
+    friend class MappedMrmesh;
     /// computes from edges_ all remaining fields: \n
     /// 1) numValidVerts_, 2) validVerts_, 3) edgePerVertex_,
     /// 4) numValidFaces_, 5) validFaces_, 6) edgePerFace_
@@ -0,0 +1,94 @@
+#include "MRMortonCode.h"
+#include "MRParallelFor.h"
+#include "MRBitSet.h"
+#include "MRVector.h"
+#include "MRTimer.h"
+#include "MRGTest.h"
+#include "MRPch/MRTBB.h"
+#include <numeric>
+
+namespace MR
+{
+
+std::vector<std::uint64_t> getMortonCodes( const std::vector<Vector3f> & points )
+{
+    MR_TIMER;
+    const auto box = tbb::parallel_reduce( tbb::blocked_range<size_t>( 0, points.size() ), Box3f{},
+        [&] ( const tbb::blocked_range<size_t> & range, Box3f curr )
+        {
+            for ( size_t i = range.begin(); i < range.end(); ++i )
+                curr.include( points[i] );
+            return curr;
+        },
+        [] ( Box3f a, const Box3f & b )
+        {
+            a.include( b );
+            return a;
+        } );
+
+    std::vector<std::uint64_t> codes( points.size() );
+    ParallelFor( points, [&] ( size_t i )
+    {
+        codes[i] = mortonCode( points[i], box );
+    } );
+    return codes;
+}
+
+std::vector<size_t> getMortonOrder( const std::vector<Vector3f> & points )
+{
+    MR_TIMER;
+    const auto codes = getMortonCodes( points );
+
+    std::vector<size_t> res( points.size() );
+    std::iota( res.begin(), res.end(), size_t( 0 ) );
+    tbb::parallel_sort( res.begin(), res.end(), [&] ( size_t a, size_t b )
+    {
+        return codes[a] < codes[b];
+    } );
+    return res;
+}
+
+std::vector<VertId> getMortonOrder( const VertCoords & points, const VertBitSet & verts )
+{
+    MR_TIMER;
+    std::vector<VertId> vs;
+    vs.reserve( verts.count() );
+    for ( auto v : verts )
+        vs.push_back( v );
+
+    std::vector<Vector3f> pts( vs.size() );
+    ParallelFor( pts, [&] ( size_t i )
+    {
+        pts[i] = points[vs[i]];
+    } );
+    const auto order = getMortonOrder( pts );
+
+    std::vector<VertId> res( vs.size() );
+    ParallelFor( res, [&] ( size_t i )
+    {
+        res[i] = vs[order[i]];
+    } );
+    return res;
+}
+
+TEST( MRMesh, MortonCode )
+{
+    const Box3f box( Vector3f( 0, 0, 0 ), Vector3f( 1, 1, 1 ) );
+    EXPECT_EQ( mortonCode( box.min, box ), 0 );
+    EXPECT_EQ( mortonCode( box.max, box ), ( std::uint64_t( 1 ) << 63 ) - 1 );
+    EXPECT_EQ( mortonCode( Vector3f( -1, 2, -3 ), box ), mortonCode( Vector3f( 0, 1, 0 ), box ) );
+    // x-bit is the lowest in each triple
+    EXPECT_LT( mortonCode( Vector3f( 0.6f, 0, 0 ), box ), mortonCode( Vector3f( 0, 0.6f, 0 ), box ) );
+    EXPECT_LT( mortonCode( Vector3f( 0, 0.6f, 0 ), box ), mortonCode( Vector3f( 0, 0, 0.6f ), box ) );
+
+    const std::vector<Vector3f> points{ { 1, 1, 1 }, { 0, 0, 0 }, { 0.9f, 0.9f, 0.9f }, { 0.1f, 0, 0 } };
+    EXPECT_EQ( getMortonOrder( points ), std::vector<size_t>( { 1, 3, 2, 0 } ) );
+
+    VertCoords coords;
+    coords.vec_ = points;
+    VertBitSet verts( points.size() );
+    verts.set( 0_v ).set( 2_v ).set( 3_v );
+    EXPECT_EQ( getMortonOrder( coords, verts ), std::vector<VertId>( { 3_v, 2_v, 0_v } ) );
+}
+
+} //namespace MR
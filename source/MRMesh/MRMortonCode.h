@@ -0,0 +1,55 @@
+#pragma once
+
+#include "MRBox.h"
+#include "MRVector3.h"
+#include <cstdint>
+#include <vector>
+
+namespace MR
+{
+
+/// \defgroup MortonCodeGroup Morton Code
+/// \ingroup MathGroup
+/// \{
+
+/// inserts two zero bits after each of 21 lower bits of x
+[[nodiscard]] inline std::uint64_t spreadBits3( std::uint64_t x )
+{
+    x &= 0x1fffff;
+    x = ( x | x << 32 ) & 0x1f00000000ffffull;
+    x = ( x | x << 16 ) & 0x1f0000ff0000ffull;
+    x = ( x | x << 8 )  & 0x100f00f00f00f00full;
+    x = ( x | x << 4 )  & 0x10c30c30c30c30c3ull;
+    x = ( x | x << 2 )  & 0x1249249249249249ull;
+    return x;
+}
+
+/// returns 63-bit Morton code (Z-order curve index) of the point quantized on 2^21 x 2^21 x 2^21 grid inside given box;
+/// the points outside of the box are clamped to its boundary;
+/// sorting points by this code places spatially close points near each other
+[[nodiscard]] inline std::uint64_t mortonCode( const Vector3f & p, const Box3f & box )
+{
+    constexpr float cMaxCoord = float( ( 1 << 21 ) - 1 );
+    const auto size = box.size();
+    auto quantize = [&] ( int i ) -> std::uint64_t
+    {
+        if ( !( size[i] > 0 ) )
+            return 0;
+        const float x = ( p[i] - box.min[i] ) / size[i] * cMaxCoord;
+        return x <= 0 ? 0 : x >= cMaxCoord ? std::uint64_t( cMaxCoord ) : std::uint64_t( x );
+    };
+    return spreadBits3( quantize( 0 ) ) | ( spreadBits3( quantize( 1 ) ) << 1 ) | ( spreadBits3( quantize( 2 ) ) << 2 );
+}
+
+/// returns Morton codes of all given points computed in the bounding box of these points
+[[nodiscard]] MRMESH_API std::vector<std::uint64_t> getMortonCodes( const std::vector<Vector3f> & points );
+
+/// returns the indices of given points ordered by their Morton codes in the bounding box of all points
+[[nodiscard]] MRMESH_API std::vector<size_t> getMortonOrder( const std::vector<Vector3f> & points );
+
+/// returns given vertices ordered by the Morton codes of their points in the bounding box of these points
+[[nodiscard]] MRMESH_API std::vector<VertId> getMortonOrder( const VertCoords & points, const VertBitSet & verts );
+
+/// \}
+
+} //namespace MR
@@ -1,4 +1,5 @@
 #include "MRMultiwayICP.h"
+#include "MRMortonCode.h"
 #include "MRParallelFor.h"
 #include "MRTimer.h"
 #include "MRPointToPointAligningTransform.h"
@@ -8,6 +9,7 @@
 #include "MRAABBTreeObjects.h"
 #include "MRAABBTreeObjects.h"
 #include <algorithm>
+#include <cmath>
 
 namespace MR
 {
@@ -283,6 +285,54 @@ MultiwayICP::MultiwayICP( const ICPObjects& objects, const MultiwayICPSamplingPa
 Vector<AffineXf3f, ObjId> MultiwayICP::calculateTransformations( ProgressCallback cb )
 {
     MR_TIMER;
+    const int numLevels = std::max( 1, samplingParams_.numPyramidLevels );
+    if ( numLevels == 1 )
+    {
+        Timer levelTimer( "level 0" );
+        if ( !iterate_( cb ) )
+            return {};
+        if ( perLevelCb_ )
+            perLevelCb_( { .samplingVoxelSize = samplingSize_, .numSamples = getNumSamples(), .iterations = std::min( iter_, prop_.iterLimit ),
+                .exitType = resultType_, .seconds = levelTimer.secondsPassed().count() } );
+    }
+    else
+    {
+        // the number of samples is approximately 4 times less on each next coarser level
+        float sumWeight = 0;
+        for ( int level = 0; level < numLevels; ++level )
+            sumWeight += std::pow( 0.25f, float( level ) );
+
+        float progressStart = 0;
+        for ( int level = numLevels - 1; level >= 0; --level )
+        {
+            Timer levelTimer( "level " + std::to_string( level ) );
+            const float progressEnd = level == 0 ? 1.0f : progressStart + std::pow( 0.25f, float( level ) ) / sumWeight;
+            const auto levelCb = subprogress( cb, progressStart, progressEnd );
+            progressStart = progressEnd;
+
+            auto params = samplingParams_;
+            params.samplingVoxelSize = samplingParams_.samplingVoxelSize * std::exp2( float( level ) );
+            params.maxGroupSize = maxGroupSize_; // keep the mode possibly changed after resamplePoints()
+            params.cb = subprogress( levelCb, 0.0f, 0.1f );
+            // the coarsest level is already sampled in resamplePoints() before the first run
+            const bool sampled = samplingSize_ == params.samplingVoxelSize;
+            if ( ( !sampled && !resample_( params ) ) || !iterate_( subprogress( levelCb, 0.1f, 1.0f ) ) )
+                return {};
+            if ( perLevelCb_ )
+                perLevelCb_( { .level = level, .samplingVoxelSize = samplingSize_, .numSamples = getNumSamples(), .iterations = std::min( iter_, prop_.iterLimit ),
+                    .exitType = resultType_, .seconds = levelTimer.secondsPassed().count() } );
+        }
+    }
+
+    Vector<AffineXf3f, ObjId> res;
+    res.resize( objs_.size() );
+    for ( int i = 0; i < objs_.size(); ++i )
+        res[ObjId( i )] = objs_[ObjId( i )].xf;
+    return res;
+}
+
+bool MultiwayICP::iterate_( ProgressCallback cb )
+{
     float minDist = std::numeric_limits<float>::max();
     int badIterCount = 0;
     resultType_ = ICPExitType::MaxIterations;
@@ -326,14 +376,9 @@ Vector<AffineXf3f, ObjId> MultiwayICP::calculateTransformations( ProgressCallbac
             badIterCount++;
         }
         if ( !reportProgress( cb, float( iter_ ) / float( prop_.iterLimit ) ) )
-            return {};
+            return false;
     }
-
-    Vector<AffineXf3f, ObjId> res;
-    res.resize( objs_.size() );
-    for ( int i = 0; i < objs_.size(); ++i )
-        res[ObjId( i )] = objs_[ObjId( i )].xf;
-    return res;
+    return true;
 }
 
 Vector<AffineXf3f, ObjId> MultiwayICP::calculateTransformationsFixFirst( ProgressCallback cb )
@@ -360,6 +405,19 @@ Vector<AffineXf3f, ObjId> MultiwayICP::calculateTransformationsFixFirst( Progres
 }
 
 bool MultiwayICP::resamplePoints( const MultiwayICPSamplingParameters& samplingParams )
+{
+    samplingParams_ = samplingParams;
+    samplingParams_.cb = {};
+    if ( samplingParams.numPyramidLevels <= 1 )
+        return resample_( samplingParams );
+
+    // calculateTransformations() starts from the coarsest level of the pyramid, so the finest samples are not needed yet
+    auto params = samplingParams;
+    params.samplingVoxelSize = samplingParams.samplingVoxelSize * std::exp2( float( samplingParams.numPyramidLevels - 1 ) );
+    return resample_( params );
+}
+
+bool MultiwayICP::resample_( const MultiwayICPSamplingParameters& samplingParams )
 {
     MR_TIMER;
 
@@ -535,6 +593,9 @@ bool MultiwayICP::reservePairsLayer0_( Vector<VertBitSet, ObjId>&& samplesPerObj
     {
         auto& pairs = pairsGrid[i];
         pairs.resize( objs_.size() );
+        ObjId srcObj = ObjId( i.get() );
+        // spatially close samples are processed by one thread
+        const auto srcSamples = getMortonOrder( objs_[srcObj].obj.points(), samplesPerObj[srcObj] );
         for ( ICPElementId j( 0 ); j < objs_.size(); ++j )
         {
             if ( i == j )
@@ -547,9 +608,8 @@ bool MultiwayICP::reservePairsLayer0_( Vector<VertBitSet, ObjId>&& samplesPerObj
             }
 
             auto& thisPairs = pairs[j];
-            ObjId srcObj = ObjId( i.get() );
-            thisPairs.vec.reserve( samplesPerObj[srcObj].count() );
-            for ( auto v : samplesPerObj[srcObj] )
+            thisPairs.vec.reserve( srcSamples.size() );
+            for ( auto v : srcSamples )
             {
                 auto& back = thisPairs.vec.emplace_back();
                 back.srcId.objId = srcObj;
@@ -678,13 +738,16 @@ bool MultiwayICP::updateLayerPairs_( ICPLayer l, ProgressCallback cb )
     auto createProjector = [&] ( ICPElementId elId )->ICPGroupProjector
     {
         if ( l == 0 )
-            return [this, elId] ( const Vector3f& p, MeshOrPoints::ProjectionResult& res, ObjId& resId ) mutable
         {
-            auto proj = objs_[ObjId( elId.get() )].obj.limitedProjector();
-            proj( objs_[ObjId( elId.get() )].xf.inverse()( p ), res );
-            if ( res.closestVert )
-                resId = ObjId( elId.get() );
-        };
+            const ObjId objId( elId.get() );
+            return [proj = objs_[objId].obj.limitedProjector(), invXf = objs_[objId].xf.inverse(), objId]
+                ( const Vector3f& p, MeshOrPoints::ProjectionResult& res, ObjId& resId )
+            {
+                proj( invXf( p ), res );
+                if ( res.closestVert )
+                    resId = objId;
+            };
+        }
         return [&trees, &maps, elId] ( const Vector3f& p, MeshOrPoints::ProjectionResult& res, ObjId& resId )
         {
             projectOnAll( p, trees[elId], res.distSq, [&] ( ObjId oId, MeshOrPoints::ProjectionResult prj )
@@ -698,6 +761,18 @@ bool MultiwayICP::updateLayerPairs_( ICPLayer l, ProgressCallback cb )
     };
 
 
+    // bounding boxes of objects in world space
+    Vector<Box3f, ICPElementId> boxes;
+    if ( l == 0 )
+    {
+        boxes.resize( numGroups );
+        ParallelFor( boxes, [&] ( ICPElementId gI )
+        {
+            const auto& obj = objs_[ObjId( gI.get() )];
+            boxes[gI] = transformed( obj.obj.getObjBoundingBox(), obj.xf );
+        } );
+    }
+
     // update pairs
     auto gridSize = numGroups * numGroups;
     auto keepGoung = ParallelFor( 0, int( gridSize ), [&] ( int gridId )
@@ -713,6 +788,16 @@ bool MultiwayICP::updateLayerPairs_( ICPLayer l, ProgressCallback cb )
                 return;
         }
 
+        if ( l == 0 && boxes[gI].valid() && boxes[gJ].valid() && boxes[gI].getDistanceSq( boxes[gJ] ) > prop_.distThresholdSq )
+        {
+            // no sample of one object can find a pair on the other object within distance threshold,
+            // which is common for large groups of objects
+            auto& pairs = pairsGridPerLayer_[l][gI][gJ];
+            pairs.active.clear();
+            pairs.active.resize( pairs.vec.size(), false );
+            return;
+        }
+
         MR::updateGroupPairs( pairsGridPerLayer_[l][gI][gJ], objs_, createProjector( gI ), createProjector( gJ ), prop_.cosThreshold, prop_.distThresholdSq, prop_.mutualClosest );
     }, cb );
     if ( !keepGoung )
@@ -913,24 +998,31 @@ bool MultiwayICP::p2plIter_()
 bool MultiwayICP::multiwayIter_( bool p2pl )
 {
     MR_TIMER;
-    Vector<MultiwayAligningTransform,ObjId> mats( objs_.size() );
-    ParallelFor( mats, [&] ( ObjId objId )
+    // each of matrices has the size proportional to the number of objects,
+    // so their number is limited to avoid quadratic memory consumption for large groups
+    constexpr size_t cMaxNumMats = 64;
+    const size_t numObjs = objs_.size();
+    std::vector<MultiwayAligningTransform> mats( std::min( numObjs, cMaxNumMats ) );
+    ParallelFor( mats, [&] ( size_t m )
     {
-        ICPElementId i( objId.get() );
         const auto& pairs = pairsGridPerLayer_[0];
-        auto& mat = mats[objId];
-        mat.reset( int( objs_.size() ) );
-        for ( ICPElementId j( 0 ); j < objs_.size(); ++j )
+        auto& mat = mats[m];
+        mat.reset( int( numObjs ) );
+        const ICPElementId iEnd( m + 1 < mats.size() ? ( m + 1 ) * numObjs / mats.size() : numObjs );
+        for ( ICPElementId i( m * numObjs / mats.size() ); i < iEnd; ++i )
         {
-            if ( j == i )
-                continue;
-            for ( auto idx : pairs[i][j].active )
+            for ( ICPElementId j( 0 ); j < numObjs; ++j )
             {
-                const auto& data = pairs[i][j].vec[idx];
-                if ( p2pl )
-                    mat.add( int( i ), data.srcPoint, int( j ), data.tgtPoint, ( data.tgtNorm + data.srcNorm ).normalized(), data.weight );
-                else
-                    mat.add( int( i ), data.srcPoint, int( j ), data.tgtPoint, data.weight );
+                if ( j == i )
+                    continue;
+                for ( auto idx : pairs[i][j].active )
+                {
+                    const auto& data = pairs[i][j].vec[idx];
+                    if ( p2pl )
+                        mat.add( int( i ), data.srcPoint, int( j ), data.tgtPoint, ( data.tgtNorm + data.srcNorm ).normalized(), data.weight );
+                    else
+                        mat.add( int( i ), data.srcPoint, int( j ), data.tgtPoint, data.weight );
+                }
             }
         }
     } );
@@ -940,7 +1032,7 @@ bool MultiwayICP::multiwayIter_( bool p2pl )
     for ( const auto& m : mats )
         mat.add( m );
 
-    mats = {}; // free memory
+    mats.clear(); // free memory
 
     MultiwayAligningTransform::Stabilizer stabilizer;
     stabilizer.rot = samplingSize_ * 1e-1f;
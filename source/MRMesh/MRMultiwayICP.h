@@ -72,10 +72,38 @@ struct MultiwayICPSamplingParameters
         AABBTreeBased /// builds AABB tree based on each object bounding box and separates subtrees (good if each object much smaller then all objects together)
     } cascadeMode{ CascadeMode::AABBTreeBased };
 
+    /// the number of levels in the pyramid of samples:
+    /// if more than one, then calculateTransformations() starts with the coarsest samples having samplingVoxelSize * 2^(numPyramidLevels-1),
+    /// and after convergence continues on the next level with twice smaller voxel size, till the level with samplingVoxelSize;
+    /// resamplePoints() samples the objects only on the coarsest level then
+    int numPyramidLevels = 1;
+
     /// callback for progress reports
     ProgressCallback cb;
 };
 
+/// statistics of the registration on one level of samples pyramid
+struct MultiwayICPLevelStats
+{
+    /// 0 is the finest level with original samplingVoxelSize
+    int level = 0;
+
+    /// sampling size of the objects on this level
+    float samplingVoxelSize = 0;
+
+    /// the number of samples able to form pairs
+    size_t numSamples = 0;
+
+    /// the number of iterations performed on this level
+    int iterations = 0;
+
+    /// the reason why the iterations on this level were stopped
+    ICPExitType exitType = ICPExitType::NotStarted;
+
+    /// time spent on this level including resampling, in seconds
+    double seconds = 0;
+};
+
 /// This class allows you to register many objects having similar parts
 /// and known initial approximations of orientations/locations using
 /// Iterative Closest Points (ICP) point-to-point or point-to-plane algorithms
@@ -95,7 +123,7 @@ public:
     /// the transformation of the first object is fixed and does not change here
     [[nodiscard]] MRMESH_API Vector<AffineXf3f, ObjId> calculateTransformationsFixFirst( ProgressCallback cb = {} );
 
-    /// select pairs with origin samples on all objects
+    /// select pairs with origin samples on all objects (on the coarsest level if samplingParams.numPyramidLevels > 1)
     MRMESH_API bool resamplePoints( const MultiwayICPSamplingParameters& samplingParams );
 
     /// in each pair updates the target data and performs basic filtering (activation)
@@ -123,6 +151,9 @@ public:
     /// sets callback that will be called for each iteration
     void setPerIterationCallback( std::function<void( int inter )> callback ) { perIterationCb_ = std::move( callback ); }
 
+    /// sets callback that will be called after the completion of each level of samples pyramid
+    void setPerLevelCallback( std::function<void( const MultiwayICPLevelStats& stats )> callback ) { perLevelCb_ = std::move( callback ); }
+
     /// if in independent equations mode - creates separate equation system for each object
     /// otherwise creates single large equation system for all objects
     bool devIndependentEquationsModeEnabled() const { return maxGroupSize_ == 1; }
@@ -146,9 +177,19 @@ private:
     ICPExitType resultType_{ ICPExitType::NotStarted };
 
     std::function<void( int )> perIterationCb_;
+    std::function<void( const MultiwayICPLevelStats& )> perLevelCb_;
+
+    /// the parameters of last resamplePoints() call without progress callback
+    MultiwayICPSamplingParameters samplingParams_;
 
     std::unique_ptr<IICPTreeIndexer> cascadeIndexer_;
 
+    /// performs iterations on current samples till convergence, returns false if terminated by the callback
+    bool iterate_( ProgressCallback cb );
+
+    /// select pairs with origin samples on all objects with given parameters, which are not stored
+    bool resample_( const MultiwayICPSamplingParameters& samplingParams );
+
     /// reserves space in pairsGridPerLayer_ according to mode and GroupIndexer
     void setupLayers_( MultiwayICPSamplingParameters::CascadeMode mode );
 
@@ -3,10 +3,12 @@
 #include "MRSerializer.h"
 #include "MRStringConvert.h"
 #include "MRHeapBytes.h"
+#include "MRUniqueTemporaryFolder.h"
 #include "MRPch/MRJson.h"
 #include "MRPch/MRSpdlog.h"
 #include "MRGTest.h"
 #include <filesystem>
+#include <fstream>
 
 namespace MR
 {
@@ -422,6 +424,11 @@ Expected<std::future<Expected<void>>> Object::serializeModel_( const std::filesy
     return {};
 }
 
+std::function<Expected<void>( std::ostream& )> Object::serializeModelToStream_( std::string& ) const
+{
+    return {};
+}
+
 void Object::serializeFields_( Json::Value& root ) const
 {
     root["Name"] = name_;
@@ -444,6 +451,27 @@ Expected<void> Object::deserializeModel_( const std::filesystem::path&, Progress
     return{};
 }
 
+Expected<void> Object::deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb )
+{
+    if ( files.empty() ) // the object had no model in files, e.g. ObjectLinesHolder keeps its model in fields
+        return deserializeModel_( {}, progressCb );
+
+    UniqueTemporaryFolder folder( {} );
+    if ( !folder )
+        return unexpected( "Cannot create temporary folder" );
+
+    for ( const auto & file : files )
+    {
+        const auto path = folder / pathFromUtf8( file.name );
+        std::ofstream ofs( path, std::ofstream::binary );
+        if ( !ofs || !ofs.write( file.data.data(), file.data.size() ) )
+            return unexpected( "Cannot write file " + utf8string( path ) );
+    }
+    files = {}; // release memory before loading the model
+
+    return deserializeModel_( folder / pathFromUtf8( key ), progressCb );
+}
+
 void Object::deserializeFields_( const Json::Value& root )
 {
     if ( root["Name"].isString() )
@@ -523,6 +551,38 @@ std::vector<std::string> Object::getInfoLines() const
     return res;
 }
 
+void Object::serializeRecursive( const std::string& folder, Json::Value& root, int childId, std::vector<ObjectModelSaver>& models ) const
+{
+    // the key must be unique among all children of same parent
+    std::string key = std::to_string( childId ) + "_" + replaceProhibitedChars( name_ );
+
+    ObjectModelSaver model;
+    model.saveToStream = serializeModelToStream_( model.extension );
+    if ( model.saveToStream || hasFileModel_() )
+    {
+        model.name = folder + key;
+        if ( !model.saveToStream )
+            model.saveToFiles = [this] ( const std::filesystem::path& path ) { return serializeModel_( path ); };
+        models.push_back( std::move( model ) );
+    }
+    serializeFields_( root );
+
+    root["Key"] = key;
+
+    if ( !children_.empty() )
+    {
+        const auto childrenFolder = folder + key + "/";
+        auto& childrenRoot = root["Children"];
+        for ( int i = 0; i < children_.size(); ++i )
+        {
+            const auto& child = children_[i];
+            if ( child->isAncillary() )
+                continue; // consider ancillary_ objects as temporary, not requiring saving
+            child->serializeRecursive( childrenFolder, childrenRoot[std::to_string( i )], i, models );
+        }
+    }
+}
+
 Expected<std::vector<std::future<Expected<void>>>> Object::serializeRecursive( const std::filesystem::path& path, Json::Value& root, int childId ) const
 {
     std::error_code ec;
@@ -566,6 +626,66 @@ Expected<std::vector<std::future<Expected<void>>>> Object::serializeRecursive( c
     return res;
 }
 
+/// creates the objects of the most derived known types for all children in given JSON,
+/// and returns them with their keys in the order of loading: sorted numeric keys first, then all string keys
+static std::vector<std::pair<std::string, std::shared_ptr<Object>>> createChildren( const Json::Value& root )
+{
+    std::vector<std::pair<std::string, std::shared_ptr<Object>>> res;
+    if ( root["Children"].isNull() )
+        return res;
+
+    // split keys by type to sort numeric
+    std::vector<long> orderedLongChildKeys; // all that can be converted to Long type
+    std::vector<std::string> orderedStringChildKeys; // others
+    for ( const std::string& childKey : root["Children"].getMemberNames() )
+    {
+        char* p_end;
+        long childKeyAsLong = std::strtol( childKey.c_str(), &p_end, 10 ); // check if key can be converted to Long
+        if ( *p_end )  // stoi failed
+            orderedStringChildKeys.push_back( childKey );
+        else
+            orderedLongChildKeys.push_back( childKeyAsLong );
+    }
+    std::sort( orderedLongChildKeys.begin(), orderedLongChildKeys.end() );
+
+    // join keys: after sorted numeric add all string keys
+    std::vector<std::string> orderedKeys;
+    orderedKeys.reserve( orderedLongChildKeys.size() + orderedStringChildKeys.size() );
+    for ( const long& k : orderedLongChildKeys )
+        orderedKeys.push_back( std::to_string( k ) );
+    orderedKeys.insert( orderedKeys.end(),
+                        std::make_move_iterator( orderedStringChildKeys.begin() ),
+                        std::make_move_iterator( orderedStringChildKeys.end() ) );
+
+    for ( std::string& child_key : orderedKeys )
+    {
+        if (!root["Children"].isMember( child_key ))
+        {
+            assert( false );
+            continue;
+        }
+        const auto& child = root["Children"][child_key];
+        if (child.isNull())
+            continue;
+
+        auto typeTreeSize = child["Type"].size();
+        std::shared_ptr<Object> childObj;
+        for (int i = typeTreeSize -1;i>=0;--i)
+        {
+            const auto& type = child["Type"][unsigned(i)];
+            if ( type.isString() )
+                childObj = createObject( type.asString() );
+            if ( childObj )
+                break;
+        }
+        if ( !childObj )
+            continue;
+
+        res.emplace_back( std::move( child_key ), std::move( childObj ) );
+    }
+    return res;
+}
+
 Expected<void> Object::deserializeRecursive( const std::filesystem::path& path, const Json::Value& root,
         ProgressCallback progressCb, int* objCounter )
 {
@@ -579,60 +699,40 @@ Expected<void> Object::deserializeRecursive( const std::filesystem::path& path,
     if ( objCounter )
         ++( *objCounter );
 
-    if (!root["Children"].isNull())
+    for ( const auto& [childKey, childObj] : createChildren( root ) )
     {
-        // split keys by type to sort numeric
-        std::vector<long> orderedLongChildKeys; // all that can be converted to Long type
-        std::vector<std::string> orderedStringChildKeys; // others
-        for ( const std::string& childKey : root["Children"].getMemberNames() )
-        {
-            char* p_end;
-            long childKeyAsLong = std::strtol( childKey.c_str(), &p_end, 10 ); // check if key can be converted to Long
-            if ( *p_end )  // stoi failed
-                orderedStringChildKeys.push_back( childKey );
-            else
-                orderedLongChildKeys.push_back( childKeyAsLong );
-        }
-        std::sort( orderedLongChildKeys.begin(), orderedLongChildKeys.end() );
-
-        // join keys: after sorted numeric add all string keys
-        std::vector<std::string> orderedKeys;
-        orderedKeys.reserve( orderedLongChildKeys.size() + orderedStringChildKeys.size() );
-        for ( const long& k : orderedLongChildKeys )
-            orderedKeys.push_back( std::to_string( k ) );
-        orderedKeys.insert( orderedKeys.end(),
-                            std::make_move_iterator( orderedStringChildKeys.begin() ),
-                            std::make_move_iterator( orderedStringChildKeys.end() ) );
-
-        for ( const std::string& child_key : orderedKeys )
-        {
-            if (!root["Children"].isMember( child_key ))
-            {
-                assert( false );
-                continue;
-            }
-            const auto& child = root["Children"][child_key];
-            if (child.isNull())
-                continue;
+        auto childRes = childObj->deserializeRecursive( path / pathFromUtf8( key ), root["Children"][childKey], progressCb, objCounter );
+        if ( !childRes.has_value() )
+            return childRes;
+        addChild( childObj );
+    }
+    return {};
+}
 
-            auto typeTreeSize = child["Type"].size();
-            std::shared_ptr<Object> childObj;
-            for (int i = typeTreeSize -1;i>=0;--i)
-            {
-                const auto& type = child["Type"][unsigned(i)];
-                if ( type.isString() )
-                    childObj = createObject( type.asString() );
-                if ( childObj )
-                    break;
-            }
-            if ( !childObj )
-                continue;
+Expected<void> Object::deserializeRecursive( const std::string& folder, const Json::Value& root,
+    const ObjectModelFilesReader& reader, ProgressCallback progressCb, int* objCounter )
+{
+    std::string key = root["Key"].isString() ? root["Key"].asString() : root["Name"].asString();
 
-            auto childRes = childObj->deserializeRecursive( path / pathFromUtf8( key ), child, progressCb, objCounter );
-            if ( !childRes.has_value() )
-                return childRes;
-            addChild( childObj );
-        }
+    auto files = reader( folder + key );
+    if ( !files.has_value() )
+        return unexpected( std::move( files.error() ) );
+
+    auto res = deserializeModelFromMemory_( key, std::move( *files ), progressCb );
+    if ( !res.has_value() )
+        return res;
+
+    deserializeFields_( root );
+    if ( objCounter )
+        ++( *objCounter );
+
+    const auto childrenFolder = folder + key + "/";
+    for ( const auto& [childKey, childObj] : createChildren( root ) )
+    {
+        auto childRes = childObj->deserializeRecursive( childrenFolder, root["Children"][childKey], reader, progressCb, objCounter );
+        if ( !childRes.has_value() )
+            return childRes;
+        addChild( childObj );
     }
     return {};
 }
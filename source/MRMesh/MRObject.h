@@ -12,6 +12,8 @@
 #include <array>
 #include <future>
 #include <filesystem>
+#include <functional>
+#include <string>
 
 namespace Json
 {
@@ -55,6 +57,36 @@ protected:
     std::vector< std::weak_ptr< Object > > bastards_; /// unrecognized children to hide from the pubic
 };
 
+/// the data to save the model of one object (e.g. mesh) in a scene archive without intermediate files, see Object::serializeRecursive
+struct MR_BIND_IGNORE ObjectModelSaver
+{
+    /// the name of the model inside the archive without extension: the folder of the object and its key
+    std::string name;
+
+    /// the extension of the model file, e.g. ".ply"
+    std::string extension;
+
+    /// writes the model in given stream, it can be called from any thread;
+    /// empty function means that the model can be saved only in files by saveToFiles
+    std::function<Expected<void>( std::ostream& )> saveToStream;
+
+    /// creates future to save the model in file(s) by given path without extension
+    std::function<Expected<std::future<Expected<void>>>( const std::filesystem::path& )> saveToFiles;
+};
+
+/// one file of object model read in memory, e.g. from a scene archive
+struct ObjectModelFile
+{
+    /// the name of the file without folders
+    std::string name;
+
+    /// the content of the file
+    std::string data;
+};
+
+/// returns all files of object model by its name inside a scene archive: the folder of the object and its key
+using ObjectModelFilesReader = std::function<Expected<std::vector<ObjectModelFile>>( const std::string& name )>;
+
 /// named object in the data model
 class MRMESH_CLASS Object : public ObjectChildrenHolder
 {
@@ -227,12 +259,27 @@ public:
     // TODO: figure out how to automate this (add a flag to the parser to outright reject functions based on their parameter and return types).
     MRMESH_API MR_BIND_IGNORE Expected<std::vector<std::future<Expected<void>>>> serializeRecursive( const std::filesystem::path& path, Json::Value& root, int childId ) const;
 
+    /// collects the data to save this object subtree in a scene archive without intermediate files:
+    ///   models in given vector and
+    ///   fields in given JSON
+    /// \param folder is the folder of this object inside the archive, it is empty or ends with '/'
+    /// \param childId is its ordinal number within the parent
+    MRMESH_API MR_BIND_IGNORE void serializeRecursive( const std::string& folder, Json::Value& root, int childId,
+        std::vector<ObjectModelSaver>& models ) const;
+
     /// loads subtree into this Object
     ///   models from the folder by given path and
     ///   fields from given JSON
     MRMESH_API Expected<void> deserializeRecursive( const std::filesystem::path& path, const Json::Value& root,
         ProgressCallback progressCb = {}, int* objCounter = nullptr );
 
+    /// loads subtree into this Object:
+    ///   models by given reader of the files from a scene archive and
+    ///   fields from given JSON
+    /// \param folder is the folder of this object inside the archive, it is empty or ends with '/'
+    MRMESH_API MR_BIND_IGNORE Expected<void> deserializeRecursive( const std::string& folder, const Json::Value& root,
+        const ObjectModelFilesReader& reader, ProgressCallback progressCb = {}, int* objCounter = nullptr );
+
     /// swaps this object with other
     /// note: do not swap object signals, so listeners will get notifications from swapped object
     /// requires implementation of `swapBase_` and `swapSignals_` (if type has signals)
@@ -278,6 +325,14 @@ protected:
     /// path is full filename without extension
     MRMESH_API virtual Expected<std::future<Expected<void>>> serializeModel_( const std::filesystem::path& path ) const;
 
+    /// Returns the function to save object model (e.g. mesh) in a stream, which can be called later from any thread,
+    /// and sets the extension of the model file (e.g. ".ply");
+    /// returns empty function if the object has no model or the model can be saved only in files by serializeModel_
+    MRMESH_API virtual std::function<Expected<void>( std::ostream& )> serializeModelToStream_( std::string& extension ) const;
+
+    /// returns true if the object has a model, which can be saved only in files by serializeModel_ (e.g. voxels)
+    [[nodiscard]] virtual bool hasFileModel_() const { return false; }
+
     /// Write parameters to given Json::Value,
     /// \note if you override this method, please call Base::serializeFields_(root) in the beginning
     MRMESH_API virtual void serializeFields_( Json::Value& root ) const;
@@ -285,6 +340,10 @@ protected:
     /// Reads model from file
     MRMESH_API virtual Expected<void> deserializeModel_( const std::filesystem::path& path, ProgressCallback progressCb = {} );
 
+    /// Reads model from its files read in memory (e.g. from a scene archive), \param key is the name of the model file without extension;
+    /// by default the files are written in a temporary folder and read by deserializeModel_
+    MRMESH_API virtual Expected<void> deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb = {} );
+
     /// Reads parameters from json value
     /// \note if you override this method, please call Base::deserializeFields_(root) in the beginning
     MRMESH_API virtual void deserializeFields_( const Json::Value& root );
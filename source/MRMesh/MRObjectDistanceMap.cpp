@@ -178,6 +178,17 @@ Expected<std::future<Expected<void>>> ObjectDistanceMap::serializeModel_( const
     } );
 }
 
+std::function<Expected<void>( std::ostream& )> ObjectDistanceMap::serializeModelToStream_( std::string& ) const
+{
+    return {};
+}
+
+Expected<void> ObjectDistanceMap::deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb )
+{
+    // skip the implementation of ObjectMeshHolder, since the files are read by deserializeModel_
+    return VisualObject::deserializeModelFromMemory_( key, std::move( files ), progressCb );
+}
+
 void ObjectDistanceMap::setDefaultColors_()
 {
     setFrontColor( SceneColors::get( SceneColors::SelectedObjectDistanceMap ), true );
@@ -72,6 +72,13 @@ protected:
 
     MRMESH_API virtual Expected<std::future<Expected<void>>> serializeModel_( const std::filesystem::path& path ) const override;
 
+    /// distance maps are saved only in files by serializeModel_
+    MRMESH_API virtual std::function<Expected<void>( std::ostream& )> serializeModelToStream_( std::string& extension ) const override;
+
+    [[nodiscard]] virtual bool hasFileModel_() const override { return bool( dmap_ ); }
+
+    MRMESH_API Expected<void> deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb = {} ) override;
+
 private:
     std::shared_ptr<DistanceMap> dmap_;
     AffineXf3f dmap2local_;
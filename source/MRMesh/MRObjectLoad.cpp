@@ -27,6 +27,7 @@
 #include "MRPch/MRTBB.h"
 #include "MRPch/MRFmt.h"
 #include "MRPch/MRJson.h"
+#include <optional>
 
 namespace MR
 {
@@ -470,44 +471,10 @@ Expected<LoadedObject> loadSceneFromAnySupportedFormat( const std::filesystem::p
     } );
 }
 
-Expected<LoadedObject> deserializeObjectTree( const std::filesystem::path& path, const FolderCallback& postDecompress,
-                                              const ProgressCallback& progressCb )
-{
-    MR_TIMER;
-    UniqueTemporaryFolder scenePath( postDecompress );
-    if ( !scenePath )
-        return unexpected( "Cannot create temporary folder" );
-    auto res = decompressZip( path, scenePath );
-    if ( !res.has_value() )
-        return unexpected( std::move( res.error() ) );
-
-    return deserializeObjectTreeFromFolder( scenePath, progressCb );
-}
-
-Expected<LoadedObject> deserializeObjectTreeFromFolder( const std::filesystem::path& folder,
-                                                        const ProgressCallback& progressCb )
+/// creates the root object by given JSON of the scene, and loads the whole tree by given function
+static Expected<LoadedObject> deserializeObjectTree_( const Json::Value& root, const ProgressCallback& progressCb,
+    const std::function<Expected<void>( Object& obj, const ProgressCallback& cb, int* objCounter )>& deserialize )
 {
-    MR_TIMER;
-
-    std::error_code ec;
-    std::filesystem::path jsonFile;
-    for ( auto entry : Directory{ folder, ec } )
-    {
-        // unlike extension() this works even if full file name is simply ".json"
-        if ( entry.path().u8string().ends_with( u8".json" ) )
-        {
-            jsonFile = entry.path();
-            break;
-        }
-    }
-
-    auto readRes = deserializeJsonValue( jsonFile );
-    if( !readRes.has_value() )
-    {
-        return unexpected( readRes.error() );
-    }
-    auto root = readRes.value();
-
     auto typeTreeSize = root["Type"].size();
     LoadedObject res;
     for (int i = typeTreeSize-1;i>=0;--i)
@@ -555,7 +522,7 @@ Expected<LoadedObject> deserializeObjectTreeFromFolder( const std::filesystem::p
         };
     }
 
-    auto resDeser = res.obj->deserializeRecursive( folder, root, cb, &modelCounter );
+    auto resDeser = deserialize( *res.obj, cb, &modelCounter );
     if ( !resDeser.has_value() )
     {
         std::string errorStr = resDeser.error();
@@ -567,6 +534,116 @@ Expected<LoadedObject> deserializeObjectTreeFromFolder( const std::filesystem::p
     return res;
 }
 
+Expected<LoadedObject> deserializeObjectTree( const std::filesystem::path& path, const FolderCallback& postDecompress,
+                                              const ProgressCallback& progressCb )
+{
+    MR_TIMER;
+    if ( postDecompress )
+    {
+        // the caller needs all files of the scene in a folder
+        UniqueTemporaryFolder scenePath( postDecompress );
+        if ( !scenePath )
+            return unexpected( "Cannot create temporary folder" );
+        auto res = decompressZip( path, scenePath );
+        if ( !res.has_value() )
+            return unexpected( std::move( res.error() ) );
+
+        return deserializeObjectTreeFromFolder( scenePath, progressCb );
+    }
+
+    // otherwise the entries of the archive are decompressed one by one in memory when the objects need them
+    auto zip = ZipReader::open( path );
+    if ( !zip )
+        return unexpected( std::move( zip.error() ) );
+
+    // the files of a model have the key of the object as the stem or, if there is no such file,
+    // as the rest of the stem after the first space (e.g. raw voxels with parameters before the key in the name);
+    // the files are indexed by the folder inside the archive with '/' at the end and the key
+    HashMap<std::string, size_t> filesByStem;
+    HashMap<std::string, std::vector<size_t>> filesByStemEnd;
+    std::optional<size_t> jsonIndex;
+    for ( size_t i = 0; i < zip->names().size(); ++i )
+    {
+        const auto& name = zip->names()[i];
+        if ( name.empty() || name.back() == '/' )
+            continue;
+        const auto slashPos = name.rfind( '/' );
+        const auto folder = slashPos == std::string::npos ? std::string{} : name.substr( 0, slashPos + 1 );
+        // unlike extension() this works even if full file name is simply ".json"
+        if ( folder.empty() && !jsonIndex && name.ends_with( ".json" ) )
+            jsonIndex = i;
+        const auto stem = utf8string( pathFromUtf8( name.substr( folder.size() ) ).stem() );
+        filesByStem.emplace( folder + stem, i );
+        if ( const auto spacePos = stem.find( ' ' ); spacePos != std::string::npos )
+            filesByStemEnd[folder + stem.substr( spacePos + 1 )].push_back( i );
+    }
+    if ( !jsonIndex )
+        return unexpected( "No scene description file found in " + utf8string( path ) );
+
+    auto json = zip->read( *jsonIndex );
+    if ( !json )
+        return unexpected( std::move( json.error() ) );
+    auto readRes = deserializeJsonValue( *json );
+    if ( !readRes.has_value() )
+        return unexpected( readRes.error() );
+
+    ObjectModelFilesReader reader = [&] ( const std::string& modelName ) -> Expected<std::vector<ObjectModelFile>>
+    {
+        std::vector<ObjectModelFile> res;
+        const auto slashPos = modelName.rfind( '/' );
+        const auto folderSize = slashPos == std::string::npos ? 0 : slashPos + 1;
+
+        std::vector<size_t> indices;
+        if ( auto it = filesByStem.find( modelName ); it != filesByStem.end() )
+            indices = { it->second };
+        else if ( auto it = filesByStemEnd.find( modelName ); it != filesByStemEnd.end() )
+            indices = it->second;
+
+        for ( auto i : indices )
+        {
+            auto data = zip->read( i );
+            if ( !data )
+                return unexpected( std::move( data.error() ) );
+            res.push_back( { .name = zip->names()[i].substr( folderSize ), .data = std::move( *data ) } );
+        }
+        return res;
+    };
+
+    return deserializeObjectTree_( *readRes, progressCb, [&] ( Object& obj, const ProgressCallback& cb, int* objCounter )
+    {
+        return obj.deserializeRecursive( std::string{}, *readRes, reader, cb, objCounter );
+    } );
+}
+
+Expected<LoadedObject> deserializeObjectTreeFromFolder( const std::filesystem::path& folder,
+                                                        const ProgressCallback& progressCb )
+{
+    MR_TIMER;
+
+    std::error_code ec;
+    std::filesystem::path jsonFile;
+    for ( auto entry : Directory{ folder, ec } )
+    {
+        // unlike extension() this works even if full file name is simply ".json"
+        if ( entry.path().u8string().ends_with( u8".json" ) )
+        {
+            jsonFile = entry.path();
+            break;
+        }
+    }
+
+    auto readRes = deserializeJsonValue( jsonFile );
+    if( !readRes.has_value() )
+    {
+        return unexpected( readRes.error() );
+    }
+
+    return deserializeObjectTree_( *readRes, progressCb, [&] ( Object& obj, const ProgressCallback& cb, int* objCounter )
+    {
+        return obj.deserializeRecursive( folder, *readRes, cb, objCounter );
+    } );
+}
+
 Expected<LoadedObject> deserializeObjectTree( const std::filesystem::path& path, const ProgressCallback& progressCb )
 {
     return deserializeObjectTree( path, FolderCallback{}, progressCb );
@@ -17,6 +17,7 @@
 #include "MRDirectory.h"
 #include "MRPch/MRJson.h"
 #include "MRPch/MRAsyncLaunchType.h"
+#include <sstream>
 
 namespace MR
 {
@@ -49,17 +50,24 @@ void ObjectMeshHolder::setSelectedEdgesColor( const Color& color, ViewportId id
     needRedraw_ = true;
 }
 
+// the settings to save a mesh in a scene exactly as it is
+static SaveSettings serializeSaveSettings( const VertColors& vertColors )
+{
+    SaveSettings saveSettings;
+    saveSettings.saveValidOnly = false;
+    saveSettings.rearrangeTriangles = false;
+    if ( !vertColors.empty() )
+        saveSettings.colors = &vertColors;
+    return saveSettings;
+}
+
 Expected<std::future<Expected<void>>> ObjectMeshHolder::serializeModel_( const std::filesystem::path& path ) const
 {
     if ( ancillary_ || !data_.mesh )
         return {};
 
-    SaveSettings saveSettings;
-    saveSettings.saveValidOnly = false;
-    saveSettings.rearrangeTriangles = false;
-    if ( !data_.vertColors.empty() )
-        saveSettings.colors = &data_.vertColors;
-    auto save = [mesh = data_.mesh, serializeFormat = serializeFormat_ ? serializeFormat_ : defaultSerializeMeshFormat(), path, saveSettings]()
+    auto save = [mesh = data_.mesh, serializeFormat = serializeFormat_ ? serializeFormat_ : defaultSerializeMeshFormat(), path,
+        saveSettings = serializeSaveSettings( data_.vertColors )]()
     {
         auto filename = path;
         const auto extension = std::string( "*" ) + serializeFormat;
@@ -77,6 +85,24 @@ Expected<std::future<Expected<void>>> ObjectMeshHolder::serializeModel_( const s
     return std::async( getAsyncLaunchType(), save );
 }
 
+std::function<Expected<void>( std::ostream& )> ObjectMeshHolder::serializeModelToStream_( std::string& extension ) const
+{
+    if ( ancillary_ || !data_.mesh )
+        return {};
+
+    extension = serializeFormat_ ? serializeFormat_ : defaultSerializeMeshFormat();
+    auto streamSave = MeshSave::getMeshSaver( "*" + extension ).streamSave;
+    if ( !streamSave )
+    {
+        extension = ".ply";
+        streamSave = MeshSave::toPly;
+    }
+    return [mesh = data_.mesh, streamSave, saveSettings = serializeSaveSettings( data_.vertColors )]( std::ostream& out )
+    {
+        return streamSave( *mesh, out, saveSettings );
+    };
+}
+
 void ObjectMeshHolder::serializeFields_( Json::Value& root ) const
 {
     VisualObject::serializeFields_( root );
@@ -261,6 +287,26 @@ Expected<void> ObjectMeshHolder::deserializeModel_( const std::filesystem::path&
     return {};
 }
 
+Expected<void> ObjectMeshHolder::deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb )
+{
+    if ( files.empty() )
+        return unexpected( "No mesh file found: " + key );
+
+    const auto extension = "*" + utf8string( pathFromUtf8( files.front().name ).extension() );
+    const auto streamLoad = MeshLoad::getMeshLoader( extension ).streamLoad;
+    if ( files.size() != 1 || !streamLoad )
+        return VisualObject::deserializeModelFromMemory_( key, std::move( files ), progressCb );
+
+    data_.vertColors.clear();
+    std::istringstream in( std::move( files.front().data ) );
+    auto res = streamLoad( in, { .colors = &data_.vertColors, .callback = progressCb } );
+    if ( !res.has_value() )
+        return unexpected( res.error() );
+
+    data_.mesh = std::make_shared<Mesh>( std::move( res.value() ) );
+    return {};
+}
+
 Box3f ObjectMeshHolder::computeBoundingBox_() const
 {
     if ( !data_.mesh )
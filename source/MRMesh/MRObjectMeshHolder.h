@@ -279,12 +279,16 @@ protected:
 
     MRMESH_API virtual Expected<std::future<Expected<void>>> serializeModel_( const std::filesystem::path& path ) const override;
 
+    MRMESH_API virtual std::function<Expected<void>( std::ostream& )> serializeModelToStream_( std::string& extension ) const override;
+
     MRMESH_API virtual void serializeFields_( Json::Value& root ) const override;
 
     MRMESH_API void deserializeFields_( const Json::Value& root ) override;
 
     MRMESH_API Expected<void> deserializeModel_( const std::filesystem::path& path, ProgressCallback progressCb = {} ) override;
 
+    MRMESH_API Expected<void> deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb = {} ) override;
+
     /// set all visualize properties masks
     MRMESH_API void setAllVisualizeProperties_( const AllVisualizeProperties& properties, std::size_t& pos ) override;
 
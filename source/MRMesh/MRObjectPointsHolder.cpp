@@ -14,6 +14,7 @@
 #include "MRPch/MRJson.h"
 #include "MRPch/MRTBB.h"
 #include "MRPch/MRAsyncLaunchType.h"
+#include <sstream>
 
 namespace MR
 {
@@ -270,6 +271,17 @@ Box3f ObjectPointsHolder::computeBoundingBox_() const
     return bb;
 }
 
+// the settings to save a point cloud in a scene exactly as it is
+static SaveSettings serializeSaveSettings( const VertColors& vertsColorMap )
+{
+    SaveSettings saveSettings;
+    saveSettings.saveValidOnly = false;
+    saveSettings.rearrangeTriangles = false;
+    if ( !vertsColorMap.empty() )
+        saveSettings.colors = &vertsColorMap;
+    return saveSettings;
+}
+
 Expected<std::future<Expected<void>>> ObjectPointsHolder::serializeModel_( const std::filesystem::path& path ) const
 {
     if ( ancillary_ || !points_ )
@@ -278,12 +290,8 @@ Expected<std::future<Expected<void>>> ObjectPointsHolder::serializeModel_( const
     if ( points_->points.empty() ) // some formats (e.g. .ctm) require at least one point in the vector
         return std::async( getAsyncLaunchType(), []{ return Expected<void>{}; } );
 
-    SaveSettings saveSettings;
-    saveSettings.saveValidOnly = false;
-    saveSettings.rearrangeTriangles = false;
-    if ( !vertsColorMap_.empty() )
-        saveSettings.colors = &vertsColorMap_;
-    auto save = [points = points_, serializeFormat = serializeFormat_ ? serializeFormat_ : defaultSerializePointsFormat(), path, saveSettings]()
+    auto save = [points = points_, serializeFormat = serializeFormat_ ? serializeFormat_ : defaultSerializePointsFormat(), path,
+        saveSettings = serializeSaveSettings( vertsColorMap_ )]()
     {
         auto filename = path;
         const auto extension = std::string( "*" ) + serializeFormat;
@@ -301,6 +309,27 @@ Expected<std::future<Expected<void>>> ObjectPointsHolder::serializeModel_( const
     return std::async( getAsyncLaunchType(), save );
 }
 
+std::function<Expected<void>( std::ostream& )> ObjectPointsHolder::serializeModelToStream_( std::string& extension ) const
+{
+    if ( ancillary_ || !points_ )
+        return {};
+
+    extension = serializeFormat_ ? serializeFormat_ : defaultSerializePointsFormat();
+    if ( points_->points.empty() ) // some formats (e.g. .ctm) require at least one point in the vector, so an empty entry is written
+        return []( std::ostream& ) { return Expected<void>{}; };
+
+    auto streamSave = PointsSave::getPointsSaver( "*" + extension ).streamSave;
+    if ( !streamSave )
+    {
+        extension = ".ply";
+        streamSave = PointsSave::toPly;
+    }
+    return [points = points_, streamSave, saveSettings = serializeSaveSettings( vertsColorMap_ )]( std::ostream& out )
+    {
+        return streamSave( *points, out, saveSettings );
+    };
+}
+
 Expected<void> ObjectPointsHolder::deserializeModel_( const std::filesystem::path& path, ProgressCallback progressCb )
 {
     auto modelPath = pathFromUtf8( utf8string( path ) + ".ctm" ); //quick path for most used format
@@ -328,6 +357,34 @@ Expected<void> ObjectPointsHolder::deserializeModel_( const std::filesystem::pat
     return {};
 }
 
+Expected<void> ObjectPointsHolder::deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb )
+{
+    if ( files.empty() || ( files.size() == 1 && files.front().data.empty() ) ) // empty point cloud is saved without data
+    {
+        points_ = std::make_shared<PointCloud>();
+        return {};
+    }
+
+    const auto extension = "*" + utf8string( pathFromUtf8( files.front().name ).extension() );
+    const auto streamLoad = PointsLoad::getPointsLoader( extension ).streamLoad;
+    if ( files.size() != 1 || !streamLoad )
+        return VisualObject::deserializeModelFromMemory_( key, std::move( files ), progressCb );
+
+    std::istringstream in( std::move( files.front().data ) );
+    auto res = streamLoad( in, {
+        .colors = &vertsColorMap_,
+        .callback = progressCb,
+    } );
+    if ( !res.has_value() )
+        return unexpected( std::move( res.error() ) );
+
+    if ( !vertsColorMap_.empty() )
+        setColoringType( ColoringType::VertsColorMap );
+
+    points_ = std::make_shared<PointCloud>( std::move( res.value() ) );
+    return {};
+}
+
 void ObjectPointsHolder::serializeFields_( Json::Value& root ) const
 {
     VisualObject::serializeFields_( root );
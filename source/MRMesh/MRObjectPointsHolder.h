@@ -168,8 +168,12 @@ protected:
 
     MRMESH_API virtual Expected<std::future<Expected<void>>> serializeModel_( const std::filesystem::path& path ) const override;
 
+    MRMESH_API virtual std::function<Expected<void>( std::ostream& )> serializeModelToStream_( std::string& extension ) const override;
+
     MRMESH_API virtual Expected<void> deserializeModel_( const std::filesystem::path& path, ProgressCallback progressCb = {} ) override;
 
+    MRMESH_API virtual Expected<void> deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb = {} ) override;
+
     MRMESH_API virtual void serializeFields_( Json::Value& root ) const override;
 
     MRMESH_API virtual void deserializeFields_( const Json::Value& root ) override;
@@ -16,8 +16,11 @@
 #include "MRTimer.h"
 #include "MRMesh.h"
 #include "MRZip.h"
+#include "MRDirectory.h"
 
 #include "MRPch/MRJson.h"
+#include <optional>
+#include <sstream>
 
 namespace
 {
@@ -187,13 +190,42 @@ Expected<void> toAnySupportedFormat( const Object& object, const std::filesystem
 
 } // namespace ObjectSave
 
-Expected<void> serializeObjectTree( const Object& object, const std::filesystem::path& path,
-                                  ProgressCallback progressCb, FolderCallback preCompress )
+/// waits for given futures reporting the progress
+static Expected<void> waitAll( std::vector<std::future<Expected<void>>>& futures, ProgressCallback progressCb )
 {
-    MR_TIMER;
-    if (path.empty())
-        return unexpected( "Cannot save to empty path" );
+#ifndef __EMSCRIPTEN__
+    BitSet inProgress( futures.size(), true );
+    while ( inProgress.any() )
+    {
+        for ( auto i : inProgress )
+        {
+            if ( futures[i].wait_for( std::chrono::milliseconds( 200 ) ) != std::future_status::timeout )
+                inProgress.reset( i );
+        }
+        if ( !reportProgress( progressCb, 1.0f - (float)inProgress.count() / inProgress.size() ) )
+            return unexpectedOperationCanceled();
+    }
+#endif
 
+    for ( auto & f : futures )
+    {
+        auto v = f.get();
+        if ( !v )
+            return v;
+    }
+    return {};
+}
+
+/// binary formats, which are compact enough to be stored in the archive without compression
+static bool isCompactModelFormat( const std::string& extension )
+{
+    return extension == ".ply" || extension == ".mrmesh" || extension == ".ctm";
+}
+
+/// saves all files of the scene in a temporary folder, and then compresses it in given zip-file
+static Expected<void> serializeObjectTreeViaFolder( const Object& object, const std::filesystem::path& path,
+                                  ProgressCallback progressCb, FolderCallback preCompress )
+{
     UniqueTemporaryFolder scenePath( {} );
     if ( !scenePath )
         return unexpected( "Cannot create temporary folder" );
@@ -219,35 +251,106 @@ Expected<void> serializeObjectTree( const Object& object, const std::filesystem:
 
     ofs.close();
 
-#ifndef __EMSCRIPTEN__
     if ( !reportProgress( progressCb, 0.1f ) )
         return unexpectedOperationCanceled();
 
     // wait for all models are saved before making compressed folder
-    BitSet inProgress( saveModelFutures.size(), true );
-    while ( inProgress.any() )
+    if ( auto res = waitAll( saveModelFutures, subprogress( progressCb, 0.1f, 0.9f ) ); !res )
+        return res;
+
+    preCompress( scenePath );
+
+    return compressZip( path, scenePath, {}, nullptr, subprogress( progressCb, 0.9f, 1.0f ) );
+}
+
+Expected<void> serializeObjectTree( const Object& object, const std::filesystem::path& path,
+                                  ProgressCallback progressCb, FolderCallback preCompress )
+{
+    MR_TIMER;
+    if (path.empty())
+        return unexpected( "Cannot save to empty path" );
+
+    // the caller needs all files of the scene in a folder
+    if ( preCompress )
+        return serializeObjectTreeViaFolder( object, path, std::move( progressCb ), std::move( preCompress ) );
+
+    if ( progressCb && !progressCb( 0.0f ) )
+        return unexpectedOperationCanceled();
+
+    Json::Value root;
+    root["FormatVersion"] = "0.0";
+    std::vector<ObjectModelSaver> models;
+    object.serializeRecursive( std::string{}, root, 0, models );
+
+    std::ostringstream paramsStream( std::ios::binary );
+    Json::StreamWriterBuilder builder;
+    std::unique_ptr<Json::StreamWriter> writer{ builder.newStreamWriter() };
+    if ( writer->write( root, &paramsStream ) != 0 )
+        return unexpected( "Cannot write parameters" );
+
+    assert( !object.name().empty() );
+    std::vector<ZipEntry> entries;
+    entries.push_back( {
+        .name = object.name() + ".json",
+        .write = [params = std::move( paramsStream ).str()] ( std::ostream& out ) -> Expected<void>
+        {
+            if ( !out.write( params.data(), params.size() ) )
+                return unexpected( "Cannot write parameters" );
+            return {};
+        }
+    } );
+
+    // the models are written directly in the archive, except for the ones that can be saved only in files
+    std::optional<UniqueTemporaryFolder> filesFolder;
+    std::vector<std::future<Expected<void>>> saveFilesFutures;
+    for ( auto & model : models )
     {
-        for ( auto i : inProgress )
+        if ( model.saveToStream )
         {
-            if ( saveModelFutures[i].wait_for( std::chrono::milliseconds( 200 ) ) != std::future_status::timeout )
-                inProgress.reset( i );
+            const bool compress = !isCompactModelFormat( model.extension );
+            entries.push_back( { .name = model.name + model.extension, .write = std::move( model.saveToStream ), .compress = compress } );
+            continue;
         }
-        if ( !reportProgress( subprogress( progressCb, 0.1f, 0.9f ), 1.0f - (float)inProgress.count() / inProgress.size() ) )
-            return unexpectedOperationCanceled();
+
+        if ( !filesFolder )
+        {
+            filesFolder.emplace( FolderCallback{} );
+            if ( !*filesFolder )
+                return unexpected( "Cannot create temporary folder" );
+        }
+        const auto modelPath = *filesFolder / pathFromUtf8( model.name );
+        std::error_code ec;
+        if ( !std::filesystem::is_directory( modelPath.parent_path(), ec ) )
+            if ( !std::filesystem::create_directories( modelPath.parent_path(), ec ) )
+                return unexpected( "Cannot create directories " + utf8string( modelPath.parent_path() ) );
+        auto future = model.saveToFiles( modelPath );
+        if ( !future )
+            return unexpected( std::move( future.error() ) );
+        if ( future->valid() )
+            saveFilesFutures.push_back( std::move( *future ) );
     }
-#endif
 
-    for ( auto & f : saveModelFutures )
+    float filesProgress = 0.0f;
+    if ( filesFolder )
     {
-        auto v = f.get();
-        if ( !v )
-            return v;
-    }
+        filesProgress = 0.5f;
+        if ( auto res = waitAll( saveFilesFutures, subprogress( progressCb, 0.0f, filesProgress ) ); !res )
+            return res;
 
-    if ( preCompress )
-        preCompress( scenePath );
+        std::error_code ec;
+        for ( auto entry : DirectoryRecursive{ *filesFolder, ec } )
+        {
+            if ( !entry.is_regular_file( ec ) )
+                continue;
+            const auto filePath = entry.path();
+            auto name = utf8string( std::filesystem::relative( filePath, *filesFolder, ec ) );
+            std::replace( name.begin(), name.end(), '\\', '/' );
+            const bool compress = !isCompactModelFormat( utf8string( filePath.extension() ) );
+            entries.push_back( { .name = std::move( name ), .file = filePath, .compress = compress } );
+        }
+    }
 
-    return compressZip( path, scenePath, {}, nullptr, subprogress( progressCb, 0.9f, 1.0f ) );
+    return compressZip( path, entries, nullptr, subprogress( progressCb, filesProgress, 1.0f ) );
 }
 
 Expected<void> serializeObjectTree( const Object& object, const std::filesystem::path& path, ProgressCallback progress )
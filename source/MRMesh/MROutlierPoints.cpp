@@ -3,13 +3,14 @@
 #include "MRProgressCallback.h"
 #include "MRBitSetParallelFor.h"
 #include "MRBestFit.h"
-#include "MRPointsInBall.h"
+#include "MRPointsKNearest.h"
 #include "MRPointsComponents.h"
 
 namespace MR
 {
 
-Expected<void> OutliersDetector::prepare( const PointCloud& pointCloud, float radius, OutlierTypeMask mask, ProgressCallback progress /*= {}*/ )
+Expected<void> OutliersDetector::prepare( const PointCloud& pointCloud, float radius, OutlierTypeMask mask, ProgressCallback progress /*= {}*/,
+    const AllPointNeighbors* neighbors /*= nullptr*/ )
 {
     validPoints_ = pointCloud.validPoints;
 
@@ -56,20 +57,15 @@ Expected<void> OutliersDetector::prepare( const PointCloud& pointCloud, float ra
             int count = 0;
             PointAccumulator plane;
             Vector3f normalSum;
-            findPointsInBall( pointCloud.getAABBTree(), { pointCloud.points[v0], sqr( radius_ ) },
-                              [&] ( const PointsProjectionResult & found, const Vector3f&, Ball3f & )
+            findNeighborsInRadius( pointCloud, v0, radius_, neighbors, [&] ( VertId v1, float )
             {
-                const auto v1 = found.vId;
                 if ( !contains( validPoints_, v1 ) )
-                    return Processing::Continue;
-                if ( v1 != v0 )
-                {
-                    ++count;
-                    if ( calcBadNormalCached )
-                        normalSum += normals[v1];
-                    if ( calcFarSurfaceCached )
-                        plane.addPoint( points[v1] );
-                }
+                    return;
+                ++count;
+                if ( calcBadNormalCached )
+                    normalSum += normals[v1];
+                if ( calcFarSurfaceCached )
+                    plane.addPoint( points[v1] );
                 if ( calcSmallComponentsCached && v0 < v1 )
                 {
                     if ( v1 >= range.end )
@@ -77,7 +73,6 @@ Expected<void> OutliersDetector::prepare( const PointCloud& pointCloud, float ra
                     else
                         unionFindStructure_.unite( v0, v1 );
                 }
-                return Processing::Continue;
             } );
             if ( calcWeaklyConnectedCached )
                 weaklyConnectedStat_[int( v0 )] = uint8_t( std::min( count, 255 ) );
@@ -108,15 +103,10 @@ Expected<void> OutliersDetector::prepare( const PointCloud& pointCloud, float ra
         const int counterDivider = std::max( lastPassVertsCount / 100, 1 );
         for ( auto v0 : *lastPassVerts )
         {
-            findPointsInBall( pointCloud.getAABBTree(), { pointCloud.points[v0], sqr( radius_ ) },
-                              [&] ( const PointsProjectionResult & found, const Vector3f&, Ball3f & )
+            findNeighborsInRadius( pointCloud, v0, radius_, neighbors, [&] ( VertId v1, float )
             {
-                const auto v1 = found.vId;
                 if ( v0 < v1 && contains( validPoints_, v1 ) )
-                {
                     unionFindStructure_.unite( v0, v1 );
-                }
-                return Processing::Continue;
             } );
             ++counterProcessedVerts;
             if ( !reportProgress( subProgress, counterProcessedVerts / counterMax, counterProcessedVerts, counterDivider ) )
@@ -228,7 +218,7 @@ Expected<VertBitSet> OutliersDetector::findAwayNormal( ProgressCallback progress
 Expected<VertBitSet> findOutliers( const PointCloud& pc, const FindOutliersParams& params )
 {
     OutliersDetector finder;
-    auto res = finder.prepare( pc, params.radius, params.mask, subprogress( params.progress, 0.f, 0.8f ) );
+    auto res = finder.prepare( pc, params.radius, params.mask, subprogress( params.progress, 0.f, 0.8f ), params.neighbors );
     if ( !res.has_value() )
         return unexpected( res.error() );
     finder.setParams( params.finderParams );
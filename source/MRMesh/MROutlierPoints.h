@@ -47,8 +47,10 @@ public:
     /// @param radius radius of the search for neighboring points for analysis
     /// @param mask mask of the types of outliers that are looking for
     /// @param progress progress callback function
+    /// @param neighbors optional precomputed neighbours of each point, used instead of the search if they include all neighbours within the radius
     /// @return error text or nothing
-    MRMESH_API Expected<void> prepare( const PointCloud& pc, float radius, OutlierTypeMask mask, ProgressCallback progress = {} ); // calculate caches
+    MRMESH_API Expected<void> prepare( const PointCloud& pc, float radius, OutlierTypeMask mask, ProgressCallback progress = {},
+        const AllPointNeighbors* neighbors = nullptr ); // calculate caches
 
     /// Set search parameters
     MRMESH_API void setParams( const OutlierParams& params );
@@ -90,6 +92,10 @@ struct FindOutliersParams
 
     OutlierTypeMask mask = OutlierTypeMask::All; ///< Mask of the types of outliers that are looking for
 
+    /// Optional precomputed neighbours of each point (e.g. from PointCloud::getNeighborsInRadius),
+    /// used instead of the search if they include all neighbours within the radius
+    const AllPointNeighbors* neighbors = nullptr;
+
     ProgressCallback progress = {}; ///< Progress callback
 };
 
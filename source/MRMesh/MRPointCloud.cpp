@@ -1,5 +1,6 @@
 #include "MRPointCloud.h"
 #include "MRAABBTreePoints.h"
+#include "MRPointsKNearest.h"
 #include "MRComputeBoundingBox.h"
 #include "MRPlane3.h"
 #include "MRBitSetParallelFor.h"
@@ -117,12 +118,28 @@ const AABBTreePoints& PointCloud::getAABBTree() const
     return AABBTreeOwner_.getOrCreate( [this]{ return AABBTreePoints( *this ); } );
 }
 
+const AllPointNeighbors * PointCloud::getNeighborsInRadius( float radius ) const
+{
+    getAABBTree(); // construct the tree before the table
+    const auto & res = radiusNeighborsOwner_.getOrCreate( [this, radius]{ return *findAllNeighborsInRadius( *this, radius ); } );
+    return res.hasAllInRadius( radius ) ? &res : nullptr;
+}
+
+const AllPointNeighbors * PointCloud::getKNearestNeighbors( int numNei ) const
+{
+    getAABBTree(); // construct the tree before the table
+    const auto & res = kNearestNeighborsOwner_.getOrCreate( [this, numNei]{ return *findAllKNearestPoints( *this, numNei ); } );
+    return res.hasKNearest( numNei ) ? &res : nullptr;
+}
+
 size_t PointCloud::heapBytes() const
 {
     return points.heapBytes()
         + normals.heapBytes()
         + validPoints.heapBytes()
-        + AABBTreeOwner_.heapBytes();
+        + AABBTreeOwner_.heapBytes()
+        + radiusNeighborsOwner_.heapBytes()
+        + kNearestNeighborsOwner_.heapBytes();
 }
 
 void PointCloud::mirror( const Plane3f& plane )
@@ -259,6 +276,8 @@ VertBMap PointCloud::pack( Reorder reoder )
     {
         getAABBTree(); // ensure that tree is constructed
         AABBTreeOwner_.update( [&map]( AABBTreePoints& t ) { t.getLeafOrderAndReset( map ); } );
+        radiusNeighborsOwner_.reset();
+        kNearestNeighborsOwner_.reset();
         if ( !wasPacked )
         {
             ParallelFor( 0_v, map.b.endId(), [&]( VertId v )
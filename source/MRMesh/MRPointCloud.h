@@ -42,6 +42,22 @@ struct PointCloud
     /// returns cached aabb-tree for this point cloud, but does not create it if it did not exist
     [[nodiscard]] const AABBTreePoints * getAABBTreeNotCreate() const { return AABBTreeOwner_.get(); }
 
+    /// returns cached table with all neighbours of each valid point within given distance, creating it if it did not exist in a thread-safe manner;
+    /// returns nullptr if the cached table was built for smaller distance: the table is never rebuilt here to keep previously returned pointers valid,
+    /// call invalidateCaches() before requesting larger distance
+    [[nodiscard]] MRMESH_API const AllPointNeighbors * getNeighborsInRadius( float radius ) const;
+
+    /// returns cached table with given number of the closest neighbours of each valid point, creating it if it did not exist in a thread-safe manner;
+    /// returns nullptr if the cached table was built for smaller number of neighbours: the table is never rebuilt here to keep previously returned pointers valid,
+    /// call invalidateCaches() before requesting more neighbours
+    [[nodiscard]] MRMESH_API const AllPointNeighbors * getKNearestNeighbors( int numNei ) const;
+
+    /// returns cached table with all neighbours of points within some distance, but does not create it if it did not exist
+    [[nodiscard]] const AllPointNeighbors * getNeighborsInRadiusNotCreate() const { return radiusNeighborsOwner_.get(); }
+
+    /// returns cached table with the closest neighbours of points, but does not create it if it did not exist
+    [[nodiscard]] const AllPointNeighbors * getKNearestNeighborsNotCreate() const { return kNearestNeighborsOwner_.get(); }
+
     /// returns the minimal bounding box containing all valid vertices (implemented via getAABBTree())
     [[nodiscard]] MRMESH_API Box3f getBoundingBox() const;
 
@@ -86,13 +102,15 @@ struct PointCloud
     MRMESH_API VertBMap pack( Reorder reoder );
 
     /// Invalidates caches (e.g. aabb-tree) after a change in point cloud
-    void invalidateCaches() { AABBTreeOwner_.reset(); }
+    void invalidateCaches() { AABBTreeOwner_.reset(); radiusNeighborsOwner_.reset(); kNearestNeighborsOwner_.reset(); }
 
     /// returns the amount of memory this object occupies on heap
     [[nodiscard]] MRMESH_API size_t heapBytes() const;
 
 private:
     mutable SharedThreadSafeOwner<AABBTreePoints> AABBTreeOwner_;
+    mutable SharedThreadSafeOwner<AllPointNeighbors> radiusNeighborsOwner_;
+    mutable SharedThreadSafeOwner<AllPointNeighbors> kNearestNeighborsOwner_;
 };
 
 } // namespace MR
@@ -5,11 +5,11 @@
 #include "MRBox.h"
 #include "MRBitSetParallelFor.h"
 #include "MRBestFit.h"
-#include "MRPointsInBall.h"
 #include "MRTimer.h"
 #include "MRPlane3.h"
 #include "MRPointCloudRadius.h"
 #include "MRPointsProject.h"
+#include "MRPointsKNearest.h"
 #include "MRHeap.h"
 #include "MRBuffer.h"
 #include "MRLocalTriangulations.h"
@@ -18,19 +18,20 @@
 namespace MR
 {
 
-std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud, float radius, const ProgressCallback & progress, OrientNormals orient )
+std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud, float radius, const ProgressCallback & progress, OrientNormals orient,
+    const AllPointNeighbors * neis )
 {
     MR_TIMER;
 
     VertNormals normals;
     normals.resizeNoInit( pointCloud.points.size() );
-    if ( !BitSetParallelFor( pointCloud.validPoints, [&, radiusSq = sqr( radius )]( VertId vid )
+    if ( !BitSetParallelFor( pointCloud.validPoints, [&]( VertId vid )
     {
         PointAccumulator accum;
-        findPointsInBall( pointCloud, { pointCloud.points[vid], radiusSq }, [&]( const PointsProjectionResult &, const Vector3f & foundPos, Ball3f & )
+        accum.addPoint( pointCloud.points[vid] );
+        findNeighborsInRadius( pointCloud, vid, radius, neis, [&]( VertId u, float )
         {
-            accum.addPoint( Vector3d( foundPos ) );
-            return Processing::Continue;
+            accum.addPoint( pointCloud.points[u] );
         } );
         auto n = Vector3f( accum.getBestPlane().n );
         if ( orient != OrientNormals::Smart )
@@ -94,6 +95,32 @@ std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud,
     return normals;
 }
 
+std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud,
+    const AllPointNeighbors & neis, const ProgressCallback & progress, OrientNormals orient )
+{
+    MR_TIMER;
+
+    VertNormals normals;
+    normals.resizeNoInit( pointCloud.points.size() );
+    if ( !BitSetParallelFor( pointCloud.validPoints, [&]( VertId vid )
+    {
+        PointAccumulator accum;
+        accum.addPoint( pointCloud.points[vid] );
+        for ( auto n : neis.get( vid ) )
+            accum.addPoint( pointCloud.points[n] );
+        auto n = Vector3f( accum.getBestPlane().n );
+        if ( orient != OrientNormals::Smart )
+        {
+            if ( ( dot( n, pointCloud.points[vid] ) > 0 ) == ( orient == OrientNormals::TowardOrigin ) )
+                n = -n;
+        }
+        normals[vid] = n;
+    }, progress ) )
+        return {};
+
+    return normals;
+}
+
 template<class T>
 bool orientNormalsCore( const PointCloud& pointCloud, VertNormals& normals, const T & enumNeis, ProgressCallback progress )
 {
@@ -181,18 +208,16 @@ bool orientNormalsCore( const PointCloud& pointCloud, VertNormals& normals, cons
     return true;
 }
 
-bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, float radius, const ProgressCallback & progress )
+bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, float radius, const ProgressCallback & progress,
+    const AllPointNeighbors * neis )
 {
     return orientNormalsCore( pointCloud, normals,
-        [&, radiusSq = sqr( radius )]( VertId base, auto callback )
+        [&]( VertId base, auto callback )
         {
-            findPointsInBall( pointCloud, { pointCloud.points[base], radiusSq },
-                [&]( const PointsProjectionResult & found, const Vector3f &, Ball3f & )
-                {
-                    if ( found.vId != base )
-                        callback( found.vId );
-                    return Processing::Continue;
-                } );
+            findNeighborsInRadius( pointCloud, base, radius, neis, [&]( VertId u, float )
+            {
+                callback( u );
+            } );
         }, progress );
 }
 
@@ -209,6 +234,17 @@ bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, const Bu
         }, progress );
 }
 
+bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, const AllPointNeighbors & neis,
+    const ProgressCallback & progress )
+{
+    return orientNormalsCore( pointCloud, normals,
+        [&neis]( VertId base, auto callback )
+        {
+            for ( auto n : neis.get( base ) )
+                callback( n );
+        }, progress );
+}
+
 bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, const AllLocalTriangulations& triangs,
      const ProgressCallback & progress )
 {
@@ -224,15 +260,15 @@ bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, const Al
 }
 
 std::optional<VertNormals> makeOrientedNormals( const PointCloud& pointCloud,
-    float radius, const ProgressCallback & progress )
+    float radius, const ProgressCallback & progress, const AllPointNeighbors * neis )
 {
     MR_TIMER;
 
-    auto optNormals = makeUnorientedNormals( pointCloud, radius, subprogress( progress, 0.0f, 0.1f ) );
+    auto optNormals = makeUnorientedNormals( pointCloud, radius, subprogress( progress, 0.0f, 0.1f ), OrientNormals::Smart, neis );
     if ( !optNormals )
         return optNormals;
 
-    if ( !orientNormals( pointCloud, *optNormals, radius, subprogress( progress, 0.1f, 1.0f ) ) )
+    if ( !orientNormals( pointCloud, *optNormals, radius, subprogress( progress, 0.1f, 1.0f ), neis ) )
         optNormals.reset();
 
     return optNormals;
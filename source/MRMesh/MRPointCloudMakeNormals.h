@@ -10,10 +10,11 @@ namespace MR
 /// \brief Makes normals for valid points of given point cloud by directing them along the normal of best plane through the neighbours
 /// \param radius of neighborhood to consider
 /// \param orient OrientNormals::Smart here means orientation from best fit plane
+/// \param neis optional precomputed neighbours of each point, used instead of the search if they include all neighbours within the radius
 /// \return nullopt if progress returned false
 /// \ingroup PointCloudGroup
 [[nodiscard]] MRMESH_API std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud,
-    float radius, const ProgressCallback & progress = {}, OrientNormals orient = OrientNormals::Smart );
+    float radius, const ProgressCallback & progress = {}, OrientNormals orient = OrientNormals::Smart, const AllPointNeighbors * neis = nullptr );
 
 /// \brief Makes normals for valid points of given point cloud by averaging neighbor triangle normals weighted by triangle's angle
 /// \triangs triangulation neighbours of each point
@@ -31,12 +32,21 @@ namespace MR
 [[nodiscard]] MRMESH_API std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud,
     const Buffer<VertId> & closeVerts, int numNei, const ProgressCallback & progress = {}, OrientNormals orient = OrientNormals::Smart );
 
+/// \brief Makes normals for valid points of given point cloud by directing them along the normal of best plane through the neighbours
+/// \param neis the table with the neighbours of each point, e.g. from \ref findAllKNearestPoints
+/// \param orient OrientNormals::Smart here means orientation from best fit plane
+/// \return nullopt if progress returned false
+/// \ingroup PointCloudGroup
+[[nodiscard]] MRMESH_API std::optional<VertNormals> makeUnorientedNormals( const PointCloud& pointCloud,
+    const AllPointNeighbors & neis, const ProgressCallback & progress = {}, OrientNormals orient = OrientNormals::Smart );
+
 /// \brief Select orientation of given normals to make directions of close points consistent;
 /// \param radius of neighborhood to consider
+/// \param neis optional precomputed neighbours of each point, used instead of the search if they include all neighbours within the radius
 /// \return false if progress returned false
 /// \ingroup PointCloudGroup
 MRMESH_API bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, float radius,
-    const ProgressCallback & progress = {} );
+    const ProgressCallback & progress = {}, const AllPointNeighbors * neis = nullptr );
 
 /// \brief Select orientation of given normals to make directions of close points consistent;
 /// \param radius of neighborhood to consider
@@ -55,12 +65,20 @@ MRMESH_API bool orientNormals( const PointCloud& pointCloud, VertNormals& normal
 MRMESH_API bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, const Buffer<VertId> & closeVerts, int numNei,
     const ProgressCallback & progress = {} );
 
+/// \brief Select orientation of given normals to make directions of close points consistent;
+/// \param neis the table with the neighbours of each point, e.g. from \ref findAllKNearestPoints
+/// \return false if progress returned false
+/// \ingroup PointCloudGroup
+MRMESH_API bool orientNormals( const PointCloud& pointCloud, VertNormals& normals, const AllPointNeighbors & neis,
+    const ProgressCallback & progress = {} );
+
 /// \brief Makes normals for valid points of given point cloud; directions of close points are selected to be consistent;
 /// \param radius of neighborhood to consider
+/// \param neis optional precomputed neighbours of each point, used instead of the search if they include all neighbours within the radius
 /// \return nullopt if progress returned false
 /// \ingroup PointCloudGroup
 [[nodiscard]] MRMESH_API std::optional<VertNormals> makeOrientedNormals( const PointCloud& pointCloud,
-    float radius, const ProgressCallback & progress = {} );
+    float radius, const ProgressCallback & progress = {}, const AllPointNeighbors * neis = nullptr );
 
 /// \brief Makes normals for valid points of given point cloud; directions of close points are selected to be consistent;
 /// \triangs triangulation neighbours of each point, which are oriented during the call as well
@@ -59,7 +59,8 @@ std::optional<Mesh> PointCloudTriangulator::triangulate( ProgressCallback progre
             .boundaryAngle = params_.boundaryAngle,
             .trustedNormals = pointCloud_.hasNormals() ? &pointCloud_.normals : nullptr,
             .automaticRadiusIncrease = params_.automaticRadiusIncrease,
-            .searchNeighbors = params_.searchNeighbors
+            .searchNeighbors = params_.searchNeighbors,
+            .neighbors = params_.neighbors
         }, subprogress( progressCb, 0.0f, pointCloud_.hasNormals() ? 0.4f : 0.3f ) );
     if ( !optLocalTriangulations )
         return {};
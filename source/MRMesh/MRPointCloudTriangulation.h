@@ -69,6 +69,10 @@ struct TriangulationParameters
 
     /// optional: if provided this cloud will be used for searching of neighbors (so it must have same validPoints)
     const PointCloud * searchNeighbors = nullptr;
+
+    /// optional: precomputed neighbors of each point (e.g. from PointCloud::getKNearestNeighbors),
+    /// used instead of the search if they include all required neighbors
+    const AllPointNeighbors * neighbors = nullptr;
 };
 
 /**
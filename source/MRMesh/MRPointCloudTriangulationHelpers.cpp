@@ -3,6 +3,7 @@
 #include "MRVector3.h"
 #include "MRPointCloud.h"
 #include "MRPointsInBall.h"
+#include "MRPointsKNearest.h"
 #include "MRBestFit.h"
 #include "MRPlane3.h"
 #include "MRTriMath.h"
@@ -112,6 +113,37 @@ void findNeighborsInBall( const PointCloud& pointCloud, VertId v, float radius,
     } );
 }
 
+/// finds all neighbors of v in given radius (v excluded) taking them from precomputed table if possible
+static void findNeighborsInBall( const PointCloud& pointCloud, VertId v, float radius, const AllPointNeighbors * neis,
+    std::vector<VertId>& neighbors )
+{
+    if ( !neis || !neis->hasAllInRadius( radius ) )
+        return findNeighborsInBall( pointCloud, v, radius, neighbors );
+    neighbors.clear();
+    findNeighborsInRadius( pointCloud, v, radius, neis, [&]( VertId u, float )
+    {
+        neighbors.push_back( u );
+    } );
+}
+
+/// takes given number of the closest neighbors of v (v excluded) from precomputed table
+/// \return maxDistSq to the furthest returned neighbor (or 0 if no neighbours are returned)
+static float takeNumNeighbors( const PointCloud& pointCloud, VertId v, int numNeis, const AllPointNeighbors & neis,
+    std::vector<VertId>& neighbors )
+{
+    assert( neis.hasKNearest( numNeis ) );
+    neighbors.clear();
+    float maxDistSq = 0;
+    for ( auto u : neis.get( v ) )
+    {
+        if ( neighbors.size() >= size_t( numNeis ) )
+            break;
+        neighbors.push_back( u );
+        maxDistSq = ( pointCloud.points[u] - pointCloud.points[v] ).lengthSq();
+    }
+    return maxDistSq;
+}
+
 float findNumNeighbors( const PointCloud& pointCloud, VertId v, int numNeis, std::vector<VertId>& neighbors,
     FewSmallest<PointsProjectionResult> & tmp, float upDistLimitSq )
 {
@@ -485,20 +517,13 @@ static void trianglulateFan( const VertCoords& points, VertId centerVert, Triang
     assert( triangulationData.neighbors.empty() || triangulationData.neighbors.size() > 1 );
 }
 
-void buildLocalTriangulation( const PointCloud& cloud, VertId v, const Settings & settings,
-    TriangulatedFanData & fanData )
+/// constructs local triangulation around given point from already found initial neighbors in fanData.neighbors
+/// \param actualRadius the radius of the search for initial neighbors
+static void buildLocalTriangulationFromNeighbors( const PointCloud& cloud, VertId v, const Settings & settings,
+    TriangulatedFanData & fanData, float actualRadius )
 {
-    float actualRadius = settings.radius;
-    assert( ( settings.radius > 0 && settings.numNeis == 0 )
-         || ( settings.radius == 0 && settings.numNeis > 0 ) );
-
     const auto & searchCloud = settings.searchNeighbors ? *settings.searchNeighbors : cloud;
 
-    if ( settings.radius > 0 )
-        findNeighborsInBall( searchCloud, v, actualRadius, fanData.neighbors );
-    else
-        actualRadius = std::sqrt( findNumNeighbors( searchCloud, v, settings.numNeis, fanData.neighbors, fanData.nearesetPoints ) );
-
     if ( settings.trustedNormals )
         filterNeighbors( *settings.trustedNormals, v, fanData.neighbors );
     if ( settings.allNeighbors )
@@ -516,7 +541,7 @@ void buildLocalTriangulation( const PointCloud& cloud, VertId v, const Settings
             // update triangulation if radius was increased
             actualRadius = maxRadius;
             if ( settings.radius > 0 )
-                findNeighborsInBall( searchCloud, v, actualRadius, fanData.neighbors );
+                findNeighborsInBall( searchCloud, v, actualRadius, settings.neighbors, fanData.neighbors );
             else
             {
                 // if the center point is an outlier then there may be too many points withing the ball of maxRadius;
@@ -536,6 +561,25 @@ void buildLocalTriangulation( const PointCloud& cloud, VertId v, const Settings
         *settings.actualRadius = actualRadius;
 }
 
+void buildLocalTriangulation( const PointCloud& cloud, VertId v, const Settings & settings,
+    TriangulatedFanData & fanData )
+{
+    float actualRadius = settings.radius;
+    assert( ( settings.radius > 0 && settings.numNeis == 0 )
+         || ( settings.radius == 0 && settings.numNeis > 0 ) );
+
+    const auto & searchCloud = settings.searchNeighbors ? *settings.searchNeighbors : cloud;
+
+    if ( settings.radius > 0 )
+        findNeighborsInBall( searchCloud, v, actualRadius, settings.neighbors, fanData.neighbors );
+    else if ( settings.neighbors && settings.neighbors->hasKNearest( settings.numNeis ) )
+        actualRadius = std::sqrt( takeNumNeighbors( searchCloud, v, settings.numNeis, *settings.neighbors, fanData.neighbors ) );
+    else
+        actualRadius = std::sqrt( findNumNeighbors( searchCloud, v, settings.numNeis, fanData.neighbors, fanData.nearesetPoints ) );
+
+    buildLocalTriangulationFromNeighbors( cloud, v, settings, fanData, actualRadius );
+}
+
 std::optional<std::vector<SomeLocalTriangulations>> buildLocalTriangulations(
     const PointCloud& cloud, const Settings & settings, const ProgressCallback & progress )
 {
@@ -553,15 +597,38 @@ std::optional<std::vector<SomeLocalTriangulations>> buildLocalTriangulations(
     };
     tbb::enumerable_thread_specific<PerThreadData> threadData;
 
-    if ( !BitSetParallelFor( cloud.validPoints, [&]( VertId v )
+    auto addFan = [&]( PerThreadData & localData, VertId v )
     {
-        auto& localData = threadData.local();
-        auto& disc = localData.fanData;
-        TriangulationHelpers::buildLocalTriangulation( cloud, v, settings, disc );
-
+        const auto& disc = localData.fanData;
         localData.fanRecords.push_back( { v, disc.border, (std::uint32_t)localData.neighbors.size() } );
         localData.neighbors.insert( localData.neighbors.end(), disc.neighbors.begin(), disc.neighbors.end() );
         localData.maxCenterId = std::max( localData.maxCenterId, v );
+    };
+
+    if ( settings.numNeis > 0 && !settings.searchNeighbors && !( settings.neighbors && settings.neighbors->hasKNearest( settings.numNeis ) ) )
+    {
+        // initial neighbors of all points are found leaf by leaf, which is much faster than independent search for each point
+        if ( !findKNearestForEachPoint( cloud, settings.numNeis, [&]( VertId v, IteratorRange<const PointsProjectionResult*> neis )
+        {
+            auto& localData = threadData.local();
+            auto& disc = localData.fanData;
+            disc.neighbors.clear();
+            float maxDistSq = 0;
+            for ( const auto & n : neis )
+            {
+                disc.neighbors.push_back( n.vId );
+                maxDistSq = n.distSq;
+            }
+            buildLocalTriangulationFromNeighbors( cloud, v, settings, disc, std::sqrt( maxDistSq ) );
+            addFan( localData, v );
+        }, FLT_MAX, progress ) )
+            return {};
+    }
+    else if ( !BitSetParallelFor( cloud.validPoints, [&]( VertId v )
+    {
+        auto& localData = threadData.local();
+        TriangulationHelpers::buildLocalTriangulation( cloud, v, settings, localData.fanData );
+        addFan( localData, v );
     }, progress ) )
         return {};
 
@@ -133,6 +133,10 @@ struct Settings
 
     /// optional: if provided this cloud will be used for searching of neighbors (so it must have same validPoints)
     const PointCloud * searchNeighbors = nullptr;
+
+    /// optional: precomputed neighbors of each point (in searchNeighbors if it is given),
+    /// used instead of the search if they include all required neighbors
+    const AllPointNeighbors * neighbors = nullptr;
 };
 
 /// constructs local triangulation around given point
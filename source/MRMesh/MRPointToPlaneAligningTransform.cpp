@@ -13,7 +13,7 @@ void PointToPlaneAligningTransform::add( const Vector3d& s, const Vector3d& d, c
 {
     Vector3d n = normal2.normalized();
     double k_B = dot( d, n );
-    double c[7];
+    Eigen::Vector<double, 7> c;
     // https://www.cs.princeton.edu/~smr/papers/icpstability.pdf
     c[0] = n.z * s.y - n.y * s.z;
     c[1] = n.x * s.z - n.z * s.x;
@@ -22,31 +22,20 @@ void PointToPlaneAligningTransform::add( const Vector3d& s, const Vector3d& d, c
     c[4] = n.y;
     c[5] = n.z;
     c[6] = dot( s, n );
-    // update upper-right part of sumA_
-    for (size_t i = 0; i < 7; i++)
-    {
-        for (size_t j = i; j < 7; j++)
-            sumA_(i, j) += w * c[i] * c[j];
-
-        sumB_(i) += w * c[i] * k_B;
-    }
-    sumAIsSym_ = false;
+    // full outer product is vectorized better than the update of upper-right part only
+    const Eigen::Vector<double, 7> wc = w * c;
+    sumA_.noalias() += wc * c.transpose();
+    sumB_ += k_B * wc;
 }
 
-void PointToPlaneAligningTransform::prepare()
+void PointToPlaneAligningTransform::add( const PointToPlaneAligningTransform & other )
 {
-    if ( sumAIsSym_ )
-        return;
-    // copy values in lower-left part
-    for (size_t i = 1; i < 7; i++)
-        for (size_t j = 0; j < i; j++)
-            sumA_(i, j) = sumA_(j, i);
-    sumAIsSym_ = true;
+    sumA_ += other.sumA_;
+    sumB_ += other.sumB_;
 }
 
 auto PointToPlaneAligningTransform::calculateAmendment() const -> RigidScaleXf3d
 {
-    assert( sumAIsSym_ );
     Eigen::LLT<Eigen::MatrixXd> chol( sumA_.topLeftCorner<6,6>() );
     Eigen::VectorXd solution = chol.solve( sumB_.topRows<6>() - sumA_.block<6,1>( 0, 6 ) );
 
@@ -58,7 +47,6 @@ auto PointToPlaneAligningTransform::calculateAmendment() const -> RigidScaleXf3d
 
 auto PointToPlaneAligningTransform::calculateAmendmentWithScale() const -> RigidScaleXf3d
 {
-    assert( sumAIsSym_ );
     Eigen::LLT<Eigen::MatrixXd> chol( sumA_ );
     Eigen::VectorXd solution = chol.solve( sumB_ );
 
@@ -74,7 +62,6 @@ auto PointToPlaneAligningTransform::calculateFixedAxisAmendment( const Vector3d
     if ( axis.lengthSq() <= 0 )
         return calculateAmendment();
 
-    assert( sumAIsSym_ );
     Eigen::Matrix<double, 4, 4> A;
     Eigen::Matrix<double, 4, 1> b;
 
@@ -105,7 +92,6 @@ auto PointToPlaneAligningTransform::calculateOrthogonalAxisAmendment( const Vect
     if ( ort.lengthSq() <= 0 )
         return calculateAmendment();
 
-    assert( sumAIsSym_ );
     Eigen::Matrix<double, 5, 5> A;
     Eigen::Matrix<double, 5, 1> b;
     Eigen::Matrix<double, 3, 2> k;
@@ -137,7 +123,6 @@ auto PointToPlaneAligningTransform::calculateOrthogonalAxisAmendment( const Vect
 
 Vector3d PointToPlaneAligningTransform::findBestTranslation( Vector3d rotAngles, double scale ) const
 {
-    assert( sumAIsSym_ );
     Eigen::LLT<Eigen::MatrixXd> chol( sumA_.block<3,3>(3, 3) );
     Eigen::VectorXd solution = chol.solve( sumB_.middleRows<3>( 3 )
         - ( sumA_.block<3,3>( 3, 0 ) * toEigen( rotAngles ) + sumA_.block<3,1>( 3, 6 ) ) * scale );
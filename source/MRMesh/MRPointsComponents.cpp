@@ -6,6 +6,7 @@
 #include "MRProgressCallback.h"
 #include "MRPch/MRTBB.h"
 #include "MRBitSetParallelFor.h"
+#include "MRConcurrentUnionFind.h"
 
 namespace MR
 {
@@ -185,63 +186,24 @@ Expected<UnionFind<VertId>> getUnionFindStructureVerts( const PointCloud& pointC
     if ( !vertsRegion.any() )
         return unexpected( std::string( "Chosen region empty" ) );
 
-    const VertBitSet* lastPassVerts = &vertsRegion;
     const auto numVerts = vertsRegion.find_last() + 1;
-    UnionFind<VertId> unionFindStructure( numVerts );
-    const auto numThreads = int( tbb::global_control::active_value( tbb::global_control::max_allowed_parallelism ) );
-
-    VertBitSet bdVerts;
-    ProgressCallback subPc = subprogress( pc, 0.f, 1.0f );
+    ConcurrentUnionFind<VertId> unionFindStructure( numVerts );
     const auto maxDistSq = sqr( maxDist );
-    if ( numThreads > 1 )
-    {
-        bdVerts.resize( numVerts );
-        lastPassVerts = &bdVerts;
-        subPc = subprogress( pc, 0.f, 0.7f );
-        BitSetParallelForAllRanged( vertsRegion, [&] ( VertId v0, const auto & range )
-        {
-            if ( !contains( vertsRegion, v0 ) )
-                return;
-            findPointsInBall( pointCloud.getAABBTree(), { pointCloud.points[v0], maxDistSq },
-                [&] ( const PointsProjectionResult & found, const Vector3f &, Ball3f & )
-            {
-                const auto v1 = found.vId;
-                if ( v0 < v1 && contains( vertsRegion, v1 ) )
-                {
-                    if ( v1 >= range.end )
-                        bdVerts.set( v0 );
-                    else
-                        unionFindStructure.unite( v0, v1 );
-                }
-                return Processing::Continue;
-            } );
-        }, subPc );
-        if ( !reportProgress( subPc, 1.f ) )
-            return unexpectedOperationCanceled();
-        subPc = subprogress( pc, 0.7f, 1.f );
-    }
-
-    int counterProcessedVerts = 0;
-    const float counterMax = float( lastPassVerts->count() );
-    const int counterDivider = int( lastPassVerts->count() ) / 100;
-    for ( auto v0 : *lastPassVerts )
+    const auto & tree = pointCloud.getAABBTree();
+    if ( !BitSetParallelFor( vertsRegion, [&] ( VertId v0 )
     {
-        findPointsInBall( pointCloud.getAABBTree(), { pointCloud.points[v0], maxDistSq },
+        findPointsInBall( tree, { pointCloud.points[v0], maxDistSq },
             [&] ( const PointsProjectionResult & found, const Vector3f &, Ball3f & )
         {
             const auto v1 = found.vId;
             if ( v0 < v1 && contains( vertsRegion, v1 ) )
-            {
                 unionFindStructure.unite( v0, v1 );
-            }
             return Processing::Continue;
         } );
-        ++counterProcessedVerts;
-        if ( !reportProgress( subPc, counterProcessedVerts / counterMax, counterProcessedVerts, counterDivider ) )
-            return unexpectedOperationCanceled();
-    }
+    }, pc ) )
+        return unexpectedOperationCanceled();
 
-    return unionFindStructure;
+    return std::move( unionFindStructure ).toUnionFind();
 }
 
 }
@@ -0,0 +1,415 @@
+#include "MRPointsKNearest.h"
+#include "MRPointCloud.h"
+#include "MRAABBTreePoints.h"
+#include "MRPointsInBall.h"
+#include "MRHeapBytes.h"
+#include "MRParallelFor.h"
+#include "MRTimer.h"
+#include "MRPch/MRTBB.h"
+#include <algorithm>
+
+namespace MR
+{
+
+size_t AllPointNeighbors::heapBytes() const
+{
+    return MR::heapBytes( neighbors ) + firstNei.heapBytes();
+}
+
+namespace
+{
+
+constexpr int MaxLeafPoints = AABBTreePoints::MaxNumPointsInLeaf;
+
+/// the points of one leaf with the coordinates stored separately to vectorize distance computation
+class LeafPoints
+{
+public:
+    explicit LeafPoints( const AABBTreePoints& tree ) : tree_( tree ) {}
+
+    /// loads the points of given leaf
+    void load( NodeId leaf );
+
+    /// the index of the first point of current leaf in tree.orderedPoints()
+    int first() const { return first_; }
+    int size() const { return size_; }
+
+    /// computes squared distances from given point to all points of current leaf
+    void distancesSq( const Vector3f& c, float* distSq ) const
+    {
+        // independent iterations to let the compiler vectorize them
+        for ( int q = 0; q < MaxLeafPoints; ++q )
+            distSq[q] = sqr( x_[q] - c.x ) + sqr( y_[q] - c.y ) + sqr( z_[q] - c.z );
+    }
+
+    const AABBTreePoints& tree() const { return tree_; }
+
+private:
+    const AABBTreePoints& tree_;
+    int first_ = 0;
+    int size_ = 0;
+    float x_[MaxLeafPoints];
+    float y_[MaxLeafPoints];
+    float z_[MaxLeafPoints];
+};
+
+void LeafPoints::load( NodeId leaf )
+{
+    const auto [first, last] = tree_[leaf].getLeafPointRange();
+    assert( last - first <= MaxLeafPoints );
+    first_ = first;
+    size_ = last - first;
+    const auto& orderedPoints = tree_.orderedPoints();
+    for ( int q = 0; q < MaxLeafPoints; ++q )
+    {
+        // the coordinates after the last leaf point are only used in the computations with ignored results
+        const auto p = q < size_ ? orderedPoints[first_ + q].coord : Vector3f{};
+        x_[q] = p.x;
+        y_[q] = p.y;
+        z_[q] = p.z;
+    }
+}
+
+/// the closest points found so far for every point of one leaf;
+/// each point has an array of numNei candidates sorted by increasing distance
+class LeafKNearest
+{
+public:
+    LeafKNearest( const AABBTreePoints& tree, int numNei, float upDistLimitSq )
+        : leafPoints_( tree ), numNei_( numNei ), upDistLimitSq_( upDistLimitSq ), found_( size_t( MaxLeafPoints ) * numNei ) {}
+
+    /// starts the search for the points of given leaf
+    void reset( NodeId leaf );
+
+    /// considers the points of given leaf as the candidates for all points of current leaf
+    void addCandidates( NodeId leaf );
+
+    /// a box with not smaller squared distance to the box of current leaf cannot contain any candidate
+    float maxTopDistSq() const { return maxTopDistSq_; }
+
+    /// passes the candidates of all points to the callback
+    void passFound( const FoundKNearestCallback& foundCb ) const;
+
+private:
+    LeafPoints leafPoints_;
+    const int numNei_;
+    const float upDistLimitSq_;
+
+    /// the squared distance to the last candidate if numNei of them are found, or upDistLimitSq otherwise
+    float topDistSq_[MaxLeafPoints];
+    int numFound_[MaxLeafPoints];
+    float maxTopDistSq_ = 0;
+
+    /// numNei_ candidates for each leaf point
+    std::vector<PointsProjectionResult> found_;
+};
+
+void LeafKNearest::reset( NodeId leaf )
+{
+    leafPoints_.load( leaf );
+    for ( int q = 0; q < MaxLeafPoints; ++q )
+    {
+        topDistSq_[q] = upDistLimitSq_;
+        numFound_[q] = 0;
+    }
+    maxTopDistSq_ = upDistLimitSq_;
+}
+
+void LeafKNearest::addCandidates( NodeId leaf )
+{
+    const auto& tree = leafPoints_.tree();
+    const auto [first, last] = tree[leaf].getLeafPointRange();
+    const auto& orderedPoints = tree.orderedPoints();
+    const int first0 = leafPoints_.first();
+    const int size0 = leafPoints_.size();
+    float distSq[MaxLeafPoints];
+    for ( int i = first; i < last; ++i )
+    {
+        const auto& c = orderedPoints[i];
+        leafPoints_.distancesSq( c.coord, distSq );
+        for ( int q = 0; q < size0; ++q )
+        {
+            if ( !( distSq[q] < topDistSq_[q] ) || i == first0 + q )
+                continue;
+            const PointsProjectionResult cand{ .distSq = distSq[q], .vId = c.id };
+            auto * f = found_.data() + size_t( q ) * numNei_;
+            int & numFound = numFound_[q];
+            int pos = numFound < numNei_ ? numFound++ : numNei_ - 1;
+            for ( ; pos > 0 && cand < f[pos - 1]; --pos )
+                f[pos] = f[pos - 1];
+            f[pos] = cand;
+            if ( numFound == numNei_ )
+                topDistSq_[q] = f[numNei_ - 1].distSq;
+        }
+    }
+    maxTopDistSq_ = *std::max_element( topDistSq_, topDistSq_ + size0 );
+}
+
+void LeafKNearest::passFound( const FoundKNearestCallback& foundCb ) const
+{
+    const auto& orderedPoints = leafPoints_.tree().orderedPoints();
+    for ( int q = 0; q < leafPoints_.size(); ++q )
+    {
+        const auto * f = found_.data() + size_t( q ) * numNei_;
+        foundCb( orderedPoints[leafPoints_.first() + q].id, { f, f + numFound_[q] } );
+    }
+}
+
+std::vector<NodeId> getLeaves( const AABBTreePoints& tree )
+{
+    const auto& nodes = tree.nodes();
+    std::vector<NodeId> leaves;
+    leaves.reserve( ( nodes.size() + 1 ) / 2 );
+    for ( NodeId n( 0 ); n < nodes.size(); ++n )
+        if ( nodes[n].leaf() )
+            leaves.push_back( n );
+    return leaves;
+}
+
+struct SubTask
+{
+    NodeId n;
+    float distSq;
+    SubTask() : n( noInit ) {}
+    SubTask( NodeId n, float dd ) : n( n ), distSq( dd ) {}
+};
+
+/// calls visit for every leaf of the tree except given one, which passes the test on squared distance between its box and the box of given leaf;
+/// the leaves with smaller distance are visited first; the test is repeated before the visit since its result may change after previous visits
+template<typename T, typename V>
+void visitCloseLeaves( const AABBTreePoints& tree, NodeId leaf, T && test, V && visit )
+{
+    const auto& nodes = tree.nodes();
+    const auto& leafBox = nodes[leaf].box;
+
+    constexpr int MaxStackSize = 32; // to avoid allocations
+    SubTask subtasks[MaxStackSize];
+    int stackSize = 0;
+
+    auto getSubTask = [&] ( NodeId n )
+    {
+        return SubTask( n, nodes[n].box.getDistanceSq( leafBox ) );
+    };
+
+    auto addSubTask = [&] ( const SubTask& s )
+    {
+        if ( s.n != leaf && test( s.distSq ) )
+        {
+            assert( stackSize < MaxStackSize );
+            subtasks[stackSize++] = s;
+        }
+    };
+
+    addSubTask( getSubTask( tree.rootNodeId() ) );
+
+    while ( stackSize > 0 )
+    {
+        const auto s = subtasks[--stackSize];
+        if ( !test( s.distSq ) )
+            continue;
+        const auto& node = nodes[s.n];
+        if ( node.leaf() )
+        {
+            visit( s.n );
+            continue;
+        }
+
+        auto s1 = getSubTask( node.l );
+        auto s2 = getSubTask( node.r );
+        // add task with smaller distance last to descend there first
+        if ( s1.distSq < s2.distSq )
+        {
+            addSubTask( s2 );
+            addSubTask( s1 );
+        }
+        else
+        {
+            addSubTask( s1 );
+            addSubTask( s2 );
+        }
+    }
+}
+
+} //anonymous namespace
+
+bool findKNearestForEachPoint( const PointCloud& pc, int numNei, const FoundKNearestCallback & foundCb,
+    float upDistLimitSq, const ProgressCallback & progress )
+{
+    MR_TIMER;
+    assert( numNei >= 1 );
+    const auto& tree = pc.getAABBTree();
+    const auto leaves = getLeaves( tree );
+
+    tbb::enumerable_thread_specific<LeafKNearest> threadData( std::cref( tree ), numNei, upDistLimitSq );
+    return ParallelFor( leaves, threadData, [&] ( size_t i, LeafKNearest & knn )
+    {
+        const auto leaf = leaves[i];
+        knn.reset( leaf );
+        // the points of the same leaf are most probably among the closest ones, so start from them to reduce the search
+        knn.addCandidates( leaf );
+        visitCloseLeaves( tree, leaf,
+            [&knn]( float distSq ) { return distSq < knn.maxTopDistSq(); },
+            [&knn]( NodeId n ) { knn.addCandidates( n ); } );
+        knn.passFound( foundCb );
+    }, progress, 64 );
+}
+
+std::optional<AllPointNeighbors> findAllKNearestPoints( const PointCloud& pc, int numNei,
+    float upDistLimitSq, const ProgressCallback & progress )
+{
+    MR_TIMER;
+    assert( numNei >= 1 );
+
+    // reserve space for maximal possible number of neighbours of each valid point
+    const auto numValid = pc.validPoints.count();
+    const size_t maxNumNei = numValid > 0 ? std::min( size_t( numNei ), numValid - 1 ) : 0;
+    AllPointNeighbors res;
+    if ( upDistLimitSq == FLT_MAX )
+        res.numNei = numNei;
+    res.firstNei.resize( pc.points.size() + 1 );
+    size_t total = 0;
+    for ( VertId v = 0_v; v < pc.points.size(); ++v )
+    {
+        res.firstNei[v] = total;
+        if ( pc.validPoints.test( v ) )
+            total += maxNumNei;
+    }
+    res.firstNei.back() = total;
+    res.neighbors.resize( total );
+
+    // actual number of found neighbours of each point
+    Vector<int, VertId> numFound;
+    if ( upDistLimitSq < FLT_MAX )
+        numFound.resize( pc.points.size(), 0 );
+
+    if ( !findKNearestForEachPoint( pc, numNei, [&] ( VertId v, IteratorRange<const PointsProjectionResult*> neis )
+    {
+        auto * p = res.neighbors.data() + res.firstNei[v];
+        for ( const auto & n : neis )
+            *p++ = n.vId;
+        if ( !numFound.empty() )
+            numFound[v] = int( p - ( res.neighbors.data() + res.firstNei[v] ) );
+        else
+            assert( p == res.neighbors.data() + res.firstNei[v + 1] );
+    }, upDistLimitSq, subprogress( progress, 0.0f, 0.9f ) ) )
+        return {};
+
+    if ( !numFound.empty() )
+    {
+        // shift the neighbours to close the gaps left by the points with less than maximal number of neighbours
+        total = 0;
+        for ( VertId v = 0_v; v < pc.points.size(); ++v )
+        {
+            const auto * p = res.neighbors.data() + res.firstNei[v];
+            res.firstNei[v] = total;
+            std::copy( p, p + numFound[v], res.neighbors.data() + total );
+            total += numFound[v];
+        }
+        res.firstNei.back() = total;
+        res.neighbors.resize( total );
+    }
+
+    if ( !reportProgress( progress, 1.0f ) )
+        return {};
+    return res;
+}
+
+std::optional<AllPointNeighbors> findAllNeighborsInRadius( const PointCloud& pc, float radius, const ProgressCallback & progress )
+{
+    MR_TIMER;
+    assert( radius > 0 );
+    const auto& tree = pc.getAABBTree();
+    const auto& orderedPoints = tree.orderedPoints();
+    const auto leaves = getLeaves( tree );
+    const float radiusSq = sqr( radius );
+
+    struct ThreadData
+    {
+        explicit ThreadData( const AABBTreePoints& tree ) : leafPoints( tree ) {}
+        LeafPoints leafPoints;
+        /// the neighbours of the points of current leaf
+        std::vector<VertId> leafNeis[MaxLeafPoints];
+        /// the neighbours of all points processed by this thread
+        std::vector<VertId> neighbors;
+        /// processed point and the position of its first neighbour in this->neighbors
+        std::vector<std::pair<VertId, size_t>> records;
+    };
+    tbb::enumerable_thread_specific<ThreadData> threadData( std::cref( tree ) );
+
+    AllPointNeighbors res;
+    res.radius = radius;
+    // the number of neighbours of point v is stored in firstNei[v+1] first
+    res.firstNei.resize( pc.points.size() + 1, 0 );
+
+    if ( !ParallelFor( leaves, threadData, [&] ( size_t i, ThreadData & td )
+    {
+        const auto leaf = leaves[i];
+        auto & lp = td.leafPoints;
+        lp.load( leaf );
+        auto addCandidates = [&] ( NodeId n )
+        {
+            const auto [first, last] = tree[n].getLeafPointRange();
+            float distSq[MaxLeafPoints];
+            for ( int j = first; j < last; ++j )
+            {
+                lp.distancesSq( orderedPoints[j].coord, distSq );
+                for ( int q = 0; q < lp.size(); ++q )
+                    if ( distSq[q] <= radiusSq && j != lp.first() + q )
+                        td.leafNeis[q].push_back( orderedPoints[j].id );
+            }
+        };
+        addCandidates( leaf );
+        visitCloseLeaves( tree, leaf, [radiusSq]( float distSq ) { return distSq <= radiusSq; }, addCandidates );
+
+        for ( int q = 0; q < lp.size(); ++q )
+        {
+            const auto v = orderedPoints[lp.first() + q].id;
+            auto & neis = td.leafNeis[q];
+            td.records.emplace_back( v, td.neighbors.size() );
+            td.neighbors.insert( td.neighbors.end(), neis.begin(), neis.end() );
+            res.firstNei[v + 1] = neis.size();
+            neis.clear();
+        }
+    }, subprogress( progress, 0.0f, 0.8f ), 64 ) )
+        return {};
+
+    for ( VertId v = 0_v; v < pc.points.size(); ++v )
+        res.firstNei[v + 1] += res.firstNei[v];
+    res.neighbors.resize( res.firstNei.back() );
+
+    std::vector<const ThreadData*> perThread;
+    for ( const auto & td : threadData )
+        perThread.push_back( &td );
+    if ( !ParallelFor( perThread, [&] ( size_t t )
+    {
+        const auto & td = *perThread[t];
+        for ( const auto & [v, pos] : td.records )
+            std::copy_n( td.neighbors.data() + pos, res.numNeis( v ), res.neighbors.data() + res.firstNei[v] );
+    }, subprogress( progress, 0.8f, 1.0f ) ) )
+        return {};
+
+    return res;
+}
+
+void findNeighborsInRadius( const PointCloud& pc, VertId v, float radius, const AllPointNeighbors * neis,
+    const std::function<void( VertId u, float distSq )> & foundCb )
+{
+    const auto c = pc.points[v];
+    const auto radiusSq = sqr( radius );
+    if ( neis && neis->hasAllInRadius( radius ) )
+    {
+        for ( auto u : neis->get( v ) )
+            if ( const auto distSq = ( pc.points[u] - c ).lengthSq(); distSq <= radiusSq )
+                foundCb( u, distSq );
+        return;
+    }
+
+    findPointsInBall( pc, { c, radiusSq }, [&] ( const PointsProjectionResult & found, const Vector3f &, Ball3f & )
+    {
+        if ( found.vId != v )
+            foundCb( found.vId, found.distSq );
+        return Processing::Continue;
+    } );
+}
+
+} //namespace MR
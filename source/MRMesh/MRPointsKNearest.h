@@ -0,0 +1,90 @@
+#pragma once
+
+#include "MRPointsProject.h"
+#include "MRVector.h"
+#include "MRIteratorRange.h"
+#include <cfloat>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace MR
+{
+/// \addtogroup AABBTreeGroup
+/// \{
+
+/// compact (CSR) table with the neighbours of all points in a cloud
+struct AllPointNeighbors
+{
+    /// the neighbours of all points one after another;
+    /// std::vector and not Buffer to keep the table copyable as required by SharedThreadSafeOwner caching it in PointCloud
+    std::vector<VertId> neighbors;
+
+    /// the neighbours of point v are located in neighbors[ firstNei[v], firstNei[v+1] );
+    /// the size of this vector is the number of points in the cloud plus one
+    Vector<size_t, VertId> firstNei;
+
+    /// if positive, then the table contains this number of the closest neighbours of each point (or all other points if there are less of them)
+    /// sorted by increasing distance
+    int numNei = 0;
+
+    /// if positive, then the table contains all neighbours of each point within this distance
+    float radius = 0;
+
+    /// returns true if the table contains all neighbours of each point within given distance
+    [[nodiscard]] bool hasAllInRadius( float r ) const { return radius > 0 && r <= radius; }
+
+    /// returns true if the table contains given number of the closest neighbours of each point
+    [[nodiscard]] bool hasKNearest( int k ) const { return numNei > 0 && k <= numNei; }
+
+    /// returns the neighbours of given point
+    [[nodiscard]] IteratorRange<const VertId*> get( VertId v ) const
+        { return { neighbors.data() + firstNei[v], neighbors.data() + firstNei[v + 1] }; }
+
+    /// returns the number of neighbours of given point
+    [[nodiscard]] size_t numNeis( VertId v ) const { return firstNei[v + 1] - firstNei[v]; }
+
+    /// returns the amount of memory this object occupies on heap
+    [[nodiscard]] MRMESH_API size_t heapBytes() const;
+};
+
+/// receives the closest points found for one point of the cloud (excluding the point itself) sorted by increasing distance
+using FoundKNearestCallback = std::function<void( VertId v, IteratorRange<const PointsProjectionResult*> neis )>;
+
+/**
+ * \brief finds at most given number of the closest points (excluding itself) to each valid point in the cloud;
+ * the points are processed leaf by leaf of AABBTreePoints: all points of one leaf share a single tree traversal,
+ * which is considerably faster than independent \ref findFewClosestPoints call for each point
+ * \param numNei maximal number of neighbours to find for each point
+ * \param foundCb is called from parallel threads exactly once for each valid point
+ * \param upDistLimitSq upper limit on the distance in question, points with larger distance than it will not be returned
+ * \return false if terminated by progress callback
+ */
+MRMESH_API bool findKNearestForEachPoint( const PointCloud& pc, int numNei, const FoundKNearestCallback & foundCb,
+    float upDistLimitSq = FLT_MAX, const ProgressCallback & progress = {} );
+
+/**
+ * \brief finds at most given number of the closest points (excluding itself) to each valid point in the cloud,
+ * and returns them in a compact table
+ * \param upDistLimitSq upper limit on the distance in question, points with larger distance than it will not be returned
+ * \return std::nullopt if terminated by progress callback
+ */
+[[nodiscard]] MRMESH_API std::optional<AllPointNeighbors> findAllKNearestPoints( const PointCloud& pc, int numNei,
+    float upDistLimitSq = FLT_MAX, const ProgressCallback & progress = {} );
+
+/**
+ * \brief finds all points within given distance (excluding itself) from each valid point in the cloud,
+ * and returns them in a compact table; the points are processed leaf by leaf of AABBTreePoints as in \ref findKNearestForEachPoint
+ * \return std::nullopt if terminated by progress callback
+ */
+[[nodiscard]] MRMESH_API std::optional<AllPointNeighbors> findAllNeighborsInRadius( const PointCloud& pc, float radius,
+    const ProgressCallback & progress = {} );
+
+/// finds all valid points within given distance from point v (excluding v itself) and passes them to the callback with squared distances;
+/// the points are taken from the table if it is given and contains all neighbours within this distance, otherwise they are searched in the cloud
+MRMESH_API void findNeighborsInRadius( const PointCloud& pc, VertId v, float radius, const AllPointNeighbors * neis,
+    const std::function<void( VertId u, float distSq )> & foundCb );
+
+/// \}
+
+} //namespace MR
@@ -1,4 +1,5 @@
 #include "MRPointsProject.h"
+#include "MRPointsKNearest.h"
 #include "MRPointCloud.h"
 #include "MRAABBTreePoints.h"
 #include "MRFewSmallest.h"
@@ -198,25 +199,15 @@ Buffer<VertId> findNClosestPointsPerPoint( const PointCloud& pc, int numNei, con
     assert( numNei >= 1 );
     Buffer<VertId> res( pc.points.size() * numNei );
 
-    tbb::enumerable_thread_specific<FewSmallest<PointsProjectionResult>> perThreadNeis( numNei + 1 );
-
-    pc.getAABBTree(); // to avoid multiple calls to tree construction from parallel region,
-                      // which can result that two different vertices will start being processed by one thread
-
-    if ( !BitSetParallelFor( pc.validPoints, [&]( VertId v )
+    if ( !findKNearestForEachPoint( pc, numNei, [&]( VertId v, IteratorRange<const PointsProjectionResult*> neis )
     {
-        auto & neis = perThreadNeis.local();
-        neis.clear();
-        assert( neis.maxElms() == numNei + 1 );
-        findFewClosestPoints( pc.points[v], pc, neis );
         VertId * p = res.data() + ( (size_t)v * numNei );
         const VertId * pEnd = p + numNei;
-        for ( const auto & n : neis.get() )
-            if ( n.vId != v && p < pEnd )
-                *p++ = n.vId;
+        for ( const auto & n : neis )
+            *p++ = n.vId;
         while ( p < pEnd )
             *p++ = {};
-    }, progress ) )
+    }, FLT_MAX, progress ) )
         res.clear();
 
     return res;
@@ -4,7 +4,6 @@
 #include "MRMatrix3Decompose.h"
 #include "MRParallelFor.h"
 #include "MRTimer.h"
-#include "MRPch/MRTBB.h"
 
 namespace MR
 {
@@ -20,16 +19,8 @@ void PointsToMeshProjector::findProjections( std::vector<MeshProjectionResult>&
     if ( !mesh_ )
         return;
 
-    result.resize( points.size() );
-
     AffineXf3f xf;
-    auto simplifiedXfs = createProjectionTransforms( xf, objXf, refObjXf );
-
-    tbb::parallel_for( tbb::blocked_range<size_t>( 0, points.size() ), [&] ( const tbb::blocked_range<size_t>& range )
-    {
-        for ( size_t i = range.begin(); i < range.end(); ++i )
-            result[i] = findProjection( simplifiedXfs.rigidXfPoint ? ( *simplifiedXfs.rigidXfPoint )( points[VertId( i )] ) : points[VertId( i )], *mesh_, upDistLimitSq, simplifiedXfs.nonRigidXfTree, loDistLimitSq );
-    } );
+    result = MR::findProjections( points, *mesh_, upDistLimitSq, createProjectionTransforms( xf, objXf, refObjXf ), loDistLimitSq );
 }
 
 size_t PointsToMeshProjector::projectionsHeapBytes( size_t ) const
@@ -3,6 +3,7 @@
 #include "MRVector2.h"
 #include "MRBox.h"
 #include "MRGTest.h"
+#include <random>
 
 namespace
 {
@@ -15,6 +16,11 @@ namespace MR
 
 bool orient3d( const Vector3i & a, const Vector3i& b, const Vector3i& c )
 {
+    // all int coordinates and their differences are exactly representable in double,
+    // so most of calls return here without slow high-precision computations
+    if ( auto s = orient3dFilter( Vector3d( a ), Vector3d( b ), Vector3d( c ) ) )
+        return s > 0;
+
     auto vhp = mixed( Vector3hp{ a }, Vector3hp{ b }, Vector3hp{ c } );
     if ( vhp ) return vhp > 0;
 
@@ -103,19 +109,34 @@ TriangleSegmentIntersectResult doTriangleSegmentIntersect( const std::array<Prec
     if ( abcd == abce )
         return res; // segment DE is located at one side of the plane ABC
 
+    res.doIntersect = doTriangleSegmentIntersectCrossingPlane( vs );
+    return res;
+}
+
+bool doTriangleSegmentIntersectCrossingPlane( const std::array<PreciseVertCoords, 5> & vs )
+{
+    constexpr int a = 0;
+    constexpr int b = 1;
+    constexpr int c = 2;
+    constexpr int d = 3;
+    constexpr int e = 4;
+
+    auto orient3d = [&]( int p, int q, int r, int s )
+    {
+        return MR::orient3d( { vs[p], vs[q], vs[r], vs[s] } );
+    };
+
     const auto dabe = orient3d( a, b, d, e );
     const auto dbce = orient3d( b, c, d, e );
     if ( dabe != dbce )
-        return res; // segment AC is located at one side of the plane DEB
+        return false; // segment AC is located at one side of the plane DEB
 
     const auto dcae = !orient3d( a, c, d, e ); // '!' is due to inverted order of a and c
     if ( dbce != dcae )
-        return res; // segment AB is located at one side of the plane DEC
+        return false; // segment AB is located at one side of the plane DEC
 
     assert ( dcae == dabe ); // segment BC is crossed by the plane DEA
-
-    res.doIntersect = true;
-    return res;
+    return true;
 }
 
 ConvertToIntVector getToIntConverter( const Box3d& box )
@@ -261,4 +282,46 @@ TEST( MRMesh, PrecisePredicates3 )
     EXPECT_TRUE( res.dIsLeftFromABC );
 }
 
+TEST( MRMesh, PrecisePredicates3Filter )
+{
+    std::mt19937 gen( 42 );
+    std::uniform_int_distribution<int> coord( -100'000'000, 100'000'000 );
+    std::uniform_int_distribution<int> small( -1000, 1000 );
+    auto randomPoint = [&]() { return Vector3i( coord( gen ), coord( gen ), coord( gen ) ); };
+
+    int numCertain = 0;
+    for ( int i = 0; i < 10000; ++i )
+    {
+        auto a = randomPoint(), b = randomPoint(), c = randomPoint(), d = randomPoint();
+        // in every second test, point D is located exactly on the plane ABC or very close to it
+        if ( i % 2 )
+        {
+            const auto u = ( b - a ) / 100, v = ( c - a ) / 100;
+            b = a + u;
+            c = a + v;
+            d = a + u * small( gen ) + v * small( gen );
+            if ( i % 4 == 3 )
+                d.z += 1;
+        }
+        const auto exact = mixed( Vector3hp{ a - d }, Vector3hp{ b - d }, Vector3hp{ c - d } );
+        const auto s = orient3dFilter( Vector3d( a - d ), Vector3d( b - d ), Vector3d( c - d ) );
+        if ( s )
+        {
+            ++numCertain;
+            EXPECT_EQ( s > 0, exact > 0 );
+        }
+        else
+        {
+            // the filter shall be uncertain only for (nearly) co-planar points
+            EXPECT_EQ( i % 2, 1 );
+        }
+        if ( exact == 0 )
+        {
+            EXPECT_EQ( s, 0 );
+        }
+    }
+    // all random points in general position shall be resolved by the filter
+    EXPECT_GE( numCertain, 5000 );
+}
+
 } //namespace MR
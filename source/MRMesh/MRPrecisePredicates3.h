@@ -4,6 +4,8 @@
 #include "MRId.h"
 
 #include <array>
+#include <cfloat>
+#include <cmath>
 
 namespace MR
 {
@@ -11,6 +13,27 @@ namespace MR
 /// \ingroup MathGroup
 /// \{
 
+/// fast floating-point filter for orient3d predicate with integer coordinates (exactly representable in double):
+/// returns +1 if the plane with orientated triangle ABC has 0 point at the left for sure, -1 if at the right for sure,
+/// and 0 if the points are too close to co-planarity, and the sign can be found only by exact computations;
+/// the error bound is from J.R. Shewchuk "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates";
+/// the function is branchless to be vectorized by the compiler when called in a loop
+[[nodiscard]] inline int orient3dFilter( const Vector3d & a, const Vector3d & b, const Vector3d & c )
+{
+    const double byz = b.y * c.z, bzy = b.z * c.y;
+    const double bzx = b.z * c.x, bxz = b.x * c.z;
+    const double bxy = b.x * c.y, byx = b.y * c.x;
+    const double det = a.x * ( byz - bzy ) + a.y * ( bzx - bxz ) + a.z * ( bxy - byx );
+    const double permanent =
+        std::abs( a.x ) * ( std::abs( byz ) + std::abs( bzy ) ) +
+        std::abs( a.y ) * ( std::abs( bzx ) + std::abs( bxz ) ) +
+        std::abs( a.z ) * ( std::abs( bxy ) + std::abs( byx ) );
+    constexpr double eps = DBL_EPSILON / 2;
+    constexpr double errBound = ( 7 + 56 * eps ) * eps;
+    const double bound = errBound * permanent;
+    return int( det > bound ) - int( det < -bound );
+}
+
 /// returns true if the plane with orientated triangle ABC has 0 point at the left;
 /// uses simulation-of-simplicity to avoid "0 is exactly on plane"
 MRMESH_API bool orient3d( const Vector3i & a, const Vector3i & b, const Vector3i & c );
@@ -43,6 +66,11 @@ struct TriangleSegmentIntersectResult
 [[nodiscard]] MRMESH_API TriangleSegmentIntersectResult doTriangleSegmentIntersect(
     const std::array<PreciseVertCoords, 5> & vs );
 
+/// checks whether triangle ABC (indices 012) and segment DE (indices 34) intersect
+/// provided that D and E are already known to be located on the opposite sides of the plane ABC;
+/// uses simulation-of-simplicity to avoid edge-segment intersections and co-planarity
+[[nodiscard]] MRMESH_API bool doTriangleSegmentIntersectCrossingPlane( const std::array<PreciseVertCoords, 5> & vs );
+
 /// float-to-int coordinate converter
 using ConvertToIntVector = std::function<Vector3i( const Vector3f& )>;
 /// int-to-float coordinate converter
@@ -16,7 +16,8 @@ public:
     using value_type        = EdgeId;
     using difference_type   = std::ptrdiff_t;
 
-    RingIterator( const MeshTopology & topology, EdgeId edge, bool first )
+    template <typename T>
+    RingIterator( const T & topology, EdgeId edge, bool first )
         : N( topology ), edge_( edge ), first_( first )
     {
     }
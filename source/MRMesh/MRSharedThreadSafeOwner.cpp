@@ -1,8 +1,10 @@
 #include "MRSharedThreadSafeOwner.h"
 #include "MRAABBTree.h"
+#include "MRAABBTreeWide.h"
 #include "MRAABBTreePolyline.h"
 #include "MRAABBTreePoints.h"
 #include "MRDipole.h"
+#include "MRPointsKNearest.h"
 #include "MRHeapBytes.h"
 #include "MRTbbTaskArenaAndGroup.h"
 #include "MRPch/MRSuppressWarning.h"
@@ -94,10 +96,12 @@ size_t SharedThreadSafeOwner<T>::heapBytes() const
 }
 
 template class SharedThreadSafeOwner<AABBTree>;
+template class SharedThreadSafeOwner<AABBTreeWide>;
 template class SharedThreadSafeOwner<AABBTreePolyline2>;
 template class SharedThreadSafeOwner<AABBTreePolyline3>;
 template class SharedThreadSafeOwner<AABBTreePoints>;
 template class SharedThreadSafeOwner<Dipoles>;
+template class SharedThreadSafeOwner<AllPointNeighbors>;
 
 } //namespace MR
 
@@ -1,8 +1,7 @@
 #include "MRSolarRadiation.h"
 #include "MRMesh.h"
 #include "MRBitSetParallelFor.h"
-#include "MRIntersectionPrecomputes.h"
-#include "MRLine3.h"
+#include "MRParallelFor.h"
 #include "MRMeshIntersect.h"
 #include "MRTimer.h"
 #include <cfloat>
@@ -48,6 +47,65 @@ std::vector<Vector3f> sampleHalfSphere()
     return patches;
 }
 
+namespace
+{
+
+/// for every sky patch, traces the rays from all valid samples toward it, and calls
+/// f( sampleVert, patchIndex, intersection ) in parallel for the samples of that patch;
+/// the samples are split between threads by blocks of validSamples, so f can set the bits of sampleVert in a VertBitSet;
+/// all rays toward one patch have the same direction and close origins, so they are traced together in coherent packets
+template<typename F>
+void forEachSkyRay( const Mesh & terrain, const VertCoords & samples, const VertBitSet & validSamples,
+    const std::vector<SkyPatch> & skyPatches, bool closestIntersect, bool needIntersections, F && f )
+{
+    std::vector<Vector3f> origins;
+    origins.reserve( validSamples.count() );
+    Vector<int, VertId> sampleIndex( validSamples.size() );
+    for ( auto v : validSamples )
+    {
+        sampleIndex[v] = int( origins.size() );
+        origins.push_back( samples[v] );
+    }
+    if ( origins.empty() || skyPatches.empty() )
+        return;
+
+    std::vector<Vector3f> dirs( origins.size(), skyPatches.front().dir );
+    // all rays have the same direction for each patch, so the order of rays depends only on their origins
+    const auto order = getCoherentRayOrder( origins, dirs );
+
+    std::vector<FaceId> faces;
+    std::vector<TriPointf> bary;
+    std::vector<float> params;
+    std::vector<Vector3f> pts;
+    MultiRayMeshIntersectResult isects{ .isectFaces = &faces };
+    if ( needIntersections )
+    {
+        isects.rayParams = &params;
+        isects.isectBary = &bary;
+        isects.isectPts = &pts;
+    }
+    for ( int patch = 0; patch < skyPatches.size(); ++patch )
+    {
+        dirs.assign( origins.size(), skyPatches[patch].dir );
+        multiRayMeshIntersect( terrain, origins, dirs, isects, 0.0f, FLT_MAX, closestIntersect, {}, true, &order );
+        BitSetParallelFor( validSamples, [&]( VertId v )
+        {
+            const auto i = sampleIndex[v];
+            MeshIntersectionResult isec;
+            isec.proj.face = faces[i];
+            if ( isec && needIntersections )
+            {
+                isec.proj.point = pts[i];
+                isec.mtp = MeshTriPoint( terrain.topology.edgeWithLeft( isec.proj.face ), bary[i] );
+                isec.distanceAlongLine = params[i];
+            }
+            f( v, patch, isec );
+        } );
+    }
+}
+
+} //anonymous namespace
+
 VertScalars computeSkyViewFactor( const Mesh & terrain, const VertCoords & samples, const VertBitSet & validSamples,
     const std::vector<SkyPatch> & skyPatches, BitSet * outSkyRays, std::vector<MeshIntersectionResult>* outIntersections )
 {
@@ -77,29 +135,22 @@ VertScalars computeSkyViewFactor( const Mesh & terrain, const VertCoords & sampl
         return res;
     }
 
-    std::vector<IntersectionPrecomputes<float>> precs;
-    precs.reserve( skyPatches.size() );
-    for ( const auto & sp : skyPatches )
-        precs.emplace_back( sp.dir );
-
     const size_t numRays = samples.size() * skyPatches.size();
     if ( outIntersections )
         outIntersections->resize( numRays );
 
+    // patches are visited in the same order for each sample as in sequential summation
+    forEachSkyRay( terrain, samples, validSamples, skyPatches, bool( outIntersections ), bool( outIntersections ),
+        [&]( VertId sampleVertId, int patch, const MeshIntersectionResult & isec )
+    {
+        if ( !isec )
+            res[sampleVertId] += skyPatches[patch].radiation;
+        else if ( outIntersections )
+            (*outIntersections)[ size_t( sampleVertId ) * skyPatches.size() + patch ] = isec;
+    } );
     BitSetParallelFor( validSamples, [&]( VertId sampleVertId )
     {
-        const auto samplePt = samples[sampleVertId];
-
-        float totalRadiation = 0;
-        for ( int i = 0; i < skyPatches.size(); ++i )
-        {
-            const auto intersectionRes = rayMeshIntersect( terrain, Line3f( samplePt, skyPatches[i].dir ), 0, FLT_MAX, &precs[i], bool( outIntersections ));
-            if ( !intersectionRes )
-                totalRadiation += skyPatches[i].radiation;
-            else if ( outIntersections )
-                (*outIntersections)[ size_t( sampleVertId ) * skyPatches.size() + i ] = intersectionRes;
-        }
-        res[sampleVertId] = rMaxRadiation * totalRadiation;
+        res[sampleVertId] *= rMaxRadiation;
     } );
 
     return res;
@@ -111,30 +162,28 @@ BitSet findSkyRays( const Mesh & terrain,
 {
     MR_TIMER;
 
-    std::vector<IntersectionPrecomputes<float>> precs;
-    precs.reserve( skyPatches.size() );
-    for ( const auto & sp : skyPatches )
-        precs.emplace_back( sp.dir );
-
     const size_t numRays = samples.size() * skyPatches.size();
-    BitSet res( numRays );
     if ( outIntersections )
         outIntersections->resize( numRays );
 
-    BitSetParallelForAll( res, [&]( size_t ray )
+    // the bits of one sample are set by different threads, so the samples reaching each patch are collected
+    // in separate bit sets first, and then transposed in the result by whole blocks
+    std::vector<VertBitSet> patchReachSky( skyPatches.size(), VertBitSet( samples.size() ) );
+    forEachSkyRay( terrain, samples, validSamples, skyPatches, false, bool( outIntersections ),
+        [&]( VertId sample, int patch, const MeshIntersectionResult & isec )
     {
-        const auto div = std::div( std::int64_t( ray ), std::int64_t( skyPatches.size() ) );
-        const VertId sample( int( div.quot ) );
-        if ( !validSamples.test( sample ) )
-            return;
-        const auto patch = div.rem;
-        const auto intersectionRes = rayMeshIntersect( terrain, Line3f( samples[sample], skyPatches[patch].dir ), 0, FLT_MAX, &precs[patch], false );
-        if ( !intersectionRes )
-            res.set( ray );
+        if ( !isec )
+            patchReachSky[patch].set( sample );
         else if ( outIntersections )
-            (*outIntersections)[ray] =  intersectionRes;
+            (*outIntersections)[ size_t( sample ) * skyPatches.size() + patch ] = isec;
     } );
 
+    BitSet res( numRays );
+    BitSetParallelForAll( res, [&]( size_t ray )
+    {
+        if ( patchReachSky[ray % skyPatches.size()].test( VertId( ray / skyPatches.size() ) ) )
+            res.set( ray );
+    } );
     return res;
 }
 
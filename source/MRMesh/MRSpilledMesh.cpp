@@ -0,0 +1,131 @@
+#include "MRSpilledMesh.h"
+#include "MRMesh.h"
+#include "MRMeshSave.h"
+#include "MRMeshLoad.h"
+#include "MRZip.h"
+#include "MRFinally.h"
+#include "MRStringConvert.h"
+#include "MRUniqueTemporaryFolder.h"
+#include "MRTorus.h"
+#include "MRTimer.h"
+#include "MRGTest.h"
+#include <atomic>
+#include <string>
+
+namespace MR
+{
+
+namespace
+{
+
+// the name of temporary folder and the mesh file inside zip-archive
+constexpr const char * cMeshFileName = "mesh.mrmesh";
+
+} //anonymous namespace
+
+SpilledMesh & SpilledMesh::operator =( SpilledMesh && b ) noexcept
+{
+    if ( this != &b )
+    {
+        remove_();
+        file_ = std::move( b.file_ );
+        bytes_ = b.bytes_;
+        b.file_.clear();
+        b.bytes_ = 0;
+    }
+    return *this;
+}
+
+SpilledMesh::~SpilledMesh()
+{
+    remove_();
+}
+
+void SpilledMesh::remove_()
+{
+    if ( file_.empty() )
+        return;
+    std::error_code ec;
+    std::filesystem::remove( file_, ec );
+    file_.clear();
+    bytes_ = 0;
+}
+
+Expected<SpilledMesh> SpilledMesh::save( const Mesh & mesh, const std::filesystem::path & folder )
+{
+    MR_TIMER;
+    static std::atomic<std::uint64_t> sCounter{ 0 };
+    const auto name = "mesh" + std::to_string( sCounter.fetch_add( 1, std::memory_order_relaxed ) );
+
+    // the mesh is saved in internal format in a temporary folder, which is compressed then in a zip-archive
+    std::error_code ec;
+    const auto tmpFolder = folder / name;
+    if ( !std::filesystem::create_directories( tmpFolder, ec ) )
+        return unexpected( "Cannot create folder " + utf8string( tmpFolder ) );
+    MR_FINALLY { std::filesystem::remove_all( tmpFolder, ec ); };
+
+    if ( auto s = MeshSave::toMrmesh( mesh, tmpFolder / cMeshFileName ); !s )
+        return unexpected( std::move( s.error() ) );
+
+    SpilledMesh res;
+    res.file_ = folder / ( name + ".zip" );
+    if ( auto s = compressZip( res.file_, tmpFolder ); !s )
+        return unexpected( std::move( s.error() ) );
+    res.bytes_ = std::filesystem::file_size( res.file_, ec );
+    return res;
+}
+
+Expected<Mesh> SpilledMesh::load()
+{
+    MR_TIMER;
+    if ( file_.empty() )
+        return unexpected( "Mesh was not spilled" );
+
+    std::error_code ec;
+    auto tmpFolder = file_;
+    tmpFolder.replace_extension();
+    if ( !std::filesystem::create_directories( tmpFolder, ec ) )
+        return unexpected( "Cannot create folder " + utf8string( tmpFolder ) );
+    MR_FINALLY { std::filesystem::remove_all( tmpFolder, ec ); };
+
+    if ( auto s = decompressZip( file_, tmpFolder ); !s )
+        return unexpected( std::move( s.error() ) );
+    auto res = MeshLoad::fromMrmesh( tmpFolder / cMeshFileName );
+    if ( res )
+        remove_(); // the file is removed only after successful loading
+    return res;
+}
+
+TEST( MRMesh, SpilledMesh )
+{
+    UniqueTemporaryFolder folder( {} );
+    ASSERT_TRUE( bool( folder ) );
+
+    const auto mesh = makeTorus( 1.0f, 0.3f, 32, 16 );
+    auto spilled = SpilledMesh::save( mesh, folder );
+    ASSERT_TRUE( spilled.has_value() );
+    EXPECT_FALSE( spilled->empty() );
+    EXPECT_GT( spilled->bytes(), 0 );
+
+    // the file is moved together with the object
+    SpilledMesh moved = std::move( *spilled );
+    EXPECT_TRUE( spilled->empty() );
+
+    auto loaded = moved.load();
+    ASSERT_TRUE( loaded.has_value() );
+    EXPECT_TRUE( moved.empty() );
+    EXPECT_EQ( loaded->topology, mesh.topology );
+    EXPECT_EQ( loaded->points, mesh.points );
+    EXPECT_TRUE( std::filesystem::is_empty( folder ) );
+
+    // the file is kept if the mesh cannot be loaded from it
+    auto broken = SpilledMesh::save( mesh, folder );
+    ASSERT_TRUE( broken.has_value() );
+    for ( const auto & entry : std::filesystem::directory_iterator( folder ) )
+        std::filesystem::resize_file( entry.path(), 10 );
+    EXPECT_FALSE( broken->load().has_value() );
+    EXPECT_FALSE( broken->empty() );
+    EXPECT_FALSE( std::filesystem::is_empty( folder ) );
+}
+
+} //namespace MR
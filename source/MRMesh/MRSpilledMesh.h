@@ -0,0 +1,45 @@
+#pragma once
+
+#include "MRMeshFwd.h"
+#include "MRExpected.h"
+#include <filesystem>
+
+namespace MR
+{
+
+/// \addtogroup HistoryGroup
+/// \{
+
+/// the mesh moved from memory into a compressed file on disk, e.g. to keep old undo actions without occupying memory;
+/// the file is removed in destructor
+class SpilledMesh
+{
+public:
+    SpilledMesh() = default;
+    SpilledMesh( SpilledMesh && b ) noexcept : file_( std::move( b.file_ ) ), bytes_( b.bytes_ ) { b.file_.clear(); b.bytes_ = 0; }
+    MRMESH_API SpilledMesh & operator =( SpilledMesh && b ) noexcept;
+    MRMESH_API ~SpilledMesh();
+
+    /// saves given mesh in a new compressed file inside given folder
+    [[nodiscard]] MRMESH_API static Expected<SpilledMesh> save( const Mesh & mesh, const std::filesystem::path & folder );
+
+    /// loads the mesh back from the file and removes the file, after that this object becomes empty;
+    /// if loading fails then the file is kept and the loading can be repeated
+    [[nodiscard]] MRMESH_API Expected<Mesh> load();
+
+    /// returns true if this object does not hold any file
+    [[nodiscard]] bool empty() const { return file_.empty(); }
+
+    /// returns the size of the file on disk
+    [[nodiscard]] size_t bytes() const { return bytes_; }
+
+private:
+    void remove_();
+
+    std::filesystem::path file_;
+    size_t bytes_ = 0;
+};
+
+/// \}
+
+} //namespace MR
@@ -1,7 +1,10 @@
 #include "MRSurfaceDistance.h"
 #include "MRSurfaceDistanceBuilder.h"
 #include "MRMesh.h"
+#include "MRMakeSphereMesh.h"
 #include "MRTimer.h"
+#include "MRGTest.h"
+#include <random>
 
 namespace MR
 {
@@ -127,4 +130,79 @@ VertScalars computeSurfaceDistances( const Mesh& mesh, const std::vector<MeshTri
     return b.takeDistanceMap();
 }
 
+VertScalars computeSurfaceDistancesParallel( const Mesh& mesh, const VertBitSet& startVertices, float maxDist,
+                                              const VertBitSet* region, int maxVertUpdates )
+{
+    MR_TIMER;
+
+    ParallelSurfaceDistanceBuilder b( mesh, region );
+    b.setMaxVertUpdates( maxVertUpdates );
+    b.addStartRegion( startVertices, 0 );
+    b.run( maxDist );
+    return b.takeDistanceMap();
+}
+
+VertScalars computeSurfaceDistancesParallel( const Mesh& mesh, const HashMap<VertId, float>& startVertices, float maxDist,
+                                              const VertBitSet* region, int maxVertUpdates )
+{
+    MR_TIMER;
+
+    ParallelSurfaceDistanceBuilder b( mesh, region );
+    b.setMaxVertUpdates( maxVertUpdates );
+    b.addStartVertices( startVertices );
+    b.run( maxDist );
+    return b.takeDistanceMap();
+}
+
+TEST( MRMesh, SurfaceDistancesParallel )
+{
+    const auto mesh = makeUVSphere( 1, 64, 64 );
+    VertBitSet starts( mesh.topology.vertSize() );
+    starts.set( 0_v );
+    starts.set( 100_v );
+
+    auto compare = [&] ( float maxDist, const VertBitSet* region )
+    {
+        const auto seq = computeSurfaceDistances( mesh, starts, maxDist, region );
+        const auto par = computeSurfaceDistancesParallel( mesh, starts, maxDist, region );
+        ASSERT_EQ( seq.size(), par.size() );
+        for ( auto v : mesh.topology.getValidVerts() )
+        {
+            // the distances beyond maxDist are not final in both algorithms
+            if ( seq[v] >= maxDist || par[v] >= maxDist )
+                continue;
+            EXPECT_NEAR( seq[v], par[v], 1e-3f );
+        }
+    };
+    compare( FLT_MAX, nullptr );
+    compare( 1.0f, nullptr );
+
+    VertBitSet region = mesh.topology.getValidVerts();
+    for ( auto v : region )
+        if ( mesh.points[v].z > 0.5f )
+            region.reset( v );
+    compare( FLT_MAX, &region );
+}
+
+TEST( MRMesh, SurfaceDistancesParallelIrregular )
+{
+    // shift sphere points randomly to get triangles of different sizes and shapes,
+    // where a vertex can be improved many times within one bucket
+    auto mesh = makeUVSphere( 1, 48, 48 );
+    std::mt19937 gen( 0 );
+    std::uniform_real_distribution<float> shift( -0.02f, 0.02f );
+    for ( auto v : mesh.topology.getValidVerts() )
+        mesh.points[v] += Vector3f( shift( gen ), shift( gen ), shift( gen ) );
+
+    VertBitSet starts( mesh.topology.vertSize() );
+    starts.set( 0_v );
+    starts.set( 777_v );
+
+    const auto seq = computeSurfaceDistances( mesh, starts );
+    const auto par = computeSurfaceDistancesParallel( mesh, starts );
+    ASSERT_EQ( seq.size(), par.size() );
+    for ( auto v : mesh.topology.getValidVerts() )
+        EXPECT_NEAR( seq[v], par[v], 2e-3f );
+}
+
 } //namespace MR
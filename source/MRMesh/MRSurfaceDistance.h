@@ -44,6 +44,20 @@ MRMESH_API VertScalars computeSurfaceDistances( const Mesh& mesh, const MeshTriP
 MRMESH_API VertScalars computeSurfaceDistances( const Mesh& mesh, const std::vector<MeshTriPoint>& starts, float maxDist = FLT_MAX,
                                                          const VertBitSet* region = nullptr, int maxVertUpdates = 3 );
 
+/// computes the same path distances as computeSurfaceDistances( mesh, startVertices, maxDist, region )
+/// within small tolerance, but processes all vertices with close distances in parallel threads (delta-stepping),
+/// which is much faster on large meshes
+/// \param maxVertUpdates if positive then limits the number of times each vertex propagates its distance,
+///                       which bounds the running time but can leave not final distances on fine or irregular meshes;
+///                       by default there is no limit
+MRMESH_API VertScalars computeSurfaceDistancesParallel( const Mesh& mesh, const VertBitSet& startVertices, float maxDist = FLT_MAX,
+                                                         const VertBitSet* region = nullptr, int maxVertUpdates = 0 );
+
+/// computes path distances in mesh vertices from given start vertices with values in them, stopping when maxDist is reached;
+/// the vertices with close distances are processed in parallel threads
+MRMESH_API VertScalars computeSurfaceDistancesParallel( const Mesh& mesh, const HashMap<VertId, float>& startVertices, float maxDist = FLT_MAX,
+                                                         const VertBitSet* region = nullptr, int maxVertUpdates = 0 );
+
 /// \}
 
 } // namespace MR
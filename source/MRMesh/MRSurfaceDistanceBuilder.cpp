@@ -1,10 +1,15 @@
 #include "MRSurfaceDistanceBuilder.h"
 #include "MRMesh.h"
 #include "MRRingIterator.h"
+#include "MRParallelFor.h"
 #include "MRTimer.h"
 #include "MRphmap.h"
 #include "MRGTest.h"
+#include "MRPch/MRTBB.h"
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <map>
 
 namespace MR
 {
@@ -199,6 +204,188 @@ float SurfaceDistanceBuilder::metricToPenalty_( float metric, VertId v ) const
     return metric + ( mesh_.points[v] - *target_ ).length();
 }
 
+ParallelSurfaceDistanceBuilder::ParallelSurfaceDistanceBuilder( const Mesh & mesh, const VertBitSet* region )
+    : mesh_( mesh ), topology_( mesh.topology ), region_{region}
+{
+    const size_t size = mesh_.topology.lastValidVert() + 1;
+    vertDistance_ = std::vector<std::atomic<float>>( size );
+    propagatedDistance_ = std::vector<std::atomic<float>>( size );
+    vertUpdatedTimes_ = std::vector<std::atomic<int>>( size );
+    ParallelFor( size_t( 0 ), size, [&]( size_t i )
+    {
+        vertDistance_[i].store( FLT_MAX, std::memory_order_relaxed );
+        propagatedDistance_[i].store( FLT_MAX, std::memory_order_relaxed );
+        vertUpdatedTimes_[i].store( 0, std::memory_order_relaxed );
+    } );
+    bucketWidth_ = mesh_.averageEdgeLength();
+}
+
+void ParallelSurfaceDistanceBuilder::addStartRegion( const VertBitSet & region, float startDistance )
+{
+    for ( auto v : region )
+    {
+        auto & vi = vertDistance_[v];
+        if ( vi.load( std::memory_order_relaxed ) > startDistance )
+            vi.store( startDistance, std::memory_order_relaxed );
+        starts_.push_back( v );
+    }
+}
+
+void ParallelSurfaceDistanceBuilder::addStartVertices( const HashMap<VertId, float>& startVertices )
+{
+    for ( const auto & [v, dist] : startVertices )
+    {
+        auto & vi = vertDistance_[v];
+        if ( vi.load( std::memory_order_relaxed ) > dist )
+            vi.store( dist, std::memory_order_relaxed );
+        starts_.push_back( v );
+    }
+}
+
+void ParallelSurfaceDistanceBuilder::setMaxVertUpdates( int v )
+{
+    maxVertUpdates_ = v > 0 ? v : INT_MAX;
+}
+
+VertScalars ParallelSurfaceDistanceBuilder::takeDistanceMap()
+{
+    VertScalars res( vertDistance_.size() );
+    ParallelFor( res, [&]( VertId v )
+    {
+        res[v] = vertDistance_[v].load( std::memory_order_relaxed );
+    } );
+    std::vector<std::atomic<float>>().swap( vertDistance_ );
+    return res;
+}
+
+bool ParallelSurfaceDistanceBuilder::suggestVertDistance_( VertId v, float dist, std::vector<VertId> & improved )
+{
+    auto & vi = vertDistance_[v];
+    float old = vi.load( std::memory_order_relaxed );
+    while ( dist < old )
+    {
+        if ( !vi.compare_exchange_weak( old, dist, std::memory_order_relaxed ) )
+            continue;
+        if ( region_ && !region_->test( v ) )
+            return false;
+        improved.push_back( v );
+        return true;
+    }
+    return false;
+}
+
+void ParallelSurfaceDistanceBuilder::suggestDistancesAround_( VertId v, float vDist, std::vector<VertId> & improved )
+{
+    for ( EdgeId e : orgRing( topology_, v ) )
+    {
+        float dist = vDist + ( mesh_.points[topology_.dest( e )] - mesh_.points[v] ).length();
+        if ( dist <= vDist )
+            dist = std::nextafter( vDist, FLT_MAX );
+        if ( !suggestVertDistance_( topology_.dest( e ), dist, improved ) )
+        {
+            // a shorter distance is known for dest
+            considerLeftTriPath_( e, improved );
+            considerLeftTriPath_( e.sym(), improved );
+        }
+    }
+}
+
+void ParallelSurfaceDistanceBuilder::considerLeftTriPath_( EdgeId e, std::vector<VertId> & improved )
+{
+    if ( !topology_.left( e ) )
+        return;
+    VertId a, b, c;
+    topology_.getLeftTriVerts( e, a, b, c );
+    float va = vertDistance_[a].load( std::memory_order_relaxed );
+    float vb = vertDistance_[b].load( std::memory_order_relaxed );
+    assert( va < FLT_MAX && vb < FLT_MAX );
+    if ( vb < va )
+    {
+        std::swap( a, b );
+        std::swap( va, vb );
+    }
+
+    float dvac = 0;
+    if ( !getFieldAtC( mesh_.points[b] - mesh_.points[a], mesh_.points[c] - mesh_.points[a], vb - va, dvac ) )
+        return;
+
+    float vc = va + dvac;
+    if( vc <= va )
+        vc = std::nextafter( va, FLT_MAX );
+    suggestVertDistance_( c, vc, improved );
+}
+
+void ParallelSurfaceDistanceBuilder::run( float maxDist )
+{
+    MR_TIMER;
+    const float width = bucketWidth_ > 0 ? bucketWidth_ : 1.0f;
+    auto distAt = [&]( VertId v )
+    {
+        return vertDistance_[v].load( std::memory_order_relaxed );
+    };
+    float minStart = FLT_MAX;
+    for ( auto v : starts_ )
+        minStart = std::min( minStart, distAt( v ) );
+
+    // buckets are sparse since start distances can be arbitrary
+    std::map<size_t, std::vector<VertId>> buckets;
+    auto bucketOf = [&] ( float dist )
+    {
+        return size_t( std::max( 0.0f, ( dist - minStart ) / width ) );
+    };
+    for ( auto v : starts_ )
+        buckets[bucketOf( distAt( v ) )].push_back( v );
+    starts_ = {};
+
+    tbb::enumerable_thread_specific<std::vector<VertId>> threadImproved;
+    while ( !buckets.empty() )
+    {
+        const auto cur = buckets.begin()->first;
+        if ( minStart + float( cur ) * width >= maxDist )
+            break;
+        const auto front = std::move( buckets.begin()->second );
+        buckets.erase( buckets.begin() );
+
+        ParallelFor( front, [&] ( size_t i )
+        {
+            const auto v = front[i];
+            const float dist = distAt( v );
+            if ( dist >= maxDist )
+                return;
+            // the vertex can be listed several times, only one thread propagates each new distance
+            auto & propagated = propagatedDistance_[v];
+            float old = propagated.load( std::memory_order_relaxed );
+            do
+            {
+                if ( old <= dist )
+                    return;
+            } while ( !propagated.compare_exchange_weak( old, dist, std::memory_order_relaxed ) );
+
+            if ( maxVertUpdates_ < INT_MAX && vertUpdatedTimes_[v].fetch_add( 1, std::memory_order_relaxed ) >= maxVertUpdates_ )
+                return; // the user limited the number of updates
+            suggestDistancesAround_( v, dist, threadImproved.local() );
+        } );
+
+        // the vertices with decreased distance are put in their buckets, but not before the current one
+        size_t lastBucket = SIZE_MAX;
+        std::vector<VertId> * lastBucketVerts = nullptr;
+        for ( auto & improved : threadImproved )
+        {
+            for ( auto v : improved )
+            {
+                const auto b = std::max( cur, bucketOf( distAt( v ) ) );
+                if ( b != lastBucket )
+                {
+                    lastBucket = b;
+                    lastBucketVerts = &buckets[b];
+                }
+                lastBucketVerts->push_back( v );
+            }
+            improved.clear();
+        }
+    }
+}
+
 TEST(MRMesh, SurfaceDistance)
 {
     float vc = 0;
@@ -3,7 +3,10 @@
 #include "MRId.h"
 #include "MRVector.h"
 #include "MRVector3.h"
+#include "MRFrozenMeshTopology.h"
+#include <atomic>
 #include <cfloat>
+#include <climits>
 #include <optional>
 #include <queue>
 
@@ -81,6 +84,55 @@ private:
     float metricToPenalty_( float metric, VertId v ) const;
 };
 
+/// this class computes distance map along the surface in parallel threads (delta-stepping):
+/// the vertices are distributed in buckets by their distances, and all vertices of the current bucket are processed simultaneously,
+/// the bucket is processed repeatedly until no distance in it decreases, and only then the next bucket is taken;
+/// the distances are the same as of SurfaceDistanceBuilder within small tolerance;
+/// since every vertex ring is visited several times, the topology is first copied in compact FrozenMeshTopology
+class ParallelSurfaceDistanceBuilder
+{
+public:
+    MRMESH_API ParallelSurfaceDistanceBuilder( const Mesh & mesh, const VertBitSet* region );
+    /// initiates distance construction from given vertices with known start distance in all of them
+    MRMESH_API void addStartRegion( const VertBitSet & region, float startDistance );
+    /// initiates distance construction from given start vertices with values in them
+    MRMESH_API void addStartVertices( const HashMap<VertId, float>& startVertices );
+
+    /// if positive then limits the number of times each vertex propagates its distance to neighbours,
+    /// which bounds the running time but can leave not final distances in some vertices;
+    /// by default (and for non-positive values) there is no limit and the distances are exact
+    MRMESH_API void setMaxVertUpdates( int v );
+    /// sets the width of distance range of one bucket, by default it is the average edge length of the mesh;
+    /// smaller width decreases the number of repeated updates but also decreases the number of vertices processed in parallel
+    void setBucketWidth( float width ) { assert( width > 0 ); bucketWidth_ = width; }
+
+    /// computes the distances in all vertices reachable from start vertices with path length less than maxDist
+    MRMESH_API void run( float maxDist = FLT_MAX );
+    /// takes constructed distance map, after which the builder cannot be used anymore
+    [[nodiscard]] MRMESH_API VertScalars takeDistanceMap();
+
+private:
+    const Mesh & mesh_;
+    FrozenMeshTopology topology_;
+    const VertBitSet* region_{nullptr};
+    /// current distance in each vertex, the vectors are indexed by VertId
+    std::vector<std::atomic<float>> vertDistance_;
+    /// the distance in each vertex, which was propagated to its neighbours last time
+    std::vector<std::atomic<float>> propagatedDistance_;
+    std::vector<std::atomic<int>> vertUpdatedTimes_;
+    std::vector<VertId> starts_;
+    float bucketWidth_ = 0;
+    int maxVertUpdates_ = INT_MAX;
+
+    /// atomically decreases the distance in v if the proposed distance is smaller, then v is added in (improved) list if it is in the region;
+    /// returns false if the distance was not decreased or v is outside the region, as SurfaceDistanceBuilder does
+    bool suggestVertDistance_( VertId v, float dist, std::vector<VertId> & improved );
+    /// suggests new distances around the vertex with given distance in it
+    void suggestDistancesAround_( VertId v, float vDist, std::vector<VertId> & improved );
+    /// consider a path going in the left triangle from edge (e) to the opposing vertex
+    void considerLeftTriPath_( EdgeId e, std::vector<VertId> & improved );
+};
+
 /// \}
 
 } // namespace MR
@@ -1,5 +1,6 @@
 #include "MRTimer.h"
 #include "MRTimeRecord.h"
+#include "MRTimerTrace.h"
 #include <sstream>
 
 using namespace std::chrono;
@@ -188,17 +189,42 @@ void Timer::restart( std::string name )
 
 void Timer::start( std::string name )
 {
+    traceName_ = isTimerTraceActive() ? internTimerTraceName( name ) : nullptr;
     auto parent = currentRecord;
+    if ( !parent && !traceName_ )
+        return;
+    start_ = high_resolution_clock::now();
     if ( !parent )
         return;
     started_ = true;
-    start_ = high_resolution_clock::now();
     currentRecord = &parent->children[ std::move( name ) ];
     currentRecord->parent = parent;
 }
 
+void Timer::startStatic_( const char * staticName )
+{
+    traceName_ = isTimerTraceActive() ? staticName : nullptr;
+    auto parent = currentRecord;
+    if ( !parent && !traceName_ )
+        return;
+    start_ = high_resolution_clock::now();
+    if ( !parent )
+        return;
+    started_ = true;
+    currentRecord = &parent->children[ staticName ];
+    currentRecord->parent = parent;
+}
+
 void Timer::finish()
 {
+    if ( !started_ && !traceName_ )
+        return;
+    const auto now = high_resolution_clock::now();
+    if ( traceName_ )
+    {
+        recordTimerTraceEvent( traceName_, start_, now );
+        traceName_ = nullptr;
+    }
     if ( !started_ )
         return;
     started_ = false;
@@ -206,7 +232,7 @@ void Timer::finish()
     if ( !currentParent )
         return;
 
-    currentRecord->time += high_resolution_clock::now() - start_;
+    currentRecord->time += now - start_;
     ++currentRecord->count;
 
     currentRecord = currentParent;
@@ -13,10 +13,23 @@ namespace MR
 
 struct TimeRecord;
 
+/// the name of a timer with static storage duration (string literal or __FUNCTION__), which can be kept by pointer;
+/// the constructor is evaluated at compile time, so it rejects pointers to local arrays and other run-time strings
+struct MR_BIND_IGNORE StaticTimerName
+{
+    explicit consteval StaticTimerName( const char * n ) : name( n ) {}
+    const char * name = nullptr;
+};
+
+/// measures the time of its life and accumulates it in the timing tree of the main thread;
+/// also records the interval in all threads if timer trace is active (see MRTimerTrace.h)
 class MR_BIND_IGNORE Timer
 {
 public:
     Timer( std::string name ) { start( std::move( name ) ); }
+    /// faster constructor for the names with static storage duration,
+    /// which avoids string construction in the threads without timing tree
+    explicit Timer( StaticTimerName staticName ) { startStatic_( staticName.name ); }
     ~Timer() { finish(); }
 
     MRMESH_API void restart( std::string name );
@@ -31,8 +44,11 @@ public:
     std::chrono::duration<double> secondsPassed() const { return std::chrono::high_resolution_clock::now() - start_; }
 
 private:
+    MRMESH_API void startStatic_( const char * staticName );
+
     std::chrono::time_point<std::chrono::high_resolution_clock> start_;
     bool started_{ false };
+    const char * traceName_ = nullptr; ///< not null if the interval must be recorded in timer trace
 };
 
 /// enables or disables printing of timing tree when application terminates
@@ -50,5 +66,5 @@ MRMESH_API void printTimingTree( double minTimeSec = 0.1 );
 
 } // namespace MR
 
-#define MR_TIMER MR::Timer _timer( __FUNCTION__ )
+#define MR_TIMER MR::Timer _timer( MR::StaticTimerName( __FUNCTION__ ) )
 #define MR_NAMED_TIMER(name) MR::Timer _named_timer( name )
@@ -0,0 +1,275 @@
+#include "MRTimerTrace.h"
+#include "MRTimer.h"
+#include "MRParallelFor.h"
+#include "MRStringConvert.h"
+#include "MRGTest.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace MR
+{
+
+namespace
+{
+
+using Clock = std::chrono::high_resolution_clock;
+
+/// one recorded interval, times are in nanoseconds from the start of tracing
+struct TraceEvent
+{
+    const char * name = nullptr;
+    std::int64_t start = 0;
+    std::int64_t duration = 0;
+};
+
+/// events of one thread, written only by that thread
+struct ThreadTraceBuffer
+{
+    int tid = 0;
+    std::atomic<unsigned> generation{ 0 }; ///< the tracing session of the events
+    std::atomic<size_t> numWritten{ 0 };   ///< the number of events written in this session, including overwritten ones
+    std::vector<TraceEvent> events;
+
+    /// calls given function for all events in this buffer, older events first
+    template<typename F>
+    void forEachEvent( F && f ) const
+    {
+        const auto n = numWritten.load( std::memory_order_acquire );
+        const auto size = events.size();
+        const auto first = n > size ? n - size : 0;
+        for ( auto i = first; i < n; ++i )
+            f( events[i % size] );
+    }
+};
+
+// constant-initialized, so they can be used by timers during static initialization
+std::atomic<bool> sTraceActive{ false };
+std::atomic<unsigned> sTraceGeneration{ 0 };
+std::atomic<size_t> sEventsPerThread{ 0 };
+std::atomic<Clock::rep> sTraceStarted{ 0 };
+
+struct TraceRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTraceBuffer>> buffers; ///< buffers are never deleted since threads can still hold them
+    std::unordered_set<std::string> names;
+};
+
+TraceRegistry & traceRegistry()
+{
+    static TraceRegistry registry;
+    return registry;
+}
+
+thread_local ThreadTraceBuffer * tlsTraceBuffer = nullptr;
+
+void writeJsonString( std::ostream & out, const char * s )
+{
+    out << '"';
+    for ( ; *s; ++s )
+    {
+        const auto c = *s;
+        if ( c == '"' || c == '\\' )
+            out << '\\' << c;
+        else if ( (unsigned char)c < 0x20 )
+            out << ' ';
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+} //anonymous namespace
+
+void startTimerTrace( size_t eventsPerThread )
+{
+    auto & reg = traceRegistry();
+    std::lock_guard lock( reg.mutex );
+    sEventsPerThread.store( std::max( eventsPerThread, size_t( 1 ) ), std::memory_order_relaxed );
+    sTraceStarted.store( Clock::now().time_since_epoch().count(), std::memory_order_relaxed );
+    // the threads will reset their buffers on the next event after seeing new generation
+    sTraceGeneration.fetch_add( 1, std::memory_order_release );
+    sTraceActive.store( true, std::memory_order_release );
+}
+
+void stopTimerTrace()
+{
+    sTraceActive.store( false, std::memory_order_release );
+}
+
+bool isTimerTraceActive()
+{
+    return sTraceActive.load( std::memory_order_relaxed );
+}
+
+const char * internTimerTraceName( const std::string & name )
+{
+    // most timers in a thread have repeating names, so look first in the thread cache without locking
+    thread_local std::unordered_map<std::string, const char *> cache;
+    if ( auto it = cache.find( name ); it != cache.end() )
+        return it->second;
+
+    auto & reg = traceRegistry();
+    std::lock_guard lock( reg.mutex );
+    const char * res = reg.names.insert( name ).first->c_str();
+    cache.emplace( name, res );
+    return res;
+}
+
+void recordTimerTraceEvent( const char * name, Clock::time_point start, Clock::time_point finish )
+{
+    const auto generation = sTraceGeneration.load( std::memory_order_acquire );
+    auto * buf = tlsTraceBuffer;
+    if ( !buf )
+    {
+        auto & reg = traceRegistry();
+        std::lock_guard lock( reg.mutex );
+        reg.buffers.push_back( std::make_unique<ThreadTraceBuffer>() );
+        buf = tlsTraceBuffer = reg.buffers.back().get();
+        buf->tid = int( reg.buffers.size() );
+        buf->generation.store( generation - 1, std::memory_order_relaxed );
+    }
+    if ( buf->generation.load( std::memory_order_relaxed ) != generation )
+    {
+        buf->numWritten.store( 0, std::memory_order_relaxed );
+        buf->events.assign( sEventsPerThread.load( std::memory_order_relaxed ), {} );
+        buf->generation.store( generation, std::memory_order_release );
+    }
+
+    const auto n = buf->numWritten.load( std::memory_order_relaxed );
+    const auto traceStarted = Clock::time_point( Clock::duration( sTraceStarted.load( std::memory_order_relaxed ) ) );
+    auto & e = buf->events[n % buf->events.size()];
+    e.name = name;
+    e.start = std::chrono::duration_cast<std::chrono::nanoseconds>( start - traceStarted ).count();
+    e.duration = std::chrono::duration_cast<std::chrono::nanoseconds>( finish - start ).count();
+    buf->numWritten.store( n + 1, std::memory_order_release );
+}
+
+Expected<void> saveTimerTrace( std::ostream & out )
+{
+    MR_TIMER;
+    auto & reg = traceRegistry();
+    std::lock_guard lock( reg.mutex );
+    const auto generation = sTraceGeneration.load( std::memory_order_acquire );
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char * sep = "\n";
+    out << std::fixed << std::setprecision( 3 );
+    for ( const auto & buf : reg.buffers )
+    {
+        if ( buf->generation.load( std::memory_order_acquire ) != generation )
+            continue;
+        out << sep << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buf->tid
+            << ",\"args\":{\"name\":\"Thread " << buf->tid << "\"}}";
+        sep = ",\n";
+        buf->forEachEvent( [&] ( const TraceEvent & e )
+        {
+            // complete events with the times in microseconds
+            out << sep << "{\"name\":";
+            writeJsonString( out, e.name );
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid
+                << ",\"ts\":" << e.start * 1e-3 << ",\"dur\":" << e.duration * 1e-3 << '}';
+        } );
+    }
+    out << "\n]}\n";
+
+    if ( !out )
+        return unexpected( std::string( "Error writing timer trace" ) );
+    return {};
+}
+
+Expected<void> saveTimerTrace( const std::filesystem::path & file )
+{
+    std::ofstream out( file, std::ofstream::binary );
+    if ( !out )
+        return unexpected( std::string( "Cannot open file for writing " ) + utf8string( file ) );
+    return saveTimerTrace( out );
+}
+
+std::vector<TimerTraceStat> aggregateTimerTrace()
+{
+    MR_TIMER;
+    auto & reg = traceRegistry();
+    std::lock_guard lock( reg.mutex );
+    const auto generation = sTraceGeneration.load( std::memory_order_acquire );
+
+    struct Agg
+    {
+        TimerTraceStat stat;
+        int lastTid = 0;
+    };
+    std::unordered_map<std::string_view, Agg> map;
+    for ( const auto & buf : reg.buffers )
+    {
+        if ( buf->generation.load( std::memory_order_acquire ) != generation )
+            continue;
+        buf->forEachEvent( [&] ( const TraceEvent & e )
+        {
+            auto & a = map[e.name];
+            ++a.stat.count;
+            a.stat.time += std::chrono::nanoseconds( e.duration );
+            if ( a.lastTid != buf->tid )
+            {
+                a.lastTid = buf->tid;
+                ++a.stat.numThreads;
+            }
+        } );
+    }
+
+    std::vector<TimerTraceStat> res;
+    res.reserve( map.size() );
+    for ( auto & [name, a] : map )
+    {
+        a.stat.name = name;
+        res.push_back( std::move( a.stat ) );
+    }
+    std::sort( res.begin(), res.end(), [] ( const auto & a, const auto & b ) { return a.time > b.time; } );
+    return res;
+}
+
+TEST( MRMesh, TimerTrace )
+{
+    constexpr size_t cNumItems = 1000;
+    startTimerTrace();
+    EXPECT_TRUE( isTimerTraceActive() );
+    {
+        MR_NAMED_TIMER( "TimerTraceTestRoot" );
+        ParallelFor( size_t( 0 ), cNumItems, [] ( size_t i )
+        {
+            MR_NAMED_TIMER( "TimerTraceTestItem" );
+            if ( i % 2 == 0 )
+                Timer t( std::string( "TimerTraceTestEven" ) );
+        } );
+    }
+    stopTimerTrace();
+    EXPECT_FALSE( isTimerTraceActive() );
+
+    size_t numItems = 0, numEven = 0, numRoot = 0;
+    for ( const auto & s : aggregateTimerTrace() )
+    {
+        if ( s.name == "TimerTraceTestItem" )
+            numItems = s.count;
+        else if ( s.name == "TimerTraceTestEven" )
+            numEven = s.count;
+        else if ( s.name == "TimerTraceTestRoot" )
+            numRoot = s.count;
+    }
+    EXPECT_EQ( numItems, cNumItems );
+    EXPECT_EQ( numEven, cNumItems / 2 );
+    EXPECT_EQ( numRoot, 1 );
+
+    std::ostringstream ss;
+    EXPECT_TRUE( saveTimerTrace( ss ).has_value() );
+    const auto json = ss.str();
+    EXPECT_NE( json.find( "\"traceEvents\"" ), std::string::npos );
+    EXPECT_NE( json.find( "\"TimerTraceTestRoot\"" ), std::string::npos );
+}
+
+} //namespace MR
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "MRMeshFwd.h"
+#include "MRExpected.h"
+#include "MRPch/MRBindingMacros.h"
+#include <chrono>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace MR
+{
+
+/// \addtogroup BasicGroup
+/// \{
+
+/// starts recording of the intervals of all timers (MR_TIMER, MR_NAMED_TIMER, MR::Timer) in all threads including TBB worker threads;
+/// each thread writes its events without locking in its own ring buffer, keeping only the last (eventsPerThread) events;
+/// previously recorded events are discarded
+MRMESH_API void startTimerTrace( size_t eventsPerThread = 1 << 16 );
+
+/// stops recording, the recorded events remain available for export and aggregation
+MRMESH_API void stopTimerTrace();
+
+/// returns true if timer events are being recorded now
+[[nodiscard]] MRMESH_API bool isTimerTraceActive();
+
+/// writes recorded events in Chrome trace event format (JSON), which can be opened in chrome://tracing or https://ui.perfetto.dev;
+/// shall be called after stopTimerTrace()
+MRMESH_API Expected<void> saveTimerTrace( std::ostream & out );
+MRMESH_API Expected<void> saveTimerTrace( const std::filesystem::path & file );
+
+/// the summary of recorded events with the same name
+struct MR_BIND_IGNORE TimerTraceStat
+{
+    std::string name;
+    size_t count = 0; ///< the number of recorded intervals
+    std::chrono::nanoseconds time = {}; ///< summed duration of all intervals, including nested timers
+    int numThreads = 0; ///< the number of threads where the intervals were recorded
+};
+
+/// aggregates recorded events by timer names, the result is sorted in time-descending order;
+/// shall be called after stopTimerTrace()
+[[nodiscard]] MR_BIND_IGNORE MRMESH_API std::vector<TimerTraceStat> aggregateTimerTrace();
+
+/// returns the pointer to a copy of given name with the lifetime of the program, the same pointer for equal names;
+/// used by Timer for the names not having static storage duration
+[[nodiscard]] MR_BIND_IGNORE MRMESH_API const char * internTimerTraceName( const std::string & name );
+
+/// writes one event in the buffer of the current thread, (name) must have static storage duration
+MR_BIND_IGNORE MRMESH_API void recordTimerTraceEvent( const char * name,
+    std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point finish );
+
+/// \}
+
+} // namespace MR
@@ -3,7 +3,7 @@
 #include "MRBitSetParallelFor.h"
 #include "MRVector.h"
 #include "MRTimer.h"
-#include "MRPointsInBall.h"
+#include "MRPointsKNearest.h"
 #include "MRBox.h"
 #include <cfloat>
 
@@ -35,17 +35,16 @@ std::optional<VertBitSet> pointUniformSampling( const PointCloud& pointCloud, co
         if ( visited.test( v ) )
             return;
         sampled.set( v );
-        const auto c = pointCloud.points[v];
         float localMaxDistSq = sqr( settings.distance );
-        findPointsInBall( pointCloud, { c, localMaxDistSq }, [&] ( const PointsProjectionResult & found, const Vector3f&, Ball3f & )
+        auto onFound = [&] ( VertId u, float distSq )
         {
-            const auto u = found.vId;
             if ( pNormals && std::abs( dot( (*pNormals)[v], (*pNormals)[u] ) ) < settings.minNormalDot )
-                localMaxDistSq = std::min( localMaxDistSq, found.distSq );
+                localMaxDistSq = std::min( localMaxDistSq, distSq );
             else
-                nearVerts.push_back( { u, found.distSq } );
-            return Processing::Continue;
-        } );
+                nearVerts.push_back( { u, distSq } );
+        };
+        onFound( v, 0.0f );
+        findNeighborsInRadius( pointCloud, v, settings.distance, settings.neighbors, onFound );
         for ( const auto & [ u, distSq ] : nearVerts )
         {
             if ( distSq >= localMaxDistSq )
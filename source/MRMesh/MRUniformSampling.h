@@ -22,6 +22,9 @@ struct UniformSamplingSettings
     bool lexicographicalOrder = true;
     /// if not nullptr then these normals will be used during sampling instead of normals in the cloud itself
     const VertNormals * pNormals = nullptr;
+    /// if not nullptr and includes all neighbours within the distance, then these precomputed neighbours
+    /// (e.g. from PointCloud::getNeighborsInRadius) will be used instead of the search
+    const AllPointNeighbors * neighbors = nullptr;
     /// to report progress and cancel processing
     ProgressCallback progress;
 };
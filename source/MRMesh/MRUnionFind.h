@@ -17,6 +17,9 @@ class UnionFind
 public:
     UnionFind() = default;
     explicit UnionFind( size_t size ) { reset( size ); }
+    /// constructs the structure from the parents of all elements and the sizes of the sets stored in their roots
+    UnionFind( Vector<I, I> parents, Vector<size_t, I> sizes ) : roots_( std::move( parents ) ), sizes_( std::move( sizes ) )
+        { assert( roots_.size() == sizes_.size() ); }
     auto size() const { return roots_.size(); }
 
     /// reset roots to represent each element as disjoint set of rank 0
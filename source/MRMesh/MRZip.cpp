@@ -3,6 +3,7 @@
 #include "MRIOParsing.h"
 #include "MRStringConvert.h"
 #include "MRTimer.h"
+#include "MRPch/MRAsyncLaunchType.h"
 
 #if (defined(__APPLE__) && defined(__clang__)) || defined(__EMSCRIPTEN__)
 #pragma clang diagnostic push
@@ -16,8 +17,14 @@
 #pragma clang diagnostic pop
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
+#include <utility>
 
 namespace MR
 {
@@ -222,6 +229,129 @@ Expected<void> decompressZip_( zip_t * zip, const std::filesystem::path& targetF
     return {};
 }
 
+// writes the data of zip-entries in memory buffers in parallel threads a little in advance of libzip requests
+class EntriesWriter
+{
+public:
+    explicit EntriesWriter( const std::vector<ZipEntry>& entries ) : entries_( entries ), futures_( entries.size() ) {}
+
+    // waits for the data of given entry, and starts writing the data of next entries
+    Expected<std::string> take( size_t i )
+    {
+        assert( i < entries_.size() && entries_[i].write );
+        const size_t ahead = std::max( 1u, std::thread::hardware_concurrency() );
+        for ( ; launched_ < entries_.size() && launched_ <= i + ahead; ++launched_ )
+        {
+            const auto & entry = entries_[launched_];
+            if ( !entry.write )
+                continue;
+            futures_[launched_] = std::async( getAsyncLaunchType(), [&entry] () -> Expected<std::string>
+            {
+                std::ostringstream out( std::ios::binary );
+                auto res = entry.write( out );
+                if ( !res )
+                    return unexpected( std::move( res.error() ) );
+                if ( !out )
+                    return unexpected( "Cannot write zip entry " + entry.name );
+                return std::move( out ).str();
+            } );
+        }
+        assert( futures_[i].valid() );
+        return futures_[i].get();
+    }
+
+private:
+    const std::vector<ZipEntry>& entries_;
+    std::vector<std::future<Expected<std::string>>> futures_;
+    size_t launched_ = 0;
+};
+
+// the source of one zip-entry, which data is requested from EntriesWriter on open and released on close
+struct EntrySource
+{
+    EntriesWriter * writer = nullptr;
+    size_t index = 0;
+    std::string data;
+    size_t pos = 0;
+    bool taken = false;
+    std::string errorText;
+    zip_error_t error;
+
+    bool take()
+    {
+        if ( taken )
+            return errorText.empty();
+        taken = true;
+        auto res = writer->take( index );
+        if ( !res )
+        {
+            errorText = std::move( res.error() );
+            zip_error_set( &error, ZIP_ER_READ, 0 );
+            return false;
+        }
+        data = std::move( *res );
+        return true;
+    }
+};
+
+/// zip-callback for reading the data of an entry written by EntriesWriter
+zip_int64_t entrySourceCallback( void *userdata, void *data, zip_uint64_t len, zip_source_cmd_t cmd )
+{
+    if ( !userdata )
+    {
+        assert( false );
+        return -1;
+    }
+
+    auto & src = *(EntrySource*)( userdata );
+
+    switch ( cmd )
+    {
+        case ZIP_SOURCE_SUPPORTS:
+            return zip_source_make_command_bitmap( ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE,
+                ZIP_SOURCE_STAT, ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, ZIP_SOURCE_SUPPORTS, -1 );
+
+        case ZIP_SOURCE_OPEN:
+            src.pos = 0;
+            return src.take() ? 0 : -1;
+
+        case ZIP_SOURCE_READ:
+        {
+            const auto n = std::min( size_t( len ), src.data.size() - src.pos );
+            std::memcpy( data, src.data.data() + src.pos, n );
+            src.pos += n;
+            return zip_int64_t( n );
+        }
+
+        case ZIP_SOURCE_CLOSE:
+            // the entry is written only once, so its data is not needed anymore
+            src.data = {};
+            return 0;
+
+        case ZIP_SOURCE_STAT:
+        {
+            if ( !src.take() )
+                return -1;
+            zip_stat_t* zipStat = (zip_stat_t*)data;
+            zip_stat_init( zipStat );
+            zipStat->size = src.data.size();
+            zipStat->valid |= ZIP_STAT_SIZE;
+            return sizeof( zip_stat_t );
+        }
+
+        case ZIP_SOURCE_ERROR:
+            return zip_error_to_data( &src.error, data, len );
+
+        case ZIP_SOURCE_FREE:
+            return 0;
+
+        default:
+            ;
+    }
+    assert( false );
+    return -1;
+}
+
 } // anonymous namespace
 
 Expected<void> compressZip( const std::filesystem::path& zipFile, const std::filesystem::path& sourceFolder,
@@ -316,6 +446,81 @@ Expected<void> compressZip( const std::filesystem::path& zipFile, const std::fil
     return {};
 }
 
+Expected<void> compressZip( const std::filesystem::path& zipFile, const std::vector<ZipEntry>& entries,
+    const char * password, ProgressCallback cb )
+{
+    MR_TIMER;
+
+    if ( !reportProgress( cb, 0.0f ) )
+        return unexpectedOperationCanceled();
+
+    // shall be destroyed after the archive is closed
+    EntriesWriter writer( entries );
+    std::vector<EntrySource> sources( entries.size() );
+
+    int err;
+    AutoCloseZip zip( utf8string( zipFile ).c_str(), ZIP_CREATE | ZIP_TRUNCATE, &err, cb );
+    if ( !zip )
+        return unexpected( "Cannot create zip, error code: " + std::to_string( err ) );
+
+    for ( size_t i = 0; i < entries.size(); ++i )
+    {
+        const auto & entry = entries[i];
+        zip_source_t * source = nullptr;
+        if ( entry.write )
+        {
+            auto & src = sources[i];
+            src.writer = &writer;
+            src.index = i;
+            zip_error_init( &src.error );
+            source = zip_source_function( zip, entrySourceCallback, &src );
+        }
+        else
+        {
+            source = zip_source_file( zip, utf8string( entry.file ).c_str(), 0, 0 );
+            if ( !source )
+                return unexpected( "Cannot open file " + utf8string( entry.file ) + " for reading" );
+        }
+        if ( !source )
+            return unexpected( "Cannot create source of " + entry.name );
+
+        const auto index = zip_file_add( zip, entry.name.c_str(), source, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8 );
+        if ( index < 0 )
+        {
+            zip_source_free( source );
+            return unexpected( "Cannot add file " + entry.name + " to archive" );
+        }
+
+        if ( !entry.compress && zip_set_file_compression( zip, index, ZIP_CM_STORE, 0 ) )
+            return unexpected( "Cannot set compression method of " + entry.name );
+
+        if ( password )
+        {
+            if ( zip_file_set_encryption( zip, index, ZIP_EM_AES_256, password ) )
+                return unexpected( "Cannot encrypt file " + entry.name + " in archive" );
+        }
+    }
+
+    // the data of entries is written during closing
+    auto closeRes = zip.close();
+
+    for ( auto & src : sources )
+    {
+        if ( !src.errorText.empty() )
+            return unexpected( std::move( src.errorText ) );
+        if ( src.writer )
+            zip_error_fini( &src.error );
+    }
+
+    if ( !reportProgress( cb, 1.0f ) )
+        return unexpectedOperationCanceled();
+
+    if ( closeRes == -1 )
+        return unexpected( "Cannot close zip" );
+
+    return {};
+}
+
 Expected<void> decompressZip( const std::filesystem::path& zipFile, const std::filesystem::path& targetFolder, const char * password )
 {
     MR_TIMER;
@@ -342,4 +547,68 @@ Expected<void> decompressZip( std::istream& zipStream, const std::filesystem::pa
     return decompressZip_( zip, targetFolder, password );
 }
 
+Expected<ZipReader> ZipReader::open( const std::filesystem::path& zipFile, const char * password )
+{
+    MR_TIMER;
+    int err;
+    ZipReader res;
+    res.zip_ = zip_open( utf8string( zipFile ).c_str(), ZIP_RDONLY, &err );
+    if ( !res.zip_ )
+        return unexpected( "Cannot open zip, error code: " + std::to_string( err ) );
+
+    if ( password )
+        zip_set_default_password( res.zip_, password );
+
+    const auto numEntries = zip_get_num_entries( res.zip_, 0 );
+    res.names_.reserve( numEntries );
+    for ( zip_int64_t i = 0; i < numEntries; ++i )
+    {
+        const char * name = zip_get_name( res.zip_, i, 0 );
+        if ( !name )
+            return unexpected( "Cannot process zip content" );
+        std::string nameFixed = name;
+        std::replace( nameFixed.begin(), nameFixed.end(), '\\', '/' );
+        res.names_.push_back( std::move( nameFixed ) );
+    }
+    return res;
+}
+
+ZipReader::ZipReader( ZipReader&& other ) noexcept
+    : zip_( std::exchange( other.zip_, nullptr ) )
+    , names_( std::move( other.names_ ) )
+{
+}
+
+ZipReader& ZipReader::operator =( ZipReader&& other ) noexcept
+{
+    std::swap( zip_, other.zip_ );
+    std::swap( names_, other.names_ );
+    return *this;
+}
+
+ZipReader::~ZipReader()
+{
+    if ( zip_ )
+        zip_discard( zip_ );
+}
+
+Expected<std::string> ZipReader::read( size_t index )
+{
+    assert( zip_ && index < names_.size() );
+    zip_stat_t stats;
+    if ( zip_stat_index( zip_, index, 0, &stats ) == -1 )
+        return unexpected( "Cannot process zip content" );
+
+    auto zfile = zip_fopen_index( zip_, index, 0 );
+    if ( !zfile )
+        return unexpected( "Cannot open zip file " + names_[index] );
+
+    std::string res( stats.size, '\0' );
+    auto bitesRead = zip_fread( zfile, res.data(), res.size() );
+    zip_fclose( zfile );
+    if ( bitesRead != (zip_int64_t)stats.size )
+        return unexpected( "Cannot read file from zip " + names_[index] );
+    return res;
+}
+
 } // namespace MR
@@ -4,8 +4,12 @@
 #include "MRProgressCallback.h"
 #include "MRExpected.h"
 #include <filesystem>
+#include <functional>
+#include <string>
 #include <vector>
 
+struct zip;
+
 namespace MR
 {
 
@@ -35,6 +39,57 @@ MRMESH_API Expected<void> decompressZip( std::istream& zipStream, const std::fil
 MRMESH_API Expected<void> compressZip( const std::filesystem::path& zipFile, const std::filesystem::path& sourceFolder, 
     const std::vector<std::filesystem::path>& excludeFiles = {}, const char * password = nullptr, ProgressCallback cb = {} );
 
+/// an entry to be written in zip-archive by compressZip without intermediate files
+struct ZipEntry
+{
+    /// the name of the entry inside the archive, the folders are separated by '/'
+    std::string name;
+
+    /// the function writing the data of the entry in given stream, it can be called from any thread
+    std::function<Expected<void>( std::ostream& )> write;
+
+    /// the file with the data of the entry, it is used only if write function is empty
+    std::filesystem::path file;
+
+    /// if false then the data is stored as is, e.g. for already compact binary formats, which gain little from compression
+    bool compress = true;
+};
+
+/**
+ * \brief compresses given entries in given zip-file without creating intermediate files:
+ * the data of each entry is written in memory in a parallel thread shortly before libzip needs it,
+ * and at most one buffer per hardware thread is kept in memory simultaneously
+ * \param password if password is given then the archive will be encrypted
+ * \param cb an option to get progress notifications and cancel the operation
+ */
+MRMESH_API Expected<void> compressZip( const std::filesystem::path& zipFile, const std::vector<ZipEntry>& entries,
+    const char * password = nullptr, ProgressCallback cb = {} );
+
+/// opens zip-archive and decompresses its entries one by one on demand without extracting whole archive
+class MR_BIND_IGNORE ZipReader
+{
+public:
+    /// opens given zip-file for reading
+    /// \param password if password is given then it will be used to decipher encrypted archive
+    [[nodiscard]] MRMESH_API static Expected<ZipReader> open( const std::filesystem::path& zipFile, const char * password = nullptr );
+
+    MRMESH_API ZipReader( ZipReader&& other ) noexcept;
+    MRMESH_API ZipReader& operator =( ZipReader&& other ) noexcept;
+    MRMESH_API ~ZipReader();
+
+    /// the names of all entries in the archive with '/' as folder separator, the names of folder entries end with '/'
+    [[nodiscard]] const std::vector<std::string>& names() const { return names_; }
+
+    /// decompresses the data of the entry with given index in memory
+    [[nodiscard]] MRMESH_API Expected<std::string> read( size_t index );
+
+private:
+    ZipReader() = default;
+
+    ::zip * zip_ = nullptr;
+    std::vector<std::string> names_;
+};
+
 /// \}
 
 } // namespace MR
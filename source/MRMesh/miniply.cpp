@@ -1,5 +1,7 @@
 #include "miniply.h"
+#include "MRParallelFor.h"
 #include "MRTimer.h"
+#include <atomic>
 #include <fstream>
 #include <cassert>
 #include <cctype>
@@ -439,6 +441,62 @@ namespace miniply {
   }
 
 
+  // Parses one ASCII value of the given type starting at `pos` (after optional
+  // whitespace) and stores it in `value`, which must have enough space for the
+  // type. On success `pos` is moved past the parsed value. This does not depend
+  // on the reader state, so it can be called from several threads at once.
+  static bool parse_ascii_value(const char*& pos, PLYPropertyType propType, uint8_t value[8])
+  {
+    while (is_whitespace(*pos)) {
+      ++pos;
+    }
+
+    int tmpInt = 0;
+    bool ok = false;
+    switch (propType) {
+    case PLYPropertyType::Char:
+    case PLYPropertyType::UChar:
+    case PLYPropertyType::Short:
+    case PLYPropertyType::UShort:
+      ok = int_literal(pos, &pos, &tmpInt);
+      break;
+    case PLYPropertyType::Int:
+    case PLYPropertyType::UInt:
+      ok = int_literal(pos, &pos, reinterpret_cast<int*>(value));
+      break;
+    case PLYPropertyType::Float:
+      ok = float_literal(pos, &pos, reinterpret_cast<float*>(value));
+      break;
+    case PLYPropertyType::Double:
+    default:
+      ok = double_literal(pos, &pos, reinterpret_cast<double*>(value));
+      break;
+    }
+
+    if (!ok) {
+      return false;
+    }
+
+    switch (propType) {
+    case PLYPropertyType::Char:
+      reinterpret_cast<int8_t*>(value)[0] = static_cast<int8_t>(tmpInt);
+      break;
+    case PLYPropertyType::UChar:
+      value[0] = static_cast<uint8_t>(tmpInt);
+      break;
+    case PLYPropertyType::Short:
+      reinterpret_cast<int16_t*>(value)[0] = static_cast<int16_t>(tmpInt);
+      break;
+    case PLYPropertyType::UShort:
+      reinterpret_cast<uint16_t*>(value)[0] = static_cast<uint16_t>(tmpInt);
+      break;
+    default:
+      break;
+    }
+    return true;
+  }
+
+
   //
   // PLYElement methods
   //
@@ -880,6 +938,13 @@ namespace miniply {
 
   bool PLYReader::extract_properties(const uint32_t propIdxs[], uint32_t numProps, PLYPropertyType destType, void *dest) const
   {
+    return extract_properties_with_stride(propIdxs, numProps, destType, dest, numProps * kPLYPropertySize[uint32_t(destType)]);
+  }
+
+
+  bool PLYReader::extract_properties_with_stride(const uint32_t propIdxs[], uint32_t numProps, PLYPropertyType destType, void *dest, uint32_t destStride) const
+  {
+    MR_TIMER;
     if (numProps == 0) {
       return false;
     }
@@ -909,11 +974,13 @@ namespace miniply {
     }
 
     // If the row we're extracting is contiguous in memory (i.e. there are no
-    // gaps anywhere in a row - start, end or middle), we can use an even MORE
-    // efficient data extraction technique.
+    // gaps anywhere in a row - start, end or middle) and the destination rows
+    // are packed in the same way, we can use an even MORE efficient data
+    // extraction technique.
     bool contiguousRows = contiguousCols &&
                           (elem->properties[propIdxs[0]].offset == 0) &&
-                          (expectedOffset == elem->rowStride);
+                          (expectedOffset == elem->rowStride) &&
+                          (destStride == elem->rowStride);
 
     // If no data conversion is required, we can memcpy chunks of data
     // directly over to `dest`. How big those chunks will be depends on whether
@@ -928,7 +995,12 @@ namespace miniply {
       }
     }
 
+    // All rows except for the single memcpy case are processed in parallel,
+    // each row has fixed position both in the element data and in `dest`.
     uint8_t* to = reinterpret_cast<uint8_t*>(dest);
+    const uint8_t* from = m_elementData.data();
+    const size_t numRows = elem->count;
+    const size_t colBytes = kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
     if (!conversionRequired) {
       // If no data conversion is required, we can just use memcpy to get
       // values into dest.
@@ -936,54 +1008,41 @@ namespace miniply {
         // Most efficient case is when the rows are contiguous. It means we're
         // simply copying the entire data block for this element, which we can
         // do with a single memcpy.
-        std::memcpy(to, m_elementData.data(), m_elementData.size());
+        std::memcpy(to, from, m_elementData.size());
       }
       else if (contiguousCols) {
         // If the rows aren't contiguous, but the columns we're extracting
         // within each row are, then we can do a single memcpy per row.
-        const uint8_t* from = m_elementData.data() + elem->properties[propIdxs[0]].offset;
-        const uint8_t* end = m_elementData.data() + m_elementData.size();
-        const size_t numBytes = expectedOffset - elem->properties[propIdxs[0]].offset;
-        while (from < end) {
-          std::memcpy(to, from, numBytes);
-          from += elem->rowStride;
-          to += numBytes;
-        }
+        const size_t firstOffset = elem->properties[propIdxs[0]].offset;
+        const size_t numBytes = expectedOffset - firstOffset;
+        MR::ParallelFor(size_t(0), numRows, [&](size_t row) {
+          std::memcpy(to + row * destStride, from + row * elem->rowStride + firstOffset, numBytes);
+        });
       }
       else {
         // If the columns aren't contiguous, we must memcpy each one separately.
-        const uint8_t* row = m_elementData.data();
-        const uint8_t* end = m_elementData.data() + m_elementData.size();
-        uint8_t* to = reinterpret_cast<uint8_t*>(dest);
-        size_t colBytes = kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
-        while (row < end) {
+        MR::ParallelFor(size_t(0), numRows, [&](size_t row) {
+          const uint8_t* rowFrom = from + row * elem->rowStride;
+          uint8_t* rowTo = to + row * destStride;
           for (uint32_t i = 0; i < numProps; i++) {
-            uint32_t propIdx = propIdxs[i];
-            const PLYProperty& prop = elem->properties[propIdx];
-            std::memcpy(to, row + prop.offset, colBytes);
-            to += colBytes;
+            const PLYProperty& prop = elem->properties[propIdxs[i]];
+            std::memcpy(rowTo + i * colBytes, rowFrom + prop.offset, colBytes);
           }
-          row += elem->rowStride;
-        }
+        });
       }
     }
     else {
       // We will have to do data type conversions on the column values here. We
       // cannot simply use memcpy in this case, every column has to be
       // processed separately.
-      const uint8_t* row = m_elementData.data();
-      const uint8_t* end = m_elementData.data() + m_elementData.size();
-      uint8_t* to = reinterpret_cast<uint8_t*>(dest);
-      size_t colBytes = kPLYPropertySize[uint32_t(destType)]; // size of an output column in bytes.
-      while (row < end) {
+      MR::ParallelFor(size_t(0), numRows, [&](size_t row) {
+        const uint8_t* rowFrom = from + row * elem->rowStride;
+        uint8_t* rowTo = to + row * destStride;
         for (uint32_t i = 0; i < numProps; i++) {
-          uint32_t propIdx = propIdxs[i];
-          const PLYProperty& prop = elem->properties[propIdx];
-          copy_and_convert(to, destType, row + prop.offset, prop.type);
-          to += colBytes;
+          const PLYProperty& prop = elem->properties[propIdxs[i]];
+          copy_and_convert(rowTo + i * colBytes, destType, rowFrom + prop.offset, prop.type);
         }
-        row += elem->rowStride;
-      }
+      });
     }
 
     return true;
@@ -1033,15 +1092,12 @@ namespace miniply {
     else {
       // If type conversion is required we'll have to process each list value separately.
       const uint8_t* from = prop.listData.data();
-      const uint8_t* end = prop.listData.data() + prop.listData.size();
       uint8_t* to = reinterpret_cast<uint8_t*>(dest);
       const size_t toBytes = kPLYPropertySize[uint32_t(destType)];
       const size_t fromBytes = kPLYPropertySize[uint32_t(prop.type)];
-      while (from < end) {
-        copy_and_convert(to, destType, from, prop.type);
-        to += toBytes;
-        from += fromBytes;
-      }
+      MR::ParallelFor(size_t(0), prop.listData.size() / fromBytes, [&](size_t i) {
+        copy_and_convert(to + i * toBytes, destType, from + i * fromBytes, prop.type);
+      });
     }
 
     return true;
@@ -1491,16 +1547,29 @@ namespace miniply {
     m_elementData.resize(numBytes);
 
     if (m_fileType == PLYFileType::ASCII) {
-      size_t back = 0;
-
-      for (uint32_t row = 0; row < elem.count; row++) {
-        for (PLYProperty& prop : elem.properties) {
-          if (!load_ascii_scalar_property(prop, back)) {
-            m_valid = false;
-            return false;
+      // Each row is on its own line, so after the lines are found they can be
+      // parsed in parallel directly into their places in the element data.
+      std::string text;
+      std::vector<size_t> rowStart;
+      if (!read_ascii_rows(elem.count, text, rowStart)) {
+        m_valid = false;
+        return false;
+      }
+      std::atomic<bool> parsed{ true };
+      MR::ParallelFor(size_t(0), size_t(elem.count), [&](size_t row) {
+        const char* pos = text.data() + rowStart[row];
+        uint8_t* dst = m_elementData.data() + row * elem.rowStride;
+        for (const PLYProperty& prop : elem.properties) {
+          if (!parse_ascii_value(pos, prop.type, dst)) {
+            parsed = false;
+            return;
           }
+          dst += kPLYPropertySize[uint32_t(prop.type)];
         }
-        next_line();
+      });
+      if (!parsed) {
+        m_valid = false;
+        return false;
       }
     }
     else {
@@ -1527,9 +1596,9 @@ namespace miniply {
       // We assume the CPU is little endian, so if the file is big-endian we
       // need to do an endianness swap on every data item in the block.
       if (m_fileType == PLYFileType::BinaryBigEndian) {
-        uint8_t* data = m_elementData.data();
-        for (uint32_t row = 0; row < elem.count; row++) {
-          for (PLYProperty& prop : elem.properties) {
+        MR::ParallelFor(size_t(0), size_t(elem.count), [&](size_t row) {
+          uint8_t* data = m_elementData.data() + row * elem.rowStride;
+          for (const PLYProperty& prop : elem.properties) {
             size_t numBytes = kPLYPropertySize[uint32_t(prop.type)];
             switch (numBytes) {
             case 2:
@@ -1546,7 +1615,7 @@ namespace miniply {
             }
             data += numBytes;
           }
-        }
+        });
       }
     }
 
@@ -1560,6 +1629,12 @@ namespace miniply {
     MR_TIMER;
     m_elementData.resize( size_t( elem.count ) * elem.rowStride);
 
+    // The most common case of an element with the only list property (e.g.
+    // faces with vertex indices) has a faster path.
+    if (elem.properties.size() == 1) {
+      return m_fileType == PLYFileType::ASCII ? load_ascii_list_element(elem) : load_binary_list_element(elem);
+    }
+
     // Preallocate enough space for each row in the property to contain three
     // items. This is based on the assumptions that (a) the most common use for
     // list properties is vertex indices; and (b) most faces are triangles.
@@ -1617,6 +1692,203 @@ namespace miniply {
   }
 
 
+  bool PLYReader::load_ascii_list_element(PLYElement& elem)
+  {
+    PLYProperty& prop = elem.properties[0];
+    if (prop.countType >= PLYPropertyType::Float) {
+      m_valid = false;
+      return false;
+    }
+
+    std::string text;
+    std::vector<size_t> rowStart;
+    if (!read_ascii_rows(elem.count, text, rowStart)) {
+      m_valid = false;
+      return false;
+    }
+
+    // The first pass finds the number of items in each row, and the second
+    // one parses the items directly into their places in the list data.
+    std::atomic<bool> parsed{ true };
+    prop.rowCount.resize(elem.count);
+    MR::ParallelFor(size_t(0), size_t(elem.count), [&](size_t row) {
+      const char* pos = text.data() + rowStart[row];
+      while (is_whitespace(*pos)) {
+        ++pos;
+      }
+      int count = 0;
+      if (!miniply::int_literal(pos, &pos, &count) || count < 0) {
+        parsed = false;
+        return;
+      }
+      prop.rowCount[row] = uint32_t(count);
+    });
+    if (!parsed) {
+      m_valid = false;
+      return false;
+    }
+
+    std::vector<size_t> firstItem(size_t(elem.count) + 1);
+    firstItem[0] = 0;
+    for (size_t row = 0; row < elem.count; row++) {
+      firstItem[row + 1] = firstItem[row] + prop.rowCount[row];
+    }
+
+    const size_t numBytes = kPLYPropertySize[uint32_t(prop.type)];
+    prop.listData.resize(firstItem.back() * numBytes);
+    MR::ParallelFor(size_t(0), size_t(elem.count), [&](size_t row) {
+      const char* pos = text.data() + rowStart[row];
+      while (is_whitespace(*pos)) {
+        ++pos;
+      }
+      miniply::int_literal(pos, &pos, nullptr); // skip count
+      uint8_t* dst = prop.listData.data() + firstItem[row] * numBytes;
+      for (uint32_t i = 0; i < prop.rowCount[row]; i++) {
+        if (!parse_ascii_value(pos, prop.type, dst)) {
+          parsed = false;
+          return;
+        }
+        dst += numBytes;
+      }
+    });
+    if (!parsed) {
+      m_valid = false;
+      return false;
+    }
+
+    m_elementLoaded = true;
+    return true;
+  }
+
+
+  bool PLYReader::load_binary_list_element(PLYElement& elem)
+  {
+    PLYProperty& prop = elem.properties[0];
+    const bool bigEndian = m_fileType == PLYFileType::BinaryBigEndian;
+    const size_t countBytes = kPLYPropertySize[uint32_t(prop.countType)];
+    const size_t typeBytes = kPLYPropertySize[uint32_t(prop.type)];
+
+    // The rows are copied as they are from the read buffer, only looking at
+    // the counts to find where each row ends; the items are moved in their
+    // places in the list data afterwards in parallel.
+    std::vector<uint8_t> rows;
+    rows.reserve(size_t(elem.count) * (countBytes + 3 * typeBytes));
+    prop.rowCount.resize(elem.count);
+    uint32_t row = 0;
+    bool sameCounts = true;
+    while (row < elem.count) {
+      const uint8_t* pos = reinterpret_cast<const uint8_t*>(m_pos);
+      const uint8_t* start = pos;
+      const uint8_t* end = reinterpret_cast<const uint8_t*>(m_bufEnd);
+      while (row < elem.count && pos + countBytes <= end) {
+        uint8_t tmp[8];
+        std::memcpy(tmp, pos, countBytes);
+        if (bigEndian) {
+          endian_swap(tmp, prop.countType);
+        }
+        int count = 0;
+        copy_and_convert_to(&count, tmp, prop.countType);
+        if (count < 0) {
+          m_valid = false;
+          return false;
+        }
+        const size_t rowBytes = countBytes + typeBytes * uint32_t(count);
+        if (pos + rowBytes > end) {
+          break;
+        }
+        prop.rowCount[row] = uint32_t(count);
+        sameCounts = sameCounts && prop.rowCount[row] == prop.rowCount[0];
+        ++row;
+        pos += rowBytes;
+      }
+      rows.insert(rows.end(), start, pos);
+      m_pos = reinterpret_cast<const char*>(pos);
+      m_end = m_pos;
+      if (row < elem.count && !refill_buffer()) {
+        m_valid = false;
+        return false;
+      }
+    }
+
+    // If all rows have the same number of items then they are of fixed size,
+    // otherwise the positions of the rows are found by prefix sum.
+    std::vector<size_t> firstItem;
+    size_t numItems = 0;
+    if (sameCounts) {
+      numItems = elem.count > 0 ? size_t(elem.count) * prop.rowCount[0] : 0;
+    }
+    else {
+      firstItem.resize(size_t(elem.count) + 1);
+      firstItem[0] = 0;
+      for (size_t r = 0; r < elem.count; r++) {
+        firstItem[r + 1] = firstItem[r] + prop.rowCount[r];
+      }
+      numItems = firstItem.back();
+    }
+
+    prop.listData.resize(numItems * typeBytes);
+    MR::ParallelFor(size_t(0), size_t(elem.count), [&](size_t r) {
+      const size_t first = sameCounts ? r * prop.rowCount[0] : firstItem[r];
+      uint8_t* dst = prop.listData.data() + first * typeBytes;
+      const size_t listBytes = prop.rowCount[r] * typeBytes;
+      std::memcpy(dst, rows.data() + (r + 1) * countBytes + first * typeBytes, listBytes);
+      if (bigEndian) {
+        endian_swap_array(dst, prop.type, int(prop.rowCount[r]));
+      }
+    });
+
+    m_elementLoaded = true;
+    return true;
+  }
+
+
+  bool PLYReader::read_ascii_rows(uint32_t numRows, std::string& text, std::vector<size_t>& rowStart)
+  {
+    MR_TIMER;
+    text.clear();
+    rowStart.clear();
+    rowStart.reserve(size_t(numRows) + 1);
+
+    size_t lineStart = 0;
+    while (rowStart.size() < numRows) {
+      const char* newline = static_cast<const char*>(std::memchr(m_pos, '\n', size_t(m_bufEnd - m_pos)));
+      const char* lineEnd = newline ? newline + 1 : m_bufEnd;
+      text.append(m_pos, lineEnd);
+      m_pos = lineEnd;
+      m_end = m_pos;
+      if (!newline) {
+        if (refill_buffer()) {
+          continue;
+        }
+        if (text.size() == lineStart) {
+          break; // no more data
+        }
+        text.push_back('\n'); // the last line of the file without line end
+      }
+      // skip comments the same way as next_line() does
+      if (text.compare(lineStart, 7, "comment") == 0 || text.compare(lineStart, 8, "obj_info") == 0) {
+        text.resize(lineStart);
+      }
+      else {
+        rowStart.push_back(lineStart);
+        lineStart = text.size();
+      }
+    }
+    if (rowStart.size() < numRows) {
+      return false;
+    }
+    rowStart.push_back(text.size());
+
+    if (match("comment") || match("obj_info")) {
+      next_line();
+    }
+    else {
+      m_end = m_pos;
+    }
+    return true;
+  }
+
+
   bool PLYReader::load_ascii_scalar_property(PLYProperty& prop, size_t& destIndex)
   {
     uint8_t value[8];
@@ -1774,53 +2046,18 @@ namespace miniply {
 
   bool PLYReader::ascii_value(PLYPropertyType propType, uint8_t value[8])
   {
-    int tmpInt = 0;
-
-    switch (propType) {
-    case PLYPropertyType::Char:
-    case PLYPropertyType::UChar:
-    case PLYPropertyType::Short:
-    case PLYPropertyType::UShort:
-      m_valid = int_literal(&tmpInt);
-      break;
-    case PLYPropertyType::Int:
-    case PLYPropertyType::UInt:
-      m_valid = int_literal(reinterpret_cast<int*>(value));
-      break;
-    case PLYPropertyType::Float:
-      m_valid = float_literal(reinterpret_cast<float*>(value));
-      break;
-    case PLYPropertyType::Double:
-    default:
-      m_valid = double_literal(reinterpret_cast<double*>(value));
-      break;
-    }
-
+    const char* pos = m_pos;
+    m_valid = parse_ascii_value(pos, propType, value);
     if (!m_valid) {
       return false;
     }
+    m_end = pos;
     advance();
-
-    switch (propType) {
-    case PLYPropertyType::Char:
-      reinterpret_cast<int8_t*>(value)[0] = static_cast<int8_t>(tmpInt);
-      break;
-    case PLYPropertyType::UChar:
-      value[0] = static_cast<uint8_t>(tmpInt);
-      break;
-    case PLYPropertyType::Short:
-      reinterpret_cast<int16_t*>(value)[0] = static_cast<int16_t>(tmpInt);
-      break;
-    case PLYPropertyType::UShort:
-      reinterpret_cast<uint16_t*>(value)[0] = static_cast<uint16_t>(tmpInt);
-      break;
-    default:
-      break;
-    }
     return true;
   }
 
 
+
   //
   // Polygon triangulation
   //
@@ -204,6 +204,12 @@ namespace miniply {
     /// `extract_list_column()` for those instead.
     bool extract_properties(const uint32_t propIdxs[], uint32_t numProps, PLYPropertyType destType, void* dest) const;
 
+    /// Same as `extract_properties`, but the start of each row in `dest` is
+    /// `destStride` bytes after the start of the previous one, which allows
+    /// to extract the properties directly into an array of larger structures
+    /// (e.g. RGB colors into RGBA array). The rows are processed in parallel.
+    bool extract_properties_with_stride(const uint32_t propIdxs[], uint32_t numProps, PLYPropertyType destType, void* dest, uint32_t destStride) const;
+
     /// Get the array of item counts for a list property. Entry `i` in this
     /// array is the number of items in the `i`th list.
     const uint32_t* get_list_counts(uint32_t propIdx) const;
@@ -254,6 +260,13 @@ namespace miniply {
 
     bool load_fixed_size_element(PLYElement& elem);
     bool load_variable_size_element(PLYElement& elem);
+    bool load_ascii_list_element(PLYElement& elem);
+    bool load_binary_list_element(PLYElement& elem);
+
+    /// Reads the lines of the next `numRows` rows of ASCII element (skipping
+    /// comments) into `text`, `rowStart` receives the offset of each row in it
+    /// and the total text size in the end.
+    bool read_ascii_rows(uint32_t numRows, std::string& text, std::vector<size_t>& rowStart);
 
     bool load_ascii_scalar_property(PLYProperty& prop, size_t& destIndex);
     bool load_ascii_list_property(PLYProperty& prop);
@@ -0,0 +1,69 @@
+#include "MRMesh/MRConcurrentUnionFind.h"
+#include "MRMesh/MRMeshComponents.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRAffineXf3.h"
+#include "MRMesh/MRTorus.h"
+#include "MRMesh/MRBitSet.h"
+#include "MRMesh/MRGTest.h"
+#include <random>
+
+namespace MR
+{
+
+TEST( MRMesh, ConcurrentUnionFind )
+{
+    constexpr size_t cSize = 100000;
+    std::mt19937 gen( 7 );
+    std::uniform_int_distribution<int> dist( 0, int( cSize ) - 1 );
+    std::vector<std::pair<VertId, VertId>> pairs( cSize / 2 );
+    for ( auto & p : pairs )
+        p = { VertId( dist( gen ) ), VertId( dist( gen ) ) };
+
+    UnionFind<VertId> seq( cSize );
+    for ( const auto & p : pairs )
+        seq.unite( p.first, p.second );
+
+    ConcurrentUnionFind<VertId> con( cSize );
+    ParallelFor( pairs, [&]( size_t i ) { con.unite( pairs[i].first, pairs[i].second ); } );
+    EXPECT_TRUE( con.united( pairs[0].first, pairs[0].second ) );
+    auto conv = std::move( con ).toUnionFind();
+
+    const auto & seqRoots = seq.roots();
+    const auto & conRoots = conv.parents();
+    for ( VertId v( 0 ); v < cSize; ++v )
+    {
+        // the root is the smallest element of each set
+        EXPECT_LE( conRoots[v], v );
+        EXPECT_EQ( conRoots[conRoots[v]], conRoots[v] );
+        // the same partition in sets
+        EXPECT_EQ( seqRoots[conRoots[v]], seqRoots[v] );
+        EXPECT_EQ( conv.sizeOfComp( v ), seq.sizeOfComp( v ) );
+    }
+
+    // voxel ids have 64 bits
+    ConcurrentUnionFind<VoxelId> voxels( 10 );
+    ParallelFor( size_t( 0 ), size_t( 9 ), [&]( size_t i ) { voxels.unite( VoxelId( i ), VoxelId( i + 1 ) ); } );
+    auto voxelsUf = std::move( voxels ).toUnionFind();
+    EXPECT_EQ( voxelsUf.sizeOfComp( VoxelId( size_t( 5 ) ) ), 10 );
+}
+
+TEST( MRMesh, ConcurrentComponents )
+{
+    auto mesh = makeTorus( 1.0f, 0.3f, 64, 32 );
+    auto other = makeTorus( 1.0f, 0.3f, 16, 8 );
+    other.transform( AffineXf3f::translation( { 5.0f, 0.0f, 0.0f } ) );
+    mesh.addMesh( other );
+
+    const auto faceComps = MeshComponents::getAllComponents( mesh );
+    ASSERT_EQ( faceComps.size(), 2 );
+    EXPECT_EQ( faceComps[0].count() + faceComps[1].count(), mesh.topology.numValidFaces() );
+    EXPECT_EQ( MeshComponents::getAllComponents( mesh, MeshComponents::PerVertex ).size(), 2 );
+    EXPECT_EQ( MeshComponents::getAllComponentsVerts( mesh ).size(), 2 );
+    EXPECT_EQ( MeshComponents::getNumComponents( mesh ), 2 );
+
+    auto edgesUf = MeshComponents::getUnionFindStructureUndirectedEdges( mesh );
+    EXPECT_EQ( edgesUf.sizeOfComp( 0_ue ) + edgesUf.sizeOfComp( UndirectedEdgeId( mesh.topology.undirectedEdgeSize() - 1 ) ),
+        mesh.topology.undirectedEdgeSize() );
+}
+
+} //namespace MR
@@ -0,0 +1,69 @@
+#ifndef MESHLIB_NO_VOXELS
+
+#include "MRVoxels/MRMeshToDistanceVolume.h"
+#include "MRVoxels/MRVoxelsVolume.h"
+#include "MRMesh/MRTorus.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRGTest.h"
+#include "MRMesh/MRIsNaN.h"
+#include "MRMesh/MRVolumeIndexer.h"
+#include <tuple>
+
+namespace MR
+{
+
+TEST( MRMesh, FunctionVolumeRows )
+{
+    const auto mesh = makeTorus( 1.0f, 0.3f, 32, 16 );
+
+    MeshToDistanceVolumeParams params;
+    params.vol.origin = Vector3f( -1.5f, -1.5f, -0.5f );
+    params.vol.voxelSize = Vector3f::diagonal( 0.1f );
+    params.vol.dimensions = Vector3i( 30, 30, 10 );
+
+    for ( auto signMode : { SignDetectionMode::WindingRule, SignDetectionMode::ProjectionNormal } )
+    {
+        params.dist.signMode = signMode;
+        // the last case has minDistSq > 0 without nulls, where the search of projection stops on any point closer than minDistSq,
+        // so the distance within minDistSq can depend on the order of the search
+        for ( auto [nullOutside, minDistSq, maxDistSq] : { std::tuple{ false, 0.0f, FLT_MAX }, { true, 0.0f, sqr( 0.25f ) }, { false, sqr( 0.15f ), FLT_MAX } } )
+        {
+            params.dist.nullOutsideMinMax = nullOutside;
+            params.dist.minDistSq = minDistSq;
+            params.dist.maxDistSq = maxDistSq;
+
+            const auto func = meshToDistanceFunctionVolume( mesh, params );
+            ASSERT_TRUE( bool( func.rowGetter ) );
+
+            // the values evaluated by rows must be the same as the values of separate voxels
+            const auto vol = functionVolumeToSimpleVolume( func );
+            ASSERT_TRUE( vol.has_value() );
+            const VolumeIndexer indexer( func.dims );
+            int numNegative = 0;
+            for ( size_t i = 0; i < indexer.size(); ++i )
+            {
+                const auto expected = func.data( indexer.toPos( VoxelId( i ) ) );
+                const auto actual = vol->data[i];
+                if ( isNanFast( expected ) )
+                {
+                    EXPECT_TRUE( isNanFast( actual ) );
+                    continue;
+                }
+                if ( std::abs( expected ) < std::sqrt( minDistSq ) )
+                {
+                    EXPECT_LT( std::abs( actual ), std::sqrt( minDistSq ) );
+                    EXPECT_EQ( expected < 0, actual < 0 );
+                }
+                else
+                    EXPECT_NEAR( expected, actual, 1e-6f );
+                if ( actual < 0 )
+                    ++numNegative;
+            }
+            EXPECT_GT( numNegative, 0 );
+        }
+    }
+}
+
+} //namespace MR
+
+#endif //!MESHLIB_NO_VOXELS
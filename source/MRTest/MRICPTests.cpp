@@ -0,0 +1,88 @@
+#include <MRMesh/MRICP.h>
+#include <MRMesh/MRMultiwayICP.h>
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRTorus.h>
+#include <MRMesh/MRQuaternion.h>
+#include <MRMesh/MRGTest.h>
+
+namespace MR
+{
+
+TEST( MRMesh, ICPTorus )
+{
+    auto torus = makeTorus( 1.0f, 0.3f, 64, 32 );
+    // break rotational symmetry
+    torus.transform( AffineXf3f::linear( Matrix3f::scale( 1.5f, 1.0f, 0.7f ) ) );
+    const auto fltXf = AffineXf3f::linear( Matrix3f( Quaternionf( Vector3f( 0.3f, 1.0f, 0.2f ).normalized(), 0.1f ) ) ) * AffineXf3f::translation( { 0.05f, -0.03f, 0.02f } );
+    ICPProperties props;
+    props.iterLimit = 100;
+    props.badIterStopCount = 10;
+
+    ICP icp( torus, torus, fltXf, {}, 0.05f );
+    icp.setParams( props );
+    ASSERT_GT( icp.getFlt2RefPairs().vec.size(), 100 );
+
+    // the pairs are ordered spatially, but each sample appears only once
+    auto srcVerts = icp.getFlt2RefPairs().vec;
+    std::sort( srcVerts.begin(), srcVerts.end(), [] ( const PointPair & a, const PointPair & b ) { return a.srcVertId < b.srcVertId; } );
+    EXPECT_TRUE( std::adjacent_find( srcVerts.begin(), srcVerts.end(), [] ( const PointPair & a, const PointPair & b ) { return a.srcVertId == b.srcVertId; } ) == srcVerts.end() );
+
+    const auto resXf = icp.calculateTransformation();
+    EXPECT_LT( icp.getMeanSqDistToPoint(), 1e-3f );
+    for ( auto v : torus.topology.getValidVerts() )
+        EXPECT_LT( ( resXf( torus.points[v] ) - torus.points[v] ).length(), 1e-3f );
+}
+
+TEST( MRMesh, MultiwayICPPyramid )
+{
+    auto torus = makeTorus( 1.0f, 0.3f, 64, 32 );
+    torus.transform( AffineXf3f::linear( Matrix3f::scale( 1.5f, 1.0f, 0.7f ) ) );
+
+    ICPObjects objs;
+    for ( int i = 0; i < 4; ++i )
+    {
+        const auto xf = AffineXf3f::linear( Matrix3f( Quaternionf( Vector3f( 0.3f, 1.0f, 0.2f * i ).normalized(), 0.02f * i ) ) )
+            * AffineXf3f::translation( Vector3f( 0.01f, -0.02f, 0.01f ) * float( i ) );
+        objs.push_back( { torus, xf } );
+    }
+
+    MultiwayICP icp( objs, { .samplingVoxelSize = 0.05f, .numPyramidLevels = 3 } );
+    const auto numCoarseSamples = icp.getNumSamples(); // only the coarsest level is sampled before the run
+    ICPProperties props;
+    props.iterLimit = 100;
+    props.badIterStopCount = 10;
+    icp.setParams( props );
+
+    std::vector<MultiwayICPLevelStats> levels;
+    icp.setPerLevelCallback( [&] ( const MultiwayICPLevelStats& stats ) { levels.push_back( stats ); } );
+    int numProgressReports = 0;
+    float lastProgress = 0;
+    const auto xfs = icp.calculateTransformations( [&] ( float p )
+    {
+        EXPECT_GE( p, lastProgress );
+        lastProgress = p;
+        ++numProgressReports;
+        return true;
+    } );
+    ASSERT_EQ( xfs.size(), objs.size() );
+    EXPECT_GT( numProgressReports, 0 );
+
+    // coarse-to-fine order of levels
+    ASSERT_EQ( levels.size(), 3 );
+    for ( int i = 0; i < 3; ++i )
+    {
+        EXPECT_EQ( levels[i].level, 2 - i );
+        EXPECT_FLOAT_EQ( levels[i].samplingVoxelSize, 0.05f * float( 1 << ( 2 - i ) ) );
+        EXPECT_GT( levels[i].iterations, 0 );
+        EXPECT_LE( levels[i].iterations, props.iterLimit );
+    }
+    EXPECT_EQ( levels[0].numSamples, numCoarseSamples );
+    EXPECT_LT( levels[0].numSamples, levels[2].numSamples );
+
+    // all objects are moved in the position of the last fixed one
+    for ( auto v : torus.topology.getValidVerts() )
+        for ( ObjId i( 0 ); i + 1 < objs.size(); ++i )
+            EXPECT_LT( ( xfs[i]( torus.points[v] ) - xfs.back()( torus.points[v] ) ).length(), 1e-3f );
+}
+
+} //namespace MR
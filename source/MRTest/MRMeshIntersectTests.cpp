@@ -2,7 +2,11 @@
 #include <MRMesh/MRMakeSphereMesh.h>
 #include <MRMesh/MRMesh.h>
 #include <MRMesh/MRMeshIntersect.h>
+#include <MRMesh/MRMeshThickness.h>
+#include <MRMesh/MRTorus.h>
 #include <MRMesh/MRLine3.h>
+#include <MRMesh/MRBitSet.h>
+#include <cmath>
 
 namespace MR
 {
@@ -27,4 +31,83 @@ TEST(MRMesh, MeshIntersect)
     }
 }
 
+TEST(MRMesh, MultiRayMeshIntersectPackets)
+{
+    Mesh sphere = makeUVSphere( 1, 16, 16 );
+
+    // a bundle of parallel rays and a fan of rays from one point, some of them miss the sphere
+    std::vector<Vector3f> origins, dirs;
+    for ( int i = -10; i <= 10; ++i )
+    {
+        for ( int j = -10; j <= 10; ++j )
+        {
+            origins.emplace_back( 0.11f * i, 0.11f * j, 3.0f );
+            dirs.emplace_back( 0.0f, 0.0f, -1.0f );
+            origins.emplace_back( 0.0f, -3.0f, 0.0f );
+            dirs.emplace_back( 0.1f * i, 1.0f, 0.1f * j );
+        }
+    }
+
+    auto run = [&]( bool closestIntersect, bool coherentPackets, const std::vector<size_t> * coherentOrder = nullptr )
+    {
+        struct Res
+        {
+            BitSet hits;
+            std::vector<float> params;
+            std::vector<FaceId> faces;
+            std::vector<Vector3f> pts;
+        } res;
+        MultiRayMeshIntersectResult r;
+        r.intersectingRays = &res.hits;
+        r.rayParams = &res.params;
+        r.isectFaces = &res.faces;
+        r.isectPts = &res.pts;
+        multiRayMeshIntersect( sphere, origins, dirs, r, 0.0f, FLT_MAX, closestIntersect, {}, coherentPackets, coherentOrder );
+        return res;
+    };
+
+    const auto single = run( true, false );
+    const auto packets = run( true, true );
+    EXPECT_GT( single.hits.count(), 0 );
+    EXPECT_LT( single.hits.count(), origins.size() );
+    EXPECT_EQ( single.hits, packets.hits );
+    for ( size_t i = 0; i < origins.size(); ++i )
+    {
+        if ( !single.hits.test( i ) )
+        {
+            EXPECT_TRUE( std::isnan( packets.params[i] ) );
+            continue;
+        }
+        EXPECT_EQ( single.params[i], packets.params[i] );
+        EXPECT_LT( ( single.pts[i] - packets.pts[i] ).length(), 1e-6f );
+    }
+
+    // any intersection is found for the same rays
+    const auto anySingle = run( false, false );
+    const auto anyPackets = run( false, true );
+    EXPECT_EQ( anySingle.hits, single.hits );
+    EXPECT_EQ( anyPackets.hits, single.hits );
+
+    // precomputed order of rays gives the same result
+    const auto order = getCoherentRayOrder( origins, dirs );
+    const auto orderedPackets = run( true, true, &order );
+    EXPECT_EQ( orderedPackets.hits, single.hits );
+    EXPECT_EQ( orderedPackets.faces, packets.faces );
+}
+
+TEST(MRMesh, RayThicknessPackets)
+{
+    // thickness is computed by coherent packets of rays skipping the faces incident to ray origins,
+    // and it must be the same as found by individual rays
+    const auto torus = makeTorus( 2, 1, 32, 32 );
+    const auto thickness = computeRayThicknessAtVertices( torus );
+    ASSERT_TRUE( thickness.has_value() );
+    for ( auto v : torus.topology.getValidVerts() )
+    {
+        const auto isec = rayInsideIntersect( torus, v );
+        ASSERT_TRUE( isec );
+        EXPECT_EQ( ( *thickness )[v], isec.distanceAlongLine );
+    }
+}
+
 } //namespace MR
@@ -2,6 +2,8 @@
 #include <MRMesh/MRMeshSave.h>
 #include <MRMesh/MRMesh.h>
 #include <MRMesh/MRBox.h>
+#include <MRMesh/MRColor.h>
+#include <MRMesh/MRVector.h>
 #include <MRMesh/MRGTest.h>
 
 namespace MR
@@ -76,4 +78,53 @@ TEST(MRMesh, LoadSave)
     EXPECT_EQ( loadRes->topology.numValidFaces(), 6 );
 }
 
+TEST(MRMesh, LoadSavePly)
+{
+    // ASCII file with a comment inside data, a quad and a triangle
+    std::string file =
+        "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 5\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property uchar red\n"
+        "property uchar green\n"
+        "property uchar blue\n"
+        "element face 2\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n"
+        "0 0 0 255 0 0\n"
+        "1 0 0 0 255 0\n"
+        "comment in the middle of vertices\n"
+        "1 1 0 0 0 255\n"
+        "0 1 0 10 20 30\n"
+        "2 0.5 0 1 2 3\n"
+        "4 0 1 2 3\n"
+        "3 1 4 2\n";
+
+    std::istringstream in( file );
+    VertColors colors;
+    auto loadRes = MeshLoad::fromPly( in, { .colors = &colors } );
+    ASSERT_TRUE( loadRes.has_value() );
+    EXPECT_EQ( loadRes->points.size(), 5 );
+    EXPECT_EQ( loadRes->topology.numValidFaces(), 3 );
+    EXPECT_EQ( loadRes->points[VertId( 4 )], Vector3f( 2, 0.5f, 0 ) );
+    ASSERT_EQ( colors.size(), 5 );
+    EXPECT_EQ( colors[VertId( 1 )], Color( 0, 255, 0 ) );
+    EXPECT_EQ( colors[VertId( 3 )], Color( 10, 20, 30 ) );
+
+    // binary save and load back
+    std::stringstream ss;
+    auto saveRes = MeshSave::toPly( *loadRes, ss, { .colors = &colors } );
+    EXPECT_TRUE( saveRes.has_value() );
+
+    VertColors colors2;
+    auto loadRes2 = MeshLoad::fromPly( ss, { .colors = &colors2 } );
+    ASSERT_TRUE( loadRes2.has_value() );
+    EXPECT_EQ( loadRes2->points, loadRes->points );
+    EXPECT_EQ( loadRes2->topology.numValidFaces(), 3 );
+    EXPECT_EQ( colors2, colors );
+}
+
 } //namespace MR
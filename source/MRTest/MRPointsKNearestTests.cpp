@@ -0,0 +1,149 @@
+#include <MRMesh/MRPointsKNearest.h>
+#include <MRMesh/MRPointCloud.h>
+#include <MRMesh/MRPointsInBall.h>
+#include <MRMesh/MRFewSmallest.h>
+#include <MRMesh/MROutlierPoints.h>
+#include <MRMesh/MRPointCloudMakeNormals.h>
+#include <MRMesh/MRPointCloudTriangulation.h>
+#include <MRMesh/MRUniformSampling.h>
+#include <MRMesh/MRBitSet.h>
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRTorus.h>
+#include <MRMesh/MRGTest.h>
+
+namespace MR
+{
+
+TEST( MRMesh, FindAllKNearestPoints )
+{
+    const auto torus = makeTorus( 1.0f, 0.3f, 64, 32 );
+    PointCloud pc;
+    pc.points = torus.points;
+    pc.validPoints = torus.topology.getValidVerts();
+    // some invalid points in the middle
+    for ( VertId v = 100_v; v < 120_v; ++v )
+        pc.validPoints.reset( v );
+
+    constexpr int numNei = 10;
+    for ( float upDistLimitSq : { FLT_MAX, 0.01f } )
+    {
+        auto optNeis = findAllKNearestPoints( pc, numNei, upDistLimitSq );
+        ASSERT_TRUE( optNeis.has_value() );
+        const auto & neis = *optNeis;
+        ASSERT_EQ( neis.firstNei.size(), pc.points.size() + 1 );
+
+        FewSmallest<PointsProjectionResult> expected;
+        for ( VertId v = 0_v; v < pc.points.size(); ++v )
+        {
+            if ( !pc.validPoints.test( v ) )
+            {
+                EXPECT_EQ( neis.numNeis( v ), 0 );
+                continue;
+            }
+            expected.reset( numNei + 1 );
+            findFewClosestPoints( pc.points[v], pc, expected, upDistLimitSq );
+            auto expectedNeis = expected.get();
+            std::sort( expectedNeis.begin(), expectedNeis.end() );
+            std::erase_if( expectedNeis, [v]( const PointsProjectionResult & p ) { return p.vId == v; } );
+            if ( expectedNeis.size() > numNei )
+                expectedNeis.resize( numNei );
+
+            // neighbours can be different only among the points on the same distance
+            ASSERT_EQ( neis.numNeis( v ), expectedNeis.size() );
+            size_t i = 0;
+            for ( auto n : neis.get( v ) )
+            {
+                EXPECT_TRUE( pc.validPoints.test( n ) );
+                EXPECT_NE( n, v );
+                EXPECT_FLOAT_EQ( ( pc.points[n] - pc.points[v] ).lengthSq(), expectedNeis[i++].distSq );
+            }
+        }
+    }
+}
+
+TEST( MRMesh, FindAllNeighborsInRadius )
+{
+    const auto torus = makeTorus( 1.0f, 0.3f, 64, 32 );
+    PointCloud pc;
+    pc.points = torus.points;
+    pc.validPoints = torus.topology.getValidVerts();
+
+    const float radius = 0.1f;
+    auto optNeis = findAllNeighborsInRadius( pc, radius );
+    ASSERT_TRUE( optNeis.has_value() );
+    const auto & neis = *optNeis;
+    EXPECT_TRUE( neis.hasAllInRadius( radius ) );
+    EXPECT_FALSE( neis.hasAllInRadius( 2 * radius ) );
+    EXPECT_FALSE( neis.hasKNearest( 1 ) );
+
+    for ( auto v : pc.validPoints )
+    {
+        std::vector<VertId> expected;
+        findPointsInBall( pc, { pc.points[v], sqr( radius ) }, [&] ( const PointsProjectionResult & found, const Vector3f &, Ball3f & )
+        {
+            if ( found.vId != v )
+                expected.push_back( found.vId );
+            return Processing::Continue;
+        } );
+        std::vector<VertId> actual( begin( neis.get( v ) ), end( neis.get( v ) ) );
+        std::sort( expected.begin(), expected.end() );
+        std::sort( actual.begin(), actual.end() );
+        EXPECT_EQ( actual, expected );
+    }
+}
+
+TEST( MRMesh, PointCloudCachedNeighbors )
+{
+    const auto torus = makeTorus( 1.0f, 0.3f, 64, 32 );
+    PointCloud pc;
+    pc.points = torus.points;
+    pc.validPoints = torus.topology.getValidVerts();
+    EXPECT_EQ( pc.getNeighborsInRadiusNotCreate(), nullptr );
+    EXPECT_EQ( pc.getKNearestNeighborsNotCreate(), nullptr );
+
+    // the table for larger radius is reused for smaller one, and it is not rebuilt for larger radius
+    const auto * neis = pc.getNeighborsInRadius( 0.15f );
+    ASSERT_TRUE( neis && neis->hasAllInRadius( 0.15f ) );
+    EXPECT_EQ( pc.getNeighborsInRadius( 0.1f ), neis );
+    EXPECT_EQ( pc.getNeighborsInRadius( 0.2f ), nullptr );
+    EXPECT_EQ( pc.getNeighborsInRadiusNotCreate(), neis );
+
+    // the table of k nearest neighbours is kept separately
+    const auto * kNeis = pc.getKNearestNeighbors( 12 );
+    ASSERT_TRUE( kNeis && kNeis->hasKNearest( 12 ) );
+    EXPECT_EQ( pc.getKNearestNeighbors( 8 ), kNeis );
+    EXPECT_EQ( pc.getKNearestNeighbors( 16 ), nullptr );
+    EXPECT_EQ( pc.getNeighborsInRadius( 0.1f ), neis );
+
+    pc.invalidateCaches();
+    EXPECT_EQ( pc.getNeighborsInRadiusNotCreate(), nullptr );
+    EXPECT_EQ( pc.getKNearestNeighborsNotCreate(), nullptr );
+
+    // the algorithms give the same results with precomputed neighbours
+    const float radius = 0.1f;
+    const auto * radiusNeis = pc.getNeighborsInRadius( radius );
+    ASSERT_TRUE( radiusNeis );
+
+    const auto outliers = findOutliers( pc, { .radius = radius } );
+    const auto outliersWithNeis = findOutliers( pc, { .radius = radius, .neighbors = radiusNeis } );
+    ASSERT_TRUE( outliers.has_value() && outliersWithNeis.has_value() );
+    EXPECT_EQ( *outliers, *outliersWithNeis );
+
+    const auto normals = makeOrientedNormals( pc, radius );
+    const auto normalsWithNeis = makeOrientedNormals( pc, radius, {}, radiusNeis );
+    ASSERT_TRUE( normals && normalsWithNeis );
+    for ( auto v : pc.validPoints )
+        EXPECT_NEAR( dot( ( *normals )[v], ( *normalsWithNeis )[v] ), 1.0f, 1e-5f );
+
+    const auto samples = pointUniformSampling( pc, { .distance = radius } );
+    const auto samplesWithNeis = pointUniformSampling( pc, { .distance = radius, .neighbors = radiusNeis } );
+    ASSERT_TRUE( samples && samplesWithNeis );
+    EXPECT_EQ( *samples, *samplesWithNeis );
+
+    const auto mesh = triangulatePointCloud( pc );
+    const auto meshWithNeis = triangulatePointCloud( pc, { .neighbors = pc.getKNearestNeighbors( TriangulationParameters{}.numNeighbours ) } );
+    ASSERT_TRUE( mesh && meshWithNeis );
+    EXPECT_EQ( mesh->topology, meshWithNeis->topology );
+}
+
+} //namespace MR
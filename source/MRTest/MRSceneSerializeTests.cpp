@@ -0,0 +1,87 @@
+#include <MRMesh/MRObjectSave.h>
+#include <MRMesh/MRObjectLoad.h>
+#include <MRMesh/MRObjectMesh.h>
+#include <MRMesh/MRObjectPoints.h>
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRPointCloud.h>
+#include <MRMesh/MRTorus.h>
+#include <MRMesh/MRUniqueTemporaryFolder.h>
+#include <MRMesh/MRZip.h>
+#include <MRMesh/MRGTest.h>
+
+namespace MR
+{
+
+TEST( MRMesh, SceneSerializeWithoutTemporaryFolder )
+{
+    UniqueTemporaryFolder folder( {} );
+    ASSERT_TRUE( folder );
+
+    auto root = std::make_shared<Object>();
+    root->setName( "Root" );
+
+    auto objMesh = std::make_shared<ObjectMesh>();
+    objMesh->setName( "Torus" );
+    objMesh->setMesh( std::make_shared<Mesh>( makeTorus( 1.0f, 0.3f, 32, 16 ) ) );
+    root->addChild( objMesh );
+
+    // points in the folder of the mesh object
+    auto objPoints = std::make_shared<ObjectPoints>();
+    objPoints->setName( "Points" );
+    auto points = std::make_shared<PointCloud>();
+    points->addPoint( Vector3f( 1, 2, 3 ) );
+    points->addPoint( Vector3f( 4, 5, 6 ) );
+    objPoints->setPointCloud( points );
+    objMesh->addChild( objPoints );
+
+    auto objEmptyPoints = std::make_shared<ObjectPoints>();
+    objEmptyPoints->setName( "Empty" );
+    objEmptyPoints->setPointCloud( std::make_shared<PointCloud>() );
+    root->addChild( objEmptyPoints );
+
+    auto check = [&] ( const std::shared_ptr<Object>& loaded )
+    {
+        ASSERT_TRUE( loaded );
+        ASSERT_EQ( loaded->children().size(), 2 );
+        auto loadedMesh = std::dynamic_pointer_cast<ObjectMesh>( loaded->children()[0] );
+        ASSERT_TRUE( loadedMesh && loadedMesh->mesh() );
+        EXPECT_EQ( loadedMesh->name(), "Torus" );
+        EXPECT_EQ( loadedMesh->mesh()->topology, objMesh->mesh()->topology );
+        EXPECT_EQ( loadedMesh->mesh()->points, objMesh->mesh()->points );
+
+        ASSERT_EQ( loadedMesh->children().size(), 1 );
+        auto loadedPoints = std::dynamic_pointer_cast<ObjectPoints>( loadedMesh->children()[0] );
+        ASSERT_TRUE( loadedPoints && loadedPoints->pointCloud() );
+        EXPECT_EQ( loadedPoints->pointCloud()->points, points->points );
+
+        auto loadedEmpty = std::dynamic_pointer_cast<ObjectPoints>( loaded->children()[1] );
+        ASSERT_TRUE( loadedEmpty && loadedEmpty->pointCloud() );
+        EXPECT_TRUE( loadedEmpty->pointCloud()->points.empty() );
+    };
+
+    // the models are written directly in the archive and read from it in memory
+    const auto scene = folder / "scene.mru";
+    ASSERT_TRUE( serializeObjectTree( *root, scene ).has_value() );
+    auto zip = ZipReader::open( scene );
+    ASSERT_TRUE( zip.has_value() );
+    EXPECT_EQ( zip->names().size(), 4 ); // json, mesh, two point clouds
+    auto loaded = deserializeObjectTree( scene );
+    ASSERT_TRUE( loaded.has_value() );
+    check( loaded->obj );
+
+    // the scenes saved via temporary folder are read in the same way
+    const auto legacyScene = folder / "legacy.mru";
+    ASSERT_TRUE( serializeObjectTree( *root, legacyScene, {}, [] ( const std::filesystem::path& ) {} ).has_value() );
+    loaded = deserializeObjectTree( legacyScene );
+    ASSERT_TRUE( loaded.has_value() );
+    check( loaded->obj );
+
+    // and the new scenes can be decompressed in a folder
+    bool decompressed = false;
+    loaded = deserializeObjectTree( scene, [&] ( const std::filesystem::path& ) { decompressed = true; } );
+    ASSERT_TRUE( loaded.has_value() );
+    EXPECT_TRUE( decompressed );
+    check( loaded->obj );
+}
+
+} //namespace MR
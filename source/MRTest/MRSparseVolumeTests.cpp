@@ -0,0 +1,63 @@
+#ifndef MESHLIB_NO_VOXELS
+
+#include "MRVoxels/MRMeshToDistanceVolume.h"
+#include "MRVoxels/MRSparseVolume.h"
+#include "MRVoxels/MRMarchingCubes.h"
+#include "MRMesh/MRTorus.h"
+#include "MRMesh/MRMesh.h"
+#include "MRMesh/MRGTest.h"
+#include <cmath>
+
+namespace MR
+{
+
+TEST( MRMesh, SparseVolume )
+{
+    const auto mesh = makeTorus( 1.0f, 0.3f, 32, 16 );
+
+    MeshToDistanceVolumeParams params;
+    params.vol.origin = Vector3f( -1.5f, -1.5f, -0.5f );
+    params.vol.voxelSize = Vector3f::diagonal( 0.03f );
+    params.vol.dimensions = Vector3i( 100, 100, 34 );
+    params.dist.signMode = SignDetectionMode::WindingRule;
+    params.dist.maxDistSq = sqr( 0.1f );
+
+    const auto sparse = meshToDistanceSparseVolume( mesh, params );
+    ASSERT_TRUE( sparse.has_value() );
+    // only the bricks near the surface have individual values
+    EXPECT_GT( sparse->data.allocatedBrickCount(), 0 );
+    EXPECT_LT( sparse->data.allocatedBrickCount(), sparse->data.brickCount() );
+    EXPECT_LT( sparse->data.heapBytes(), sizeof( float ) * params.vol.dimensions.x * params.vol.dimensions.y * params.vol.dimensions.z );
+
+    // the values in the band are the same as in dense volume, and all voxels of empty bricks are out of the band
+    const auto dense = meshToDistanceVolume( mesh, params );
+    ASSERT_TRUE( dense.has_value() );
+    const auto fromSparse = sparseVolumeToSimpleVolume( *sparse );
+    ASSERT_TRUE( fromSparse.has_value() );
+    ASSERT_EQ( dense->data.size(), fromSparse->data.size() );
+    int numMismatches = 0;
+    for ( size_t i = 0; i < dense->data.size(); ++i )
+    {
+        const auto d = dense->data[i];
+        const auto s = fromSparse->data[i];
+        if ( std::isnan( d ) ? !std::isnan( s ) && std::abs( s ) != 0.1f : d != s )
+            ++numMismatches;
+    }
+    EXPECT_EQ( numMismatches, 0 );
+
+    MarchingCubesParams mcParams;
+    mcParams.origin = params.vol.origin;
+    mcParams.lessInside = true;
+    const auto sparseMesh = marchingCubes( *sparse, mcParams );
+    ASSERT_TRUE( sparseMesh.has_value() );
+    const auto denseMesh = marchingCubes( *dense, mcParams );
+    ASSERT_TRUE( denseMesh.has_value() );
+    EXPECT_EQ( sparseMesh->topology.numValidFaces(), denseMesh->topology.numValidFaces() );
+    EXPECT_EQ( sparseMesh->topology.numValidVerts(), denseMesh->topology.numValidVerts() );
+    EXPECT_TRUE( sparseMesh->topology.isClosed() );
+    EXPECT_NEAR( sparseMesh->volume(), denseMesh->volume(), 1e-6 );
+}
+
+} //namespace MR
+
+#endif //!MESHLIB_NO_VOXELS
@@ -1,9 +1,15 @@
 #include "MRHistoryStore.h"
 #include "MRViewer.h"
 #include "MRMesh/MRCombinedHistoryAction.h"
+#include "MRMesh/MRChangeMeshAction.h"
+#include "MRMesh/MRTorus.h"
+#include "MRMesh/MRGTest.h"
 #include "MRMesh/MRFinally.h"
+#include "MRMesh/MRUniqueTemporaryFolder.h"
 #include "MRPch/MRSpdlog.h"
+#include <algorithm>
 #include <cassert>
+#include <numeric>
 
 namespace MR
 {
@@ -40,6 +46,7 @@ void HistoryStore::appendAction( std::shared_ptr<HistoryAction> action )
     changedSignal( *this, ChangeType::AppendAction );
 
     filterByMemoryLimit_();
+    spillByMemoryLimit_();
 }
 
 void HistoryStore::clear()
@@ -74,17 +81,23 @@ bool HistoryStore::undo()
     if ( firstRedoIndex_ == 0 )
         return false;
 
-    undoRedoInProgress_ = true;
-    MR_FINALLY { undoRedoInProgress_ = false; };
-    assert( stack_.size() >= firstRedoIndex_ );
-    if ( stack_[firstRedoIndex_ - 1] )
     {
-        spdlog::info( "History action undo: \"{}\"", stack_[firstRedoIndex_ - 1]->name() );
-        changedSignal( *this, ChangeType::PreUndo );
-        stack_[firstRedoIndex_ - 1]->action( HistoryAction::Type::Undo );
+        undoRedoInProgress_ = true;
+        MR_FINALLY { undoRedoInProgress_ = false; };
+        assert( stack_.size() >= firstRedoIndex_ );
+        if ( !unspillOrDrop_( firstRedoIndex_ - 1 ) )
+            return false;
+        if ( stack_[firstRedoIndex_ - 1] )
+        {
+            spdlog::info( "History action undo: \"{}\"", stack_[firstRedoIndex_ - 1]->name() );
+            changedSignal( *this, ChangeType::PreUndo );
+            stack_[firstRedoIndex_ - 1]->action( HistoryAction::Type::Undo );
+        }
+        --firstRedoIndex_;
+        changedSignal( *this, ChangeType::PostUndo );
     }
-    --firstRedoIndex_;
-    changedSignal( *this, ChangeType::PostUndo );
+    // spill only after undoRedoInProgress_ is cleared, otherwise spillByMemoryLimit_ does nothing
+    spillByMemoryLimit_();
     return true;
 }
 
@@ -96,16 +109,21 @@ bool HistoryStore::redo()
     if ( firstRedoIndex_ >= stack_.size() )
         return false;
 
-    undoRedoInProgress_ = true;
-    MR_FINALLY { undoRedoInProgress_ = false; };
-    if ( stack_[firstRedoIndex_] )
     {
-        spdlog::info( "History action redo: \"{}\"", stack_[firstRedoIndex_]->name() );
-        changedSignal( *this, ChangeType::PreRedo );
-        stack_[firstRedoIndex_]->action( HistoryAction::Type::Redo );
+        undoRedoInProgress_ = true;
+        MR_FINALLY { undoRedoInProgress_ = false; };
+        if ( !unspillOrDrop_( firstRedoIndex_ ) )
+            return false;
+        if ( stack_[firstRedoIndex_] )
+        {
+            spdlog::info( "History action redo: \"{}\"", stack_[firstRedoIndex_]->name() );
+            changedSignal( *this, ChangeType::PreRedo );
+            stack_[firstRedoIndex_]->action( HistoryAction::Type::Redo );
+        }
+        ++firstRedoIndex_;
+        changedSignal( *this, ChangeType::PostRedo );
     }
-    ++firstRedoIndex_;
-    changedSignal( *this, ChangeType::PostRedo );
+    spillByMemoryLimit_();
     return true;
 }
 
@@ -150,12 +168,45 @@ size_t HistoryStore::calcUsedMemory() const
     return currentStackSize;
 }
 
+size_t HistoryStore::calcSpilledBytes() const
+{
+    size_t res = 0;
+    for ( const auto & a : stack_ )
+        if ( a )
+            res += a->spilledBytes();
+    return res;
+}
+
+bool HistoryStore::unspillOrDrop_( size_t index )
+{
+    const auto & a = stack_[index];
+    if ( !a )
+        return true;
+    auto s = a->unspill();
+    if ( s )
+        return true;
+
+    spdlog::error( "History action \"{}\" cannot be restored from disk and is removed: {}", a->name(), s.error() );
+    stack_.erase( stack_.begin() + index );
+    if ( index < firstRedoIndex_ )
+        --firstRedoIndex_;
+    if ( index < savedSceneIndex_ )
+        --savedSceneIndex_;
+    changedSignal( *this, ChangeType::PopAction );
+    return false;
+}
+
 void HistoryStore::filterByMemoryLimit_()
 {
-    size_t currentStackSize = calcUsedMemory();
+    size_t currentStackSize = 0;
+    for ( int i = 0; i < firstRedoIndex_; ++i )
+        currentStackSize += stack_[i]->heapBytes() + stack_[i]->spilledBytes();
     size_t numActionsToDelete = 0;
     while ( currentStackSize > storageLimit_ && numActionsToDelete <= firstRedoIndex_ )
-        currentStackSize -= stack_[numActionsToDelete++]->heapBytes();
+    {
+        const auto & a = stack_[numActionsToDelete++];
+        currentStackSize -= a->heapBytes() + a->spilledBytes();
+    }
 
     for ( int i = 0; i < numActionsToDelete; ++i )
     {
@@ -166,4 +217,98 @@ void HistoryStore::filterByMemoryLimit_()
     }
 }
 
+void HistoryStore::spillByMemoryLimit_()
+{
+    if ( undoRedoInProgress_ )
+        return;
+    size_t inMemory = 0;
+    for ( const auto & a : stack_ )
+        if ( a )
+            inMemory += a->heapBytes();
+    if ( inMemory <= spillLimit_ )
+        return;
+
+    if ( !spillFolder_ )
+    {
+        spillFolder_ = std::make_unique<UniqueTemporaryFolder>( FolderCallback{} );
+        if ( !*spillFolder_ )
+        {
+            spdlog::warn( "History store cannot create temporary folder for spilled actions" );
+            spillFolder_.reset();
+            return;
+        }
+    }
+
+    // the actions most distant from current position are the least likely to be undone or redone soon
+    auto distance = [this] ( size_t i ) { return i < firstRedoIndex_ ? firstRedoIndex_ - 1 - i : i - firstRedoIndex_; };
+    std::vector<size_t> order( stack_.size() );
+    std::iota( order.begin(), order.end(), size_t( 0 ) );
+    std::stable_sort( order.begin(), order.end(), [&] ( size_t a, size_t b ) { return distance( a ) > distance( b ); } );
+
+    size_t numSpilled = 0;
+    for ( auto i : order )
+    {
+        if ( inMemory <= spillLimit_ )
+            break;
+        const auto & a = stack_[i];
+        if ( !a )
+            continue;
+        const auto before = a->heapBytes();
+        if ( !a->spill( *spillFolder_ ) )
+            continue;
+        inMemory -= std::min( inMemory, before - std::min( before, a->heapBytes() ) );
+        ++numSpilled;
+    }
+    if ( numSpilled > 0 )
+        spdlog::info( "History store spilled {} actions on disk, {} bytes remain in memory", numSpilled, inMemory );
+}
+
+TEST( MRViewer, HistoryStoreSpill )
+{
+    const auto oldMesh = makeTorus( 1.0f, 0.3f, 32, 16 );
+    const auto newMesh = makeTorus( 1.0f, 0.5f, 16, 8 );
+    auto obj = std::make_shared<ObjectMesh>();
+    obj->setMesh( std::make_shared<Mesh>( oldMesh ) );
+
+    HistoryStore store;
+    store.appendAction( std::make_shared<ChangeMeshAction>( "Change mesh", obj, std::make_shared<Mesh>( newMesh ) ) );
+    store.setSpillLimit( 0 );
+    EXPECT_GT( store.calcSpilledBytes(), 0 );
+
+    ASSERT_TRUE( store.undo() );
+    EXPECT_EQ( obj->mesh()->topology, oldMesh.topology );
+    EXPECT_EQ( obj->mesh()->points, oldMesh.points );
+    EXPECT_GT( store.calcSpilledBytes(), 0 ); // the action is spilled again with the new mesh
+
+    ASSERT_TRUE( store.redo() );
+    EXPECT_EQ( obj->mesh()->topology, newMesh.topology );
+    EXPECT_EQ( obj->mesh()->points, newMesh.points );
+    EXPECT_GT( store.calcSpilledBytes(), 0 );
+    EXPECT_EQ( store.getStackPointer(), 1 );
+}
+
+TEST( MRViewer, HistoryStoreUnspillFailure )
+{
+    class BrokenAction : public HistoryAction
+    {
+    public:
+        std::string name() const override { return "Broken"; }
+        void action( Type ) override { ++numActions; }
+        size_t heapBytes() const override { return 0; }
+        Expected<void> unspill() override { return unexpected( "Spilled file is damaged" ); }
+        int numActions = 0;
+    };
+
+    HistoryStore store;
+    auto broken = std::make_shared<BrokenAction>();
+    store.appendAction( broken );
+    ASSERT_EQ( store.getHistoryStack().size(), 1 );
+
+    // the action that cannot be restored is not performed and removed from the stack
+    EXPECT_FALSE( store.undo() );
+    EXPECT_EQ( broken->numActions, 0 );
+    EXPECT_TRUE( store.getHistoryStack().empty() );
+    EXPECT_EQ( store.getStackPointer(), 0 );
+}
+
 } //namespace MR
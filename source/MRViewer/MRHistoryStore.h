@@ -48,6 +48,17 @@ public:
     /// Compute amount of memory occupied by all actions in this store
     [[nodiscard]] MRVIEWER_API size_t calcUsedMemory() const;
 
+    /// Set memory limit for the actions kept in memory, if all actions in the stack exceed it -
+    /// the actions most distant from the current position are moved in compressed files on disk (if they support it),
+    /// and loaded back on undo/redo; the memory limit above applies to the sum of memory and disk sizes of undo actions
+    void setSpillLimit( size_t limit ) { spillLimit_ = limit; spillByMemoryLimit_(); }
+
+    /// Returns current limit for the actions kept in memory (by default uint64 max, meaning no spilling on disk)
+    [[nodiscard]] size_t getSpillLimit() const { return spillLimit_; }
+
+    /// Compute amount of disk space occupied by all spilled actions in this store
+    [[nodiscard]] MRVIEWER_API size_t calcSpilledBytes() const;
+
     /// Returns full history stack
     [[nodiscard]] const HistoryActionsVector& getHistoryStack() const { return stack_; }
 
@@ -93,6 +104,9 @@ private:
     /// buffer for merging actions, if present, used for storing
     HistoryActionsVector* scopedBlock_{ nullptr };
 
+    /// temporary folder for spilled actions, created on first need
+    std::unique_ptr<UniqueTemporaryFolder> spillFolder_;
+
     /// main history stack
     HistoryActionsVector stack_;
 
@@ -106,11 +120,21 @@ private:
     /// memory limit (bytes) to this HistoryStore if stack_ exceed it, old actions are removed
     size_t storageLimit_{ size_t( ~0 ) };
 
+    /// memory limit (bytes) for the actions in stack_ kept in memory, if exceeded, the actions are spilled on disk
+    size_t spillLimit_{ size_t( ~0 ) };
+
     /// true only during Undo or Redo ongoing operation
     bool undoRedoInProgress_{ false };
 
+    /// loads back spilled data of the action with given index before undo or redo,
+    /// if it fails then logs the error, removes the action from the stack and returns false
+    bool unspillOrDrop_( size_t index );
+
     /// removes all undo actions from the beginning of the stack that exceed memory limit
     void filterByMemoryLimit_();
+
+    /// moves the actions most distant from firstRedoIndex_ on disk until the memory of remaining actions fits in spill limit
+    MRVIEWER_API void spillByMemoryLimit_();
 };
 
 /// \}
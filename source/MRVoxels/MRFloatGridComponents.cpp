@@ -1,10 +1,11 @@
 #include "MRFloatGridComponents.h"
 
-#include "MRMesh/MRUnionFind.h"
+#include "MRMesh/MRConcurrentUnionFind.h"
 #include "MRVDBFloatGrid.h"
 #include "MRMesh/MRVolumeIndexer.h"
 #include "MRMesh/MRBitSet.h"
 #include "MRMesh/MRTimer.h"
+#include "MRMesh/MRParallelFor.h"
 
 namespace MR
 {
@@ -15,10 +16,12 @@ namespace FloatGridComponents
 UnionFind<VoxelId> getUnionFindStructureVoxels( const FloatGrid& grid, const VolumeIndexer& indexer, const Vector3i& minVox, float isoValue )
 {
     MR_TIMER;
-    UnionFind<VoxelId> unionFindStructure( indexer.size() );
-    auto accessor = grid->getConstAccessor();
+    ConcurrentUnionFind<VoxelId> unionFindStructure( indexer.size() );
 
-    for ( int z = 0; z < indexer.dims().z; ++z )
+    ParallelFor( 0, indexer.dims().z, [&]( int z )
+    {
+        // accessors cache tree nodes and cannot be shared among threads
+        auto accessor = grid->getConstAccessor();
         for ( int y = 0; y < indexer.dims().y; ++y )
             for ( int x = 0; x < indexer.dims().x; ++x )
             {
@@ -36,7 +39,8 @@ UnionFind<VoxelId> getUnionFindStructureVoxels( const FloatGrid& grid, const Vol
                         unionFindStructure.unite( thisVox, neighVox );
                 }
             }
-    return unionFindStructure;
+    } );
+    return std::move( unionFindStructure ).toUnionFind();
 }
 
 std::vector<VoxelBitSet> getAllComponents( const FloatGrid& grid, float isoValue /*= 0.0f*/ )
@@ -1,5 +1,6 @@
 #include "MRMarchingCubes.h"
 #include "MRVoxelsVolumeCachingAccessor.h"
+#include "MRSparseVolume.h"
 #include "MROpenVDB.h"
 #include "MRMesh/MRSeparationPoint.h"
 #include "MRMesh/MRIsNaN.h"
@@ -9,6 +10,7 @@
 #include "MRMesh/MRMeshBuilder.h"
 #include "MRMesh/MRTimer.h"
 #include "MRMesh/MRParallelFor.h"
+#include "MRMesh/MRBitSetParallelFor.h"
 #include "MRMesh/MRTriMesh.h"
 
 #include <thread>
@@ -325,6 +327,14 @@ TriangulationPlan{}
 
 const std::array<OutEdge, size_t( NeighborDir::Count )> cPlusOutEdges { OutEdge::PlusX, OutEdge::PlusY, OutEdge::PlusZ };
 
+constexpr auto defaultPositioner = []( const Vector3f& pos0, const Vector3f& pos1, float v0, float v1, float iso )
+{
+    assert( v0 != v1 );
+    const auto ratio = ( iso - v0 ) / ( v1 - v0 );
+    assert( ratio >= 0 && ratio <= 1 );
+    return ( 1.0f - ratio ) * pos0 + ratio * pos1;
+};
+
 class VolumeMesher
 {
 public:
@@ -416,14 +426,6 @@ VolumeMesher::VolumeMesher( const Vector3i & dims, const MarchingCubesParams& pa
 template<typename V>
 Expected<void> VolumeMesher::addPart( const V& part )
 {
-    constexpr auto defaultPositioner = []( const Vector3f& pos0, const Vector3f& pos1, float v0, float v1, float iso )
-    {
-        assert( v0 != v1 );
-        const auto ratio = ( iso - v0 ) / ( v1 - v0 );
-        assert( ratio >= 0 && ratio <= 1 );
-        return ( 1.0f - ratio ) * pos0 + ratio * pos1;
-    };
-
     if ( params_.positioner )
         return addPart_( part, params_.positioner );
     else
@@ -872,6 +874,210 @@ Expected<TriMesh> VolumeMesher::finalize()
     return result;
 }
 
+/// marching cubes over sparse volume, where only the bricks with individual values of voxels and the bricks touching them are processed in parallel;
+/// the separation points on the edges from each voxel in positive directions are stored in the block of voxel's brick
+template<typename Positioner>
+Expected<TriMesh> sparseMarchingCubes( const SparseVolume& volume, const MarchingCubesParams& params, Positioner&& positioner )
+{
+    MR_TIMER;
+    const auto & grid = volume.data;
+    const auto & dims = volume.dims;
+    const auto & brickDims = grid.brickDims();
+    assert( grid.dims() == dims );
+    constexpr int side = SparseBlockGrid::cBrickSide;
+
+    // an empty brick can contain separation points or triangles only if some of its neighbours in positive directions
+    // is not empty or has another value
+    BitSet active( grid.brickCount() );
+    BitSetParallelForAll( active, [&]( size_t brickId )
+    {
+        if ( grid.isAllocated( brickId ) )
+        {
+            active.set( brickId );
+            return;
+        }
+        const auto brickPos = grid.toBrickPos( brickId );
+        const auto value = grid.emptyValue( brickId );
+        for ( const auto & d : cVoxelNeighbors )
+        {
+            const auto neiPos = brickPos + d;
+            if ( neiPos.x >= brickDims.x || neiPos.y >= brickDims.y || neiPos.z >= brickDims.z )
+                continue;
+            const auto neiId = grid.toBrickId( neiPos );
+            if ( grid.isAllocated( neiId ) || !( grid.emptyValue( neiId ) == value ) )
+            {
+                active.set( brickId );
+                return;
+            }
+        }
+    } );
+
+    std::vector<size_t> activeBricks;
+    activeBricks.reserve( active.count() );
+    std::vector<int> brickToActive( grid.brickCount(), -1 );
+    for ( auto brickId : active )
+    {
+        brickToActive[brickId] = int( activeBricks.size() );
+        activeBricks.push_back( brickId );
+    }
+
+    SeparationPointStorage sepStorage;
+    sepStorage.resize( activeBricks.size(), SparseBlockGrid::cBrickVoxels );
+    auto voxelKey = []( int activeIndex, const Vector3i & pos )
+    {
+        return size_t( activeIndex ) * SparseBlockGrid::cBrickVoxels + SparseBlockGrid::inBrickIndex( pos );
+    };
+    // all neighbours of the voxels not on the upper sides of an empty brick have the same value
+    auto innerInEmpty = []( const Vector3i & pos, const Vector3i & begin )
+    {
+        return pos.x + 1 < begin.x + side && pos.y + 1 < begin.y + side && pos.z + 1 < begin.z + side;
+    };
+    const Vector3f zeroPoint = params.origin + 0.5f * volume.voxelSize;
+
+    if ( !ParallelFor( activeBricks, [&]( size_t ai )
+    {
+        const auto brickId = activeBricks[ai];
+        auto & block = sepStorage.getBlock( ai );
+        const bool allocated = grid.isAllocated( brickId );
+        const auto begin = grid.brickBegin( brickId );
+        const auto end = grid.brickEnd( brickId );
+        Vector3i pos;
+        for ( pos.z = begin.z; pos.z < end.z; ++pos.z )
+        {
+            for ( pos.y = begin.y; pos.y < end.y; ++pos.y )
+            {
+                for ( pos.x = begin.x; pos.x < end.x; ++pos.x )
+                {
+                    if ( !allocated && innerInEmpty( pos, begin ) )
+                        continue;
+                    const float value = grid.value( pos );
+                    const bool lower = value < params.iso;
+                    if ( !lower && !( value >= params.iso ) )
+                        continue; // value is NaN
+
+                    const auto coords = zeroPoint + mult( volume.voxelSize, Vector3f( pos ) );
+                    SeparationPointSet set;
+                    bool atLeastOneOk = false;
+                    for ( int n = int( NeighborDir::X ); n < int( NeighborDir::Count ); ++n )
+                    {
+                        auto nextPos = pos;
+                        if ( ++nextPos[n] >= dims[n] )
+                            continue;
+                        const float nextValue = grid.value( nextPos );
+                        if ( lower ? !( nextValue >= params.iso ) : !( nextValue < params.iso ) )
+                            continue; // nextValue is on the same side of params.iso or it is NaN
+
+                        auto nextCoords = coords;
+                        nextCoords[n] += volume.voxelSize[n];
+                        set[n] = block.nextVid();
+                        block.coords.push_back( positioner( coords, nextCoords, value, nextValue, params.iso ) );
+                        atLeastOneOk = true;
+                    }
+                    if ( atLeastOneOk )
+                        block.smap.insert( { voxelKey( int( ai ), pos ), set } );
+                }
+            }
+        }
+    }, subprogress( params.cb, 0.0f, 0.4f ), 1 ) )
+        return unexpectedOperationCanceled();
+
+    const auto totalVertices = sepStorage.makeUniqueVids();
+    if ( totalVertices > params.maxVertices )
+        return unexpected( "Vertices number limit exceeded." );
+
+    // triangulate the cells having the lowest corner in each active brick
+    const VolumeIndexer indexer( dims );
+    if ( !ParallelFor( activeBricks, [&]( size_t ai )
+    {
+        const auto brickId = activeBricks[ai];
+        auto & block = sepStorage.getBlock( ai );
+        const bool allocated = grid.isAllocated( brickId );
+        const auto begin = grid.brickBegin( brickId );
+        const auto end = grid.brickEnd( brickId );
+        std::array<const SeparationPointSet*, 7> neis;
+        Vector3i pos;
+        for ( pos.z = begin.z; pos.z < end.z && pos.z + 1 < dims.z; ++pos.z )
+        {
+            for ( pos.y = begin.y; pos.y < end.y && pos.y + 1 < dims.y; ++pos.y )
+            {
+                for ( pos.x = begin.x; pos.x < end.x && pos.x + 1 < dims.x; ++pos.x )
+                {
+                    if ( !allocated && innerInEmpty( pos, begin ) )
+                        continue;
+                    unsigned char voxelConfiguration = 0;
+                    bool voxelValid = true;
+                    for ( int i = 0; i < cVoxelNeighbors.size(); ++i )
+                    {
+                        const float v = grid.value( pos + cVoxelNeighbors[i] );
+                        if ( v < params.iso )
+                            voxelConfiguration |= cMapNeighbors[i];
+                        else if ( !( v >= params.iso ) )
+                        {
+                            // the cells with NaN values are skipped
+                            voxelValid = false;
+                            break;
+                        }
+                    }
+                    if ( !voxelValid || voxelConfiguration == 0x00 || voxelConfiguration == 0xff )
+                        continue;
+
+                    for ( int i = 0; i < neis.size(); ++i )
+                    {
+                        const auto neiPos = pos + cVoxelNeighbors[i];
+                        const auto neiActive = brickToActive[grid.toBrickId( SparseBlockGrid::brickOf( neiPos ) )];
+                        neis[i] = neiActive >= 0 ? sepStorage.findSeparationPointSet( voxelKey( neiActive, neiPos ) ) : nullptr;
+                    }
+
+                    const auto& plan = cTriangleTable[voxelConfiguration];
+                    for ( int i = 0; i < plan.size(); i += 3 )
+                    {
+                        const auto& [interIndex0, dir0] = cEdgeIndicesMap[plan[i]];
+                        const auto& [interIndex1, dir1] = cEdgeIndicesMap[plan[i + 1]];
+                        const auto& [interIndex2, dir2] = cEdgeIndicesMap[plan[i + 2]];
+                        assert( neis[interIndex0] && (*neis[interIndex0])[int( dir0 )] );
+                        assert( neis[interIndex1] && (*neis[interIndex1])[int( dir1 )] );
+                        assert( neis[interIndex2] && (*neis[interIndex2])[int( dir2 )] );
+
+                        if ( params.lessInside )
+                            block.tris.emplace_back( ThreeVertIds{
+                                (*neis[interIndex0])[int( dir0 )],
+                                (*neis[interIndex2])[int( dir2 )],
+                                (*neis[interIndex1])[int( dir1 )]
+                            } );
+                        else
+                            block.tris.emplace_back( ThreeVertIds{
+                                (*neis[interIndex0])[int( dir0 )],
+                                (*neis[interIndex1])[int( dir1 )],
+                                (*neis[interIndex2])[int( dir2 )]
+                            } );
+                        if ( params.outVoxelPerFaceMap )
+                            block.faceMap.emplace_back( indexer.toVoxelId( pos ) );
+                    }
+                }
+            }
+        }
+    }, subprogress( params.cb, 0.4f, 0.85f ), 1 ) )
+        return unexpectedOperationCanceled();
+
+    // free input volume, since it will not be used below any more
+    if ( params.freeVolume )
+        params.freeVolume();
+
+    TriMesh result;
+    result.tris = sepStorage.getTriangulation( params.outVoxelPerFaceMap );
+
+    if ( params.cb && !params.cb( 0.95f ) )
+        return unexpectedOperationCanceled();
+
+    result.points.resize( totalVertices );
+    sepStorage.getPoints( result.points );
+
+    if ( params.cb && !params.cb( 1.0f ) )
+        return unexpectedOperationCanceled();
+
+    return result;
+}
+
 } // anonymous namespace
 
 Expected<TriMesh> marchingCubesAsTriMesh( const SimpleVolume& volume, const MarchingCubesParams& params /*= {} */ )
@@ -946,6 +1152,27 @@ Expected<Mesh> marchingCubes( const FunctionVolume& volume, const MarchingCubesP
     } );
 }
 
+Expected<TriMesh> marchingCubesAsTriMesh( const SparseVolume& volume, const MarchingCubesParams& params )
+{
+    if ( volume.dims.x <= 0 || volume.dims.y <= 0 || volume.dims.z <= 0 )
+        return TriMesh{};
+    if ( params.positioner )
+        return sparseMarchingCubes( volume, params, params.positioner );
+    else
+        return sparseMarchingCubes( volume, params, defaultPositioner );
+}
+
+Expected<Mesh> marchingCubes( const SparseVolume& volume, const MarchingCubesParams& params )
+{
+    MR_TIMER;
+    auto p = params;
+    p.cb = subprogress( params.cb, 0.0f, 0.9f );
+    return marchingCubesAsTriMesh( volume, p ).and_then( [&params]( TriMesh && tm ) -> Expected<Mesh>
+    {
+        return Mesh::fromTriMesh( std::move( tm ), {}, subprogress( params.cb, 0.9f, 1.0f ) );
+    } );
+}
+
 struct MarchingCubesByParts::Impl
 {
     VolumeMesher mesher;
@@ -73,6 +73,11 @@ MRVOXELS_API Expected<TriMesh> marchingCubesAsTriMesh( const VdbVolume& volume,
 MRVOXELS_API Expected<Mesh> marchingCubes( const FunctionVolume& volume, const MarchingCubesParams& params = {} );
 MRVOXELS_API Expected<TriMesh> marchingCubesAsTriMesh( const FunctionVolume& volume, const MarchingCubesParams& params = {} );
 
+// makes Mesh from SparseVolume with given settings using Marching Cubes algorithm,
+// only the bricks with individual values of voxels and their neighbours are processed; the cells with NaN values are skipped
+MRVOXELS_API Expected<Mesh> marchingCubes( const SparseVolume& volume, const MarchingCubesParams& params = {} );
+MRVOXELS_API Expected<TriMesh> marchingCubesAsTriMesh( const SparseVolume& volume, const MarchingCubesParams& params = {} );
+
 /// converts volume split on parts by planes z=const into mesh,
 /// last z-layer of previous part must be repeated as first z-layer of next part
 /// usage:
@@ -6,8 +6,13 @@
 #include "MRMesh/MRVolumeIndexer.h"
 #include "MRMesh/MRFastWindingNumber.h"
 #include "MRMesh/MRParallelMinMax.h"
+#include "MRMesh/MRBitSetParallelFor.h"
 #include "MRMesh/MRAABBTree.h"
 #include "MRMesh/MRPointsToMeshProjector.h"
+#include "MRMesh/MRMeshProject.h"
+#include "MRMesh/MRMeshIntersect.h"
+#include "MRMesh/MRMeshDistance.h"
+#include "MRMesh/MRLine3.h"
 #include <tuple>
 
 namespace MR
@@ -75,18 +80,136 @@ FunctionVolume meshToDistanceFunctionVolume( const MeshPart& mp, const MeshToDis
     if ( params.dist.signMode == SignDetectionMode::HoleWindingRule )
         mp.mesh.getDipoles();
 
-    return FunctionVolume
+    auto getter = [params, mp] ( const Vector3i& pos ) -> float
+    {
+        const auto coord = Vector3f( pos ) + Vector3f::diagonal( 0.5f );
+        const auto voxelCenter = params.vol.origin + mult( params.vol.voxelSize, coord );
+        auto dist = signedDistanceToMesh( mp, voxelCenter, params.dist );
+        return dist ? *dist : cQuietNan;
+    };
+
+    // same values as from getter, but the projection of each voxel starts from the triangle of the previous voxel in the row,
+    // and in WindingRule mode one ray along the row gives the signs of all its voxels
+    auto rowGetter = [params, mp] ( const Vector3i& pos, int count, float* out )
     {
-        .data = [params, mp] ( const Vector3i& pos ) -> float
+        const auto& op = params.dist;
+        std::vector<Vector3f> centers( count );
+        for ( int i = 0; i < count; ++i )
+        {
+            const auto coord = Vector3f( pos ) + Vector3f( float( i ) + 0.5f, 0.5f, 0.5f );
+            centers[i] = params.vol.origin + mult( params.vol.voxelSize, coord );
+        }
+
+        const auto range = signedDistanceProjectionRange( op );
+        const auto projs = findProjections( centers, mp, range.max, {}, range.min );
+
+        // distances along the row from the first voxel center to all intersections with the mesh
+        std::vector<double> hits;
+        if ( op.signMode == SignDetectionMode::WindingRule && count > 0 )
+        {
+            const Line3d ray{ Vector3d( centers[0] ), Vector3d::plusX() };
+            rayMeshIntersectAll( mp, ray, [&hits] ( const MeshIntersectionResult& r ) { hits.push_back( r.distanceAlongLine ); return true; } );
+            std::sort( hits.begin(), hits.end() );
+        }
+
+        size_t numHitsBefore = 0;
+        for ( int i = 0; i < count; ++i )
         {
-            const auto coord = Vector3f( pos ) + Vector3f::diagonal( 0.5f );
-            const auto voxelCenter = params.vol.origin + mult( params.vol.voxelSize, coord );
-            auto dist = signedDistanceToMesh( mp, voxelCenter, params.dist );
-            return dist ? *dist : cQuietNan;
-        },
+            std::optional<bool> inside;
+            if ( op.signMode == SignDetectionMode::WindingRule )
+            {
+                // the ray from this voxel center sees only the intersections not before it
+                const double offset = double( centers[i].x ) - double( centers[0].x );
+                while ( numHitsBefore < hits.size() && hits[numHitsBefore] < offset )
+                    ++numHitsBefore;
+                inside = ( hits.size() - numHitsBefore ) % 2 == 1;
+            }
+            const auto dist = signedDistanceToMesh( mp, centers[i], projs[i], op, inside );
+            out[i] = dist ? *dist : cQuietNan;
+        }
+    };
+
+    return FunctionVolume
+    {
+        .data = std::move( getter ),
+        .dims = params.vol.dimensions,
+        .voxelSize = params.vol.voxelSize,
+        .rowGetter = std::move( rowGetter )
+    };
+}
+
+Expected<SparseVolume> meshToDistanceSparseVolume( const MeshPart& mp, const MeshToDistanceVolumeParams& params )
+{
+    MR_TIMER;
+    if ( params.dist.signMode == SignDetectionMode::OpenVDB )
+        return unexpected( "OpenVDB sign detection mode is not supported for sparse volumes" );
+    if ( !( params.dist.maxDistSq < FLT_MAX ) )
+        return unexpected( "Maximal distance must be finite for sparse volumes" );
+
+    const auto minDist = std::sqrt( params.dist.minDistSq );
+    const auto maxDist = std::sqrt( params.dist.maxDistSq );
+    SparseVolume res
+    {
+        .data = SparseBlockGrid( params.vol.dimensions, maxDist ),
         .dims = params.vol.dimensions,
         .voxelSize = params.vol.voxelSize
     };
+    auto & grid = res.data;
+    const auto func = meshToDistanceFunctionVolume( mp, params );
+
+    // find the bricks intersecting the band by the distance from the center of each brick
+    BitSet inBand( grid.brickCount() );
+    if ( !BitSetParallelForAll( inBand, [&]( size_t brickId )
+    {
+        const auto begin = grid.brickBegin( brickId );
+        const auto end = grid.brickEnd( brickId );
+        const auto center = params.vol.origin + mult( params.vol.voxelSize, 0.5f * Vector3f( begin + end ) );
+        const auto halfDiag = 0.5f * mult( params.vol.voxelSize, Vector3f( end - begin - Vector3i::diagonal( 1 ) ) ).length();
+
+        auto op = params.dist;
+        op.minDistSq = sqr( std::max( 0.0f, minDist - halfDiag ) );
+        op.maxDistSq = sqr( maxDist + halfDiag );
+        op.nullOutsideMinMax = false;
+        const auto dist = signedDistanceToMesh( mp, center, op );
+        if ( !dist )
+            return; // no projection found, leave the brick empty with positive value
+        const auto absDist = std::abs( *dist );
+        if ( absDist >= maxDist + halfDiag )
+            grid.setEmptyValue( brickId, std::copysign( maxDist, *dist ) );
+        else if ( absDist < minDist - halfDiag )
+            grid.setEmptyValue( brickId, std::copysign( minDist, *dist ) );
+        else
+            inBand.set( brickId );
+    }, subprogress( params.vol.cb, 0.0f, 0.2f ), 64 ) )
+        return unexpectedOperationCanceled();
+
+    std::vector<size_t> bandBricks;
+    bandBricks.reserve( inBand.count() );
+    for ( auto brickId : inBand )
+    {
+        grid.allocate( brickId );
+        bandBricks.push_back( brickId );
+    }
+
+    // evaluate the values in the band by rows of bricks
+    if ( !ParallelFor( bandBricks, [&]( size_t i )
+    {
+        const auto brickId = bandBricks[i];
+        const auto begin = grid.brickBegin( brickId );
+        const auto end = grid.brickEnd( brickId );
+        auto * values = grid.brickValues( brickId );
+        for ( int z = begin.z; z < end.z; ++z )
+        {
+            for ( int y = begin.y; y < end.y; ++y )
+            {
+                const Vector3i pos{ begin.x, y, z };
+                func.getRow( pos, end.x - begin.x, values + SparseBlockGrid::inBrickIndex( pos ) );
+            }
+        }
+    }, subprogress( params.vol.cb, 0.2f, 1.0f ), 1 ) )
+        return unexpectedOperationCanceled();
+
+    return res;
 }
 
 Expected<SimpleVolumeMinMax> meshRegionToIndicatorVolume( const Mesh& mesh, const FaceBitSet& region,
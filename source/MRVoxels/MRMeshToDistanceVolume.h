@@ -2,6 +2,7 @@
 
 #include "MRDistanceVolumeParams.h"
 #include "MRVoxelsVolume.h"
+#include "MRSparseVolume.h"
 #include "MRMesh/MRExpected.h"
 #include "MRMesh/MRMeshDistance.h"
 #include <memory>
@@ -24,6 +25,12 @@ MRVOXELS_API Expected<SimpleVolumeMinMax> meshToDistanceVolume( const MeshPart&
 /// makes FunctionVolume representing (signed or unsigned) distances from Mesh with given settings
 MRVOXELS_API FunctionVolume meshToDistanceFunctionVolume( const MeshPart& mp, const MeshToDistanceVolumeParams& params = {} );
 
+/// makes SparseVolume with (signed or unsigned) distances from Mesh computed only in the bricks intersecting the band of distances
+/// [sqrt(params.dist.minDistSq), sqrt(params.dist.maxDistSq)), which must be finite;
+/// all voxels of any other brick get the value of nearest band boundary with the sign of brick's center;
+/// params.dist.nullOutsideMinMax = false is recommended for subsequent marchingCubes, otherwise the voxels outside the band are NaNs
+MRVOXELS_API Expected<SparseVolume> meshToDistanceSparseVolume( const MeshPart& mp, const MeshToDistanceVolumeParams& params );
+
 /// returns a volume filled with the values:
 /// v < 0: this point is within offset distance to region-part of mesh and it is closer to region-part than to not-region-part
 MRVOXELS_API Expected<SimpleVolumeMinMax> meshRegionToIndicatorVolume( const Mesh& mesh, const FaceBitSet& region,
@@ -629,6 +629,17 @@ Expected<std::future<Expected<void>>> ObjectVoxels::serializeModel_( const std::
     } );
 }
 
+std::function<Expected<void>( std::ostream& )> ObjectVoxels::serializeModelToStream_( std::string& ) const
+{
+    return {};
+}
+
+Expected<void> ObjectVoxels::deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb )
+{
+    // skip the implementation of ObjectMeshHolder, since the files are read by deserializeModel_
+    return VisualObject::deserializeModelFromMemory_( key, std::move( files ), progressCb );
+}
+
 void ObjectVoxels::deserializeFields_( const Json::Value& root )
 {
     VisualObject::deserializeFields_( root );
@@ -268,6 +268,13 @@ protected:
     MRVOXELS_API Expected<void> deserializeModel_( const std::filesystem::path& path, ProgressCallback progressCb = {} ) override;
 
     MRVOXELS_API virtual Expected<std::future<Expected<void>>> serializeModel_( const std::filesystem::path& path ) const override;
+
+    /// voxels are saved only in files by serializeModel_
+    MRVOXELS_API virtual std::function<Expected<void>( std::ostream& )> serializeModelToStream_( std::string& extension ) const override;
+
+    [[nodiscard]] virtual bool hasFileModel_() const override { return !ancillary_ && bool( vdbVolume_.data ); }
+
+    MRVOXELS_API Expected<void> deserializeModelFromMemory_( const std::string& key, std::vector<ObjectModelFile> files, ProgressCallback progressCb = {} ) override;
 };
 
 /// returns file extension used to serialize ObjectVoxels by default (if not overridden in specific object),
@@ -0,0 +1,49 @@
+#include "MRSparseVolume.h"
+#include "MRMesh/MRExpected.h"
+#include "MRMesh/MRTimer.h"
+#include "MRMesh/MRVolumeIndexer.h"
+#include "MRMesh/MRParallelMinMax.h"
+
+namespace MR
+{
+
+SparseBlockGrid::SparseBlockGrid( const Vector3i & dims, float emptyValue )
+    : dims_( dims )
+    , brickDims_( ( dims + Vector3i::diagonal( cBrickSide - 1 ) ) / cBrickSide )
+{
+    assert( dims.x >= 0 && dims.y >= 0 && dims.z >= 0 );
+    bricks_.resize( size_t( brickDims_.x ) * brickDims_.y * brickDims_.z, Brick{ .value = emptyValue } );
+}
+
+void SparseBlockGrid::allocate( size_t brickId )
+{
+    auto & b = bricks_[brickId];
+    if ( b.slot >= 0 )
+        return;
+    b.slot = int( allocatedBrickCount() );
+    values_.resize( values_.size() + cBrickVoxels, b.value );
+}
+
+Expected<SimpleVolumeMinMax> sparseVolumeToSimpleVolume( const SparseVolume& volume, const ProgressCallback& cb )
+{
+    MR_TIMER;
+    SimpleVolumeMinMax res;
+    res.voxelSize = volume.voxelSize;
+    res.dims = volume.dims;
+    VolumeIndexer indexer( res.dims );
+    res.data.resize( indexer.size() );
+
+    if ( !ParallelFor( size_t( 0 ), size_t( res.dims.y ) * res.dims.z, [&]( size_t row )
+    {
+        Vector3i pos{ 0, int( row % res.dims.y ), int( row / res.dims.y ) };
+        auto * out = res.data.data() + indexer.toVoxelId( pos );
+        for ( ; pos.x < res.dims.x; ++pos.x )
+            *out++ = volume.data.value( pos );
+    }, cb ) )
+        return unexpectedOperationCanceled();
+
+    std::tie( res.min, res.max ) = parallelMinMax( res.data );
+    return res;
+}
+
+} //namespace MR
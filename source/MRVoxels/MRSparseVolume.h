@@ -0,0 +1,105 @@
+#pragma once
+
+#include "MRVoxelsVolume.h"
+#include <algorithm>
+#include <cassert>
+
+namespace MR
+{
+
+/// voxel values stored in bricks of 8x8x8 voxels, where only the bricks near the surface of interest have individual values of voxels,
+/// and all voxels of any other (empty) brick have one common value;
+/// it gives memory savings similar to OpenVDB grids for narrow-band distance volumes without OpenVDB dependency
+class SparseBlockGrid
+{
+public:
+    /// the number of voxels along each side of a brick
+    static constexpr int cBrickSide = 8;
+    /// the number of voxels in one brick
+    static constexpr int cBrickVoxels = cBrickSide * cBrickSide * cBrickSide;
+
+    SparseBlockGrid() = default;
+
+    /// creates the grid of given dimensions in voxels with all bricks empty having given value
+    MRVOXELS_API explicit SparseBlockGrid( const Vector3i & dims, float emptyValue = 0 );
+
+    /// the number of voxels along each axis
+    [[nodiscard]] const Vector3i & dims() const { return dims_; }
+
+    /// the number of bricks along each axis
+    [[nodiscard]] const Vector3i & brickDims() const { return brickDims_; }
+
+    /// the total number of bricks including empty ones
+    [[nodiscard]] size_t brickCount() const { return bricks_.size(); }
+
+    /// the number of bricks with individual values of voxels
+    [[nodiscard]] size_t allocatedBrickCount() const { return values_.size() / cBrickVoxels; }
+
+    /// returns the brick containing given voxel
+    [[nodiscard]] static Vector3i brickOf( const Vector3i & voxelPos ) { return voxelPos / cBrickSide; }
+
+    /// returns the index of given voxel among the values of its brick
+    [[nodiscard]] static int inBrickIndex( const Vector3i & voxelPos )
+        { return ( voxelPos.x % cBrickSide ) + cBrickSide * ( ( voxelPos.y % cBrickSide ) + cBrickSide * ( voxelPos.z % cBrickSide ) ); }
+
+    /// converts the brick's position in the grid of bricks into its linear index and back
+    [[nodiscard]] size_t toBrickId( const Vector3i & brickPos ) const
+        { return size_t( brickPos.x ) + size_t( brickDims_.x ) * ( size_t( brickPos.y ) + size_t( brickDims_.y ) * brickPos.z ); }
+    [[nodiscard]] Vector3i toBrickPos( size_t brickId ) const
+        { return { int( brickId % brickDims_.x ), int( brickId / brickDims_.x % brickDims_.y ), int( brickId / ( size_t( brickDims_.x ) * brickDims_.y ) ) }; }
+
+    /// the range [begin, end) of voxels in given brick, which is smaller than full brick near the upper boundaries of the grid
+    [[nodiscard]] Vector3i brickBegin( size_t brickId ) const { return toBrickPos( brickId ) * cBrickSide; }
+    [[nodiscard]] Vector3i brickEnd( size_t brickId ) const
+    {
+        const auto e = brickBegin( brickId ) + Vector3i::diagonal( cBrickSide );
+        return { std::min( e.x, dims_.x ), std::min( e.y, dims_.y ), std::min( e.z, dims_.z ) };
+    }
+
+    /// returns true if given brick has individual values of voxels
+    [[nodiscard]] bool isAllocated( size_t brickId ) const { return bricks_[brickId].slot >= 0; }
+
+    /// the value of all voxels in given empty brick
+    [[nodiscard]] float emptyValue( size_t brickId ) const { assert( !isAllocated( brickId ) ); return bricks_[brickId].value; }
+    void setEmptyValue( size_t brickId, float value ) { assert( !isAllocated( brickId ) ); bricks_[brickId].value = value; }
+
+    /// allocates individual values of voxels in given brick, all initialized with its empty value;
+    /// this function is not thread-safe and invalidates pointers returned by brickValues()
+    MRVOXELS_API void allocate( size_t brickId );
+
+    /// returns the values of all voxels of given allocated brick, x-index changes fastest, then y, and z is the slowest
+    [[nodiscard]] float * brickValues( size_t brickId ) { assert( isAllocated( brickId ) ); return values_.data() + size_t( bricks_[brickId].slot ) * cBrickVoxels; }
+    [[nodiscard]] const float * brickValues( size_t brickId ) const { assert( isAllocated( brickId ) ); return values_.data() + size_t( bricks_[brickId].slot ) * cBrickVoxels; }
+
+    /// returns the value of given voxel
+    [[nodiscard]] float value( const Vector3i & voxelPos ) const
+    {
+        const auto & b = bricks_[toBrickId( brickOf( voxelPos ) )];
+        return b.slot < 0 ? b.value : values_[size_t( b.slot ) * cBrickVoxels + inBrickIndex( voxelPos )];
+    }
+
+    /// returns the amount of memory this object occupies on heap
+    [[nodiscard]] size_t heapBytes() const { return MR::heapBytes( bricks_ ) + MR::heapBytes( values_ ); }
+
+private:
+    struct Brick
+    {
+        int slot = -1; ///< the index of brick's values in values_ or -1 if the brick is empty
+        float value = 0; ///< the value of all voxels in empty brick
+    };
+    Vector3i dims_;
+    Vector3i brickDims_;
+    std::vector<Brick> bricks_;
+    std::vector<float> values_;
+};
+
+template <>
+struct VoxelTraits<SparseBlockGrid>
+{
+    using ValueType = float;
+};
+
+/// converts sparse volume into dense simple volume
+MRVOXELS_API Expected<SimpleVolumeMinMax> sparseVolumeToSimpleVolume( const SparseVolume& volume, const ProgressCallback& callback = {} );
+
+} //namespace MR
@@ -360,8 +360,29 @@ VdbVolume functionVolumeToVdbVolume( const FunctionVolume& functoinVolume, Progr
     MR_TIMER;
     VdbVolume res;
     std::shared_ptr<openvdb::FloatGrid> grid = std::make_shared<openvdb::FloatGrid>( FLT_MAX );
-    auto gridAccessor = grid->getAccessor();
-    putVolumeInDenseGrid( gridAccessor, { 0, 0, 0 }, functoinVolume, cb );
+
+    // evaluate whole rows of voxels in parallel in dense slabs of several layers, and copy each slab in the grid
+    const auto& dims = functoinVolume.dims;
+    const size_t layerSize = size_t( std::max( dims.x, 0 ) ) * std::max( dims.y, 0 );
+    const int slabLayers = layerSize > 0 ? int( std::clamp( ( size_t( 1 ) << 22 ) / layerSize, size_t( 1 ), size_t( std::max( dims.z, 1 ) ) ) ) : 1;
+    SimpleVolume slab;
+    slab.dims = { dims.x, dims.y, slabLayers };
+    slab.data.resize( layerSize * slabLayers );
+    for ( int z0 = 0; layerSize > 0 && z0 < dims.z; z0 += slabLayers )
+    {
+        slab.dims.z = std::min( slabLayers, dims.z - z0 );
+        slab.data.resize( layerSize * slab.dims.z );
+        ParallelFor( 0, dims.y * slab.dims.z, [&] ( int row )
+        {
+            const int y = row % dims.y;
+            const int z = row / dims.y;
+            functoinVolume.getRow( { 0, y, z0 + z }, dims.x, slab.data.data() + size_t( row ) * dims.x );
+        } );
+        putSimpleVolumeInDenseGrid( *grid, { 0, 0, z0 }, slab );
+        if ( !reportProgress( cb, float( z0 + slab.dims.z ) / dims.z ) )
+            return {};
+    }
+
     auto minMax = openvdb::tools::minMax( grid->tree() );
     res.min = minMax.min();
     res.max = minMax.max();
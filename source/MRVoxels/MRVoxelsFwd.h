@@ -32,14 +32,21 @@ MR_CANONICAL_TYPEDEFS( (template <typename T> struct), MRVOXELS_CLASS VoxelsVolu
 
 using VdbVolumes = std::vector<VdbVolume>;
 
+/// evaluates the values of (count) consecutive voxels along x-axis starting from (pos) and writes them in (out)
+template <typename T>
+using VoxelRowGetter = std::function<void ( const Vector3i& pos, int count, T* out )>;
+
 template <typename T>
 using VoxelValueGetter = std::function<T ( const Vector3i& )>;
 
+class SparseBlockGrid;
+
 MR_CANONICAL_TYPEDEFS( (template <typename T> struct), MRVOXELS_CLASS VoxelsVolume,
     ( FunctionVolume, VoxelsVolume<VoxelValueGetter<float>> )
     ( FunctionVolumeU8, VoxelsVolume<VoxelValueGetter<uint8_t>> )
     ( SimpleVolume, VoxelsVolume<std::vector<float>> )
     ( SimpleVolumeU16, VoxelsVolume<std::vector<uint16_t>> )
+    ( SparseVolume, VoxelsVolume<SparseBlockGrid> )
 )
 
 namespace VoxelsLoad
@@ -16,9 +16,11 @@ Expected<SimpleVolumeMinMax> functionVolumeToSimpleVolume( const FunctionVolume&
     VolumeIndexer indexer( res.dims );
     res.data.resize( indexer.size() );
 
-    if ( !ParallelFor( size_t( 0 ), indexer.size(), [&]( size_t i )
+    // evaluate whole rows along x-axis
+    if ( !ParallelFor( size_t( 0 ), size_t( res.dims.y ) * res.dims.z, [&]( size_t row )
     {
-        res.data[i] = volume.data( indexer.toPos( VoxelId( i ) ) );
+        const Vector3i pos{ 0, int( row % res.dims.y ), int( row / res.dims.y ) };
+        volume.getRow( pos, res.dims.x, res.data.data() + indexer.toVoxelId( pos ) );
     }, cb ) )
         return unexpectedOperationCanceled();
 
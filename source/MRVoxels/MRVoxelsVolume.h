@@ -46,6 +46,33 @@ struct VoxelsVolume
     [[nodiscard]] size_t heapBytes() const { return MR::heapBytes( data ); }
 };
 
+/// represents a box in 3D space with the values of voxels given by a function;
+/// the function can be accompanied by the function evaluating whole rows of voxels at once, which is much faster than separate calls for each voxel
+template <typename T>
+struct VoxelsVolume<VoxelValueGetter<T>>
+{
+    using ValueType = T;
+
+    VoxelValueGetter<T> data;
+    Vector3i dims;
+    Vector3f voxelSize{ 1.f, 1.f, 1.f };
+
+    /// optional function evaluating whole rows of voxels, the values must be the same as returned by (data)
+    VoxelRowGetter<T> rowGetter;
+
+    /// evaluates (count) consecutive voxels along x-axis starting from (pos) by rowGetter if it is set, or by (data) otherwise
+    void getRow( const Vector3i& pos, int count, T* out ) const
+    {
+        if ( rowGetter )
+            return rowGetter( pos, count, out );
+        auto p = pos;
+        for ( int i = 0; i < count; ++i, ++p.x )
+            out[i] = data( p );
+    }
+
+    [[nodiscard]] size_t heapBytes() const { return MR::heapBytes( data ); }
+};
+
 /// represents a box in 3D space subdivided on voxels stored in T;
 /// and stores minimum and maximum values among all valid voxels
 template <typename T>
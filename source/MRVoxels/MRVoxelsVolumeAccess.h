@@ -104,12 +104,12 @@ public:
     static constexpr bool cacheEffective = true; ///< caching results of this accessor can improve performance
 
     explicit VoxelsVolumeAccessor( const VolumeType& volume )
-        : data_( volume.data )
+        : volume_( volume )
     {}
 
     ValueType get( const Vector3i& pos ) const
     {
-        return data_( pos );
+        return volume_.data( pos );
     }
 
     ValueType get( const VoxelLocation & loc ) const
@@ -117,11 +117,17 @@ public:
         return get( loc.pos );
     }
 
+    /// evaluates (count) consecutive voxels along x-axis starting from (pos)
+    void getRow( const Vector3i& pos, int count, ValueType* out ) const
+    {
+        volume_.getRow( pos, count, out );
+    }
+
     /// this additional shift shall be added to integer voxel coordinates during transformation in 3D space
     Vector3f shift() const { return Vector3f::diagonal( 0.5f ); }
 
 private:
-    const VoxelValueGetter<T>& data_;
+    const VolumeType& volume_;
 };
 
 } // namespace MR
@@ -98,9 +98,15 @@ private:
         firstLayerVoxelId_[layerIndex] = indexer_.toVoxelId( Vector3i{ 0, 0, z } );
         return ParallelFor( 0, dims.y, [&]( int y )
         {
+            size_t n = size_t( y ) * dims.x;
+            if constexpr ( requires { accessor_.getRow( Vector3i{}, 0, (ValueType*)nullptr ); } )
+            {
+                // evaluate whole row at once if the accessor supports it
+                accessor_.getRow( Vector3i{ 0, y, z }, dims.x, layer.data() + n );
+                return;
+            }
             auto accessor = accessor_; // only for OpenVDB accessor, which is not thread-safe
             auto loc = indexer_.toLoc( Vector3i{ 0, y, z } );
-            size_t n = size_t( y ) * dims.x;
             for ( loc.pos.x = 0; loc.pos.x < dims.x; ++loc.pos.x, ++loc.id, ++n )
                 layer[n] = accessor.get( loc );
         }, cb, 1 );
@@ -9,6 +9,8 @@
 #include "MRMesh/MRVertexAttributeGradient.h"
 #include "MRMesh/MRPolyline.h"
 #include "MRMesh/MRCloseVertices.h"
+#include "MRMesh/MRColor.h"
+#include <cstring>
 
 #include "MRMesh/MRMacros.h"
 #include "MRPythonNumpy.h"
@@ -18,12 +20,27 @@ MR_INIT_PYTHON_MODULE_PRECALL( mrmeshnumpy, [] ()
     pybind11::module_::import( MR_STR( MRMESHNUMPY_PARENT_MODULE_NAME ) ".mrmeshpy" );
 } )
 
+// returns true if given (n,cols) array of elements of type T is C-contiguous, so it can be copied as a whole
+template<typename T>
+bool isContiguousNumpyArray( const pybind11::buffer_info& bufInfo, pybind11::ssize_t cols )
+{
+    return bufInfo.format == pybind11::format_descriptor<T>::format() && bufInfo.itemsize == sizeof( T )
+        && bufInfo.strides[1] == pybind11::ssize_t( sizeof( T ) ) && bufInfo.strides[0] == cols * pybind11::ssize_t( sizeof( T ) );
+}
+
 std::vector<MR::Vector3f> fromNumpyArrayInfo( const pybind11::buffer_info& bufInfo )
 {
     std::vector<MR::Vector3f> vec;
     auto stride0 = bufInfo.strides[0] / bufInfo.itemsize;
     auto stride1 = bufInfo.strides[1] / bufInfo.itemsize;
     vec.resize( bufInfo.shape[0] );
+    static_assert( sizeof( MR::Vector3f ) == 3 * sizeof( float ) );
+    if ( !vec.empty() && isContiguousNumpyArray<float>( bufInfo, 3 ) )
+    {
+        // the layout of float32 array is the same as of Vector3f
+        std::memcpy( vec.data(), bufInfo.ptr, vec.size() * sizeof( MR::Vector3f ) );
+        return vec;
+    }
     auto fillData = [&] ( const auto* data )
     {
         for ( auto i = 0; i < bufInfo.shape[0]; i++ )
@@ -73,8 +90,19 @@ MR::Mesh fromFV( const pybind11::buffer& faces, const pybind11::buffer& verts, c
     auto strideF1 = infoFaces.strides[1] / infoFaces.itemsize;
     MR::Triangulation t;
 
+    static_assert( sizeof( MR::ThreeVertIds ) == 3 * sizeof( int32_t ) );
     auto fillTris = [&] ( const auto* data )
     {
+        if constexpr ( std::is_same_v<std::remove_cvref_t<decltype( *data )>, int32_t> )
+        {
+            if ( infoFaces.shape[0] > 0 && isContiguousNumpyArray<int32_t>( infoFaces, 3 ) )
+            {
+                // the layout of int32 array is the same as of Triangulation
+                t.resize( infoFaces.shape[0] );
+                std::memcpy( t.data(), data, t.size() * sizeof( MR::ThreeVertIds ) );
+                return;
+            }
+        }
         t.reserve( infoFaces.shape[0] );
         for ( auto i = 0; i < infoFaces.shape[0]; i++ )
         {
@@ -513,6 +541,57 @@ pybind11::array_t<double> getNumpyCurvatureGradient( const MR::Mesh& mesh )
         freeWhenDone ); // numpy array references this parent
 }
 
+// returns numpy array of shape [n,cols] referencing the memory of (data) without copying;
+// the array keeps alive the Python object of (owner), which shall own the memory
+template<typename T, typename Owner>
+pybind11::array_t<T> makeNumpyView( const Owner& owner, const void* data, size_t n, size_t cols )
+{
+    return pybind11::array_t<T>(
+        { n, cols }, // shape
+        { cols * sizeof( T ), sizeof( T ) }, // C-style contiguous strides
+        static_cast<const T*>( data ),
+        pybind11::cast( &owner, pybind11::return_value_policy::reference ) ); // numpy array references the owner instead of copying the data
+}
+
+template<typename I>
+pybind11::array_t<float> toNumpyArrayView( const MR::Vector<MR::Vector3f, I>& coords )
+{
+    static_assert( sizeof( MR::Vector3f ) == 3 * sizeof( float ) );
+    return makeNumpyView<float>( coords, coords.data(), coords.size(), 3 );
+}
+
+pybind11::array_t<int32_t> toNumpyArrayView( const MR::Triangulation& tris )
+{
+    static_assert( sizeof( MR::ThreeVertIds ) == 3 * sizeof( int32_t ) );
+    return makeNumpyView<int32_t>( tris, tris.data(), tris.size(), 3 );
+}
+
+pybind11::array_t<uint8_t> toNumpyArrayView( const MR::VertColors& colors )
+{
+    static_assert( sizeof( MR::Color ) == 4 * sizeof( uint8_t ) );
+    return makeNumpyView<uint8_t>( colors, colors.data(), colors.size(), 4 );
+}
+
+// returns numpy array shapes [num verts,3] of float32 referencing the coordinates of all mesh points without copying
+pybind11::array_t<float> getNumpyVertsView( const MR::Mesh& mesh )
+{
+    return makeNumpyView<float>( mesh, mesh.points.data(), mesh.points.size(), 3 );
+}
+
+// returns read-only numpy array of uint64 referencing the blocks of given bitset without copying
+pybind11::array_t<uint64_t> getNumpyBitSetWordsView( const MR::BitSet& bitSet )
+{
+    const auto& bits = bitSet.bits();
+    pybind11::array_t<uint64_t> res(
+        { bits.size() }, // shape
+        { sizeof( uint64_t ) }, // C-style contiguous strides
+        bits.data(),
+        pybind11::cast( &bitSet, pybind11::return_value_policy::reference ) ); // numpy array references the bitset instead of copying the data
+    // modification of the blocks could break the invariants of the bitset
+    res.attr( "setflags" )( false );
+    return res;
+}
+
 MR_ADD_PYTHON_CUSTOM_DEF( mrmeshnumpy, NumpyMeshData, [] ( pybind11::module_& m )
 {
     m.def( "getNumpyCurvature", &getNumpyCurvature, pybind11::arg( "mesh" ), "retunrs numpy array with curvature for each valid vertex of given mesh" );
@@ -524,6 +603,20 @@ MR_ADD_PYTHON_CUSTOM_DEF( mrmeshnumpy, NumpyMeshData, [] ( pybind11::module_& m
     m.def( "toNumpyArray", ( pybind11::array_t<double>( * )( const MR::FaceNormals& ) )& toNumpyArray, pybind11::arg( "coords" ), "returns numpy array shapes [num coords,3] which represents coordinates from given vector" );
     m.def( "toNumpyArray", ( pybind11::array_t<double>( * )( const std::vector<MR::Vector3f>& ) )& toNumpyArray, pybind11::arg( "coords" ), "returns numpy array shapes [num coords,3] which represents coordinates from given vector" );
     m.def( "fromNumpyArray", &fromNumpyArray, pybind11::arg( "coords" ), "constructs mrmeshpy.vectorVector3f from numpy ndarray with shape (n,3)" );
+
+    m.def( "getNumpyVertsView", &getNumpyVertsView, pybind11::arg( "mesh" ),
+        "returns float32 numpy array shapes [num verts,3] sharing the memory of all mesh points (including invalid ones) without copying; "
+        "the array keeps the mesh alive, and becomes invalid if the number of mesh points changes" );
+    m.def( "toNumpyArrayView", ( pybind11::array_t<float>( * )( const MR::VertCoords& ) )& toNumpyArrayView, pybind11::arg( "coords" ),
+        "returns float32 numpy array shapes [num coords,3] sharing the memory of given vector without copying, e.g. of VertCoords or VertNormals" );
+    m.def( "toNumpyArrayView", ( pybind11::array_t<float>( * )( const MR::FaceNormals& ) )& toNumpyArrayView, pybind11::arg( "coords" ),
+        "returns float32 numpy array shapes [num coords,3] sharing the memory of given vector without copying" );
+    m.def( "toNumpyArrayView", ( pybind11::array_t<int32_t>( * )( const MR::Triangulation& ) )& toNumpyArrayView, pybind11::arg( "tris" ),
+        "returns int32 numpy array shapes [num faces,3] sharing the memory of given triangulation without copying" );
+    m.def( "toNumpyArrayView", ( pybind11::array_t<uint8_t>( * )( const MR::VertColors& ) )& toNumpyArrayView, pybind11::arg( "colors" ),
+        "returns uint8 numpy array shapes [num verts,4] sharing the memory of given colors without copying" );
+    m.def( "getNumpyBitSetWordsView", &getNumpyBitSetWordsView, pybind11::arg( "bitset" ),
+        "returns read-only uint64 numpy array sharing the memory of the blocks of given bitset without copying, bit i is in the block i/64" );
 } )
 
 MR_ADD_PYTHON_CUSTOM_DEF( mrmeshnumpy, PointCloudFromPoints, [] ( pybind11::module_& m )
@@ -0,0 +1,38 @@
+import numpy as np
+import pytest
+from helper import *
+
+
+def test_numpy_views():
+    faces = np.array([[0, 1, 2], [2, 3, 0]], dtype=np.int32)
+    verts = np.array(
+        [[0.0, 0.0, 0.0], [1.0, 0.0, 0.0], [1.0, 1.0, 0.0], [0.0, 1.0, 0.0]],
+        dtype=np.float32,
+    )
+    mesh = mrmeshnumpy.meshFromFacesVerts(faces, verts)
+
+    # the view shares the memory with the mesh
+    vertsView = mrmeshnumpy.getNumpyVertsView(mesh)
+    assert vertsView.dtype == np.float32
+    assert vertsView.shape == (4, 3)
+    assert np.array_equal(vertsView, verts)
+    vertsView[1, 2] = 5.0
+    assert mesh.points.vec[1].z == 5.0
+
+    # the view keeps the mesh alive
+    del mesh
+    assert vertsView[1, 2] == 5.0
+
+    mesh = mrmeshnumpy.meshFromFacesVerts(faces, verts)
+    normsView = mrmeshnumpy.toNumpyArrayView(mrmesh.computePerVertNormals(mesh))
+    assert normsView.shape == (4, 3)
+    assert np.allclose(normsView[:, 2], 1.0)
+
+    trisView = mrmeshnumpy.toNumpyArrayView(mesh.topology.getTriangulation())
+    assert trisView.dtype == np.int32
+    assert trisView.shape == (2, 3)
+
+    wordsView = mrmeshnumpy.getNumpyBitSetWordsView(mesh.topology.getValidVerts())
+    assert wordsView.dtype == np.uint64
+    assert wordsView[0] == 0b1111
+    assert not wordsView.flags.writeable